@@ -192,7 +192,7 @@ void create_model::createModelClassFromPG(
     *client << "SELECT * "
                "FROM information_schema.columns "
                "WHERE table_schema = $1 "
-               "AND table_name   = $2"
+               "AND table_name   = $2"_sqlLiteral
             << schema << tableName << Mode::Blocking >>
         [&](const Result &r) {
             if (r.size() == 0)
@@ -302,7 +302,7 @@ void create_model::createModelClassFromPG(
                "INNER JOIN pg_class ON pg_constraint.conrelid = pg_class.oid "
                "WHERE "
                "pg_class.relname = $1 "
-               "AND pg_constraint.contype = 'p'"
+               "AND pg_constraint.contype = 'p'"_sqlLiteral
             << tableName << Mode::Blocking >>
         [&](bool isNull,
             const std::string &pkName,
@@ -330,7 +330,8 @@ void create_model::createModelClassFromPG(
                    "pg_class.oid "
                    "AND pg_attribute.attnum = pg_constraint.conkey [ 1 ] "
                    "INNER JOIN pg_type ON pg_type.oid = pg_attribute.atttypid "
-                   "WHERE pg_class.relname = $1 and pg_constraint.contype='p'"
+                   "WHERE pg_class.relname = $1 and "
+                   "pg_constraint.contype='p'"_sqlLiteral
                 << tableName << Mode::Blocking >>
             [&](bool isNull,
                 const std::string &colName,
@@ -371,7 +372,7 @@ void create_model::createModelClassFromPG(
                        "INNER JOIN pg_type ON pg_type.oid = "
                        "pg_attribute.atttypid "
                        "WHERE pg_class.relname = $2 and "
-                       "pg_constraint.contype='p'"
+                       "pg_constraint.contype='p'"_sqlLiteral
                     << (int)i << tableName << Mode::Blocking >>
                 [&](bool isNull, std::string colName, const std::string &type) {
                     if (isNull)
@@ -424,7 +425,7 @@ void create_model::createModelFromPG(
                "b.objoid "
                "WHERE a.relnamespace = (SELECT oid FROM pg_namespace WHERE "
                "nspname = $1) "
-               "AND a.relkind = 'r' ORDER BY a.relname"
+               "AND a.relkind = 'r' ORDER BY a.relname"_sqlLiteral
             << schema << Mode::Blocking >>
         [&](bool isNull,
             size_t oid,
@@ -611,22 +612,23 @@ void create_model::createModelFromMysql(
     std::map<std::string, std::vector<Relationship>> &relationships,
     std::map<std::string, std::vector<ConvertMethod>> &convertMethods)
 {
-    *client << "show tables" << Mode::Blocking >> [&](bool isNull,
-                                                      std::string &&tableName) {
-        if (!isNull)
-        {
-            std::cout << "table name:" << tableName << std::endl;
-            createModelClassFromMysql(path,
-                                      client,
-                                      tableName,
-                                      restfulApiConfig,
-                                      relationships[tableName],
-                                      convertMethods[tableName]);
-        }
-    } >> [](const DrogonDbException &e) {
-        std::cerr << e.base().what() << std::endl;
-        exit(1);
-    };
+    *client << "show tables"_sqlLiteral << Mode::Blocking >>
+        [&](bool isNull, std::string &&tableName) {
+            if (!isNull)
+            {
+                std::cout << "table name:" << tableName << std::endl;
+                createModelClassFromMysql(path,
+                                          client,
+                                          tableName,
+                                          restfulApiConfig,
+                                          relationships[tableName],
+                                          convertMethods[tableName]);
+            }
+        } >>
+        [](const DrogonDbException &e) {
+            std::cerr << e.base().what() << std::endl;
+            exit(1);
+        };
 }
 #endif
 #if USE_SQLITE3
@@ -679,7 +681,7 @@ void create_model::createModelClassFromSqlite3(
                 else
                 {
                     *client << "SELECT sql FROM sqlite_master WHERE name=? and "
-                               "(type='table' or type='view');"
+                               "(type='table' or type='view');"_sqlLiteral
                             << tableName << Mode::Blocking >>
                         [&](bool isNull, std::string sql) {
                             if (!isNull)
@@ -793,7 +795,7 @@ void create_model::createModelFromSqlite3(
     std::map<std::string, std::vector<ConvertMethod>> &convertMethods)
 {
     *client << "SELECT name FROM sqlite_master WHERE name!='sqlite_sequence' "
-               "and (type='table' or type='view') ORDER BY name;"
+               "and (type='table' or type='view') ORDER BY name;"_sqlLiteral
             << Mode::Blocking >>
         [&](bool isNull, std::string &&tableName) mutable {
             if (!isNull)
@@ -24,6 +24,7 @@
 #include <drogon/HttpFilter.h>
 #include <drogon/MultiPart.h>
 #include <drogon/NotFound.h>
+#include <drogon/SessionStore.h>
 #include <drogon/drogon_callbacks.h>
 #include <drogon/utils/Utilities.h>
 #include <drogon/plugins/Plugin.h>
@@ -917,6 +918,33 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
     virtual HttpAppFramework &registerSessionDestroyAdvice(
         const AdviceDestroySessionCallback &advice) = 0;
 
+    /// Set the store of sessions.
+    /**
+     * @param store The session store. Sessions are kept in the memory of the
+     * process by default.
+     * @note This method takes effect only if sessions are enabled.
+     */
+    virtual HttpAppFramework &setSessionStore(
+        const std::shared_ptr<SessionStore> &store) = 0;
+
+    /// Keep sessions in redis, so that they can be shared by processes.
+    /**
+     * @param clientName The name of the redis client created by the
+     * createRedisClient() method or in the configuration file.
+     * @param keyPrefix The prefix of the keys of sessions.
+     * @param nearCacheSize The max number of sessions cached in the process,
+     * 0 means no cache. A cached session is used without being loaded from
+     * redis for one second.
+     *
+     * @note
+     * See nosql::RedisSessionStore for details.
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &setRedisSessionStore(
+        const std::string &clientName = "default",
+        const std::string &keyPrefix = "drogon:session:",
+        size_t nearCacheSize = 0) = 0;
+
     /// Disable sessions supporting.
     /**
      * @note
@@ -1110,13 +1138,35 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
      *
      * @note
      * This operation can be performed by an option in the configuration file.
-     * Even though sendfile() is enabled, only files larger than 200k are sent
-     * this way,
+     * Even though sendfile() is enabled, only files larger than the threshold
+     * set by the setSendfileThreshold() method are sent this way,
      * because the advantages of sendfile() can only be reflected in sending
      * large files.
      */
     virtual HttpAppFramework &enableSendfile(bool sendFile) = 0;
 
+    /// Set the size of files above which sendfile() is used.
+    /**
+     * @param threshold The number of bytes, 200k by default. Smaller files
+     * are read into the bodies of responses by the file IO threads.
+     *
+     * @note
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &setSendfileThreshold(size_t threshold) = 0;
+
+    /// Set the number of threads that read and write files.
+    /**
+     * @param threadNum The number of threads, 2 by default. Files of responses,
+     * uploaded files saved by the HttpFile::saveAsync() method and request
+     * bodies cached in files are read or written in these threads, so that
+     * slow disks don't stall the IO threads.
+     *
+     * @note
+     * This operation can be performed by an option in the configuration file.
+     */
+    virtual HttpAppFramework &setFileIoThreadNum(size_t threadNum) = 0;
+
     /// Enable gzip compression.
     /**
      * @param useGzip if the parameter is true, use gzip to compress the
@@ -1508,6 +1558,10 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
      * @param password Password for the redis server
      * @param connectionNum The number of connections to the redis server.
      * @param isFast Indicates if the client is a fast database client.
+     * @param loopAffinity If true (and isFast is false), the client creates
+     * connectionNum connections on each IO loop instead of running its own
+     * threads. The commands executed in an IO loop are sent by the connections
+     * of that loop and their callbacks are called in the same loop.
      *
      * @note
      * This operation can be performed by an option in the configuration file.
@@ -1521,7 +1575,8 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
         bool isFast = false,
         double timeout = -1.0,
         unsigned int db = 0,
-        const std::string &username = "") = 0;
+        const std::string &username = "",
+        bool loopAffinity = false) = 0;
 
     /// Get the DNS resolver
     /**
@@ -1618,6 +1673,25 @@ class DROGON_EXPORT HttpAppFramework : public trantor::NonCopyable
     virtual HttpAppFramework &enableRequestStream(bool enable = true) = 0;
     virtual bool isRequestStreamEnabled() const = 0;
 
+    /**
+     * @brief Enable streaming of large multipart/form-data bodies to disk.
+     *
+     * @param enable If true, when the body of a multipart/form-data request
+     * is larger than the client_max_memory_body_size, each uploaded file is
+     * written to its own temporary file while the body is received. Saving
+     * such a file renames its temporary file instead of copying it. The
+     * body() of such requests is empty, their files and parameters are got
+     * through the MultiPartParser. Form fields without file names are still
+     * kept in memory and are limited by the client_max_memory_body_size.
+     * The default value is false.
+     *
+     * @note This operation can be performed by an option in the
+     * configuration file.
+     */
+    virtual HttpAppFramework &enableStreamingMultipartUpload(
+        bool enable = true) = 0;
+    virtual bool isStreamingMultipartUploadEnabled() const = 0;
+
   private:
     virtual void registerHttpController(
         const std::string &pathPattern,
@@ -506,6 +506,16 @@ class DROGON_EXPORT HttpRequest
 
     virtual bool connected() const noexcept = 0;
 
+    /**
+     * @brief Add a callback that is called if the client closes the
+     * connection before the response is sent, e.g. to cancel the database
+     * statements of the request with a drogon::orm::CancelToken.
+     *
+     * @note The callback is called in the IO loop of the connection, or right
+     * away if the request has already been aborted.
+     */
+    virtual void addAbortCallback(std::function<void()> callback) = 0;
+
     virtual ~HttpRequest()
     {
     }
@@ -438,6 +438,10 @@ class DROGON_EXPORT HttpResponse
 
     /// Create a response that returns a file to the client.
     /**
+     * @note When it is called in an IO loop and the file isn't sent with
+     * sendfile, the file is read in a file IO thread while the response is
+     * being sent, so the body() of the returned response is empty. If the
+     * file IO threads are overloaded, a 503 response is sent instead.
      * @param fullPath is the full path to the file.
      * @param attachmentFileName if the parameter is not empty, the browser
      * does not open the file, but saves it as an attachment.
@@ -457,6 +461,10 @@ class DROGON_EXPORT HttpResponse
     /**
      * @brief If offset and length can not be satisfied, statusCode will be set
      * to k416RequestedRangeNotSatisfiable, and nothing else will be modified.
+     * @note When it is called in an IO loop and the file isn't sent with
+     * sendfile, the file is read in a file IO thread while the response is
+     * being sent, so the body() of the returned response is empty. If the
+     * file IO threads are overloaded, a 503 response is sent instead.
      *
      * @param fullPath is the full path to the file.
      * @param offset is the offset to begin sending, in bytes.
@@ -17,6 +17,7 @@
 #include "drogon/utils/Utilities.h"
 #include <drogon/exports.h>
 #include <drogon/HttpRequest.h>
+#include <functional>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -80,6 +81,24 @@ class DROGON_EXPORT HttpFile
      */
     int saveAs(const std::string &fileName) const noexcept;
 
+    /// Save the file in the file IO threads like the save() method.
+    /**
+     * @param callback is called with the result of the saving, in the IO
+     * thread that calls this method, or in a file IO thread if this method
+     * isn't called in an IO thread.
+     */
+    void saveAsync(std::function<void(int)> &&callback) const;
+
+    /// Save the file to @p path in the file IO threads like the save(path)
+    /// method.
+    void saveAsync(const std::string &path,
+                   std::function<void(int)> &&callback) const;
+
+    /// Save the file with a new name in the file IO threads like the saveAs()
+    /// method.
+    void saveAsAsync(const std::string &fileName,
+                     std::function<void(int)> &&callback) const;
+
     /**
      * @brief return the content of the file.
      *
@@ -27,6 +27,9 @@ namespace drogon
 /**
  * @brief This class represents a session stored in the framework.
  * One can get or set any type of data to a session object.
+ * @note Any call to the insert(), erase(), clear() or modify() methods that
+ * may change the data marks the session as modified, session stores that keep
+ * sessions out of the process only write back modified sessions.
  */
 class Session
 {
@@ -114,6 +117,7 @@ class Session
             if (typeid(T) == it->second.type())
             {
                 handler(*(std::any_cast<T>(&(it->second))));
+                dirty_ = true;
             }
             else
             {
@@ -125,6 +129,7 @@ class Session
             auto item = T();
             handler(item);
             sessionMap_.insert(std::make_pair(key, std::any(std::move(item))));
+            dirty_ = true;
         }
     }
 
@@ -142,6 +147,7 @@ class Session
     {
         std::lock_guard<std::mutex> lck(mutex_);
         handler(sessionMap_);
+        dirty_ = true;
     }
 
     /**
@@ -155,7 +161,7 @@ class Session
     void insert(const std::string &key, const std::any &obj)
     {
         std::lock_guard<std::mutex> lck(mutex_);
-        sessionMap_.insert(std::make_pair(key, obj));
+        dirty_ |= sessionMap_.insert(std::make_pair(key, obj)).second;
     }
 
     /**
@@ -169,7 +175,8 @@ class Session
     void insert(const std::string &key, std::any &&obj)
     {
         std::lock_guard<std::mutex> lck(mutex_);
-        sessionMap_.insert(std::make_pair(key, std::move(obj)));
+        dirty_ |=
+            sessionMap_.insert(std::make_pair(key, std::move(obj))).second;
     }
 
     /**
@@ -178,7 +185,7 @@ class Session
     void erase(const std::string &key)
     {
         std::lock_guard<std::mutex> lck(mutex_);
-        sessionMap_.erase(key);
+        dirty_ |= (sessionMap_.erase(key) > 0);
     }
 
     /**
@@ -200,6 +207,7 @@ class Session
     void clear()
     {
         std::lock_guard<std::mutex> lck(mutex_);
+        dirty_ |= !sessionMap_.empty();
         sessionMap_.clear();
     }
 
@@ -231,7 +239,9 @@ class Session
     std::string sessionId_;
     bool needToSet_{false};
     bool needToChange_{false};
+    bool dirty_{false};
     friend class SessionManager;
+    friend class SessionStore;
     friend class HttpAppFrameworkImpl;
 
     /**
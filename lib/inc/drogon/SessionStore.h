@@ -0,0 +1,125 @@
+/**
+ *
+ *  @file SessionStore.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/exports.h>
+#include <drogon/Session.h>
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/net/EventLoop.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace drogon
+{
+/**
+ * @brief The interface of session stores. The framework keeps sessions in
+ * the memory of the process by default, a custom store can be set by the
+ * HttpAppFramework::setSessionStore() method to share sessions between
+ * processes.
+ */
+class DROGON_EXPORT SessionStore : public trantor::NonCopyable
+{
+  public:
+    using SessionCallback = std::function<void(const SessionPtr &)>;
+
+    virtual ~SessionStore() = default;
+
+    /**
+     * @brief Called by the framework before the store is used.
+     *
+     * @param loop The main event loop of the application.
+     * @param timeout The timeout of sessions in seconds, 0 means sessions are
+     * never expired.
+     */
+    virtual void init(trantor::EventLoop * /*loop*/, size_t /*timeout*/)
+    {
+    }
+
+    /**
+     * @brief Find the session with the ID without waiting.
+     *
+     * @param sessionId The session ID.
+     * @param isNew True if the ID is just created for a new client, in which
+     * case there is nothing to look up and a new session must be returned.
+     * @return The session, or nullptr if it has to be loaded by the
+     * loadSession() method.
+     */
+    virtual SessionPtr findSession(const std::string &sessionId,
+                                   bool isNew) = 0;
+
+    /**
+     * @brief Load the session with the ID, a new session with the ID is
+     * created if it doesn't exist in the store.
+     *
+     * @param callback is called with the session in any thread, or with
+     * nullptr if the store can't be read, in which case the request is
+     * answered with 503 Service Unavailable.
+     */
+    virtual void loadSession(const std::string &sessionId,
+                             SessionCallback &&callback) = 0;
+
+    /**
+     * @brief Called when a request that uses the session is handled, the
+     * store should write the session back if it is modified.
+     */
+    virtual void saveSession(const SessionPtr &sessionPtr) = 0;
+
+    /**
+     * @brief Called after the ID of the session is changed. The old ID should
+     * remain valid for a while for requests sent before the client gets the
+     * new one.
+     */
+    virtual void changeSessionId(const SessionPtr &sessionPtr,
+                                 const std::string &oldId) = 0;
+
+  protected:
+    /**
+     * @brief Create a session object.
+     *
+     * @param needToSet True if the session ID has to be set to the client.
+     */
+    static SessionPtr newSession(const std::string &sessionId, bool needToSet);
+
+    /**
+     * @brief Return true if the session is modified since the last call of
+     * this method or of the encodeSession() method.
+     */
+    static bool checkDirty(const SessionPtr &sessionPtr);
+
+    /**
+     * @brief Serialize the data of the session and reset its modified flag.
+     *
+     * @note Values of the following types are supported: bool, int,
+     * unsigned int, long, unsigned long, long long, unsigned long long,
+     * float, double, std::string, const char * and Json::Value. A
+     * 'const char *' value is decoded as a std::string value. Values of other
+     * types are skipped with an error log.
+     */
+    static std::string encodeSession(const SessionPtr &sessionPtr);
+
+    /**
+     * @brief Restore the data encoded by the encodeSession() method to the
+     * session.
+     *
+     * @return false if the data is malformed, in which case the session is
+     * not changed.
+     */
+    static bool decodeSession(const SessionPtr &sessionPtr,
+                              std::string_view data);
+};
+
+}  // namespace drogon
@@ -16,6 +16,9 @@ namespace drogon
 {
 namespace plugin
 {
+class AccessLogFormatter;
+class AsyncAccessLogWriter;
+
 /**
  * @brief This plugin is used to print all requests to the log.
  *
@@ -29,13 +32,16 @@ namespace plugin
             "use_spdlog": false,
             "log_path": "./",
             "log_format": "",
+            "output_format": "text",
             "log_file": "access.log",
             "log_size_limit": 0,
             "use_local_time": true,
             "log_index": 0,
             // "show_microseconds": true,
             // "custom_time_format": "",
-            // "use_real_ip": false
+            // "use_real_ip": false,
+            // "async": false,
+            // "async_queue_size": 2048
       }
    }
    @endcode
@@ -69,6 +75,17 @@ namespace plugin
  * "$request_date $method $url [$body_bytes_received] ($remote_addr -
  * $local_addr) $status $body_bytes_sent $processing_time" is applied.
  *
+ * output_format: The format of the lines, "text" by default.
+ *     text: the log_format string with the placeholders replaced.
+ *     json: one JSON object per line. Each placeholder of log_format is a
+ *           key named after it without the '$' (e.g. "method", "http_host"),
+ *           the text between the placeholders is ignored. The lengths, the
+ *           status code, the thread number and the processing time are
+ *           numbers, the other values are escaped strings.
+ *     logfmt: key=value pairs separated by spaces, with the same keys as
+ *             json. The values containing spaces, quotes or '=' are quoted
+ *             and escaped.
+ *
  * use_spdlog: log using spdlog, disabled by default.
  *
  * log_path: Log file path, empty by default,in which case,logs are output to
@@ -95,6 +112,16 @@ namespace plugin
  * use_real_ip: Log the real ip of peer. This option only takes effects when
  * set to true and RealIpResolver is enabled. False by default.
  *
+ * async: If true, the IO threads only copy the data of each line into a
+ * per-thread queue, and a background thread formats the lines and writes them
+ * in batches. Strings of a line (paths, headers, cookies) are truncated when
+ * they exceed 512 bytes in total. False by default.
+ *
+ * async_queue_size: The number of lines each IO thread can queue when async is
+ * true, 2048 by default. When a queue is full, the lines are dropped and
+ * counted instead of blocking the IO thread, and a warning with the number of
+ * dropped lines is logged.
+ *
  * Enable the plugin by adding the configuration to the list of plugins in the
  * configuration file.
  *
@@ -109,6 +136,12 @@ class DROGON_EXPORT AccessLogger : public drogon::Plugin<AccessLogger>
     void initAndStart(const Json::Value &config) override;
     void shutdown() override;
 
+    /**
+     * @brief Return the number of lines dropped because the queue of an IO
+     * thread was full, always 0 if the async option is false.
+     */
+    uint64_t droppedLines() const;
+
   private:
     trantor::AsyncFileLogger asyncFileLogger_;
     int logIndex_{0};
@@ -117,97 +150,12 @@ class DROGON_EXPORT AccessLogger : public drogon::Plugin<AccessLogger>
     bool useCustomTimeFormat_{false};
     std::string timeFormat_;
     static bool useRealIp_;
+    std::shared_ptr<AsyncAccessLogWriter> asyncWriterPtr_;
 
-    using LogFunction = std::function<void(trantor::LogStream &,
-                                           const drogon::HttpRequestPtr &,
-                                           const drogon::HttpResponsePtr &)>;
-    std::vector<LogFunction> logFunctions_;
+    std::shared_ptr<AccessLogFormatter> formatterPtr_;
     void logging(trantor::LogStream &stream,
                  const drogon::HttpRequestPtr &req,
                  const drogon::HttpResponsePtr &resp);
-    void createLogFunctions(std::string format);
-    LogFunction newLogFunction(const std::string &placeholder);
-    std::map<std::string, LogFunction> logFunctionMap_;
-    //$request_path
-    static void outputReqPath(trantor::LogStream &,
-                              const drogon::HttpRequestPtr &,
-                              const drogon::HttpResponsePtr &);
-    //$request_query
-    static void outputReqQuery(trantor::LogStream &,
-                               const drogon::HttpRequestPtr &,
-                               const drogon::HttpResponsePtr &);
-    //$request_url
-    static void outputReqURL(trantor::LogStream &,
-                             const drogon::HttpRequestPtr &,
-                             const drogon::HttpResponsePtr &);
-    //$version
-    static void outputVersion(trantor::LogStream &,
-                              const drogon::HttpRequestPtr &,
-                              const drogon::HttpResponsePtr &);
-    //$request
-    static void outputReqLine(trantor::LogStream &,
-                              const drogon::HttpRequestPtr &,
-                              const drogon::HttpResponsePtr &);
-    //$date
-    void outputDate(trantor::LogStream &,
-                    const drogon::HttpRequestPtr &,
-                    const drogon::HttpResponsePtr &) const;
-    //$request_date
-    void outputReqDate(trantor::LogStream &,
-                       const drogon::HttpRequestPtr &,
-                       const drogon::HttpResponsePtr &) const;
-    //$remote_addr
-    static void outputRemoteAddr(trantor::LogStream &,
-                                 const drogon::HttpRequestPtr &,
-                                 const drogon::HttpResponsePtr &);
-    //$local_addr
-    static void outputLocalAddr(trantor::LogStream &,
-                                const drogon::HttpRequestPtr &,
-                                const drogon::HttpResponsePtr &);
-    //$request_len $body_bytes_received
-    static void outputReqLength(trantor::LogStream &,
-                                const drogon::HttpRequestPtr &,
-                                const drogon::HttpResponsePtr &);
-    //$response_len $body_bytes_sent
-    static void outputRespLength(trantor::LogStream &,
-                                 const drogon::HttpRequestPtr &,
-                                 const drogon::HttpResponsePtr &);
-    //$method
-    static void outputMethod(trantor::LogStream &,
-                             const drogon::HttpRequestPtr &,
-                             const drogon::HttpResponsePtr &);
-    //$thread
-    static void outputThreadNumber(trantor::LogStream &,
-                                   const drogon::HttpRequestPtr &,
-                                   const drogon::HttpResponsePtr &);
-    //$http_[header_name]
-    static void outputReqHeader(trantor::LogStream &stream,
-                                const drogon::HttpRequestPtr &req,
-                                const std::string &headerName);
-    //$cookie_[cookie_name]
-    static void outputReqCookie(trantor::LogStream &stream,
-                                const drogon::HttpRequestPtr &req,
-                                const std::string &cookie);
-    //$upstream_http_[header_name]
-    static void outputRespHeader(trantor::LogStream &stream,
-                                 const drogon::HttpResponsePtr &resp,
-                                 const std::string &headerName);
-    //$status
-    static void outputStatusString(trantor::LogStream &,
-                                   const drogon::HttpRequestPtr &,
-                                   const drogon::HttpResponsePtr &);
-    //$status_code
-    static void outputStatusCode(trantor::LogStream &,
-                                 const drogon::HttpRequestPtr &,
-                                 const drogon::HttpResponsePtr &);
-    //$processing_time
-    static void outputProcessingTime(trantor::LogStream &,
-                                     const drogon::HttpRequestPtr &,
-                                     const drogon::HttpResponsePtr &);
-    //$upstream_http_content-type $upstream_http_content_type
-    static void outputRespContentType(trantor::LogStream &,
-                                      const drogon::HttpRequestPtr &,
-                                      const drogon::HttpResponsePtr &);
 };
 }  // namespace plugin
 }  // namespace drogon
@@ -15,12 +15,13 @@
 #include <drogon/plugins/Plugin.h>
 #include <drogon/plugins/RealIpResolver.h>
 #include <drogon/HttpAppFramework.h>
-#include <drogon/CacheMap.h>
 #include <regex>
 #include <optional>
 
 namespace drogon
 {
+class RateLimiterTable;
+
 namespace plugin
 {
 /**
@@ -61,9 +62,14 @@ true, some mutexes are used for thread-safe.
         "multi_threads": true,
         // The message body of the response when the request is rejected.
         "rejection_message": "Too many requests",
-        // In seconds, the minimum expiration time of the limiters for different
-IPs or users. the default value is 600.
+        // This option is no longer used, the limiter of an IP or a user is
+dropped once it is back to its initial state.
         "limiter_expire_time": 600,
+        // The maximum number of IPs or users whose limiters are kept, for
+each capacity. Each one takes 32 bytes, the memory is allocated as clients are
+seen. When more clients are seen at the same time, the limiters of the least
+recently updated ones are dropped. the default value is 262144.
+        "limiter_table_size": 262144,
         "sub_limits": [
             {
                 "urls": ["^/api/1/.*", ...],
@@ -122,9 +128,8 @@ class DROGON_EXPORT Hodor : public drogon::Plugin<Hodor>
         size_t userCapacity{0};
         bool regexFlag{false};
         RateLimiterPtr globalLimiterPtr;
-        std::unique_ptr<CacheMap<std::string, RateLimiterPtr>> ipLimiterMapPtr;
-        std::unique_ptr<CacheMap<std::string, RateLimiterPtr>>
-            userLimiterMapPtr;
+        std::shared_ptr<RateLimiterTable> ipLimiterTablePtr;
+        std::shared_ptr<RateLimiterTable> userLimiterTablePtr;
     };
 
     LimitStrategy makeLimitStrategy(const Json::Value &config);
@@ -133,7 +138,7 @@ class DROGON_EXPORT Hodor : public drogon::Plugin<Hodor>
     std::chrono::duration<double> timeUnit_{1.0};
     bool multiThreads_{true};
     bool useRealIpResolver_{false};
-    size_t limiterExpireTime_{600};
+    size_t limiterTableSize_{262144};
     std::function<std::optional<std::string>(const drogon::HttpRequestPtr &)>
         userIdGetter_;
     std::function<HttpResponsePtr(const drogon::HttpRequestPtr &)>
@@ -32,6 +32,17 @@ namespace plugin
       "config": {
          // The path of the metrics. the default value is "/metrics".
          "path": "/metrics",
+         // If true, the request count, status classes, body sizes, queue
+         // time, handler time and write time of each route are recorded by
+         // the framework and exported with the drogon_http_ prefix. Routes
+         // are labeled with their path patterns, requests that don't match
+         // any controller are labeled with an empty route. The default value
+         // is false.
+         "server_metrics": false,
+         // The bucket boundaries in seconds of the histograms of the server
+         // metrics.
+         "server_metrics_buckets": [0.0001, 0.0005, 0.001, 0.005, 0.01,
+                                    0.05, 0.1, 0.5, 1, 5],
          // The list of collectors.
          "collectors":[
             {
@@ -41,7 +52,7 @@ namespace plugin
                "help": "The total number of http requests",
                // The type of the collector. The default value is "counter".
                // The other possible value is as following:
-               // "gauge", "histogram".
+               // "gauge", "histogram", "summary".
                "type": "counter",
                // The labels of the collector.
                "labels": ["method", "status"]
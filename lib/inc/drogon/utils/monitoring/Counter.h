@@ -14,8 +14,8 @@
 
 #pragma once
 #include <drogon/utils/monitoring/Metric.h>
+#include <drogon/utils/monitoring/MetricCells.h>
 #include <string_view>
-#include <mutex>
 
 namespace drogon
 {
@@ -38,10 +38,7 @@ class Counter : public Metric
     {
         Sample s;
         s.name = name_;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            s.value = value_;
-        }
+        s.value = value_.value();
         return {s};
     }
 
@@ -50,8 +47,7 @@ class Counter : public Metric
      * */
     void increment()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_++;
+        value_.add(1);
     }
 
     /**
@@ -59,14 +55,12 @@ class Counter : public Metric
      * */
     void increment(double value)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ += value;
+        value_.add(value);
     }
 
     void reset()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ = 0;
+        value_.reset();
     }
 
     static std::string_view type()
@@ -75,8 +69,9 @@ class Counter : public Metric
     }
 
   private:
-    mutable std::mutex mutex_;
-    double value_{0};
+    // The counter is updated from many threads, so it is split into
+    // per-thread cells that are only added up when it's collected.
+    internal::ShardedValue value_;
 };
 }  // namespace monitoring
 }  // namespace drogon
@@ -14,6 +14,7 @@
 
 #pragma once
 #include <drogon/utils/monitoring/Metric.h>
+#include <drogon/utils/monitoring/MetricCells.h>
 #include <string_view>
 #include <atomic>
 
@@ -40,10 +41,10 @@ class Gauge : public Metric
     std::vector<Sample> collect() const override
     {
         Sample s;
-        std::lock_guard<std::mutex> lock(mutex_);
         s.name = name_;
-        s.value = value_;
-        s.timestamp = timestamp_;
+        s.value = value_.load(std::memory_order_relaxed);
+        s.timestamp =
+            trantor::Date(timestamp_.load(std::memory_order_relaxed));
         return {s};
     }
 
@@ -52,20 +53,17 @@ class Gauge : public Metric
      * */
     void increment()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ += 1;
+        internal::atomicAdd(value_, 1);
     }
 
     void decrement()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ -= 1;
+        internal::atomicAdd(value_, -1);
     }
 
     void decrement(double value)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ -= value;
+        internal::atomicAdd(value_, -value);
     }
 
     /**
@@ -73,20 +71,17 @@ class Gauge : public Metric
      * */
     void increment(double value)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ += value;
+        internal::atomicAdd(value_, value);
     }
 
     void reset()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ = 0;
+        value_.store(0, std::memory_order_relaxed);
     }
 
     void set(double value)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        value_ = value;
+        value_.store(value, std::memory_order_relaxed);
     }
 
     static std::string_view type()
@@ -96,14 +91,15 @@ class Gauge : public Metric
 
     void setToCurrentTime()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        timestamp_ = trantor::Date::now();
+        timestamp_.store(trantor::Date::now().microSecondsSinceEpoch(),
+                         std::memory_order_relaxed);
     }
 
   private:
-    mutable std::mutex mutex_;
-    double value_{0};
-    trantor::Date timestamp_{0};
+    // Unlike counters, gauges can be set, so the value is a single atomic
+    // rather than per-thread cells.
+    std::atomic<double> value_{0};
+    std::atomic<int64_t> timestamp_{0};
 };
 }  // namespace monitoring
 }  // namespace drogon
@@ -15,6 +15,7 @@
 #pragma once
 #include <drogon/exports.h>
 #include <drogon/utils/monitoring/Metric.h>
+#include <drogon/utils/monitoring/MetricCells.h>
 #include <trantor/net/EventLoopThread.h>
 #include <string_view>
 #include <atomic>
@@ -30,13 +31,6 @@ namespace monitoring
 class DROGON_EXPORT Histogram : public Metric
 {
   public:
-    struct TimeBucket
-    {
-        std::vector<uint64_t> buckets;
-        uint64_t count{0};
-        double sum{0};
-    };
-
     Histogram(const std::string &name,
               const std::vector<std::string> &labelNames,
               const std::vector<std::string> &labelValues,
@@ -67,8 +61,6 @@ class DROGON_EXPORT Histogram : public Metric
                     "timeBucketsCount must be greater than 0");
             }
         }
-        timeBuckets_.emplace_back();
-        timeBuckets_.back().buckets.resize(bucketBoundaries.size() + 1);
         // check the bucket boundaries are sorted
         for (size_t i = 1; i < bucketBoundaries.size(); i++)
         {
@@ -78,6 +70,14 @@ class DROGON_EXPORT Histogram : public Metric
                     "The bucket boundaries must be sorted");
             }
         }
+        // The time buckets are a ring, the oldest one is cleared and reused
+        // when they are rotated.
+        auto ringSize = maxAge > std::chrono::seconds(0) ? timeBucketsCount : 1;
+        for (size_t i = 0; i < ringSize; ++i)
+        {
+            timeBuckets_.emplace_back(
+                std::make_unique<TimeBucket>(bucketBoundaries_.size() + 1));
+        }
     }
 
     void observe(double value);
@@ -97,27 +97,40 @@ class DROGON_EXPORT Histogram : public Metric
     }
 
   private:
-    std::deque<TimeBucket> timeBuckets_;
+    /**
+     * The samples observed in a period of time. Each thread updates its own
+     * cells with relaxed atomic operations, they are only added up when the
+     * histogram is collected.
+     * */
+    struct TimeBucket
+    {
+        explicit TimeBucket(size_t bucketsCount) : counters(bucketsCount)
+        {
+        }
+
+        void clear()
+        {
+            counters.reset();
+            sum.reset();
+        }
+
+        internal::ShardedCounters counters;
+        internal::ShardedValue sum;
+    };
+
+    std::vector<std::unique_ptr<TimeBucket>> timeBuckets_;
+    std::atomic<size_t> currentTimeBucket_{0};
     std::unique_ptr<trantor::EventLoopThread> loopThreadPtr_;
     trantor::EventLoop *loopPtr_{nullptr};
-    mutable std::mutex mutex_;
+    std::mutex timerMutex_;
+    std::atomic<bool> timerStarted_{false};
     std::chrono::duration<double> maxAge_;
     trantor::TimerId timerId_{trantor::InvalidTimerId};
     size_t timeBucketCount_{0};
     const std::vector<double> bucketBoundaries_;
 
-    void rotateTimeBuckets()
-    {
-        std::lock_guard<std::mutex> guard(mutex_);
-        TimeBucket bucket;
-        bucket.buckets.resize(bucketBoundaries_.size() + 1);
-        timeBuckets_.emplace_back(std::move(bucket));
-        if (timeBuckets_.size() > timeBucketCount_)
-        {
-            auto expiredTimeBucket = timeBuckets_.front();
-            timeBuckets_.erase(timeBuckets_.begin());
-        }
-    }
+    void startTimer();
+    void rotateTimeBuckets();
 };
 }  // namespace monitoring
 }  // namespace drogon
@@ -0,0 +1,174 @@
+/**
+ *
+ *  MetricCells.h
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace drogon
+{
+namespace monitoring
+{
+namespace internal
+{
+/**
+ * The number of cells a metric value is split into. Threads are assigned to
+ * the cells in a round-robin way, so threads updating the same metric don't
+ * contend on the same cache line unless there are more threads than cells.
+ * */
+constexpr size_t kMetricShardCount = 16;
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * Return the index of the cell used by the calling thread.
+ * */
+inline size_t metricShardIndex()
+{
+    static std::atomic<size_t> nextIndex{0};
+    thread_local size_t index =
+        nextIndex.fetch_add(1, std::memory_order_relaxed) % kMetricShardCount;
+    return index;
+}
+
+inline void atomicAdd(std::atomic<double> &target, double value)
+{
+    auto current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current,
+                                         current + value,
+                                         std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * A double value split into per-thread cells. Updates are relaxed atomic
+ * operations on the cell of the calling thread, the cells are only added up
+ * when the value is read.
+ * */
+class ShardedValue
+{
+  public:
+    void add(double value)
+    {
+        atomicAdd(cells_[metricShardIndex()].value, value);
+    }
+
+    double value() const
+    {
+        double sum{0};
+        for (auto &cell : cells_)
+        {
+            sum += cell.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    void reset()
+    {
+        for (auto &cell : cells_)
+        {
+            cell.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+  private:
+    struct alignas(kCacheLineSize) Cell
+    {
+        std::atomic<double> value{0};
+    };
+
+    std::array<Cell, kMetricShardCount> cells_;
+};
+
+/**
+ * An array of counters split into per-thread copies. The copy of each thread
+ * starts on its own cache line, the copies are only added up when the
+ * counters are read.
+ * */
+class ShardedCounters
+{
+  public:
+    explicit ShardedCounters(size_t size,
+                             size_t shardCount = kMetricShardCount)
+        : size_(size),
+          shardCount_(shardCount),
+          linesPerShard_((size + kCountersPerLine - 1) / kCountersPerLine),
+          lines_(new CacheLine[linesPerShard_ * shardCount_])
+    {
+    }
+
+    void add(size_t index, uint64_t value = 1)
+    {
+        counter(metricShardIndex() % shardCount_, index)
+            .fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t value(size_t index) const
+    {
+        uint64_t sum{0};
+        for (size_t shard = 0; shard < shardCount_; ++shard)
+        {
+            sum += counter(shard, index).load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    void reset()
+    {
+        for (size_t i = 0; i < linesPerShard_ * shardCount_; ++i)
+        {
+            for (auto &counter : lines_[i].counters)
+            {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    static constexpr size_t kCountersPerLine =
+        kCacheLineSize / sizeof(std::atomic<uint64_t>);
+
+    struct alignas(kCacheLineSize) CacheLine
+    {
+        std::atomic<uint64_t> counters[kCountersPerLine]{};
+    };
+
+    std::atomic<uint64_t> &counter(size_t shard, size_t index)
+    {
+        return lines_[shard * linesPerShard_ + index / kCountersPerLine]
+            .counters[index % kCountersPerLine];
+    }
+
+    const std::atomic<uint64_t> &counter(size_t shard, size_t index) const
+    {
+        return lines_[shard * linesPerShard_ + index / kCountersPerLine]
+            .counters[index % kCountersPerLine];
+    }
+
+    const size_t size_;
+    const size_t shardCount_;
+    const size_t linesPerShard_;
+    std::unique_ptr<CacheLine[]> lines_;
+};
+}  // namespace internal
+}  // namespace monitoring
+}  // namespace drogon
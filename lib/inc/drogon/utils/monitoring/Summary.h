@@ -0,0 +1,99 @@
+/**
+ *
+ *  Summary.h
+ *  An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+#include <drogon/exports.h>
+#include <drogon/utils/monitoring/Metric.h>
+#include <drogon/utils/monitoring/MetricCells.h>
+#include <string_view>
+#include <vector>
+
+namespace drogon
+{
+namespace monitoring
+{
+/**
+ * This class is used to collect samples for a summary metric.
+ *
+ * The observed values are counted in logarithmic buckets (a DDSketch), so
+ * every reported quantile is within the relative accuracy of the exact
+ * value. The buckets cover the range from minValue to maxValue and are
+ * allocated once, values less than minValue are reported as 0 and values
+ * greater than maxValue are reported as maxValue. With the default
+ * parameters there are about 1150 buckets.
+ *
+ * Unlike the histogram, the summary is cumulative, it has no time window.
+ * Summaries with the same accuracy and range can be merged.
+ * */
+class DROGON_EXPORT Summary : public Metric
+{
+  public:
+    Summary(const std::string &name,
+            const std::vector<std::string> &labelNames,
+            const std::vector<std::string> &labelValues,
+            const std::vector<double> &quantiles = {0.5, 0.9, 0.99},
+            double relativeAccuracy = 0.01,
+            double minValue = 1e-6,
+            double maxValue = 1e4) noexcept(false);
+
+    void observe(double value);
+
+    /**
+     * @brief Add the observations of another summary to this one.
+     *
+     * @note The two summaries must have the same relative accuracy and range,
+     * otherwise an exception is thrown.
+     */
+    void merge(const Summary &other) noexcept(false);
+
+    /**
+     * @brief Return the estimated value of the quantile q (0 <= q <= 1), or
+     * NaN if nothing has been observed.
+     */
+    double quantile(double q) const;
+    uint64_t count() const;
+    double sum() const;
+    void reset();
+
+    std::vector<Sample> collect() const override;
+
+    static std::string_view type()
+    {
+        return "summary";
+    }
+
+  private:
+    // The bucket counts are updated by all the threads, but spread over
+    // fewer cells than the other metrics to keep the memory bounded.
+    static constexpr size_t kShardCount = 4;
+
+    size_t bucketIndex(double value) const;
+    double bucketValue(size_t index) const;
+    double quantile(const std::vector<uint64_t> &counts,
+                    uint64_t total,
+                    double q) const;
+
+    std::vector<double> quantiles_;
+    double relativeAccuracy_;
+    double minValue_;
+    double maxValue_;
+    double gamma_;
+    double logGamma_;
+    // The logarithmic index of the first bucket after the underflow bucket.
+    int64_t minIndex_;
+    internal::ShardedCounters counts_;
+    internal::ShardedValue sum_;
+};
+}  // namespace monitoring
+}  // namespace drogon
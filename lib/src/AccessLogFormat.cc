@@ -0,0 +1,598 @@
+/**
+ *
+ *  @file AccessLogFormat.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "AccessLogFormat.h"
+#include "HttpUtils.h"
+#include <drogon/plugins/RealIpResolver.h>
+#include <trantor/utils/Logger.h>
+#include <charconv>
+#include <cstdio>
+#include <map>
+#include <regex>
+#include <thread>
+#if !defined _WIN32 && !defined __HAIKU__
+#include <unistd.h>
+#include <sys/syscall.h>
+#elif defined __HAIKU__
+#include <unistd.h>
+#else
+#include <sstream>
+#endif
+#ifdef __FreeBSD__
+#include <pthread_np.h>
+#endif
+
+using namespace drogon;
+using namespace drogon::plugin;
+
+static AccessLogItem newLogItem(const std::string &placeholder)
+{
+    static const std::map<std::string, AccessLogField> fieldMap = {
+        {"$request_path", AccessLogField::Path},
+        {"$path", AccessLogField::Path},
+        {"$date", AccessLogField::Date},
+        {"$request_date", AccessLogField::RequestDate},
+        {"$request_query", AccessLogField::Query},
+        {"$request_url", AccessLogField::Url},
+        {"$query", AccessLogField::Query},
+        {"$url", AccessLogField::Url},
+        {"$request_version", AccessLogField::Version},
+        {"$version", AccessLogField::Version},
+        {"$request", AccessLogField::RequestLine},
+        {"$remote_addr", AccessLogField::RemoteAddr},
+        {"$local_addr", AccessLogField::LocalAddr},
+        {"$request_len", AccessLogField::RequestLength},
+        {"$body_bytes_received", AccessLogField::RequestLength},
+        {"$method", AccessLogField::Method},
+        {"$thread", AccessLogField::Thread},
+        {"$response_len", AccessLogField::ResponseLength},
+        {"$body_bytes_sent", AccessLogField::ResponseLength},
+        {"$status", AccessLogField::Status},
+        {"$status_code", AccessLogField::StatusCode},
+        {"$processing_time", AccessLogField::ProcessingTime},
+        {"$upstream_http_content-type", AccessLogField::ResponseContentType},
+        {"$upstream_http_content_type", AccessLogField::ResponseContentType}};
+    auto name = placeholder.substr(1);
+    auto iter = fieldMap.find(placeholder);
+    if (iter != fieldMap.end())
+    {
+        return {iter->second, {}, std::move(name)};
+    }
+    if (placeholder.find("$http_") == 0 && placeholder.size() > 6)
+    {
+        return {AccessLogField::RequestHeader,
+                placeholder.substr(6),
+                std::move(name)};
+    }
+    if (placeholder.find("$cookie_") == 0 && placeholder.size() > 8)
+    {
+        return {AccessLogField::RequestCookie,
+                placeholder.substr(8),
+                std::move(name)};
+    }
+    if (placeholder.find("$upstream_http_") == 0 && placeholder.size() > 15)
+    {
+        return {AccessLogField::ResponseHeader,
+                placeholder.substr(15),
+                std::move(name)};
+    }
+    return {AccessLogField::Text, placeholder, {}};
+}
+
+std::vector<AccessLogItem> drogon::plugin::parseAccessLogFormat(
+    const std::string &logFormat)
+{
+    std::vector<AccessLogItem> items;
+    auto format = logFormat;
+    std::string rawString;
+    while (!format.empty())
+    {
+        LOG_TRACE << format;
+        auto pos = format.find('$');
+        if (pos != std::string::npos)
+        {
+            rawString += format.substr(0, pos);
+
+            format = format.substr(pos);
+            std::regex e{"^\\$[a-zA-Z0-9\\-_]+"};
+            std::smatch m;
+            if (std::regex_search(format, m, e))
+            {
+                auto item = newLogItem(m[0]);
+                if (item.field == AccessLogField::Text)
+                {
+                    rawString += item.argument;
+                }
+                else
+                {
+                    if (!rawString.empty())
+                    {
+                        items.push_back(
+                            {AccessLogField::Text, std::move(rawString), {}});
+                        rawString.clear();
+                    }
+                    items.emplace_back(std::move(item));
+                }
+                format = m.suffix().str();
+            }
+            else
+            {
+                rawString += '$';
+                format = format.substr(1);
+            }
+        }
+        else
+        {
+            rawString += format;
+            break;
+        }
+    }
+    rawString += "\n";
+    items.push_back({AccessLogField::Text, std::move(rawString), {}});
+    return items;
+}
+
+uint64_t drogon::plugin::accessLogThreadNumber()
+{
+#ifdef __linux__
+    static thread_local pid_t threadId_{0};
+#else
+    static thread_local uint64_t threadId_{0};
+#endif
+#ifdef __linux__
+    if (threadId_ == 0)
+        threadId_ = static_cast<pid_t>(::syscall(SYS_gettid));
+#elif defined __FreeBSD__
+    if (threadId_ == 0)
+    {
+        threadId_ = pthread_getthreadid_np();
+    }
+#elif defined __OpenBSD__
+    if (threadId_ == 0)
+    {
+        threadId_ = getthrid();
+    }
+#elif defined _WIN32 || defined __HAIKU__
+    if (threadId_ == 0)
+    {
+        std::stringstream ss;
+        ss << std::this_thread::get_id();
+        threadId_ = std::stoull(ss.str());
+    }
+#else
+    if (threadId_ == 0)
+    {
+        pthread_threadid_np(NULL, &threadId_);
+    }
+#endif
+    return static_cast<uint64_t>(threadId_);
+}
+
+const std::string &AccessLogDateFormatter::format(const trantor::Date &date)
+{
+    auto microSeconds = date.microSecondsSinceEpoch();
+    auto seconds = microSeconds / 1000000;
+    auto remainder = microSeconds % 1000000;
+    if (remainder < 0)
+    {
+        --seconds;
+        remainder += 1000000;
+    }
+    if (seconds != cachedSeconds_)
+    {
+        trantor::Date secondsDate(seconds * 1000000);
+        if (timeFormat_.empty())
+        {
+            result_ = useLocalTime_ ? secondsDate.toFormattedStringLocal(false)
+                                    : secondsDate.toFormattedString(false);
+        }
+        else if (useLocalTime_)
+        {
+            result_ =
+                secondsDate.toCustomFormattedStringLocal(timeFormat_, false);
+        }
+        else
+        {
+            result_ = secondsDate.toCustomFormattedString(timeFormat_, false);
+        }
+        cachedSeconds_ = seconds;
+        cachedLength_ = result_.size();
+    }
+    if (showMicroseconds_)
+    {
+        char buf[8];
+        snprintf(buf, sizeof(buf), ".%06d", static_cast<int>(remainder));
+        result_.resize(cachedLength_);
+        result_.append(buf, 7);
+    }
+    return result_;
+}
+
+// The number of strings of the entry used by the field.
+static uint32_t textsCount(AccessLogField field)
+{
+    switch (field)
+    {
+        case AccessLogField::Path:
+        case AccessLogField::Query:
+        case AccessLogField::RequestHeader:
+        case AccessLogField::RequestCookie:
+        case AccessLogField::ResponseHeader:
+        case AccessLogField::ResponseContentType:
+            return 1;
+        case AccessLogField::Url:
+        case AccessLogField::RequestLine:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+static bool isNumeric(AccessLogField field)
+{
+    switch (field)
+    {
+        case AccessLogField::RequestLength:
+        case AccessLogField::ResponseLength:
+        case AccessLogField::Thread:
+        case AccessLogField::StatusCode:
+        case AccessLogField::ProcessingTime:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void appendJsonEscaped(std::string &output, std::string_view value)
+{
+    // Copy the runs of characters which don't need escaping at once.
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        output.append(value.data() + start, i - start);
+        switch (c)
+        {
+            case '"':
+                output.append("\\\"");
+                break;
+            case '\\':
+                output.append("\\\\");
+                break;
+            case '\n':
+                output.append("\\n");
+                break;
+            case '\r':
+                output.append("\\r");
+                break;
+            case '\t':
+                output.append("\\t");
+                break;
+            default:
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                output.append(buf, 6);
+                break;
+            }
+        }
+        start = i + 1;
+    }
+    output.append(value.data() + start, value.size() - start);
+}
+
+static void appendLogfmtEscaped(std::string &output, std::string_view value)
+{
+    auto needsQuotes = value.empty();
+    for (auto c : value)
+    {
+        if (static_cast<unsigned char>(c) <= ' ' || c == '=' || c == '"' ||
+            c == '\\')
+        {
+            needsQuotes = true;
+            break;
+        }
+    }
+    if (!needsQuotes)
+    {
+        output.append(value);
+        return;
+    }
+    output.append(1, '"');
+    appendJsonEscaped(output, value);
+    output.append(1, '"');
+}
+
+template <typename T>
+static void appendNumber(std::string &output, T value)
+{
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    output.append(buf, result.ptr - buf);
+}
+
+// Append the duration in seconds the same as printing it with "%.12g", which
+// is how the LogStream of the synchronous logger prints a double.
+static void appendSeconds(std::string &output, int64_t microSeconds)
+{
+    // "%.12g" uses the exponent notation below 0.0001 seconds, and needs more
+    // than 12 significant digits from a million seconds on. Between them, it
+    // prints the microseconds with the trailing zeros removed.
+    auto magnitude = microSeconds < 0 ? -microSeconds : microSeconds;
+    if ((magnitude > 0 && magnitude < 100) || magnitude >= 1000000000000LL)
+    {
+        char buf[32];
+        auto length = snprintf(buf,
+                               sizeof(buf),
+                               "%.12g",
+                               static_cast<double>(microSeconds) / 1000000.0);
+        output.append(buf, length);
+        return;
+    }
+    if (microSeconds < 0)
+    {
+        output.append(1, '-');
+        microSeconds = -microSeconds;
+    }
+    appendNumber(output, microSeconds / 1000000);
+    auto fraction = static_cast<int>(microSeconds % 1000000);
+    if (fraction == 0)
+        return;
+    char buf[7];
+    int length = 6;
+    for (int i = 5; i >= 0; --i)
+    {
+        buf[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    while (buf[length - 1] == '0')
+        --length;
+    output.append(1, '.').append(buf, length);
+}
+
+AccessLogFormatter::AccessLogFormatter(std::vector<AccessLogItem> items,
+                                       Style style)
+    : items_(std::move(items))
+{
+    auto appendText = [this](std::string text) {
+        if (text.empty())
+            return;
+        if (!instructions_.empty() &&
+            instructions_.back().field == AccessLogField::Text)
+        {
+            instructions_.back().argument.append(text);
+            return;
+        }
+        instructions_.push_back(
+            {AccessLogField::Text, Escape::None, 0, std::move(text)});
+    };
+    uint32_t textIndex{0};
+    bool first{true};
+    if (style == Style::Json)
+        appendText("{");
+    for (auto &item : items_)
+    {
+        Instruction instruction{item.field, Escape::None, textIndex, {}};
+        textIndex += textsCount(item.field);
+        if (style == Style::Text)
+        {
+            switch (item.field)
+            {
+                case AccessLogField::Text:
+                    appendText(item.argument);
+                    continue;
+                case AccessLogField::RequestHeader:
+                case AccessLogField::ResponseHeader:
+                    appendText(item.argument + ": ");
+                    break;
+                case AccessLogField::RequestCookie:
+                    appendText("(cookie)" + item.argument + "=");
+                    break;
+                default:
+                    break;
+            }
+            instructions_.emplace_back(std::move(instruction));
+            continue;
+        }
+        if (item.field == AccessLogField::Text)
+            continue;
+        if (style == Style::Json)
+        {
+            std::string key = first ? "\"" : ",\"";
+            appendJsonEscaped(key, item.name);
+            appendText(key + "\":");
+            if (isNumeric(item.field))
+            {
+                instructions_.emplace_back(std::move(instruction));
+            }
+            else
+            {
+                appendText("\"");
+                instruction.escape = Escape::Json;
+                instructions_.emplace_back(std::move(instruction));
+                appendText("\"");
+            }
+        }
+        else
+        {
+            appendText((first ? "" : " ") + item.name + "=");
+            if (!isNumeric(item.field))
+                instruction.escape = Escape::Logfmt;
+            instructions_.emplace_back(std::move(instruction));
+        }
+        first = false;
+    }
+    if (style == Style::Json)
+        appendText("}\n");
+    else if (style == Style::Logfmt)
+        appendText("\n");
+}
+
+void AccessLogFormatter::capture(AccessLogEntry &entry,
+                                 const HttpRequestPtr &req,
+                                 const HttpResponsePtr &resp,
+                                 bool useRealIp) const
+{
+    entry.date = trantor::Date::now().microSecondsSinceEpoch();
+    entry.requestDate = req->creationDate().microSecondsSinceEpoch();
+    entry.threadNumber = accessLogThreadNumber();
+    entry.requestLength = req->body().length();
+    entry.responseLength = resp->body().length();
+    entry.remoteAddr =
+        useRealIp ? RealIpResolver::GetRealAddr(req) : req->peerAddr();
+    entry.localAddr = req->localAddr();
+    entry.method = req->methodString();
+    entry.version = req->versionString();
+    entry.statusCode = static_cast<uint16_t>(resp->getStatusCode());
+    entry.texts.clear();
+    bool hasContentType{false};
+    for (auto &item : items_)
+    {
+        switch (item.field)
+        {
+            case AccessLogField::Path:
+                entry.texts.emplace_back(req->path());
+                break;
+            case AccessLogField::Query:
+                entry.texts.emplace_back(req->query());
+                break;
+            case AccessLogField::Url:
+            case AccessLogField::RequestLine:
+                entry.texts.emplace_back(req->path());
+                entry.texts.emplace_back(req->query());
+                break;
+            case AccessLogField::RequestHeader:
+                entry.texts.emplace_back(req->getHeader(item.argument));
+                break;
+            case AccessLogField::RequestCookie:
+                entry.texts.emplace_back(req->getCookie(item.argument));
+                break;
+            case AccessLogField::ResponseHeader:
+                entry.texts.emplace_back(resp->getHeader(item.argument));
+                break;
+            case AccessLogField::ResponseContentType:
+                if (!hasContentType)
+                {
+                    entry.contentType = resp->contentTypeString();
+                    hasContentType = true;
+                }
+                entry.texts.emplace_back(entry.contentType);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void AccessLogFormatter::format(const AccessLogEntry &entry,
+                                AccessLogFormatContext &context,
+                                std::string &output) const
+{
+    for (auto &instruction : instructions_)
+    {
+        switch (instruction.escape)
+        {
+            case Escape::None:
+                appendValue(instruction, entry, context, output);
+                break;
+            case Escape::Json:
+                context.value.clear();
+                appendValue(instruction, entry, context, context.value);
+                appendJsonEscaped(output, context.value);
+                break;
+            case Escape::Logfmt:
+                context.value.clear();
+                appendValue(instruction, entry, context, context.value);
+                appendLogfmtEscaped(output, context.value);
+                break;
+        }
+    }
+}
+
+void AccessLogFormatter::appendValue(const Instruction &instruction,
+                                     const AccessLogEntry &entry,
+                                     AccessLogFormatContext &context,
+                                     std::string &output) const
+{
+    auto text = [&entry, &instruction](uint32_t offset) {
+        auto index = instruction.textIndex + offset;
+        return index < entry.texts.size() ? entry.texts[index]
+                                          : std::string_view{};
+    };
+    switch (instruction.field)
+    {
+        case AccessLogField::Text:
+            output.append(instruction.argument);
+            break;
+        case AccessLogField::Date:
+            output.append(context.date.format(trantor::Date(entry.date)));
+            break;
+        case AccessLogField::RequestDate:
+            output.append(
+                context.requestDate.format(trantor::Date(entry.requestDate)));
+            break;
+        case AccessLogField::Path:
+        case AccessLogField::Query:
+        case AccessLogField::RequestHeader:
+        case AccessLogField::RequestCookie:
+        case AccessLogField::ResponseHeader:
+        case AccessLogField::ResponseContentType:
+            output.append(text(0));
+            break;
+        case AccessLogField::Url:
+            output.append(text(0));
+            if (!text(1).empty())
+                output.append(1, '?').append(text(1));
+            break;
+        case AccessLogField::Version:
+            output.append(entry.version);
+            break;
+        case AccessLogField::RequestLine:
+            output.append(entry.method).append(1, ' ').append(text(0));
+            if (!text(1).empty())
+                output.append(1, '?').append(text(1));
+            output.append(1, ' ').append(entry.version);
+            break;
+        case AccessLogField::RemoteAddr:
+            output.append(entry.remoteAddr.toIpPort());
+            break;
+        case AccessLogField::LocalAddr:
+            output.append(entry.localAddr.toIpPort());
+            break;
+        case AccessLogField::RequestLength:
+            appendNumber(output, entry.requestLength);
+            break;
+        case AccessLogField::ResponseLength:
+            appendNumber(output, entry.responseLength);
+            break;
+        case AccessLogField::Method:
+            output.append(entry.method);
+            break;
+        case AccessLogField::Thread:
+            appendNumber(output, entry.threadNumber);
+            break;
+        case AccessLogField::Status:
+            appendNumber(output, entry.statusCode);
+            output.append(1, ' ').append(statusCodeToString(entry.statusCode));
+            break;
+        case AccessLogField::StatusCode:
+            appendNumber(output, entry.statusCode);
+            break;
+        case AccessLogField::ProcessingTime:
+            appendSeconds(output, entry.date - entry.requestDate);
+            break;
+    }
+}
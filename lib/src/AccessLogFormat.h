@@ -0,0 +1,220 @@
+/**
+ *
+ *  @file AccessLogFormat.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <trantor/net/InetAddress.h>
+#include <trantor/utils/Date.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace drogon
+{
+namespace plugin
+{
+/**
+ * @brief The fields of an access log line, one for each placeholder of the
+ * log_format option.
+ */
+enum class AccessLogField : uint8_t
+{
+    Text,
+    Date,
+    RequestDate,
+    Path,
+    Query,
+    Url,
+    Version,
+    RequestLine,
+    RemoteAddr,
+    LocalAddr,
+    RequestLength,
+    ResponseLength,
+    Method,
+    Thread,
+    RequestHeader,
+    RequestCookie,
+    ResponseHeader,
+    Status,
+    StatusCode,
+    ProcessingTime,
+    ResponseContentType
+};
+
+struct AccessLogItem
+{
+    AccessLogField field;
+    // The text of Text items, the header or cookie name of the
+    // RequestHeader, RequestCookie and ResponseHeader items.
+    std::string argument;
+    // The placeholder without the leading '$', used as the key of the field
+    // in the JSON and logfmt outputs.
+    std::string name;
+};
+
+/**
+ * @brief Split the log_format option into the list of items of a line. The
+ * list always ends with a text item containing the line break, unknown
+ * placeholders are kept as text.
+ */
+std::vector<AccessLogItem> parseAccessLogFormat(const std::string &format);
+
+/**
+ * @brief Return the system id of the calling thread, used by $thread.
+ */
+uint64_t accessLogThreadNumber();
+
+/**
+ * @brief Formats the dates of the access log. The part of the string up to
+ * the seconds is only formatted once per second, the microseconds are
+ * appended to it if they are shown.
+ */
+class AccessLogDateFormatter
+{
+  public:
+    AccessLogDateFormatter(bool useLocalTime,
+                           bool showMicroseconds,
+                           std::string customTimeFormat)
+        : useLocalTime_(useLocalTime),
+          showMicroseconds_(showMicroseconds),
+          timeFormat_(std::move(customTimeFormat))
+    {
+    }
+
+    const std::string &format(const trantor::Date &date);
+
+  private:
+    bool useLocalTime_;
+    bool showMicroseconds_;
+    std::string timeFormat_;
+    int64_t cachedSeconds_{std::numeric_limits<int64_t>::min()};
+    size_t cachedLength_{0};
+    std::string result_;
+};
+
+/**
+ * @brief The fixed-size data of an access log line.
+ */
+struct AccessLogFields
+{
+    int64_t date;
+    int64_t requestDate;
+    uint64_t threadNumber;
+    uint64_t requestLength;
+    uint64_t responseLength;
+    trantor::InetAddress remoteAddr;
+    trantor::InetAddress localAddr;
+    const char *method;
+    const char *version;
+    uint16_t statusCode;
+};
+
+/**
+ * @brief The data of an access log line. The strings needed by the items
+ * (paths, queries, headers, cookies) are referenced in the order of the
+ * items, the entry must not outlive the request and the response it is
+ * captured from.
+ */
+struct AccessLogEntry : AccessLogFields
+{
+    std::vector<std::string_view> texts;
+    // The storage of the content type string of the response.
+    std::string contentType;
+};
+
+/**
+ * @brief The per-thread state used to format lines.
+ */
+struct AccessLogFormatContext
+{
+    AccessLogFormatContext(const AccessLogDateFormatter &dateFormatter)
+        : date(dateFormatter), requestDate(dateFormatter)
+    {
+    }
+
+    AccessLogDateFormatter date;
+    AccessLogDateFormatter requestDate;
+    // The buffer of the values escaped in bulk.
+    std::string value;
+};
+
+/**
+ * @brief The log format compiled into a flat list of instructions, each one
+ * an opcode (the field) and its argument. A line is formatted by running the
+ * instructions in a single loop.
+ *
+ * In the text style, the line is the log_format string with the
+ * placeholders replaced. In the JSON and logfmt styles, the text between the
+ * placeholders is ignored, each placeholder becomes a key named after it and
+ * the values are escaped.
+ */
+class AccessLogFormatter
+{
+  public:
+    enum class Style
+    {
+        Text,
+        Json,
+        Logfmt
+    };
+
+    AccessLogFormatter(std::vector<AccessLogItem> items, Style style);
+
+    /**
+     * @brief Copy the data of the line from the request and the response.
+     */
+    void capture(AccessLogEntry &entry,
+                 const HttpRequestPtr &req,
+                 const HttpResponsePtr &resp,
+                 bool useRealIp) const;
+
+    /**
+     * @brief Append the line of the entry to the output.
+     */
+    void format(const AccessLogEntry &entry,
+                AccessLogFormatContext &context,
+                std::string &output) const;
+
+  private:
+    enum class Escape : uint8_t
+    {
+        None,
+        Json,
+        Logfmt
+    };
+
+    struct Instruction
+    {
+        AccessLogField field;
+        Escape escape;
+        // The index of the first string of the field in the entry.
+        uint32_t textIndex;
+        std::string argument;
+    };
+
+    void appendValue(const Instruction &instruction,
+                     const AccessLogEntry &entry,
+                     AccessLogFormatContext &context,
+                     std::string &output) const;
+
+    std::vector<AccessLogItem> items_;
+    std::vector<Instruction> instructions_;
+};
+}  // namespace plugin
+}  // namespace drogon
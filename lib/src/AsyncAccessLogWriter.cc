@@ -0,0 +1,264 @@
+/**
+ *
+ *  @file AsyncAccessLogWriter.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "AsyncAccessLogWriter.h"
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace drogon;
+using namespace drogon::plugin;
+
+// The background thread wakes up at least this often to write the queued
+// lines.
+static constexpr std::chrono::milliseconds kFlushInterval{10};
+// The batches are written when they reach this size.
+static constexpr size_t kMaxBatchSize = 64 * 1024;
+
+static size_t roundUpToPowerOfTwo(size_t n)
+{
+    size_t result = 1;
+    while (result < n)
+        result <<= 1;
+    return result;
+}
+
+static void appendText(AccessLogRecord &record, std::string_view text)
+{
+    auto available = AccessLogRecord::kTextSize - record.textLength;
+    if (available < sizeof(uint16_t))
+        return;
+    auto length = static_cast<uint16_t>(
+        std::min(text.size(), available - sizeof(uint16_t)));
+    memcpy(record.text + record.textLength, &length, sizeof(length));
+    memcpy(record.text + record.textLength + sizeof(length),
+           text.data(),
+           length);
+    record.textLength += static_cast<uint16_t>(sizeof(length) + length);
+}
+
+static std::string_view nextText(const AccessLogRecord &record, size_t &offset)
+{
+    if (offset + sizeof(uint16_t) > record.textLength)
+        return {};
+    uint16_t length;
+    memcpy(&length, record.text + offset, sizeof(length));
+    std::string_view text(record.text + offset + sizeof(length), length);
+    offset += sizeof(length) + length;
+    return text;
+}
+
+AsyncAccessLogWriter::AsyncAccessLogWriter(
+    std::shared_ptr<const AccessLogFormatter> formatterPtr,
+    size_t queueSize,
+    bool useRealIp,
+    const AccessLogDateFormatter &dateFormatter,
+    OutputFunction output)
+    : formatterPtr_(std::move(formatterPtr)),
+      queueSize_(roundUpToPowerOfTwo(std::max<size_t>(queueSize, 2))),
+      useRealIp_(useRealIp),
+      id_([]() {
+          static std::atomic<uint64_t> nextId{1};
+          return nextId.fetch_add(1, std::memory_order_relaxed);
+      }()),
+      output_(std::move(output)),
+      context_(dateFormatter)
+{
+    thread_ = std::thread([this]() { run(); });
+}
+
+AsyncAccessLogWriter::~AsyncAccessLogWriter()
+{
+    stop();
+}
+
+struct AsyncAccessLogWriter::ThreadRings
+{
+    ~ThreadRings()
+    {
+        for (auto &ring : rings)
+        {
+            ring.second->retire();
+        }
+    }
+
+    // The writers are identified by id rather than by address, a new writer
+    // may be allocated at the address of a destroyed one.
+    std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+    uint64_t lastWriterId{0};
+    Ring *lastRing{nullptr};
+};
+
+AsyncAccessLogWriter::Ring &AsyncAccessLogWriter::threadRing()
+{
+    thread_local ThreadRings threadRings;
+    if (threadRings.lastWriterId == id_)
+        return *threadRings.lastRing;
+    auto &rings = threadRings.rings;
+    // Drop the rings of the stopped writers.
+    rings.erase(std::remove_if(rings.begin(),
+                               rings.end(),
+                               [](const auto &ring) {
+                                   return ring.second->isOrphaned();
+                               }),
+                rings.end());
+    auto iter = std::find_if(rings.begin(),
+                             rings.end(),
+                             [this](const auto &ring) {
+                                 return ring.first == id_;
+                             });
+    if (iter == rings.end())
+    {
+        auto ringPtr = std::make_shared<Ring>(queueSize_);
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.push_back(ringPtr);
+        }
+        rings.emplace_back(id_, std::move(ringPtr));
+        iter = rings.end() - 1;
+    }
+    threadRings.lastWriterId = id_;
+    threadRings.lastRing = iter->second.get();
+    return *threadRings.lastRing;
+}
+
+void AsyncAccessLogWriter::push(const HttpRequestPtr &req,
+                                const HttpResponsePtr &resp)
+{
+    auto &ring = threadRing();
+    auto record = ring.reserve();
+    if (!record)
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    thread_local AccessLogEntry entry;
+    formatterPtr_->capture(entry, req, resp, useRealIp_);
+    static_cast<AccessLogFields &>(*record) = entry;
+    record->textsCount = static_cast<uint16_t>(entry.texts.size());
+    record->textLength = 0;
+    for (auto &text : entry.texts)
+    {
+        appendText(*record, text);
+    }
+    if (ring.commit() == ring.capacity() / 2)
+    {
+        cond_.notify_one();
+    }
+}
+
+void AsyncAccessLogWriter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+            return;
+        running_ = false;
+    }
+    cond_.notify_one();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void AsyncAccessLogWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_)
+    {
+        cond_.wait_for(lock, kFlushInterval);
+        lock.unlock();
+        drain(false);
+        lock.lock();
+    }
+    lock.unlock();
+    drain(true);
+    std::lock_guard<std::mutex> ringsLock(ringsMutex_);
+    for (auto &ring : rings_)
+    {
+        ring->orphan();
+    }
+    rings_.clear();
+}
+
+void AsyncAccessLogWriter::drain(bool stopping)
+{
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings = rings_;
+    }
+    std::vector<Ring *> retiredRings;
+    for (auto &ring : rings)
+    {
+        // Checked first, so that the last records of the thread are consumed
+        // below.
+        auto retired = ring->isRetired();
+        ring->consume([this](const AccessLogRecord &record) {
+            format(record);
+            if (batch_.size() >= kMaxBatchSize)
+                flushBatch();
+        });
+        if (retired)
+            retiredRings.push_back(ring.get());
+    }
+    flushBatch();
+    if (!retiredRings.empty())
+    {
+        // The rings of the exited threads are freed with the last pointers.
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings_.erase(std::remove_if(rings_.begin(),
+                                    rings_.end(),
+                                    [&retiredRings](const auto &ring) {
+                                        return std::find(retiredRings.begin(),
+                                                         retiredRings.end(),
+                                                         ring.get()) !=
+                                               retiredRings.end();
+                                    }),
+                     rings_.end());
+    }
+    auto dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped_)
+    {
+        auto now = trantor::Date::now().microSecondsSinceEpoch();
+        if (now - lastReportTime_ >= 1000000 || stopping)
+        {
+            LOG_WARN << dropped - reportedDropped_
+                     << " access log lines were dropped because the queue "
+                        "was full";
+            reportedDropped_ = dropped;
+            lastReportTime_ = now;
+        }
+    }
+}
+
+void AsyncAccessLogWriter::flushBatch()
+{
+    if (batch_.empty())
+        return;
+    output_(batch_);
+    batch_.clear();
+}
+
+void AsyncAccessLogWriter::format(const AccessLogRecord &record)
+{
+    static_cast<AccessLogFields &>(entry_) = record;
+    entry_.texts.clear();
+    size_t offset{0};
+    for (uint16_t i = 0; i < record.textsCount; ++i)
+    {
+        entry_.texts.emplace_back(nextText(record, offset));
+    }
+    formatterPtr_->format(entry_, context_, batch_);
+}
@@ -0,0 +1,201 @@
+/**
+ *
+ *  @file AsyncAccessLogWriter.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include "AccessLogFormat.h"
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <trantor/utils/NonCopyable.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace drogon
+{
+namespace plugin
+{
+/**
+ * @brief The data of one access log line, copied from the request and the
+ * response on the IO thread. The strings of the entry are stored in the text
+ * buffer, each one prefixed with its length, and truncated when the buffer is
+ * full.
+ */
+struct AccessLogRecord : AccessLogFields
+{
+    static constexpr size_t kTextSize = 512;
+
+    uint16_t textsCount;
+    uint16_t textLength;
+    char text[kTextSize];
+};
+
+/**
+ * @brief Writes the access log from a background thread.
+ *
+ * Each IO thread pushes records into its own single-producer ring buffer
+ * without locking. The background thread wakes up every few milliseconds,
+ * or earlier when a ring is half full, formats the queued records and
+ * outputs them in batches. When a ring is full, the record is dropped and
+ * counted instead of blocking the IO thread. A ring is freed once its
+ * thread has exited and its records are written, or once the writer is
+ * stopped.
+ */
+class AsyncAccessLogWriter : public trantor::NonCopyable
+{
+  public:
+    using OutputFunction = std::function<void(const std::string &)>;
+
+    AsyncAccessLogWriter(
+        std::shared_ptr<const AccessLogFormatter> formatterPtr,
+        size_t queueSize,
+        bool useRealIp,
+        const AccessLogDateFormatter &dateFormatter,
+        OutputFunction output);
+    ~AsyncAccessLogWriter();
+
+    /**
+     * @brief Queue the line of the request, called on the IO threads.
+     */
+    void push(const HttpRequestPtr &req, const HttpResponsePtr &resp);
+
+    /**
+     * @brief Write the queued lines and stop the background thread.
+     */
+    void stop();
+
+    uint64_t droppedCount() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    class Ring
+    {
+      public:
+        explicit Ring(size_t capacity)
+            : records_(capacity), mask_(capacity - 1)
+        {
+        }
+
+        // Return the slot of the next record, or nullptr if the ring is
+        // full. Only called by the owner thread.
+        AccessLogRecord *reserve()
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) >=
+                records_.size())
+                return nullptr;
+            return &records_[tail & mask_];
+        }
+
+        // Publish the reserved record and return the number of records in
+        // the ring.
+        size_t commit()
+        {
+            auto tail = tail_.load(std::memory_order_relaxed) + 1;
+            tail_.store(tail, std::memory_order_release);
+            return tail - head_.load(std::memory_order_relaxed);
+        }
+
+        size_t capacity() const
+        {
+            return records_.size();
+        }
+
+        // Called by the owner thread when it exits, the records it committed
+        // are still consumed.
+        void retire()
+        {
+            retired_.store(true, std::memory_order_release);
+        }
+
+        bool isRetired() const
+        {
+            return retired_.load(std::memory_order_acquire);
+        }
+
+        // Called by the writer when it stops, the owner thread drops the
+        // ring then.
+        void orphan()
+        {
+            orphaned_.store(true, std::memory_order_release);
+        }
+
+        bool isOrphaned() const
+        {
+            return orphaned_.load(std::memory_order_acquire);
+        }
+
+        // Only called by the background thread.
+        template <typename Callback>
+        void consume(Callback &&callback)
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+            auto tail = tail_.load(std::memory_order_acquire);
+            for (auto i = head; i != tail; ++i)
+            {
+                callback(records_[i & mask_]);
+            }
+            head_.store(tail, std::memory_order_release);
+        }
+
+      private:
+        std::vector<AccessLogRecord> records_;
+        const size_t mask_;
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        std::atomic<bool> retired_{false};
+        std::atomic<bool> orphaned_{false};
+    };
+
+    // The rings of a thread, shared with their writers.
+    struct ThreadRings;
+
+    Ring &threadRing();
+    void run();
+    void drain(bool stopping);
+    void flushBatch();
+    void format(const AccessLogRecord &record);
+
+    const std::shared_ptr<const AccessLogFormatter> formatterPtr_;
+    const size_t queueSize_;
+    const bool useRealIp_;
+    const uint64_t id_;
+    OutputFunction output_;
+    // Only used by the background thread.
+    AccessLogFormatContext context_;
+    AccessLogEntry entry_;
+
+    std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool running_{true};
+    std::thread thread_;
+
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reportedDropped_{0};
+    int64_t lastReportTime_{0};
+    std::string batch_;
+};
+}  // namespace plugin
+}  // namespace drogon
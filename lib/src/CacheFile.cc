@@ -13,10 +13,12 @@
  */
 
 #include "CacheFile.h"
+#include "FileIoService.h"
+#include "HttpAppFrameworkImpl.h"
+#include <drogon/utils/Utilities.h>
 #include <trantor/utils/Logger.h>
 #ifdef _WIN32
 #include <mman.h>
-#include <drogon/utils/Utilities.h>
 #else
 #include <unistd.h>
 #include <sys/mman.h>
@@ -36,6 +38,13 @@ CacheFile::CacheFile(const std::string &path, bool autoDelete)
         file_ = nullptr;
     }
 #endif
+    if (file_)
+    {
+        writeStatePtr_ = std::make_shared<WriteState>();
+        writeStatePtr_->file = file_;
+        writeStatePtr_->path = path_;
+        writeStatePtr_->autoDelete = autoDelete_;
+    }
 }
 
 CacheFile::~CacheFile()
@@ -44,26 +53,225 @@ CacheFile::~CacheFile()
     {
         munmap(data_, dataLength_);
     }
-    if (autoDelete_ && file_)
+    if (writeStatePtr_)
+    {
+        // The file is closed by the last task writing it, the IO loop never
+        // waits for the disk here.
+        std::lock_guard<std::mutex> lock(writeStatePtr_->mutex);
+        writeStatePtr_->autoDelete = autoDelete_;
+        if (autoDelete_)
+        {
+            // Nobody reads them any more.
+            writeStatePtr_->chunks.clear();
+        }
+    }
+}
+
+CacheFile::WriteState::~WriteState()
+{
+    fclose(file);
+    if (autoDelete)
     {
-        fclose(file_);
 #if defined(_WIN32) && !defined(__MINGW32__)
-        auto wPath{drogon::utils::toNativePath(path_)};
+        auto wPath{drogon::utils::toNativePath(path)};
         _wunlink(wPath.c_str());
 #else
-        unlink(path_.data());
+        unlink(path.data());
 #endif
     }
-    else if (file_)
+}
+
+// The size of chunks handed to the file IO threads. Request bodies arrive
+// in pieces of a few KiB, writing each of them in a task costs more than the
+// write itself.
+static constexpr size_t kWriteChunkSize = 64 * 1024;
+// The chunks waiting to be written of a file before it is congested.
+static constexpr size_t kMaxPendingChunks = 16;
+
+void CacheFile::append(const char *data, size_t length)
+{
+    if (!file_)
+        return;
+    buffer_.append(data, length);
+    if (buffer_.length() >= kWriteChunkSize)
     {
-        fclose(file_);
+        flushBuffer();
     }
 }
 
-void CacheFile::append(const char *data, size_t length)
+// Write the pending chunks in order, only one thread does it at a time.
+void CacheFile::writeChunks(WriteState &state,
+                            std::unique_lock<std::mutex> &lock)
+{
+    state.draining = true;
+    while (!state.chunks.empty())
+    {
+        auto chunk = std::move(state.chunks.front());
+        state.chunks.pop_front();
+        lock.unlock();
+        if (fwrite(chunk.data(), chunk.length(), 1, state.file) != 1)
+        {
+            LOG_SYSERR << "fwrite:";
+        }
+        lock.lock();
+        notifyWaiters(state, lock);
+    }
+    state.draining = false;
+    state.scheduled = false;
+    state.cond.notify_all();
+}
+
+// Call the callbacks waiting for no more than the pending chunks, the chunk
+// being written is not pending any more when this is called.
+void CacheFile::notifyWaiters(WriteState &state,
+                              std::unique_lock<std::mutex> &lock)
+{
+    if (state.waiters.empty())
+        return;
+    std::vector<std::function<void()>> callbacks;
+    auto pending = state.chunks.size();
+    for (auto iter = state.waiters.begin(); iter != state.waiters.end();)
+    {
+        if (iter->first >= pending)
+        {
+            callbacks.emplace_back(std::move(iter->second));
+            iter = state.waiters.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    if (callbacks.empty())
+        return;
+    lock.unlock();
+    for (auto &callback : callbacks)
+    {
+        callback();
+    }
+    lock.lock();
+}
+
+void CacheFile::flushBuffer()
+{
+    if (buffer_.empty())
+        return;
+    {
+        auto &state = *writeStatePtr_;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.chunks.emplace_back(std::move(buffer_));
+        buffer_.clear();
+        if (state.scheduled)
+            return;
+        state.scheduled = true;
+    }
+    FileIoService::instance().runTask([statePtr = writeStatePtr_]() {
+        std::unique_lock<std::mutex> lock(statePtr->mutex);
+        // The chunks may have been written by a thread waiting for them.
+        if (statePtr->scheduled && !statePtr->draining)
+        {
+            writeChunks(*statePtr, lock);
+        }
+    });
+}
+
+bool CacheFile::isCongested() const
+{
+    if (!writeStatePtr_)
+        return false;
+    std::lock_guard<std::mutex> lock(writeStatePtr_->mutex);
+    return writeStatePtr_->chunks.size() > kMaxPendingChunks;
+}
+
+void CacheFile::addWaiter(size_t pendingChunks,
+                          std::function<void()> &&callback)
+{
+    if (writeStatePtr_)
+    {
+        auto &state = *writeStatePtr_;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        // The chunk being written is still pending.
+        auto pending = state.chunks.size() + (state.draining ? 1 : 0);
+        if (pending > pendingChunks)
+        {
+            state.waiters.emplace_back(pendingChunks, std::move(callback));
+            return;
+        }
+    }
+    callback();
+}
+
+void CacheFile::whenUncongested(std::function<void()> &&callback)
+{
+    // Resume when half of the chunks are written, so that the disk keeps
+    // busy while the next ones are appended.
+    addWaiter(kMaxPendingChunks / 2, std::move(callback));
+}
+
+void CacheFile::whenWritten(std::function<void()> &&callback)
 {
     if (file_)
-        fwrite(data, length, 1, file_);
+        flushBuffer();
+    addWaiter(0, std::move(callback));
+}
+
+void CacheFile::waitForWriting()
+{
+    auto &state = *writeStatePtr_;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (state.scheduled && !state.draining)
+    {
+        // Don't wait for the task in the queue, the caller may be a file IO
+        // thread the task is waiting for.
+        writeChunks(state, lock);
+        return;
+    }
+    state.cond.wait(lock, [&state]() { return !state.scheduled; });
+}
+
+void CacheFile::flush()
+{
+    waitForWriting();
+    if (!buffer_.empty())
+    {
+        if (fwrite(buffer_.data(), buffer_.length(), 1, file_) != 1)
+        {
+            LOG_SYSERR << "fwrite:";
+        }
+        buffer_.clear();
+    }
+    fflush(file_);
+}
+
+bool CacheFile::moveTo(const std::filesystem::path &path)
+{
+    if (!file_ || !autoDelete_)
+        return false;
+    flush();
+    std::error_code err;
+    std::filesystem::rename(utils::toNativePath(path_), path, err);
+    if (err)
+    {
+        LOG_TRACE << "Can't move " << path_ << " to " << path << ": "
+                  << err.message();
+        return false;
+    }
+    // The file belongs to the new path now, it's still readable by the
+    // descriptor.
+    autoDelete_ = false;
+    return true;
+}
+
+std::unique_ptr<CacheFile> CacheFile::newTmpFile()
+{
+    auto tmpfile = HttpAppFrameworkImpl::instance().getUploadPath();
+    auto fileName = utils::getUuid(false);
+    tmpfile.append("/tmp/")
+        .append(1, fileName[0])
+        .append(1, fileName[1])
+        .append("/")
+        .append(fileName);
+    return std::make_unique<CacheFile>(tmpfile);
 }
 
 size_t CacheFile::length()
@@ -83,13 +291,15 @@ char *CacheFile::data()
         return nullptr;
     if (!data_)
     {
-        fflush(file_);
+        flush();
 #ifdef _WIN32
         auto fd = _fileno(file_);
 #else
         auto fd = fileno(file_);
 #endif
         dataLength_ = length();
+        if (dataLength_ == 0)
+            return nullptr;
         data_ = static_cast<char *>(
             mmap(nullptr, dataLength_, PROT_READ, MAP_SHARED, fd, 0));
         if (data_ == MAP_FAILED)
@@ -15,23 +15,45 @@
 #pragma once
 
 #include <trantor/utils/NonCopyable.h>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 #include <stdio.h>
 
 namespace drogon
 {
+/**
+ * @brief A temporary file for large request bodies. Appended data is written
+ * to the file in the file IO threads in chunks, the file is mapped to memory
+ * when its content is accessed.
+ */
 class CacheFile : public trantor::NonCopyable
 {
   public:
     explicit CacheFile(const std::string &path, bool autoDelete = true);
     ~CacheFile();
 
+    bool isOpen() const
+    {
+        return file_ != nullptr;
+    }
+
     void append(const std::string &data)
     {
         append(data.data(), data.length());
     }
 
+    /**
+     * @brief Append the data, it never waits for the disk. The caller should
+     * stop appending while the file is congested.
+     */
     void append(const char *data, size_t length);
 
     std::string_view getStringView()
@@ -41,10 +63,74 @@ class CacheFile : public trantor::NonCopyable
         return std::string_view();
     }
 
+    /// Write all the appended data to the file, waiting for the file IO
+    /// threads if needed.
+    void flush();
+
+    /// Return true if the data are appended faster than they are written.
+    bool isCongested() const;
+
+    /**
+     * @brief Call the callback once the file isn't congested any more, in a
+     * file IO thread, or right away if it isn't congested.
+     */
+    void whenUncongested(std::function<void()> &&callback);
+
+    /**
+     * @brief Hand all the appended data to the file IO threads and call the
+     * callback once they are written, in a file IO thread, or right away if
+     * there is nothing to write. flush() doesn't wait after that.
+     */
+    void whenWritten(std::function<void()> &&callback);
+
+    /**
+     * @brief Rename the file to the path instead of copying it. The file is
+     * not deleted any more then.
+     *
+     * @return false if the file is not deleted automatically or can't be
+     * renamed, e.g. the path is on another file system, or the file has been
+     * moved.
+     */
+    bool moveTo(const std::filesystem::path &path);
+
+    /// Create a file in the tmp directory of the upload path.
+    static std::unique_ptr<CacheFile> newTmpFile();
+
   private:
+    // The state shared with the file IO tasks writing the chunks in order.
+    // The last owner closes the file, so that the CacheFile object can be
+    // destroyed while chunks are being written.
+    struct WriteState
+    {
+        ~WriteState();
+
+        FILE *file{nullptr};
+        std::string path;
+        bool autoDelete{true};
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<std::string> chunks;
+        // A task is queued to write the chunks
+        bool scheduled{false};
+        // A thread is writing the chunks
+        bool draining{false};
+        // The callbacks waiting for the number of chunks not written yet to
+        // drop to the first value.
+        std::vector<std::pair<size_t, std::function<void()>>> waiters;
+    };
+
+    static void writeChunks(WriteState &state,
+                            std::unique_lock<std::mutex> &lock);
+    static void notifyWaiters(WriteState &state,
+                              std::unique_lock<std::mutex> &lock);
+    void addWaiter(size_t pendingChunks, std::function<void()> &&callback);
     char *data();
     size_t length();
+    void flushBuffer();
+    void waitForWriting();
     FILE *file_{nullptr};
+    std::string buffer_;
+    std::shared_ptr<WriteState> writeStatePtr_;
     bool autoDelete_{true};
     const std::string path_;
     char *data_{nullptr};
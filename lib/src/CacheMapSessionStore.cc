@@ -0,0 +1,128 @@
+/**
+ *
+ *  @file CacheMapSessionStore.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "CacheMapSessionStore.h"
+
+using namespace drogon;
+
+CacheMapSessionStore::CacheMapSessionStore(
+    const std::vector<AdviceStartSessionCallback> &startAdvices,
+    const std::vector<AdviceDestroySessionCallback> &destroyAdvices)
+    : sessionStartAdvices_(startAdvices), sessionDestroyAdvices_(destroyAdvices)
+{
+}
+
+void CacheMapSessionStore::init(trantor::EventLoop *loop, size_t timeout)
+{
+    timeout_ = timeout;
+    if (timeout_ > 0)
+    {
+        size_t wheelNum = 1;
+        size_t bucketNum = 0;
+        if (timeout_ < 500)
+        {
+            bucketNum = timeout_ + 1;
+        }
+        else
+        {
+            auto tmpTimeout = timeout_;
+            bucketNum = 100;
+            while (tmpTimeout > 100)
+            {
+                ++wheelNum;
+                tmpTimeout = tmpTimeout / 100;
+            }
+        }
+
+        sessionMapPtr_ = std::unique_ptr<CacheMap<std::string, SessionPtr>>(
+            new CacheMap<std::string, SessionPtr>(
+                loop,
+                1.0,
+                wheelNum,
+                bucketNum,
+                [this](const std::string &key) {
+                    for (auto &advice : sessionStartAdvices_)
+                    {
+                        advice(key);
+                    }
+                },
+                [this](const std::string &key) {
+                    for (auto &advice : sessionDestroyAdvices_)
+                    {
+                        advice(key);
+                    }
+                }));
+    }
+    else if (timeout_ == 0)
+    {
+        sessionMapPtr_ = std::unique_ptr<CacheMap<std::string, SessionPtr>>(
+            new CacheMap<std::string, SessionPtr>(
+                loop,
+                0,
+                0,
+                0,
+                [this](const std::string &key) {
+                    for (auto &advice : sessionStartAdvices_)
+                    {
+                        advice(key);
+                    }
+                },
+                [this](const std::string &key) {
+                    for (auto &advice : sessionDestroyAdvices_)
+                    {
+                        advice(key);
+                    }
+                }));
+    }
+}
+
+SessionPtr CacheMapSessionStore::findSession(const std::string &sessionId,
+                                             bool isNew)
+{
+    SessionPtr sessionPtr;
+    sessionMapPtr_->modify(
+        sessionId,
+        [&sessionPtr, &sessionId, isNew](SessionPtr &sessionInCache) {
+            if (sessionInCache)
+            {
+                sessionPtr = sessionInCache;
+            }
+            else
+            {
+                sessionPtr = newSession(sessionId, isNew);
+                sessionInCache = sessionPtr;
+            }
+        },
+        timeout_);
+
+    return sessionPtr;
+}
+
+void CacheMapSessionStore::loadSession(const std::string &sessionId,
+                                       SessionCallback &&callback)
+{
+    callback(findSession(sessionId, false));
+}
+
+void CacheMapSessionStore::changeSessionId(const SessionPtr &sessionPtr,
+                                           const std::string &oldId)
+{
+    sessionMapPtr_->insert(sessionPtr->sessionId(), sessionPtr, timeout_);
+    // For requests sent before setting the new session ID to the client, we
+    // reserve the old session slot for a period of time.
+    sessionMapPtr_->runAfter(10, [this, oldId]() {
+        LOG_TRACE << "remove the old slot of the session";
+        sessionMapPtr_->erase(oldId);
+    });
+}
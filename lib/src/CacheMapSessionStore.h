@@ -0,0 +1,60 @@
+/**
+ *
+ *  @file CacheMapSessionStore.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/SessionStore.h>
+#include <drogon/drogon_callbacks.h>
+#include <drogon/CacheMap.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace drogon
+{
+/**
+ * @brief The default session store that keeps sessions in a CacheMap in the
+ * memory of the process.
+ */
+class CacheMapSessionStore : public SessionStore
+{
+  public:
+    CacheMapSessionStore(
+        const std::vector<AdviceStartSessionCallback> &startAdvices,
+        const std::vector<AdviceDestroySessionCallback> &destroyAdvices);
+
+    ~CacheMapSessionStore() override
+    {
+        sessionMapPtr_.reset();
+    }
+
+    void init(trantor::EventLoop *loop, size_t timeout) override;
+    SessionPtr findSession(const std::string &sessionId, bool isNew) override;
+    void loadSession(const std::string &sessionId,
+                     SessionCallback &&callback) override;
+
+    void saveSession(const SessionPtr & /*sessionPtr*/) override
+    {
+    }
+
+    void changeSessionId(const SessionPtr &sessionPtr,
+                         const std::string &oldId) override;
+
+  private:
+    std::unique_ptr<CacheMap<std::string, SessionPtr>> sessionMapPtr_;
+    size_t timeout_{0};
+    const std::vector<AdviceStartSessionCallback> &sessionStartAdvices_;
+    const std::vector<AdviceDestroySessionCallback> &sessionDestroyAdvices_;
+};
+}  // namespace drogon
@@ -274,6 +274,28 @@ static void loadApp(const Json::Value &app)
                                     Cookie::convertString2SameSite(sameSite),
                                     cookieKey,
                                     maxAge);
+        auto &sessionStore = app["session_store"];
+        if (!sessionStore.isNull())
+        {
+            auto type = sessionStore.get("type", "memory").asString();
+            std::transform(type.begin(),
+                           type.end(),
+                           type.begin(),
+                           [](unsigned char c) { return tolower(c); });
+            if (type == "redis")
+            {
+                drogon::app().setRedisSessionStore(
+                    sessionStore.get("redis_client", "default").asString(),
+                    sessionStore.get("key_prefix", "drogon:session:")
+                        .asString(),
+                    sessionStore.get("near_cache_size", 0).asUInt64());
+            }
+            else if (type != "memory")
+            {
+                throw std::runtime_error("Unsupported session store type: " +
+                                         type);
+            }
+        }
     }
     else
         drogon::app().disableSession();
@@ -439,6 +461,11 @@ static void loadApp(const Json::Value &app)
     }
     auto useSendfile = app.get("use_sendfile", true).asBool();
     drogon::app().enableSendfile(useSendfile);
+    auto sendfileThreshold =
+        app.get("sendfile_threshold", 200 * 1024).asUInt64();
+    drogon::app().setSendfileThreshold(sendfileThreshold);
+    auto fileIoThreads = app.get("file_io_threads", 2).asUInt64();
+    drogon::app().setFileIoThreadNum(fileIoThreads);
     auto useGzip = app.get("use_gzip", true).asBool();
     drogon::app().enableGzip(useGzip);
     auto useBr = app.get("use_brotli", false).asBool();
@@ -527,6 +554,8 @@ static void loadApp(const Json::Value &app)
 
     drogon::app().enableRequestStream(
         app.get("enable_request_stream", false).asBool());
+    drogon::app().enableStreamingMultipartUpload(
+        app.get("enable_streaming_multipart_upload", false).asBool());
 }
 
 static void loadDbClients(const Json::Value &dbClients)
@@ -570,6 +599,21 @@ static void loadDbClients(const Json::Value &dbClients)
         auto connectOptions = client.get("connect_options", Json::Value());
         auto timeout = client.get("timeout", -1.0).asDouble();
         auto autoBatch = client.get("auto_batch", false).asBool();
+        std::vector<orm::ReplicaConfig> replicas;
+        for (auto const &replica : client["replicas"])
+        {
+            replicas.push_back(
+                {replica.get("host", "127.0.0.1").asString(),
+                 (unsigned short)replica.get("port", port).asUInt()});
+        }
+        auto replicaCheckInterval =
+            client.get("replica_check_interval", 5.0).asDouble();
+        auto maxReplicaLag = client.get("max_replica_lag", -1.0).asDouble();
+        orm::BatchOptions batchOptions;
+        batchOptions.maxBatchSize = client.get("max_batch_size", 256).asUInt();
+        batchOptions.maxSqlLength =
+            client.get("max_batch_sql_length", 1024).asUInt();
+        batchOptions.batchWindow = client.get("batch_window", 0.0).asDouble();
 
         std::unordered_map<std::string, std::string> options;
         if (connectOptions.isObject() && !connectOptions.empty())
@@ -593,7 +637,11 @@ static void loadDbClients(const Json::Value &dbClients)
                                                      characterSet,
                                                      timeout,
                                                      autoBatch,
-                                                     std::move(options));
+                                                     std::move(options),
+                                                     std::move(replicas),
+                                                     replicaCheckInterval,
+                                                     maxReplicaLag,
+                                                     batchOptions);
     }
 }
 
@@ -626,6 +674,7 @@ static void loadRedisClients(const Json::Value &redisClients)
         auto isFast = client.get("is_fast", false).asBool();
         auto timeout = client.get("timeout", -1.0).asDouble();
         auto db = client.get("db", 0).asUInt();
+        auto loopAffinity = client.get("loop_affinity", false).asBool();
         auto hostIp = future.get();
         drogon::app().createRedisClient(hostIp,
                                         port,
@@ -635,7 +684,8 @@ static void loadRedisClients(const Json::Value &redisClients)
                                         isFast,
                                         timeout,
                                         db,
-                                        username);
+                                        username,
+                                        loopAffinity);
     }
 }
 
@@ -57,6 +57,7 @@ class DbClientManager : public trantor::NonCopyable
     {
         std::string connectionInfo_;
         DbConfig config_;
+        std::vector<std::string> replicaConnectionInfos_{};
     };
 
     std::vector<DbInfo> dbInfos_;
@@ -0,0 +1,79 @@
+/**
+ *
+ *  @file FileIoService.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "FileIoService.h"
+#include <drogon/utils/Utilities.h>
+#include <trantor/utils/Logger.h>
+#include <fstream>
+
+using namespace drogon;
+
+// The tasks of a file IO thread that can wait in the queue. When all the
+// threads are that busy the disk is the bottleneck, the tasks that can be
+// refused are refused instead of queuing unbounded memory.
+static constexpr size_t kMaxPendingTasksPerThread = 256;
+
+void FileIoService::init()
+{
+    std::call_once(once_, [this]() {
+        if (threadNum_ == 0)
+        {
+            threadNum_ = 1;
+        }
+        queuePtr_ = std::make_unique<trantor::ConcurrentTaskQueue>(threadNum_,
+                                                                   "FileIO");
+    });
+}
+
+void FileIoService::runTask(std::function<void()> &&task)
+{
+    init();
+    queuePtr_->runTaskInQueue(std::move(task));
+}
+
+bool FileIoService::tryRunTask(std::function<void()> &&task)
+{
+    init();
+    if (queuePtr_->getTaskCount() >= kMaxPendingTasksPerThread * threadNum_)
+    {
+        LOG_WARN << "Too many file IO tasks, the task is refused";
+        return false;
+    }
+    queuePtr_->runTaskInQueue(std::move(task));
+    return true;
+}
+
+bool FileIoService::readFile(const std::string &path,
+                             size_t offset,
+                             size_t length,
+                             std::string &data)
+{
+    std::ifstream infile(utils::toNativePath(path), std::ifstream::binary);
+    if (!infile)
+    {
+        LOG_ERROR << "Can't open the file " << path;
+        return false;
+    }
+    data.resize(length);
+    std::streambuf *pbuf = infile.rdbuf();
+    pbuf->pubseekoff(offset, std::ifstream::beg);
+    if (pbuf->sgetn(&data[0], length) != static_cast<std::streamsize>(length))
+    {
+        LOG_ERROR << "Can't read " << length << " bytes at " << offset
+                  << " of the file " << path;
+        data.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+/**
+ *
+ *  @file FileIoService.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <trantor/utils/ConcurrentTaskQueue.h>
+#include <trantor/utils/NonCopyable.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace drogon
+{
+/**
+ * @brief Runs blocking file operations in a bounded pool of threads, so that
+ * slow disks don't stall the IO loops.
+ */
+class FileIoService : public trantor::NonCopyable
+{
+  public:
+    static FileIoService &instance()
+    {
+        static FileIoService service;
+        return service;
+    }
+
+    /**
+     * @brief Set the number of file IO threads, it must be called before the
+     * service is used.
+     */
+    void setThreadNum(size_t threadNum)
+    {
+        threadNum_ = threadNum;
+    }
+
+    /**
+     * @brief Run the task in a file IO thread. The task is always queued, the
+     * callers bound the number of their pending tasks.
+     */
+    void runTask(std::function<void()> &&task);
+
+    /**
+     * @brief Run the task in a file IO thread unless too many tasks are
+     * waiting.
+     *
+     * @return false if the task is dropped because the file IO threads are
+     * overloaded.
+     */
+    bool tryRunTask(std::function<void()> &&task);
+
+    /**
+     * @brief Read a part of the file in the current thread.
+     */
+    static bool readFile(const std::string &path,
+                         size_t offset,
+                         size_t length,
+                         std::string &data);
+
+  private:
+    FileIoService() = default;
+    void init();
+
+    size_t threadNum_{2};
+    std::once_flag once_;
+    std::unique_ptr<trantor::ConcurrentTaskQueue> queuePtr_;
+};
+}  // namespace drogon
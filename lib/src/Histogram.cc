@@ -1,12 +1,31 @@
 #include <drogon/utils/monitoring/Histogram.h>
+#include <algorithm>
 using namespace drogon;
 using namespace drogon::monitoring;
 
 void Histogram::observe(double value)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
     if (maxAge_ > std::chrono::seconds(0) &&
-        timerId_ == trantor::InvalidTimerId)
+        !timerStarted_.load(std::memory_order_acquire))
+    {
+        startTimer();
+    }
+    // The first bucket whose upper bound is not less than the value, values
+    // greater than all the bounds are counted in the +Inf bucket.
+    auto iter = std::lower_bound(bucketBoundaries_.begin(),
+                                 bucketBoundaries_.end(),
+                                 value);
+    auto bucket = static_cast<size_t>(iter - bucketBoundaries_.begin());
+    auto &timeBucket =
+        *timeBuckets_[currentTimeBucket_.load(std::memory_order_acquire)];
+    timeBucket.counters.add(bucket);
+    timeBucket.sum.add(value);
+}
+
+void Histogram::startTimer()
+{
+    std::lock_guard<std::mutex> lock(timerMutex_);
+    if (timerId_ == trantor::InvalidTimerId)
     {
         std::weak_ptr<Histogram> weakPtr =
             std::dynamic_pointer_cast<Histogram>(shared_from_this());
@@ -17,35 +36,38 @@ void Histogram::observe(double value)
             thisPtr->rotateTimeBuckets();
         });
     }
-    auto &currentBucket = timeBuckets_.back();
-    currentBucket.sum += value;
-    currentBucket.count += 1;
-    for (size_t i = 0; i < bucketBoundaries_.size(); i++)
-    {
-        if (value <= bucketBoundaries_[i])
-        {
-            currentBucket.buckets[i] += 1;
-            break;
-        }
-    }
-    if (value > bucketBoundaries_.back())
-    {
-        currentBucket.buckets.back() += 1;
-    }
+    timerStarted_.store(true, std::memory_order_release);
+}
+
+void Histogram::rotateTimeBuckets()
+{
+    // Only called in the timer, the oldest time bucket is cleared before it
+    // becomes the current one.
+    auto next = (currentTimeBucket_.load(std::memory_order_relaxed) + 1) %
+                timeBuckets_.size();
+    timeBuckets_[next]->clear();
+    currentTimeBucket_.store(next, std::memory_order_release);
 }
 
 std::vector<Sample> Histogram::collect() const
 {
     std::vector<Sample> samples;
-    std::lock_guard<std::mutex> guard(mutex_);
-    size_t count{0};
-    for (size_t i = 0; i < bucketBoundaries_.size(); i++)
+    auto bucketsCount = bucketBoundaries_.size() + 1;
+    std::vector<uint64_t> counts(bucketsCount, 0);
+    double sum{0};
+    for (auto &timeBucket : timeBuckets_)
     {
-        Sample sample;
-        for (auto &bucket : timeBuckets_)
+        for (size_t i = 0; i < bucketsCount; ++i)
         {
-            count += bucket.buckets[i];
+            counts[i] += timeBucket->counters.value(i);
         }
+        sum += timeBucket->sum.value();
+    }
+    uint64_t count{0};
+    for (size_t i = 0; i < bucketBoundaries_.size(); i++)
+    {
+        Sample sample;
+        count += counts[i];
         sample.name = name_ + "_bucket";
         sample.exLabels.emplace_back("le",
                                      std::to_string(bucketBoundaries_[i]));
@@ -53,28 +75,18 @@ std::vector<Sample> Histogram::collect() const
         samples.emplace_back(std::move(sample));
     }
     Sample sample;
-    for (auto &bucket : timeBuckets_)
-    {
-        count += bucket.buckets.back();
-    }
+    count += counts.back();
     sample.name = name_ + "_bucket";
     sample.exLabels.emplace_back("le", "+Inf");
     sample.value = count;
     samples.emplace_back(std::move(sample));
-    double sum{0};
-    uint64_t totalCount{0};
-    for (auto &bucket : timeBuckets_)
-    {
-        sum += bucket.sum;
-        totalCount += bucket.count;
-    }
     Sample sumSample;
     sumSample.name = name_ + "_sum";
     sumSample.value = sum;
     samples.emplace_back(std::move(sumSample));
     Sample countSample;
     countSample.name = name_ + "_count";
-    countSample.value = totalCount;
+    countSample.value = count;
     samples.emplace_back(std::move(countSample));
     return samples;
 }
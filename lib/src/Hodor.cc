@@ -1,5 +1,6 @@
 #include <drogon/plugins/Hodor.h>
 #include <drogon/plugins/RealIpResolver.h>
+#include "RateLimiterTable.h"
 
 using namespace drogon::plugin;
 
@@ -43,23 +44,23 @@ Hodor::LimitStrategy Hodor::makeLimitStrategy(const Json::Value &config)
     strategy.ipCapacity = config.get("ip_capacity", 0).asUInt();
     if (strategy.ipCapacity > 0)
     {
-        strategy.ipLimiterMapPtr =
-            std::make_unique<CacheMap<std::string, RateLimiterPtr>>(
-                drogon::app().getLoop(),
-                float(timeUnit_.count() / 60 < 1 ? 1 : timeUnit_.count() / 60),
-                2,
-                100);
+        strategy.ipLimiterTablePtr =
+            std::make_shared<RateLimiterTable>(algorithm_,
+                                               strategy.ipCapacity,
+                                               timeUnit_,
+                                               limiterTableSize_,
+                                               multiThreads_);
     }
 
     strategy.userCapacity = config.get("user_capacity", 0).asUInt();
     if (strategy.userCapacity > 0)
     {
-        strategy.userLimiterMapPtr =
-            std::make_unique<CacheMap<std::string, RateLimiterPtr>>(
-                drogon::app().getLoop(),
-                float(timeUnit_.count() / 60 < 1 ? 1 : timeUnit_.count() / 60),
-                2,
-                100);
+        strategy.userLimiterTablePtr =
+            std::make_shared<RateLimiterTable>(algorithm_,
+                                               strategy.userCapacity,
+                                               timeUnit_,
+                                               limiterTableSize_,
+                                               multiThreads_);
     }
     return strategy;
 }
@@ -78,10 +79,7 @@ void Hodor::initAndStart(const Json::Value &config)
     rejectResponse_->setBody(
         config.get("rejection_message", "Too many requests").asString());
     rejectResponse_->setCloseConnection(true);
-    limiterExpireTime_ =
-        (std::max)(static_cast<size_t>(
-                       config.get("limiter_expire_time", 600).asUInt()),
-                   static_cast<size_t>(timeUnit_.count() * 3));
+    limiterTableSize_ = config.get("limiter_table_size", 262144).asUInt64();
     limitStrategies_.emplace_back(makeLimitStrategy(config));
     if (config.isMember("sub_limits") && config["sub_limits"].isArray())
     {
@@ -153,30 +151,8 @@ bool Hodor::checkLimit(const drogon::HttpRequestPtr &req,
     }
     if (strategy.ipCapacity > 0)
     {
-        RateLimiterPtr limiterPtr;
-        strategy.ipLimiterMapPtr->modify(
-            ip.toIpNetEndian(),
-            [this, &limiterPtr, &strategy](RateLimiterPtr &ptr) {
-                if (!ptr)
-                {
-                    if (multiThreads_)
-                    {
-                        ptr = std::make_shared<SafeRateLimiter>(
-                            RateLimiter::newRateLimiter(algorithm_,
-                                                        strategy.ipCapacity,
-                                                        timeUnit_));
-                    }
-                    else
-                    {
-                        ptr = RateLimiter::newRateLimiter(algorithm_,
-                                                          strategy.ipCapacity,
-                                                          timeUnit_);
-                    }
-                }
-                limiterPtr = ptr;
-            },
-            limiterExpireTime_);
-        if (!limiterPtr->isAllowed())
+        if (!strategy.ipLimiterTablePtr->isAllowed(
+                RateLimiterTable::makeKey(ip)))
         {
             return false;
         }
@@ -187,30 +163,8 @@ bool Hodor::checkLimit(const drogon::HttpRequestPtr &req,
         {
             return true;
         }
-        RateLimiterPtr limiterPtr;
-        strategy.userLimiterMapPtr->modify(
-            *userId,
-            [this, &strategy, &limiterPtr](RateLimiterPtr &ptr) {
-                if (!ptr)
-                {
-                    if (multiThreads_)
-                    {
-                        ptr = std::make_shared<SafeRateLimiter>(
-                            RateLimiter::newRateLimiter(algorithm_,
-                                                        strategy.userCapacity,
-                                                        timeUnit_));
-                    }
-                    else
-                    {
-                        ptr = RateLimiter::newRateLimiter(algorithm_,
-                                                          strategy.userCapacity,
-                                                          timeUnit_);
-                    }
-                }
-                limiterPtr = ptr;
-            },
-            limiterExpireTime_);
-        if (!limiterPtr->isAllowed())
+        if (!strategy.userLimiterTablePtr->isAllowed(
+                RateLimiterTable::makeKey(*userId)))
         {
             return false;
         }
@@ -18,12 +18,14 @@
 #include <drogon/HttpTypes.h>
 #include <drogon/utils/Utilities.h>
 #include <drogon/version.h>
+#include <drogon/nosql/RedisSessionStore.h>
 #include <json/json.h>
 #include <trantor/utils/AsyncFileLogger.h>
 #include <algorithm>
 #include "AOPAdvice.h"
 #include "ConfigLoader.h"
 #include "DbClientManager.h"
+#include "FileIoService.h"
 #include "HttpClientImpl.h"
 #include "HttpConnectionLimit.h"
 #include "HttpControllersRouter.h"
@@ -632,12 +634,13 @@ void HttpAppFrameworkImpl::run()
     redisClientManagerPtr_->createRedisClients(ioLoops);
     if (useSession_)
     {
-        sessionManagerPtr_ =
-            std::make_unique<SessionManager>(getLoop(),
-                                             sessionTimeout_,
-                                             sessionStartAdvices_,
-                                             sessionDestroyAdvices_,
-                                             sessionIdGeneratorCallback_);
+        sessionManagerPtr_ = std::make_unique<SessionManager>(
+            getLoop(),
+            sessionTimeout_,
+            sessionStartAdvices_,
+            sessionDestroyAdvices_,
+            sessionIdGeneratorCallback_,
+            sessionStoreFactory_ ? sessionStoreFactory_() : nullptr);
     }
     // now start running!!
     running_ = true;
@@ -704,7 +707,7 @@ HttpAppFramework &HttpAppFrameworkImpl::setUploadPath(
     return *this;
 }
 
-void HttpAppFrameworkImpl::findSessionForRequest(const HttpRequestImplPtr &req)
+bool HttpAppFrameworkImpl::findSessionForRequest(const HttpRequestImplPtr &req)
 {
     if (useSession_)
     {
@@ -715,9 +718,44 @@ void HttpAppFrameworkImpl::findSessionForRequest(const HttpRequestImplPtr &req)
             sessionId = sessionIdGeneratorCallback_();
             needSetSessionid = true;
         }
-        req->setSession(
-            sessionManagerPtr_->getSession(sessionId, needSetSessionid));
+        auto sessionPtr =
+            sessionManagerPtr_->findSession(sessionId, needSetSessionid);
+        if (!sessionPtr)
+        {
+            return false;
+        }
+        req->setSession(sessionPtr);
     }
+    return true;
+}
+
+void HttpAppFrameworkImpl::loadSessionForRequest(
+    const HttpRequestImplPtr &req,
+    std::function<void(bool)> &&callback)
+{
+    auto loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+    sessionManagerPtr_->loadSession(
+        req->getCookie(sessionCookieKey_),
+        [req, loop, callback = std::move(callback)](
+            const SessionPtr &sessionPtr) mutable {
+            // A null session means the store failed, the request isn't
+            // handled with an empty session that would overwrite the stored
+            // one.
+            bool loaded = sessionPtr != nullptr;
+            if (loaded)
+                req->setSession(sessionPtr);
+            // Handle the request in its IO loop again.
+            if (!loop || loop->isInLoopThread())
+            {
+                callback(loaded);
+            }
+            else
+            {
+                loop->queueInLoop([callback = std::move(callback), loaded]() {
+                    callback(loaded);
+                });
+            }
+        });
 }
 
 std::vector<HttpHandlerInfo> HttpAppFrameworkImpl::getHandlersInfo() const
@@ -740,6 +778,7 @@ HttpResponsePtr HttpAppFrameworkImpl::handleSessionForResponse(
         {
             sessionManagerPtr_->changeSessionId(sessionPtr);
         }
+        sessionManagerPtr_->saveSession(sessionPtr);
         if (sessionPtr->needSetToClient())
         {
             if (resp->expiredTime() >= 0)
@@ -966,7 +1005,11 @@ void HttpAppFrameworkImpl::addDbClient(
     const std::string &characterSet,
     double timeout,
     bool autoBatch,
-    std::unordered_map<std::string, std::string> options)
+    std::unordered_map<std::string, std::string> options,
+    std::vector<orm::ReplicaConfig> replicas,
+    double replicaCheckInterval,
+    double maxReplicaLag,
+    const orm::BatchOptions &batchOptions)
 {
     if (dbType == "postgresql" || dbType == "postgres")
     {
@@ -981,7 +1024,13 @@ void HttpAppFrameworkImpl::addDbClient(
                                         characterSet,
                                         timeout,
                                         autoBatch,
-                                        std::move(options)});
+                                        std::move(options),
+                                        std::move(replicas),
+                                        replicaCheckInterval,
+                                        maxReplicaLag,
+                                        batchOptions.maxBatchSize,
+                                        batchOptions.maxSqlLength,
+                                        batchOptions.batchWindow});
     }
     else if (dbType == "mysql")
     {
@@ -998,7 +1047,8 @@ void HttpAppFrameworkImpl::addDbClient(
     }
     else if (dbType == "sqlite3")
     {
-        addDbClient(orm::Sqlite3Config{connectionNum, filename, name, timeout});
+        addDbClient(orm::Sqlite3Config{
+            connectionNum, filename, name, timeout, std::move(options)});
     }
     else
     {
@@ -1023,11 +1073,49 @@ HttpAppFramework &HttpAppFrameworkImpl::createRedisClient(
     bool isFast,
     double timeout,
     unsigned int db,
-    const std::string &username)
+    const std::string &username,
+    bool loopAffinity)
 {
     assert(!running_);
-    redisClientManagerPtr_->createRedisClient(
-        name, ip, port, username, password, connectionNum, isFast, timeout, db);
+    redisClientManagerPtr_->createRedisClient(name,
+                                              ip,
+                                              port,
+                                              username,
+                                              password,
+                                              connectionNum,
+                                              isFast,
+                                              timeout,
+                                              db,
+                                              loopAffinity);
+    return *this;
+}
+
+HttpAppFramework &HttpAppFrameworkImpl::setFileIoThreadNum(size_t threadNum)
+{
+    assert(!running_);
+    FileIoService::instance().setThreadNum(threadNum);
+    return *this;
+}
+
+HttpAppFramework &HttpAppFrameworkImpl::setRedisSessionStore(
+    const std::string &clientName,
+    const std::string &keyPrefix,
+    size_t nearCacheSize)
+{
+    assert(!running_);
+    // Redis clients are created when the application starts running.
+    sessionStoreFactory_ = [this, clientName, keyPrefix, nearCacheSize]() {
+        auto client = getRedisClient(clientName);
+        if (!client)
+        {
+            LOG_FATAL << "The redis client '" << clientName
+                      << "' of the session store doesn't exist";
+            abort();
+        }
+        return nosql::RedisSessionStore::newRedisSessionStore(client,
+                                                              keyPrefix,
+                                                              nearCacheSize);
+    };
     return *this;
 }
 
@@ -1263,6 +1351,18 @@ bool HttpAppFrameworkImpl::isRequestStreamEnabled() const
     return enableRequestStream_;
 }
 
+HttpAppFramework &HttpAppFrameworkImpl::enableStreamingMultipartUpload(
+    bool enable)
+{
+    enableStreamingMultipartUpload_ = enable;
+    return *this;
+}
+
+bool HttpAppFrameworkImpl::isStreamingMultipartUploadEnabled() const
+{
+    return enableStreamingMultipartUpload_;
+}
+
 // AOP registration methods
 
 HttpAppFramework &HttpAppFrameworkImpl::registerNewConnectionAdvice(
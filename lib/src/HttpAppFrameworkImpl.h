@@ -209,6 +209,17 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
         return *this;
     }
 
+    HttpAppFramework &setSessionStore(
+        const std::shared_ptr<SessionStore> &store) override
+    {
+        sessionStoreFactory_ = [store]() { return store; };
+        return *this;
+    }
+
+    HttpAppFramework &setRedisSessionStore(const std::string &clientName,
+                                           const std::string &keyPrefix,
+                                           size_t nearCacheSize) override;
+
     HttpAppFramework &disableSession() override
     {
         useSession_ = false;
@@ -314,6 +325,14 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
         return *this;
     }
 
+    HttpAppFramework &setSendfileThreshold(size_t threshold) override
+    {
+        sendfileThreshold_ = threshold;
+        return *this;
+    }
+
+    HttpAppFramework &setFileIoThreadNum(size_t threadNum) override;
+
     HttpAppFramework &enableGzip(bool useGzip) override
     {
         useGzip_ = useGzip;
@@ -565,7 +584,11 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
                      const std::string &characterSet,
                      double timeout,
                      bool autoBatch,
-                     std::unordered_map<std::string, std::string> options);
+                     std::unordered_map<std::string, std::string> options,
+                     std::vector<orm::ReplicaConfig> replicas = {},
+                     double replicaCheckInterval = 5.0,
+                     double maxReplicaLag = -1.0,
+                     const orm::BatchOptions &batchOptions = {});
     HttpAppFramework &addDbClient(const orm::DbConfig &config) override;
 
     HttpAppFramework &createRedisClient(const std::string &ip,
@@ -576,7 +599,8 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
                                         bool isFast,
                                         double timeout,
                                         unsigned int db,
-                                        const std::string &username) override;
+                                        const std::string &username,
+                                        bool loopAffinity) override;
     nosql::RedisClientPtr getRedisClient(const std::string &name) override;
     nosql::RedisClientPtr getFastRedisClient(const std::string &name) override;
     std::vector<trantor::InetAddress> getListeners() const override;
@@ -592,6 +616,11 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
         return useSendfile_;
     }
 
+    size_t sendfileThreshold() const
+    {
+        return sendfileThreshold_;
+    }
+
     bool supportSSL() const override
     {
         return trantor::utils::tlsBackend() != "None";
@@ -657,7 +686,18 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     int64_t getConnectionCount() const override;
 
     // TODO: move session related codes to its own singleton class
-    void findSessionForRequest(const HttpRequestImplPtr &req);
+    /**
+     * @brief Set the session to the request if it can be found without
+     * waiting, otherwise return false and the loadSessionForRequest() method
+     * should be called.
+     */
+    bool findSessionForRequest(const HttpRequestImplPtr &req);
+    /**
+     * @brief Load the session of the request, the callback is called in the
+     * IO loop of the request with false if the session store failed.
+     */
+    void loadSessionForRequest(const HttpRequestImplPtr &req,
+                               std::function<void(bool)> &&callback);
     HttpResponsePtr handleSessionForResponse(const HttpRequestImplPtr &req,
                                              const HttpResponsePtr &resp);
 
@@ -669,6 +709,9 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     HttpAppFramework &enableRequestStream(bool enable) override;
     bool isRequestStreamEnabled() const override;
 
+    HttpAppFramework &enableStreamingMultipartUpload(bool enable) override;
+    bool isStreamingMultipartUploadEnabled() const override;
+
   private:
     void registerHttpController(const std::string &pathPattern,
                                 const internal::HttpBinderBasePtr &binder,
@@ -729,6 +772,7 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     size_t pipeliningRequestsNumber_{0};
     size_t jsonStackLimit_{1000};
     bool useSendfile_{true};
+    size_t sendfileThreshold_{200 * 1024};
     bool useGzip_{true};
     bool useBrotli_{false};
     bool usingUnicodeEscaping_{true};
@@ -745,6 +789,7 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     std::vector<AdviceStartSessionCallback> sessionStartAdvices_;
     std::vector<AdviceDestroySessionCallback> sessionDestroyAdvices_;
     SessionManager::IdGeneratorCallback sessionIdGeneratorCallback_;
+    std::function<std::shared_ptr<SessionStore>()> sessionStoreFactory_;
     std::shared_ptr<trantor::AsyncFileLogger> asyncFileLoggerPtr_;
     Json::Value jsonConfig_;
     Json::Value jsonRuntimeConfig_;
@@ -761,6 +806,7 @@ class HttpAppFrameworkImpl final : public HttpAppFramework
     bool enableCompressedRequest_{false};
 
     bool enableRequestStream_{false};
+    bool enableStreamingMultipartUpload_{false};
 };
 
 }  // namespace drogon
@@ -16,6 +16,7 @@
 #include "HttpControllerBinder.h"
 #include "HttpRequestImpl.h"
 #include "HttpAppFrameworkImpl.h"
+#include "HttpServerMetrics.h"
 #include "MiddlewaresFunction.h"
 #include <drogon/HttpSimpleController.h>
 #include <drogon/WebSocketController.h>
@@ -52,10 +53,24 @@ void HttpControllersRouter::init(
         }
         corsMethods->pop_back();  // remove last comma
     };
+    auto initMetrics = [](auto &item, const std::string &pathPattern) {
+        auto &metrics = HttpServerMetrics::instance();
+        if (!metrics.isEnabled())
+            return;
+        for (size_t i = 0; i < Invalid; ++i)
+        {
+            if (item.binders_[i])
+            {
+                item.metrics_[i] =
+                    metrics.routeMetrics(pathPattern, (HttpMethod)i);
+            }
+        }
+    };
 
     for (auto &iter : simpleCtrlMap_)
     {
         initMiddlewaresAndCorsMethods(iter.second);
+        initMetrics(iter.second, iter.first);
     }
 
     for (auto &iter : wsCtrlMap_)
@@ -68,6 +83,7 @@ void HttpControllersRouter::init(
         router.regex_ = std::regex(router.pathParameterPattern_,
                                    std::regex_constants::icase);
         initMiddlewaresAndCorsMethods(router);
+        initMetrics(router, router.pathPattern_);
     }
 
     for (auto &p : ctrlMap_)
@@ -76,6 +92,7 @@ void HttpControllersRouter::init(
         router.regex_ = std::regex(router.pathParameterPattern_,
                                    std::regex_constants::icase);
         initMiddlewaresAndCorsMethods(router);
+        initMetrics(router, router.pathPattern_);
     }
 }
 
@@ -610,6 +627,7 @@ RouteResult HttpControllersRouter::route(const HttpRequestImplPtr &req)
             {
                 return {RouteResult::MethodNotAllowed, nullptr};
             }
+            req->setRouteMetrics(ctrlInfo.metrics_[req->method()].get());
             return {RouteResult::Success, binder};
         }
     }
@@ -651,6 +669,7 @@ RouteResult HttpControllersRouter::route(const HttpRequestImplPtr &req)
     {
         return {RouteResult::MethodNotAllowed, nullptr};
     }
+    req->setRouteMetrics(routerItem.metrics_[req->method()].get());
     std::vector<std::string> params;
     for (size_t j = 1; j < result.size(); ++j)
     {
@@ -78,6 +78,7 @@ class HttpControllersRouter : public trantor::NonCopyable
     struct SimpleControllerRouterItem
     {
         std::shared_ptr<HttpSimpleControllerBinder> binders_[Invalid]{nullptr};
+        std::shared_ptr<RouteMetrics> metrics_[Invalid]{nullptr};
     };
 
     struct HttpControllerRouterItem
@@ -86,6 +87,7 @@ class HttpControllersRouter : public trantor::NonCopyable
         std::string pathPattern_;
         std::regex regex_;
         std::shared_ptr<HttpControllerBinder> binders_[Invalid]{nullptr};
+        std::shared_ptr<RouteMetrics> metrics_[Invalid]{nullptr};
     };
 
     struct WebSocketControllerRouterItem
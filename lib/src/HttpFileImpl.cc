@@ -14,6 +14,7 @@
 
 #include "HttpFileImpl.h"
 #include "HttpAppFrameworkImpl.h"
+#include "FileIoService.h"
 #include <drogon/MultiPart.h>
 #include <drogon/utils/Utilities.h>
 #include <fstream>
@@ -112,11 +113,17 @@ int HttpFileImpl::saveTo(
     const std::filesystem::path &pathAndFileName) const noexcept
 {
     LOG_TRACE << "save uploaded file:" << pathAndFileName;
+    if (cacheFilePtr_ && cacheFilePtr_->moveTo(pathAndFileName))
+    {
+        // The data is written to disk once.
+        return 0;
+    }
     auto wPath = utils::toNativePath(pathAndFileName.native());
     std::ofstream file(wPath, std::ios::binary);
     if (file.is_open())
     {
-        file.write(fileContent_.data(), fileContent_.size());
+        auto &content = fileContent();
+        file.write(content.data(), content.size());
         file.close();
         return 0;
     }
@@ -129,17 +136,17 @@ int HttpFileImpl::saveTo(
 
 std::string HttpFileImpl::getMd5() const noexcept
 {
-    return utils::getMd5(fileContent_.data(), fileContent_.size());
+    return utils::getMd5(fileContent().data(), fileContent().size());
 }
 
 std::string HttpFileImpl::getSha256() const noexcept
 {
-    return utils::getSha256(fileContent_.data(), fileContent_.size());
+    return utils::getSha256(fileContent().data(), fileContent().size());
 }
 
 std::string HttpFileImpl::getSha3() const noexcept
 {
-    return utils::getSha3(fileContent_.data(), fileContent_.size());
+    return utils::getSha3(fileContent().data(), fileContent().size());
 }
 
 const std::string &HttpFile::getFileName() const noexcept
@@ -182,6 +189,55 @@ int HttpFile::saveAs(const std::string &fileName) const noexcept
     return implPtr_->saveAs(fileName);
 }
 
+// The impl object keeps the request holding the file data alive.
+static void saveInFileIoThread(
+    const std::shared_ptr<HttpFileImpl> &implPtr,
+    std::function<int(const HttpFileImpl &)> &&saving,
+    std::function<void(int)> &&callback)
+{
+    auto loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+    FileIoService::instance().runTask([implPtr,
+                                       loop,
+                                       saving = std::move(saving),
+                                       callback =
+                                           std::move(callback)]() mutable {
+        auto ret = saving(*implPtr);
+        if (!loop)
+        {
+            callback(ret);
+            return;
+        }
+        loop->queueInLoop(
+            [ret, callback = std::move(callback)]() { callback(ret); });
+    });
+}
+
+void HttpFile::saveAsync(std::function<void(int)> &&callback) const
+{
+    saveInFileIoThread(
+        implPtr_,
+        [](const HttpFileImpl &file) { return file.save(); },
+        std::move(callback));
+}
+
+void HttpFile::saveAsync(const std::string &path,
+                         std::function<void(int)> &&callback) const
+{
+    saveInFileIoThread(
+        implPtr_,
+        [path](const HttpFileImpl &file) { return file.save(path); },
+        std::move(callback));
+}
+
+void HttpFile::saveAsAsync(const std::string &fileName,
+                           std::function<void(int)> &&callback) const
+{
+    saveInFileIoThread(
+        implPtr_,
+        [fileName](const HttpFileImpl &file) { return file.saveAs(fileName); },
+        std::move(callback));
+}
+
 size_t HttpFile::fileLength() const noexcept
 {
     return implPtr_->fileLength();
@@ -13,6 +13,7 @@
  */
 
 #pragma once
+#include "CacheFile.h"
 #include "HttpUtils.h"
 #include <drogon/HttpRequest.h>
 
@@ -58,6 +59,13 @@ class HttpFileImpl
         fileContent_ = std::string_view{data, length};
     }
 
+    /// Set the temporary file holding the contents, it is mapped to memory
+    /// when the contents are accessed and renamed when the file is saved.
+    void setCacheFile(std::shared_ptr<CacheFile> cacheFilePtr) noexcept
+    {
+        cacheFilePtr_ = std::move(cacheFilePtr);
+    }
+
     /// Save the file to the file system.
     /**
      * The folder saving the file is app().getUploadPath().
@@ -85,16 +93,20 @@ class HttpFileImpl
     /// Return the file length.
     size_t fileLength() const noexcept
     {
-        return fileContent_.length();
+        return fileContent().length();
     }
 
     const char *fileData() const noexcept
     {
-        return fileContent_.data();
+        return fileContent().data();
     }
 
     const std::string_view &fileContent() const noexcept
     {
+        if (cacheFilePtr_ && fileContent_.empty())
+        {
+            fileContent_ = cacheFilePtr_->getStringView();
+        }
         return fileContent_;
     }
 
@@ -168,7 +180,8 @@ class HttpFileImpl
     std::string fileName_;
     std::string itemName_;
     std::string transferEncoding_;
-    std::string_view fileContent_;
+    mutable std::string_view fileContent_;
+    std::shared_ptr<CacheFile> cacheFilePtr_;
     HttpRequestPtr requestPtr_;
     drogon::ContentType contentType_{drogon::CT_NONE};
 };
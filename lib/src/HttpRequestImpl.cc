@@ -582,9 +582,13 @@ void HttpRequestImpl::swap(HttpRequestImpl &that) noexcept
     swap(sessionPtr_, that.sessionPtr_);
     swap(attributesPtr_, that.attributesPtr_);
     swap(cacheFilePtr_, that.cacheFilePtr_);
+    swap(uploadWriterPtr_, that.uploadWriterPtr_);
     swap(peer_, that.peer_);
     swap(local_, that.local_);
     swap(creationDate_, that.creationDate_);
+    swap(handlerStartDate_, that.handlerStartDate_);
+    swap(handlerEndDate_, that.handlerEndDate_);
+    swap(routeMetricsPtr_, that.routeMetricsPtr_);
     swap(content_, that.content_);
     swap(expectPtr_, that.expectPtr_);
     swap(contentType_, that.contentType_);
@@ -601,6 +605,40 @@ void HttpRequestImpl::swap(HttpRequestImpl &that) noexcept
     swap(streamExceptionPtr_, that.streamExceptionPtr_);
     swap(startProcessing_, that.startProcessing_);
     swap(connPtr_, that.connPtr_);
+    {
+        std::scoped_lock lock(abortMutex_, that.abortMutex_);
+        swap(aborted_, that.aborted_);
+        swap(abortCallbacks_, that.abortCallbacks_);
+    }
+}
+
+void HttpRequestImpl::addAbortCallback(std::function<void()> callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(abortMutex_);
+        if (!aborted_)
+        {
+            abortCallbacks_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback();
+}
+
+void HttpRequestImpl::abort()
+{
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(abortMutex_);
+        if (aborted_)
+            return;
+        aborted_ = true;
+        callbacks.swap(abortCallbacks_);
+    }
+    for (auto &callback : callbacks)
+    {
+        callback();
+    }
 }
 
 const char *HttpRequestImpl::versionString() const
@@ -741,7 +779,7 @@ HttpRequestImpl::~HttpRequestImpl()
 void HttpRequestImpl::reserveBodySize(size_t length)
 {
     assert(loop_->isInLoopThread());
-    if (cacheFilePtr_)
+    if (cacheFilePtr_ || uploadWriterPtr_)
     {
         return;
     }
@@ -765,6 +803,10 @@ void HttpRequestImpl::appendToBody(const char *data, size_t length)
         assert(streamStatus_ == ReqStreamStatus::Open);
         streamReaderPtr_->onStreamData(data, length);
     }
+    else if (uploadWriterPtr_)
+    {
+        uploadWriterPtr_->append(data, length);
+    }
     else if (cacheFilePtr_)
     {
         cacheFilePtr_->append(data, length);
@@ -779,23 +821,72 @@ void HttpRequestImpl::appendToBody(const char *data, size_t length)
         else
         {
             createTmpFile();
-            cacheFilePtr_->append(content_);
-            cacheFilePtr_->append(data, length);
+            if (uploadWriterPtr_)
+            {
+                uploadWriterPtr_->append(content_.data(), content_.length());
+                uploadWriterPtr_->append(data, length);
+            }
+            else
+            {
+                cacheFilePtr_->append(content_);
+                cacheFilePtr_->append(data, length);
+            }
             content_.clear();
         }
     }
 }
 
+// Call the callback in the loop, from the thread that writes the file.
+static std::function<void()> callbackInLoop(trantor::EventLoop *loop,
+                                            std::function<void()> &&callback)
+{
+    return [loop, callback = std::move(callback)]() mutable {
+        loop->queueInLoop(std::move(callback));
+    };
+}
+
+void HttpRequestImpl::whenBodyWritingUncongested(
+    std::function<void()> &&callback)
+{
+    assert(loop_->isInLoopThread());
+    auto cb = callbackInLoop(loop_, std::move(callback));
+    if (uploadWriterPtr_)
+        uploadWriterPtr_->whenUncongested(std::move(cb));
+    else if (cacheFilePtr_)
+        cacheFilePtr_->whenUncongested(std::move(cb));
+    else
+        cb();
+}
+
+void HttpRequestImpl::whenBodyWritten(std::function<void()> &&callback)
+{
+    assert(loop_->isInLoopThread());
+    auto cb = callbackInLoop(loop_, std::move(callback));
+    if (uploadWriterPtr_)
+        uploadWriterPtr_->whenWritten(std::move(cb));
+    else if (cacheFilePtr_)
+        cacheFilePtr_->whenWritten(std::move(cb));
+    else
+        cb();
+}
+
 void HttpRequestImpl::createTmpFile()
 {
-    auto tmpfile = HttpAppFrameworkImpl::instance().getUploadPath();
-    auto fileName = utils::getUuid(false);
-    tmpfile.append("/tmp/")
-        .append(1, fileName[0])
-        .append(1, fileName[1])
-        .append("/")
-        .append(fileName);
-    cacheFilePtr_ = std::make_unique<CacheFile>(tmpfile);
+    auto &app = HttpAppFrameworkImpl::instance();
+    if (app.isStreamingMultipartUploadEnabled() &&
+        getHeaderBy("content-encoding").empty())
+    {
+        // Files of multipart bodies are written to their own temporary files
+        // while the body is received instead of caching the whole body.
+        auto writerPtr = std::make_unique<MultipartUploadWriter>(
+            getHeaderBy("content-type"));
+        if (writerPtr->isValid())
+        {
+            uploadWriterPtr_ = std::move(writerPtr);
+            return;
+        }
+    }
+    cacheFilePtr_ = CacheFile::newTmpFile();
 }
 
 void HttpRequestImpl::setContentTypeString(const char *typeString,
@@ -1056,7 +1147,15 @@ void HttpRequestImpl::streamFinish()
     {
         auto cb = std::move(streamFinishCb_);
         streamFinishCb_ = nullptr;
-        cb();
+        if (isBodyInFiles())
+        {
+            // Don't let the handler wait for the disk in the loop.
+            whenBodyWritten(std::move(cb));
+        }
+        else
+        {
+            cb();
+        }
     }
     if (streamReaderPtr_)
     {
@@ -1087,7 +1186,15 @@ void HttpRequestImpl::streamError(std::exception_ptr ex)
     {
         auto cb = std::move(streamFinishCb_);
         streamFinishCb_ = nullptr;
-        cb();
+        if (isBodyInFiles())
+        {
+            // Don't let the handler wait for the disk in the loop.
+            whenBodyWritten(std::move(cb));
+        }
+        else
+        {
+            cb();
+        }
     }
 }
 
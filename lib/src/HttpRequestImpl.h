@@ -16,6 +16,7 @@
 
 #include "HttpUtils.h"
 #include "CacheFile.h"
+#include "MultipartUploadWriter.h"
 #include <drogon/utils/Utilities.h>
 #include <drogon/HttpRequest.h>
 #include <drogon/RequestStream.h>
@@ -30,6 +31,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <future>
 #include <unordered_map>
@@ -38,6 +40,8 @@
 
 namespace drogon
 {
+struct RouteMetrics;
+
 enum class StreamDecompressStatus
 {
     TooLarge,
@@ -85,6 +89,10 @@ class HttpRequestImpl : public HttpRequest
         sessionPtr_.reset();
         attributesPtr_.reset();
         cacheFilePtr_.reset();
+        uploadWriterPtr_.reset();
+        routeMetricsPtr_ = nullptr;
+        handlerStartDate_ = trantor::Date{0};
+        handlerEndDate_ = trantor::Date{0};
         expectPtr_.reset();
         content_.clear();
         contentType_ = CT_TEXT_PLAIN;
@@ -101,6 +109,11 @@ class HttpRequestImpl : public HttpRequest
         streamExceptionPtr_ = nullptr;
         startProcessing_ = false;
         connPtr_.reset();
+        {
+            std::lock_guard<std::mutex> lock(abortMutex_);
+            aborted_ = false;
+            abortCallbacks_.clear();
+        }
     }
 
     trantor::EventLoop *getLoop()
@@ -269,6 +282,41 @@ class HttpRequestImpl : public HttpRequest
 
     void reserveBodySize(size_t length);
 
+    /// Return true if the body is received faster than it is written to the
+    /// temporary files, the parsing should stop until it isn't.
+    bool isBodyWritingCongested() const
+    {
+        if (uploadWriterPtr_)
+            return uploadWriterPtr_->isCongested();
+        return cacheFilePtr_ && cacheFilePtr_->isCongested();
+    }
+
+    /// Return true if the body is written to temporary files.
+    bool isBodyInFiles() const
+    {
+        return cacheFilePtr_ || uploadWriterPtr_;
+    }
+
+    /**
+     * @brief Call the callback in the loop of the request once the body
+     * isn't congested any more. It is never called right away.
+     */
+    void whenBodyWritingUncongested(std::function<void()> &&callback);
+
+    /**
+     * @brief Call the callback in the loop of the request once the whole body
+     * is written to the temporary files, so that reading it doesn't wait for
+     * the disk. It is never called right away.
+     */
+    void whenBodyWritten(std::function<void()> &&callback);
+
+    /// The writer of the multipart body if it is streamed to temporary files,
+    /// the body of the request is empty in this case.
+    const MultipartUploadWriter *uploadWriter() const
+    {
+        return uploadWriterPtr_.get();
+    }
+
     std::string_view queryView() const
     {
         return query_;
@@ -315,6 +363,38 @@ class HttpRequestImpl : public HttpRequest
         creationDate_ = date;
     }
 
+    /// The built-in metrics of the matched route, nullptr if the metrics are
+    /// disabled.
+    RouteMetrics *routeMetrics() const
+    {
+        return routeMetricsPtr_;
+    }
+
+    void setRouteMetrics(RouteMetrics *metricsPtr)
+    {
+        routeMetricsPtr_ = metricsPtr;
+    }
+
+    const trantor::Date &handlerStartDate() const
+    {
+        return handlerStartDate_;
+    }
+
+    void setHandlerStartDate(const trantor::Date &date)
+    {
+        handlerStartDate_ = date;
+    }
+
+    const trantor::Date &handlerEndDate() const
+    {
+        return handlerEndDate_;
+    }
+
+    void setHandlerEndDate(const trantor::Date &date)
+    {
+        handlerEndDate_ = date;
+    }
+
     void setPeerAddr(const trantor::InetAddress &peer)
     {
         peer_ = peer;
@@ -577,6 +657,11 @@ class HttpRequestImpl : public HttpRequest
         return isOnSecureConnection_;
     }
 
+    void addAbortCallback(std::function<void()> callback) override;
+
+    // Called when the connection is closed before the response is sent
+    void abort();
+
     const std::string &getJsonError() const override
     {
         static const std::string none{""};
@@ -709,8 +794,12 @@ class HttpRequestImpl : public HttpRequest
     trantor::InetAddress peer_;
     trantor::InetAddress local_;
     trantor::Date creationDate_;
+    trantor::Date handlerStartDate_{0};
+    trantor::Date handlerEndDate_{0};
+    RouteMetrics *routeMetricsPtr_{nullptr};
     trantor::CertificatePtr peerCertificate_;
     std::unique_ptr<CacheFile> cacheFilePtr_;
+    std::unique_ptr<MultipartUploadWriter> uploadWriterPtr_;
     mutable std::unique_ptr<std::string> jsonParsingErrorPtr_;
     std::unique_ptr<std::string> expectPtr_;
     bool keepAlive_{true};
@@ -725,6 +814,11 @@ class HttpRequestImpl : public HttpRequest
     bool startProcessing_{false};
     std::weak_ptr<trantor::TcpConnection> connPtr_;
 
+    // Callbacks may be added in any thread
+    std::mutex abortMutex_;
+    bool aborted_{false};
+    std::vector<std::function<void()>> abortCallbacks_;
+
   protected:
     std::string content_;
     trantor::EventLoop *loop_;
@@ -401,6 +401,11 @@ int HttpRequestParser::parseRequest(MsgBuffer *buf)
                 remainContentLength_ += currentChunkLength_;
                 currentChunkLength_ = 0;
                 status_ = HttpRequestParseStatus::kExpectChunkLen;
+                if (request_->isBodyWritingCongested())
+                {
+                    // Let the server wait for the disk.
+                    return 0;
+                }
                 continue;
             }
             case HttpRequestParseStatus::kExpectLastEmptyChunk:
@@ -489,3 +494,15 @@ void HttpRequestParser::popReadyResponses(
         requestPipelining_.pop_front();
     }
 }
+
+void HttpRequestParser::abortPendingRequests()
+{
+    assert(loop_->isInLoopThread());
+    for (auto &item : requestPipelining_)
+    {
+        if (!item.second.first)
+        {
+            static_cast<HttpRequestImpl *>(item.first.get())->abort();
+        }
+    }
+}
@@ -81,6 +81,8 @@ class HttpRequestParser : public trantor::NonCopyable,
     void pushRequestToPipelining(const HttpRequestPtr &, bool isHeadMethod);
     bool pushResponseToPipelining(const HttpRequestPtr &, HttpResponsePtr);
     void popReadyResponses(std::vector<std::pair<HttpResponsePtr, bool>> &);
+    // Abort the requests whose responses are not ready
+    void abortPendingRequests();
 
     size_t numberOfRequestsInPipelining() const
     {
@@ -102,6 +104,17 @@ class HttpRequestParser : public trantor::NonCopyable,
         stopWorking_ = true;
     }
 
+    // The received data are left in the buffer while the parsing is paused.
+    bool isPaused() const
+    {
+        return paused_;
+    }
+
+    void setPaused(bool paused)
+    {
+        paused_ = paused;
+    }
+
     size_t numberOfRequestsParsed() const
     {
         return requestsCounter_;
@@ -148,6 +161,7 @@ class HttpRequestParser : public trantor::NonCopyable,
     size_t requestsCounter_{0};
     std::weak_ptr<trantor::TcpConnection> conn_;
     bool stopWorking_{false};
+    bool paused_{false};
     trantor::MsgBuffer sendBuffer_;
     std::unique_ptr<std::vector<std::pair<HttpResponsePtr, bool>>>
         responseBuffer_;
@@ -15,11 +15,11 @@
 #include "HttpResponseImpl.h"
 #include "AOPAdvice.h"
 #include "HttpAppFrameworkImpl.h"
+#include "FileIoService.h"
 #include "HttpUtils.h"
 #include <drogon/HttpViewData.h>
 #include <drogon/IOThreadStorage.h>
 #include <filesystem>
-#include <fstream>
 #include <memory>
 #include <cstdio>
 #include <string>
@@ -279,18 +279,23 @@ HttpResponsePtr HttpResponse::newFileResponse(
     const std::string &typeString,
     const HttpRequestPtr &req)
 {
-    std::ifstream infile(utils::toNativePath(fullPath), std::ifstream::binary);
     LOG_TRACE << "send http file:" << fullPath << " offset " << offset
               << " length " << length;
-    if (!infile)
+    std::error_code err;
+    std::filesystem::path fsFilePath(utils::toNativePath(fullPath));
+    if (!std::filesystem::is_regular_file(fsFilePath, err))
+    {
+        auto resp = HttpResponse::newNotFoundResponse(req);
+        return resp;
+    }
+    auto filesize =
+        static_cast<size_t>(std::filesystem::file_size(fsFilePath, err));
+    if (err)
     {
         auto resp = HttpResponse::newNotFoundResponse(req);
         return resp;
     }
     auto resp = std::make_shared<HttpResponseImpl>();
-    std::streambuf *pbuf = infile.rdbuf();
-    size_t filesize =
-        static_cast<size_t>(pbuf->pubseekoff(0, std::ifstream::end));
     if (offset > filesize || length > filesize ||  // in case of overflow
         offset + length > filesize)
     {
@@ -307,10 +312,9 @@ HttpResponsePtr HttpResponse::newFileResponse(
     {
         length = filesize - offset;
     }
-    pbuf->pubseekoff(offset, std::ifstream::beg);  // rewind
 
-    if (HttpAppFrameworkImpl::instance().useSendfile() && length > 1024 * 200)
-    // TODO : Is 200k an appropriate value? Or set it to be configurable
+    auto &appImpl = HttpAppFrameworkImpl::instance();
+    if (appImpl.useSendfile() && length > appImpl.sendfileThreshold())
     {
         // The advantages of sendfile() can only be reflected in sending large
         // files.
@@ -319,11 +323,21 @@ HttpResponsePtr HttpResponse::newFileResponse(
         // this value.
         resp->setSendfileRange(offset, length);
     }
+    else if (trantor::EventLoop::getEventLoopOfCurrentThread())
+    {
+        // Don't block the event loop, the file is read by the file IO service
+        // before the response is sent.
+        resp->setSendfile(fullPath);
+        resp->setSendfileRange(offset, length);
+        resp->setFileBodyDeferred(true);
+    }
     else
     {
         std::string str;
-        str.resize(length);
-        pbuf->sgetn(&str[0], length);
+        if (!FileIoService::readFile(fullPath, offset, length, str))
+        {
+            return HttpResponse::newNotFoundResponse(req);
+        }
         resp->setBody(std::move(str));
         resp->setSendfileRange(offset, length);
     }
@@ -398,6 +412,29 @@ HttpResponsePtr HttpResponse::newFileResponse(
     return resp;
 }
 
+bool HttpResponseImpl::readFileBody(std::string &body) const
+{
+    if (sendfileParts_.empty())
+    {
+        return FileIoService::readFile(sendfileName_,
+                                       sendfileRange_.first,
+                                       sendfileRange_.second,
+                                       body);
+    }
+    std::string data;
+    for (auto &part : sendfileParts_)
+    {
+        if (!FileIoService::readFile(
+                sendfileName_, part.offset, part.length, data))
+        {
+            return false;
+        }
+        body.append(part.header).append(data);
+    }
+    body.append(sendfileTrailer_);
+    return true;
+}
+
 HttpResponsePtr HttpResponse::newStreamResponse(
     const std::function<std::size_t(char *, std::size_t)> &callback,
     const std::string &attachmentFileName,
@@ -560,6 +597,14 @@ void HttpResponseImpl::makeHeaderString(trantor::MsgBuffer &buffer)
         else
         {
             auto bodyLength = sendfileRange_.second;
+            if (!sendfileParts_.empty())
+            {
+                bodyLength = sendfileTrailer_.length();
+                for (auto &part : sendfileParts_)
+                {
+                    bodyLength += part.header.length() + part.length;
+                }
+            }
             len = snprintf(buffer.beginWrite(),
                            buffer.writableBytes(),
                            contentLengthFormatString<decltype(bodyLength)>(),
@@ -889,6 +934,9 @@ void HttpResponseImpl::swap(HttpResponseImpl &that) noexcept
     swap(flagForParsingContentType_, that.flagForParsingContentType_);
     swap(flagForParsingJson_, that.flagForParsingJson_);
     swap(sendfileName_, that.sendfileName_);
+    swap(fileBodyDeferred_, that.fileBodyDeferred_);
+    swap(sendfileParts_, that.sendfileParts_);
+    swap(sendfileTrailer_, that.sendfileTrailer_);
     swap(streamCallback_, that.streamCallback_);
     swap(asyncStreamCallback_, that.asyncStreamCallback_);
     jsonPtr_.swap(that.jsonPtr_);
@@ -906,6 +954,9 @@ void HttpResponseImpl::clear()
     fullHeaderString_.reset();
     jsonParsingErrorPtr_.reset();
     sendfileName_.clear();
+    fileBodyDeferred_ = false;
+    sendfileParts_.clear();
+    sendfileTrailer_.clear();
     if (streamCallback_)
     {
         LOG_TRACE << "Cleanup HttpResponse stream callback";
@@ -27,6 +27,7 @@
 #include <string>
 #include <atomic>
 #include <unordered_map>
+#include <vector>
 
 namespace drogon
 {
@@ -347,6 +348,67 @@ class DROGON_EXPORT HttpResponseImpl : public HttpResponse
         sendfileRange_.second = len;
     }
 
+    /**
+     * @brief The body is the sendfile range of the file, it is read by the
+     * file IO service before the response is sent.
+     */
+    void setFileBodyDeferred(bool deferred)
+    {
+        fileBodyDeferred_ = deferred;
+    }
+
+    bool isFileBodyDeferred() const
+    {
+        return fileBodyDeferred_;
+    }
+
+    void setDeferredFileBody(std::string &&body)
+    {
+        setBody(std::move(body));
+        sendfileName_.clear();
+        sendfileParts_.clear();
+        sendfileTrailer_.clear();
+        fileBodyDeferred_ = false;
+    }
+
+    /**
+     * @brief Read the body the sendfile file would send, the range or the
+     * parts and the trailer, in the current thread.
+     */
+    bool readFileBody(std::string &body) const;
+
+    /**
+     * @brief A part of a multipart/byteranges body, the range of the sendfile
+     * file is sent after the header of the part.
+     */
+    struct SendfilePart
+    {
+        std::string header;
+        size_t offset;
+        size_t length;
+    };
+
+    /**
+     * @brief Send the parts and then the trailer as the body, the sendfile
+     * range is ignored.
+     */
+    void setSendfileParts(std::vector<SendfilePart> &&parts,
+                          std::string &&trailer)
+    {
+        sendfileParts_ = std::move(parts);
+        sendfileTrailer_ = std::move(trailer);
+    }
+
+    const std::vector<SendfilePart> &sendfileParts() const
+    {
+        return sendfileParts_;
+    }
+
+    const std::string &sendfileTrailer() const
+    {
+        return sendfileTrailer_;
+    }
+
     const std::function<std::size_t(char *, std::size_t)> &streamCallback()
         const override
     {
@@ -518,6 +580,9 @@ class DROGON_EXPORT HttpResponseImpl : public HttpResponse
     ssize_t expriedTime_{-1};
     std::string sendfileName_;
     SendfileRange sendfileRange_{0, 0};
+    bool fileBodyDeferred_{false};
+    std::vector<SendfilePart> sendfileParts_;
+    std::string sendfileTrailer_;
     std::function<std::size_t(char *, std::size_t)> streamCallback_;
     std::function<void(ResponseStreamPtr)> asyncStreamCallback_;
     bool asyncStreamDisableKickoff_{false};
@@ -20,6 +20,7 @@
 #include <memory>
 #include <utility>
 #include "AOPAdvice.h"
+#include "FileIoService.h"
 #include "MiddlewaresFunction.h"
 #include "HttpAppFrameworkImpl.h"
 #include "HttpConnectionLimit.h"
@@ -27,6 +28,7 @@
 #include "HttpRequestImpl.h"
 #include "HttpRequestParser.h"
 #include "HttpResponseImpl.h"
+#include "HttpServerMetrics.h"
 #include "HttpControllersRouter.h"
 #include "StaticFileRouter.h"
 #include "WebSocketConnectionImpl.h"
@@ -139,6 +141,7 @@ void HttpServer::onConnection(const TcpConnectionPtr &conn)
                         StreamError(StreamErrorCode::kConnectionBroken,
                                     "Connection closed")));
             }
+            requestParser->abortPendingRequests();
             conn->clearContext();
         }
     }
@@ -157,6 +160,11 @@ void HttpServer::onMessage(const TcpConnectionPtr &conn, MsgBuffer *buf)
         requestParser->webSocketConn()->onNewMessage(conn, buf);
         return;
     }
+    if (requestParser->isPaused())
+    {
+        // The data are parsed once the body being received is written.
+        return;
+    }
 
     auto &requests = requestParser->getRequestBuffer();
     // With the pipelining feature or web socket, it is possible to receive
@@ -211,6 +219,16 @@ void HttpServer::onMessage(const TcpConnectionPtr &conn, MsgBuffer *buf)
         }
         if (parseRes == 0)
         {
+            if (req->isBodyWritingCongested())
+            {
+                // The disk is slower than the network, leave the data in the
+                // buffer until the body is written instead of queuing it.
+                requestParser->setPaused(true);
+                req->whenBodyWritingUncongested(
+                    [weakConn = std::weak_ptr<TcpConnection>(conn)]() {
+                        resumeParsing(weakConn, nullptr);
+                    });
+            }
             break;
         }
         if (parseRes >= 2 || parseRes == 1 && !req->isStreamMode())
@@ -231,6 +249,19 @@ void HttpServer::onMessage(const TcpConnectionPtr &conn, MsgBuffer *buf)
             {
                 req->streamFinish();
             }
+            else if (req->isBodyInFiles())
+            {
+                // Handle the request once its body is written, so that
+                // reading the body doesn't wait for the disk in the loop.
+                auto finishedReq = std::move(requests.back());
+                requests.pop_back();
+                requestParser->reset();
+                requestParser->setPaused(true);
+                finishedReq->whenBodyWritten(
+                    [weakConn = std::weak_ptr<TcpConnection>(conn),
+                     finishedReq]() { resumeParsing(weakConn, finishedReq); });
+                break;
+            }
             requestParser->reset();
         }
     }
@@ -241,6 +272,23 @@ void HttpServer::onMessage(const TcpConnectionPtr &conn, MsgBuffer *buf)
     }
 }
 
+void HttpServer::resumeParsing(const std::weak_ptr<TcpConnection> &weakConn,
+                               const HttpRequestImplPtr &req)
+{
+    auto conn = weakConn.lock();
+    if (!conn || !conn->connected() || !conn->hasContext())
+        return;
+    auto requestParser = conn->getContext<HttpRequestParser>();
+    if (!requestParser)
+        return;
+    requestParser->setPaused(false);
+    if (req)
+    {
+        onRequests(conn, {req}, requestParser);
+    }
+    onMessage(conn, conn->getRecvBuffer());
+}
+
 struct CallbackParamPack
 {
     CallbackParamPack(trantor::TcpConnectionPtr conn,
@@ -421,7 +469,28 @@ void HttpServer::onHttpRequest(
     }
 
     // TODO: move session related codes to its own singleton class
-    HttpAppFrameworkImpl::instance().findSessionForRequest(req);
+    auto &appImpl = HttpAppFrameworkImpl::instance();
+    if (!appImpl.findSessionForRequest(req))
+    {
+        appImpl.loadSessionForRequest(
+            req, [req, callback = std::move(callback)](bool loaded) mutable {
+                if (!loaded)
+                {
+                    callback(app().getCustomErrorHandler()(
+                        k503ServiceUnavailable, req));
+                    return;
+                }
+                httpRequestPreRouting(req, std::move(callback));
+            });
+        return;
+    }
+    httpRequestPreRouting(req, std::move(callback));
+}
+
+void HttpServer::httpRequestPreRouting(
+    const HttpRequestImplPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback)
+{
     // pre-routing aop
     auto &aop = AopAdvice::instance();
     aop.passPreRoutingObservers(req);
@@ -451,6 +520,11 @@ void HttpServer::httpRequestRouting(
 {
     // How to access router here?? Make router class singleton?
     RouteResult result = HttpControllersRouter::instance().route(req);
+    if (result.result != RouteResult::Success)
+    {
+        req->setRouteMetrics(
+            HttpServerMetrics::instance().unmatchedRouteMetrics(req->method()));
+    }
     if (result.result == RouteResult::Success)
     {
         HttpRequestParamPack pack{std::move(result.binderPtr),
@@ -652,12 +726,14 @@ void HttpServer::httpRequestHandling(
         }
     }
 
+    HttpServerMetrics::onHandlerStart(req);
     auto &binderRef = *binderPtr;
     binderRef.handleRequest(
         req,
         // This is the actual callback being passed to controller
         [req, binderPtr = std::move(binderPtr), callback = std::move(callback)](
             const HttpResponsePtr &resp) mutable {
+            HttpServerMetrics::onHandlerEnd(req);
             // Check if we need to cache the response
             if (resp->expiredTime() >= 0 && resp->statusCode() != k404NotFound)
             {
@@ -686,7 +762,34 @@ void HttpServer::onWebsocketRequest(
     std::function<void(const HttpResponsePtr &)> &&callback,
     WebSocketConnectionImplPtr &&wsConnPtr)
 {
-    HttpAppFrameworkImpl::instance().findSessionForRequest(req);
+    auto &appImpl = HttpAppFrameworkImpl::instance();
+    if (!appImpl.findSessionForRequest(req))
+    {
+        appImpl.loadSessionForRequest(
+            req,
+            [req,
+             callback = std::move(callback),
+             wsConnPtr = std::move(wsConnPtr)](bool loaded) mutable {
+                if (!loaded)
+                {
+                    callback(app().getCustomErrorHandler()(
+                        k503ServiceUnavailable, req));
+                    return;
+                }
+                websocketRequestPreRouting(req,
+                                           std::move(callback),
+                                           std::move(wsConnPtr));
+            });
+        return;
+    }
+    websocketRequestPreRouting(req, std::move(callback), std::move(wsConnPtr));
+}
+
+void HttpServer::websocketRequestPreRouting(
+    const HttpRequestImplPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback,
+    WebSocketConnectionImplPtr &&wsConnPtr)
+{
     // pre-routing aop
     auto &aop = AopAdvice::instance();
     aop.passPreRoutingObservers(req);
@@ -763,10 +866,6 @@ void HttpServer::handleResponse(
     bool *respReadyPtr)
 {
     auto &conn = paramPack->conn_;
-    auto &req = paramPack->req_;
-    auto &requestParser = paramPack->requestParser_;
-    auto &loopFlagPtr = paramPack->loopFlag_;
-    const bool isHeadMethod = paramPack->isHeadMethod_;
 
     if (!response)
         return;
@@ -780,6 +879,62 @@ void HttpServer::handleResponse(
         return;
     }
 
+    auto respImplPtr = static_cast<HttpResponseImpl *>(response.get());
+    if (respImplPtr->isFileBodyDeferred() && !paramPack->isHeadMethod_)
+    {
+        // Read the file out of the IO loop. The response is sent later, so
+        // the request is already in the pipelining queue then.
+        auto loop = conn->getLoop();
+        auto read = [response, paramPack, loop]() {
+            std::string data;
+            auto ok = static_cast<HttpResponseImpl *>(response.get())
+                          ->readFileBody(data);
+            loop->queueInLoop([response,
+                               paramPack,
+                               ok,
+                               data = std::move(data)]() mutable {
+                bool respReady{false};
+                if (!ok)
+                {
+                    finishResponse(
+                        HttpResponse::newNotFoundResponse(paramPack->req_),
+                        paramPack,
+                        &respReady);
+                    return;
+                }
+                static_cast<HttpResponseImpl *>(response.get())
+                    ->setDeferredFileBody(std::move(data));
+                finishResponse(response, paramPack, &respReady);
+            });
+        };
+        if (FileIoService::instance().tryRunTask(std::move(read)))
+        {
+            return;
+        }
+        // The disk can't keep up, don't queue more reads.
+        finishResponse(app().getCustomErrorHandler()(k503ServiceUnavailable,
+                                                     paramPack->req_),
+                       paramPack,
+                       respReadyPtr);
+        return;
+    }
+    finishResponse(response, paramPack, respReadyPtr);
+}
+
+void HttpServer::finishResponse(
+    const HttpResponsePtr &response,
+    const std::shared_ptr<CallbackParamPack> &paramPack,
+    bool *respReadyPtr)
+{
+    auto &conn = paramPack->conn_;
+    auto &req = paramPack->req_;
+    auto &requestParser = paramPack->requestParser_;
+    auto &loopFlagPtr = paramPack->loopFlag_;
+    const bool isHeadMethod = paramPack->isHeadMethod_;
+
+    if (!conn->connected())
+        return;
+
     auto resp =
         HttpAppFrameworkImpl::instance().handleSessionForResponse(req,
                                                                   response);
@@ -788,6 +943,7 @@ void HttpServer::handleResponse(
     AopAdvice::instance().passPreSendingAdvices(req, resp);
 
     auto newResp = getCompressedResponse(req, resp, isHeadMethod);
+    HttpServerMetrics::onResponse(req, newResp);
     if (conn->getLoop()->isInLoopThread())
     {
         /*
@@ -957,6 +1113,26 @@ static std::size_t chunkingCallback(
     //    return nHeaderLen + nDataSize + 2;
 }
 
+static void sendFileBody(const TcpConnectionPtr &conn,
+                         const HttpResponseImpl *respImplPtr)
+{
+    const std::string &sendfileName = respImplPtr->sendfileName();
+    auto &parts = respImplPtr->sendfileParts();
+    if (parts.empty())
+    {
+        const auto &range = respImplPtr->sendfileRange();
+        conn->sendFile(sendfileName.c_str(), range.first, range.second);
+        return;
+    }
+    // A multipart/byteranges body, the file is never read into memory.
+    for (auto &part : parts)
+    {
+        conn->send(part.header);
+        conn->sendFile(sendfileName.c_str(), part.offset, part.length);
+    }
+    conn->send(respImplPtr->sendfileTrailer());
+}
+
 void HttpServer::sendResponse(const TcpConnectionPtr &conn,
                               const HttpResponsePtr &response,
                               bool isHeadMethod)
@@ -1009,8 +1185,7 @@ void HttpServer::sendResponse(const TcpConnectionPtr &conn,
             }
             else
             {
-                const auto &range = respImplPtr->sendfileRange();
-                conn->sendFile(sendfileName.c_str(), range.first, range.second);
+                sendFileBody(conn, respImplPtr);
             }
         }
         COZ_PROGRESS
@@ -1095,10 +1270,7 @@ void HttpServer::sendResponses(
                 }
                 else
                 {
-                    const auto &range = respImplPtr->sendfileRange();
-                    conn->sendFile(sendfileName.c_str(),
-                                   range.first,
-                                   range.second);
+                    sendFileBody(conn, respImplPtr);
                 }
                 COZ_PROGRESS
             }
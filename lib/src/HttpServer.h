@@ -78,6 +78,10 @@ class HttpServer : trantor::NonCopyable
     static void onRequests(const trantor::TcpConnectionPtr &,
                            const std::vector<HttpRequestImplPtr> &,
                            const std::shared_ptr<HttpRequestParser> &);
+    // Parse the data received while the parsing was paused for writing a
+    // request body, after handling that request if it is complete.
+    static void resumeParsing(const std::weak_ptr<trantor::TcpConnection> &,
+                              const HttpRequestImplPtr &);
 
     struct HttpRequestParamPack
     {
@@ -95,6 +99,9 @@ class HttpServer : trantor::NonCopyable
     // Http request handling steps
     static void onHttpRequest(const HttpRequestImplPtr &,
                               std::function<void(const HttpResponsePtr &)> &&);
+    static void httpRequestPreRouting(
+        const HttpRequestImplPtr &req,
+        std::function<void(const HttpResponsePtr &)> &&callback);
     static void httpRequestRouting(
         const HttpRequestImplPtr &req,
         std::function<void(const HttpResponsePtr &)> &&callback);
@@ -108,6 +115,10 @@ class HttpServer : trantor::NonCopyable
         const HttpRequestImplPtr &,
         std::function<void(const HttpResponsePtr &)> &&,
         WebSocketConnectionImplPtr &&);
+    static void websocketRequestPreRouting(
+        const HttpRequestImplPtr &req,
+        std::function<void(const HttpResponsePtr &)> &&callback,
+        WebSocketConnectionImplPtr &&wsConnPtr);
     static void websocketRequestRouting(
         const HttpRequestImplPtr &req,
         std::function<void(const HttpResponsePtr &)> &&callback,
@@ -132,6 +143,10 @@ class HttpServer : trantor::NonCopyable
         const HttpResponsePtr &response,
         const std::shared_ptr<CallbackParamPack> &paramPack,
         bool *respReadyPtr);
+    static void finishResponse(
+        const HttpResponsePtr &response,
+        const std::shared_ptr<CallbackParamPack> &paramPack,
+        bool *respReadyPtr);
     static void sendResponse(const trantor::TcpConnectionPtr &,
                              const HttpResponsePtr &,
                              bool isHeadMethod);
@@ -0,0 +1,140 @@
+/**
+ *
+ *  @file HttpServerMetrics.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "HttpServerMetrics.h"
+#include "HttpAppFrameworkImpl.h"
+#include "HttpResponseImpl.h"
+
+using namespace drogon;
+using namespace drogon::monitoring;
+
+void HttpServerMetrics::enable(Registry &registry,
+                               const std::vector<double> &buckets)
+{
+    if (enabled_)
+        return;
+    buckets_ = buckets;
+    requests_ = std::make_shared<Collector<Counter>>(
+        "drogon_http_requests_total",
+        "The number of HTTP requests by route, method and status class",
+        std::vector<std::string>{"route", "method", "status"});
+    requestBytes_ = std::make_shared<Collector<Counter>>(
+        "drogon_http_request_bytes_total",
+        "The number of bytes in the bodies of HTTP requests",
+        std::vector<std::string>{"route", "method"});
+    responseBytes_ = std::make_shared<Collector<Counter>>(
+        "drogon_http_response_bytes_total",
+        "The number of bytes in the bodies of HTTP responses",
+        std::vector<std::string>{"route", "method"});
+    queueTime_ = std::make_shared<Collector<Histogram>>(
+        "drogon_http_queue_seconds",
+        "The time from parsing HTTP requests to calling their handlers",
+        std::vector<std::string>{"route", "method"});
+    handlerTime_ = std::make_shared<Collector<Histogram>>(
+        "drogon_http_handler_seconds",
+        "The time HTTP handlers take to return responses",
+        std::vector<std::string>{"route", "method"});
+    writeTime_ = std::make_shared<Collector<Histogram>>(
+        "drogon_http_write_seconds",
+        "The time from handlers returning responses to the responses being "
+        "queued on the connections",
+        std::vector<std::string>{"route", "method"});
+    registry.registerCollector(requests_);
+    registry.registerCollector(requestBytes_);
+    registry.registerCollector(responseBytes_);
+    registry.registerCollector(queueTime_);
+    registry.registerCollector(handlerTime_);
+    registry.registerCollector(writeTime_);
+    enabled_ = true;
+    for (int i = 0; i < Invalid; ++i)
+    {
+        unmatchedRoutes_[i] = routeMetrics("", static_cast<HttpMethod>(i));
+    }
+}
+
+std::shared_ptr<RouteMetrics> HttpServerMetrics::routeMetrics(
+    const std::string &pathPattern,
+    HttpMethod method)
+{
+    if (!enabled_)
+        return nullptr;
+    static const char *statusClasses[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+    std::string methodString{to_string_view(method)};
+    auto metricsPtr = std::make_shared<RouteMetrics>();
+    for (size_t i = 0; i < 5; ++i)
+    {
+        metricsPtr->requests[i] =
+            requests_->metric({pathPattern, methodString, statusClasses[i]});
+    }
+    metricsPtr->requestBytes =
+        requestBytes_->metric({pathPattern, methodString});
+    metricsPtr->responseBytes =
+        responseBytes_->metric({pathPattern, methodString});
+    // The histograms are cumulative, so they don't need the timer of a loop
+    // to rotate time buckets. The loop is passed to keep them from creating
+    // their own threads.
+    auto loop = HttpAppFrameworkImpl::instance().getLoop();
+    metricsPtr->queueTime = queueTime_->metric({pathPattern, methodString},
+                                               buckets_,
+                                               std::chrono::seconds(0),
+                                               0,
+                                               loop);
+    metricsPtr->handlerTime = handlerTime_->metric({pathPattern, methodString},
+                                                   buckets_,
+                                                   std::chrono::seconds(0),
+                                                   0,
+                                                   loop);
+    metricsPtr->writeTime = writeTime_->metric({pathPattern, methodString},
+                                               buckets_,
+                                               std::chrono::seconds(0),
+                                               0,
+                                               loop);
+    return metricsPtr;
+}
+
+void HttpServerMetrics::recordResponse(const HttpRequestImplPtr &req,
+                                       const HttpResponsePtr &resp)
+{
+    auto metricsPtr = req->routeMetrics();
+    auto statusClass = static_cast<int>(resp->statusCode()) / 100;
+    if (statusClass >= 1 && statusClass <= 5)
+    {
+        metricsPtr->requests[statusClass - 1]->increment();
+    }
+    metricsPtr->requestBytes->increment(
+        static_cast<double>(req->realContentLength()));
+    auto respImplPtr = static_cast<HttpResponseImpl *>(resp.get());
+    size_t bodyLength = respImplPtr->getBodyLength();
+    auto &parts = respImplPtr->sendfileParts();
+    if (!parts.empty())
+    {
+        for (auto &part : parts)
+        {
+            bodyLength += part.header.length() + part.length;
+        }
+        bodyLength += respImplPtr->sendfileTrailer().length();
+    }
+    else if (!respImplPtr->sendfileName().empty())
+    {
+        // The length of a whole file is not known here.
+        bodyLength += respImplPtr->sendfileRange().second;
+    }
+    metricsPtr->responseBytes->increment(static_cast<double>(bodyLength));
+    auto &handlerEndDate = req->handlerEndDate();
+    if (handlerEndDate.microSecondsSinceEpoch() > 0)
+    {
+        metricsPtr->writeTime->observe(
+            secondsBetween(handlerEndDate, trantor::Date::now()));
+    }
+}
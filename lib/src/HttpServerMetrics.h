@@ -0,0 +1,147 @@
+/**
+ *
+ *  @file HttpServerMetrics.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include "HttpRequestImpl.h"
+#include <drogon/HttpResponse.h>
+#include <drogon/utils/monitoring/Collector.h>
+#include <drogon/utils/monitoring/Counter.h>
+#include <drogon/utils/monitoring/Histogram.h>
+#include <drogon/utils/monitoring/Registry.h>
+#include <trantor/utils/NonCopyable.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace drogon
+{
+/**
+ * @brief The built-in metrics of the requests handled by one route (a path
+ * pattern and a method). They are created when the routers are initialized
+ * and never removed, so requests only keep a raw pointer to them.
+ */
+struct RouteMetrics
+{
+    // The requests by the status class of the responses, 1xx to 5xx.
+    std::shared_ptr<monitoring::Counter> requests[5];
+    std::shared_ptr<monitoring::Counter> requestBytes;
+    std::shared_ptr<monitoring::Counter> responseBytes;
+    // From the time the request is parsed to the time its handler is called.
+    std::shared_ptr<monitoring::Histogram> queueTime;
+    std::shared_ptr<monitoring::Histogram> handlerTime;
+    // From the time the handler returns the response to the time the
+    // response is queued on the connection.
+    std::shared_ptr<monitoring::Histogram> writeTime;
+};
+
+/**
+ * @brief Records the request count, status classes, bytes in and out, queue
+ * time, handler time and write time of each route. Nothing is recorded
+ * unless the metrics are enabled by the PromExporter plugin, in which case
+ * the routers attach a RouteMetrics object to each request.
+ */
+class HttpServerMetrics : public trantor::NonCopyable
+{
+  public:
+    static HttpServerMetrics &instance()
+    {
+        static HttpServerMetrics metrics;
+        return metrics;
+    }
+
+    /**
+     * @brief Create the collectors and register them to the registry, it
+     * must be called before the routers are initialized.
+     *
+     * @param buckets The bucket boundaries in seconds of the histograms.
+     */
+    void enable(monitoring::Registry &registry,
+                const std::vector<double> &buckets);
+
+    bool isEnabled() const
+    {
+        return enabled_;
+    }
+
+    /**
+     * @brief Create the metrics of the route, the underlying metrics are
+     * shared by the calls with the same path pattern and method.
+     */
+    std::shared_ptr<RouteMetrics> routeMetrics(const std::string &pathPattern,
+                                               HttpMethod method);
+
+    /**
+     * @brief The metrics of requests which don't match any controller, they
+     * are labeled with an empty route.
+     */
+    RouteMetrics *unmatchedRouteMetrics(HttpMethod method) const
+    {
+        if (!enabled_ || method >= Invalid)
+            return nullptr;
+        return unmatchedRoutes_[method].get();
+    }
+
+    static void onHandlerStart(const HttpRequestImplPtr &req)
+    {
+        auto metricsPtr = req->routeMetrics();
+        if (!metricsPtr)
+            return;
+        auto now = trantor::Date::now();
+        req->setHandlerStartDate(now);
+        metricsPtr->queueTime->observe(
+            secondsBetween(req->creationDate(), now));
+    }
+
+    static void onHandlerEnd(const HttpRequestImplPtr &req)
+    {
+        auto metricsPtr = req->routeMetrics();
+        if (!metricsPtr)
+            return;
+        auto now = trantor::Date::now();
+        req->setHandlerEndDate(now);
+        metricsPtr->handlerTime->observe(
+            secondsBetween(req->handlerStartDate(), now));
+    }
+
+    static void onResponse(const HttpRequestImplPtr &req,
+                           const HttpResponsePtr &resp)
+    {
+        if (req->routeMetrics())
+            recordResponse(req, resp);
+    }
+
+  private:
+    static double secondsBetween(const trantor::Date &from,
+                                 const trantor::Date &to)
+    {
+        return static_cast<double>(to.microSecondsSinceEpoch() -
+                                   from.microSecondsSinceEpoch()) /
+               1000000.0;
+    }
+
+    static void recordResponse(const HttpRequestImplPtr &req,
+                               const HttpResponsePtr &resp);
+
+    bool enabled_{false};
+    std::shared_ptr<monitoring::Collector<monitoring::Counter>> requests_;
+    std::shared_ptr<monitoring::Collector<monitoring::Counter>> requestBytes_;
+    std::shared_ptr<monitoring::Collector<monitoring::Counter>> responseBytes_;
+    std::shared_ptr<monitoring::Collector<monitoring::Histogram>> queueTime_;
+    std::shared_ptr<monitoring::Collector<monitoring::Histogram>> handlerTime_;
+    std::shared_ptr<monitoring::Collector<monitoring::Histogram>> writeTime_;
+    std::vector<double> buckets_;
+    std::shared_ptr<RouteMetrics> unmatchedRoutes_[Invalid];
+};
+}  // namespace drogon
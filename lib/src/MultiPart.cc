@@ -62,8 +62,24 @@ int MultiPartParser::parse(const HttpRequestPtr &req)
             return -1;
     }
 
-    const std::string &contentType =
-        static_cast<HttpRequestImpl *>(req.get())->getHeaderBy("content-type");
+    auto reqImpl = static_cast<HttpRequestImpl *>(req.get());
+    if (auto uploadWriter = reqImpl->uploadWriter())
+    {
+        // The body was parsed and the files were written to disk while it
+        // was received.
+        if (!uploadWriter->isValid() || !uploadWriter->isFinished())
+            return -1;
+        for (auto &filePtr : uploadWriter->files())
+        {
+            files_.emplace_back(std::shared_ptr<HttpFileImpl>(filePtr));
+        }
+        for (auto &item : uploadWriter->parameters())
+        {
+            parameters_.emplace(item.first, item.second);
+        }
+        return 0;
+    }
+    const std::string &contentType = reqImpl->getHeaderBy("content-type");
     if (contentType.empty())
     {
         return -1;
@@ -84,6 +84,34 @@ MultipartStreamParser::MultipartStreamParser(const std::string &contentType)
     boundary_ = contentType.substr(pos, pos2 - pos);
     dashBoundaryCrlf_ = dash_ + boundary_ + crlf_;
     crlfDashBoundary_ = crlf_ + dash_ + boundary_;
+    auto length = crlfDashBoundary_.size();
+    boundaryShifts_.fill(length);
+    for (size_t i = 0; i + 1 < length; ++i)
+    {
+        boundaryShifts_[static_cast<unsigned char>(crlfDashBoundary_[i])] =
+            length - 1 - i;
+    }
+}
+
+// Bodies of files are large and the boundary is usually long, so most bytes
+// of them are skipped without being compared.
+size_t MultipartStreamParser::findBoundary(std::string_view data) const
+{
+    auto length = crlfDashBoundary_.size();
+    auto last = static_cast<unsigned char>(crlfDashBoundary_[length - 1]);
+    size_t pos = 0;
+    while (pos + length <= data.size())
+    {
+        auto c = static_cast<unsigned char>(data[pos + length - 1]);
+        if (c == last &&
+            data.compare(pos, length - 1, crlfDashBoundary_, 0, length - 1) ==
+                0)
+        {
+            return pos;
+        }
+        pos += boundaryShifts_[c];
+    }
+    return std::string_view::npos;
 }
 
 // TODO: same function in HttpRequestParser.cc
@@ -251,7 +279,7 @@ void drogon::MultipartStreamParser::parse(
                     return;  // not enough data to check boundary
                 }
                 std::string_view v = buffer_.view();
-                auto pos = v.find(crlfDashBoundary_);
+                auto pos = findBoundary(v);
                 if (pos == std::string::npos)
                 {
                     // boundary not found, leave potential partial boundary
@@ -15,6 +15,7 @@
 #pragma once
 #include <drogon/exports.h>
 #include <drogon/RequestStream.h>
+#include <array>
 #include <string>
 
 namespace drogon
@@ -40,11 +41,15 @@ class DROGON_EXPORT MultipartStreamParser
     }
 
   private:
+    size_t findBoundary(std::string_view data) const;
+
     const std::string dash_ = "--";
     const std::string crlf_ = "\r\n";
     std::string boundary_;
     std::string dashBoundaryCrlf_;
     std::string crlfDashBoundary_;
+    // The Boyer-Moore-Horspool shifts of crlfDashBoundary_
+    std::array<size_t, 256> boundaryShifts_;
 
     struct Buffer
     {
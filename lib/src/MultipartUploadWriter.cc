@@ -0,0 +1,140 @@
+/**
+ *
+ *  @file MultipartUploadWriter.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "MultipartUploadWriter.h"
+#include "HttpAppFrameworkImpl.h"
+#include "HttpUtils.h"
+#include <trantor/utils/Logger.h>
+#include <atomic>
+
+using namespace drogon;
+
+MultipartUploadWriter::MultipartUploadWriter(const std::string &contentType)
+    : parser_(contentType)
+{
+    headerCallback_ = [this](MultipartHeader header) { onHeader(header); };
+    dataCallback_ = [this](const char *data, size_t length) {
+        onData(data, length);
+    };
+}
+
+void MultipartUploadWriter::append(const char *data, size_t length)
+{
+    if (!isValid() || isFinished())
+        return;
+    parser_.parse(data, length, headerCallback_, dataCallback_);
+    if (!isValid())
+    {
+        // The temporary files are deleted with the objects.
+        currentFilePtr_.reset();
+        cacheFiles_.clear();
+        files_.clear();
+        parameters_.clear();
+    }
+}
+
+void MultipartUploadWriter::whenUncongested(std::function<void()> &&callback)
+{
+    if (!currentFilePtr_)
+    {
+        callback();
+        return;
+    }
+    currentFilePtr_->whenUncongested(std::move(callback));
+}
+
+void MultipartUploadWriter::whenWritten(std::function<void()> &&callback)
+{
+    if (cacheFiles_.empty())
+    {
+        callback();
+        return;
+    }
+    // The files are written in parallel, the last one calls the callback.
+    auto countPtr = std::make_shared<std::atomic<size_t>>(cacheFiles_.size());
+    auto callbackPtr =
+        std::make_shared<std::function<void()>>(std::move(callback));
+    for (auto &filePtr : cacheFiles_)
+    {
+        filePtr->whenWritten([countPtr, callbackPtr]() {
+            if (countPtr->fetch_sub(1) == 1)
+                (*callbackPtr)();
+        });
+    }
+}
+
+void MultipartUploadWriter::onHeader(const MultipartHeader &header)
+{
+    if (!isValid_)
+        return;
+    if (header.filename.empty())
+    {
+        currentName_ = header.name;
+        currentValue_.clear();
+        return;
+    }
+    std::shared_ptr<CacheFile> filePtr = CacheFile::newTmpFile();
+    if (!filePtr->isOpen())
+    {
+        LOG_ERROR << "Can't create a temporary file for the uploaded file "
+                  << header.filename;
+        isValid_ = false;
+        return;
+    }
+    auto httpFilePtr = std::make_shared<HttpFileImpl>();
+    httpFilePtr->setItemName(header.name);
+    httpFilePtr->setFileName(header.filename);
+    auto semiColonPos = header.contentType.find(';');
+    httpFilePtr->setContentType(parseContentType(
+        std::string_view(header.contentType).substr(0, semiColonPos)));
+    httpFilePtr->setCacheFile(filePtr);
+    files_.emplace_back(std::move(httpFilePtr));
+    cacheFiles_.push_back(filePtr);
+    currentFilePtr_ = std::move(filePtr);
+}
+
+void MultipartUploadWriter::onData(const char *data, size_t length)
+{
+    if (!isValid_)
+        return;
+    if (currentFilePtr_)
+    {
+        if (length == 0)
+        {
+            // The end of the file, the rest of it is written when it's read
+            // or saved.
+            currentFilePtr_.reset();
+            return;
+        }
+        currentFilePtr_->append(data, length);
+        return;
+    }
+    if (length == 0)
+    {
+        parameters_[std::move(currentName_)] = std::move(currentValue_);
+        currentName_.clear();
+        currentValue_.clear();
+        return;
+    }
+    // Only files are written to disk, the other fields must fit in memory.
+    parametersSize_ += length;
+    if (parametersSize_ >
+        HttpAppFrameworkImpl::instance().getClientMaxMemoryBodySize())
+    {
+        LOG_ERROR << "The form fields of the multipart body are too large";
+        isValid_ = false;
+        return;
+    }
+    currentValue_.append(data, length);
+}
@@ -0,0 +1,92 @@
+/**
+ *
+ *  @file MultipartUploadWriter.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include "CacheFile.h"
+#include "HttpFileImpl.h"
+#include "MultipartStreamParser.h"
+#include <drogon/utils/Utilities.h>
+#include <trantor/utils/NonCopyable.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace drogon
+{
+/**
+ * @brief Parses a multipart/form-data body while it is received. Each file
+ * is written to its own temporary file as its bytes arrive, so large uploads
+ * use constant memory and the files are saved by renaming the temporary
+ * files.
+ */
+class MultipartUploadWriter : public trantor::NonCopyable
+{
+  public:
+    explicit MultipartUploadWriter(const std::string &contentType);
+
+    void append(const char *data, size_t length);
+
+    bool isValid() const
+    {
+        return isValid_ && parser_.isValid();
+    }
+
+    bool isFinished() const
+    {
+        return parser_.isFinished();
+    }
+
+    const std::vector<std::shared_ptr<HttpFileImpl>> &files() const
+    {
+        return files_;
+    }
+
+    const SafeStringMap<std::string> &parameters() const
+    {
+        return parameters_;
+    }
+
+    /// Return true if the file being received is appended faster than it is
+    /// written.
+    bool isCongested() const
+    {
+        return currentFilePtr_ && currentFilePtr_->isCongested();
+    }
+
+    /// See CacheFile::whenUncongested().
+    void whenUncongested(std::function<void()> &&callback);
+
+    /// Call the callback once all the files are written, see
+    /// CacheFile::whenWritten().
+    void whenWritten(std::function<void()> &&callback);
+
+  private:
+    void onHeader(const MultipartHeader &header);
+    void onData(const char *data, size_t length);
+
+    MultipartStreamParser parser_;
+    RequestStreamReader::MultipartHeaderCallback headerCallback_;
+    RequestStreamReader::StreamDataCallback dataCallback_;
+    std::vector<std::shared_ptr<HttpFileImpl>> files_;
+    SafeStringMap<std::string> parameters_;
+    std::shared_ptr<CacheFile> currentFilePtr_;
+    std::vector<std::shared_ptr<CacheFile>> cacheFiles_;
+    std::string currentName_;
+    std::string currentValue_;
+    size_t parametersSize_{0};
+    bool isValid_{true};
+};
+}  // namespace drogon
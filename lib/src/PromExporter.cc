@@ -1,8 +1,10 @@
+#include "HttpServerMetrics.h"
 #include <drogon/plugins/PromExporter.h>
 #include <drogon/HttpAppFramework.h>
 #include <drogon/utils/monitoring/Counter.h>
 #include <drogon/utils/monitoring/Gauge.h>
 #include <drogon/utils/monitoring/Histogram.h>
+#include <drogon/utils/monitoring/Summary.h>
 #include <drogon/utils/monitoring/Collector.h>
 
 using namespace drogon;
@@ -87,6 +89,14 @@ void PromExporter::initAndStart(const Json::Value &config)
                             collectors_.insert(
                                 std::make_pair(name, histogramCollector));
                         }
+                        else if (type == "summary")
+                        {
+                            auto summaryCollector =
+                                std::make_shared<Collector<Summary>>(
+                                    name, help, labelNames);
+                            collectors_.insert(
+                                std::make_pair(name, summaryCollector));
+                        }
                         else
                         {
                             LOG_ERROR << "Unknown collector type: " << type;
@@ -108,6 +118,24 @@ void PromExporter::initAndStart(const Json::Value &config)
             LOG_ERROR << "collectors must be an array!";
         }
     }
+    if (config.get("server_metrics", false).asBool())
+    {
+        std::vector<double> buckets;
+        auto &bucketsConfig = config["server_metrics_buckets"];
+        if (bucketsConfig.isArray())
+        {
+            for (auto const &bucket : bucketsConfig)
+            {
+                buckets.push_back(bucket.asDouble());
+            }
+        }
+        else
+        {
+            buckets =
+                {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5};
+        }
+        HttpServerMetrics::instance().enable(*this, buckets);
+    }
 }
 
 static std::string exportCollector(
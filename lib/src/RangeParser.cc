@@ -14,6 +14,7 @@
 
 #include "RangeParser.h"
 
+#include <algorithm>
 #include <limits>
 
 using namespace drogon;
@@ -21,6 +22,10 @@ using namespace drogon;
 static constexpr size_t MAX_SIZE = std::numeric_limits<size_t>::max();
 static constexpr size_t MAX_TEN = MAX_SIZE / 10;
 static constexpr size_t MAX_DIGIT = MAX_SIZE % 10;
+// We restrict the number of ranges, to avoid malicious requests. Though rfc
+// does not say anything about max number of ranges, it does mention that
+// server can ignore range header freely.
+static constexpr size_t kMaxRanges = 100;
 
 // clang-format off
 #define DR_SKIP_WHITESPACE(p) while (*p == ' ') { ++(p); }
@@ -50,7 +55,6 @@ FileRangeParseResult drogon::parseRangeHeader(const std::string &rangeStr,
     }
     const char *iter = rangeStr.c_str() + 6;
 
-    size_t totalSize = 0;
     while (true)
     {
         size_t start = 0;
@@ -95,12 +99,11 @@ FileRangeParseResult drogon::parseRangeHeader(const std::string &rangeStr,
                 // Handle found
                 if (start < end)
                 {
-                    if (totalSize > MAX_SIZE - (end - start))
+                    ranges.push_back({start, end});
+                    if (ranges.size() > kMaxRanges)
                     {
-                        return NotSatisfiable;
+                        return InvalidRange;
                     }
-                    totalSize += end - start;
-                    ranges.push_back({start, end});
                 }
                 if (*iter++ != ',')
                 {
@@ -148,16 +151,7 @@ FileRangeParseResult drogon::parseRangeHeader(const std::string &rangeStr,
         if (start < end)
         {
             ranges.push_back({start, end});
-            if (totalSize > MAX_SIZE - (end - start))
-            {
-                return NotSatisfiable;
-            }
-            totalSize += end - start;
-            // We restrict the number to be under 100, to avoid malicious
-            // requests.
-            // Though rfc does not say anything about max number of ranges,
-            // it does mention that server can ignore range header freely.
-            if (ranges.size() > 100)
+            if (ranges.size() > kMaxRanges)
             {
                 return InvalidRange;
             }
@@ -168,10 +162,33 @@ FileRangeParseResult drogon::parseRangeHeader(const std::string &rangeStr,
         }
     }
 
-    if (ranges.size() == 0 || totalSize > contentLength)
+    if (ranges.size() == 0)
     {
         return NotSatisfiable;
     }
+    if (ranges.size() > 1)
+    {
+        // rfc7233 4.1: ranges that overlap or are adjacent are coalesced, so
+        // no byte is sent twice.
+        std::sort(ranges.begin(),
+                  ranges.end(),
+                  [](const FileRange &a, const FileRange &b) {
+                      return a.start < b.start;
+                  });
+        size_t last = 0;
+        for (size_t i = 1; i < ranges.size(); ++i)
+        {
+            if (ranges[i].start <= ranges[last].end)
+            {
+                ranges[last].end = std::max(ranges[last].end, ranges[i].end);
+            }
+            else
+            {
+                ranges[++last] = ranges[i];
+            }
+        }
+        ranges.resize(last + 1);
+    }
     return ranges.size() == 1 ? SinglePart : MultiPart;
 }
 
@@ -0,0 +1,266 @@
+/**
+ *
+ *  @file RateLimiterTable.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RateLimiterTable.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+
+using namespace drogon;
+
+// The number of slots in which a client is looked up.
+static constexpr size_t kProbeLength = 16;
+static constexpr size_t kMaxShards = 64;
+// The minimum number of slots of a shard when there are several shards.
+static constexpr size_t kMinShardSlots = 1024;
+// The number of slots of a shard when it is first used.
+static constexpr size_t kInitialShardSlots = 64;
+
+static size_t roundUpToPowerOfTwo(size_t n)
+{
+    size_t result = 1;
+    while (result < n)
+        result <<= 1;
+    return result;
+}
+
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+RateLimiterTable::Key RateLimiterTable::makeKey(
+    const trantor::InetAddress &addr)
+{
+    unsigned char bytes[16]{};
+    if (addr.isIpV6())
+    {
+        memcpy(bytes, addr.ip6NetEndian(), sizeof(bytes));
+    }
+    else
+    {
+        // The IPv4-mapped IPv6 address, ::ffff:a.b.c.d
+        auto ip = addr.ipNetEndian();
+        bytes[10] = 0xff;
+        bytes[11] = 0xff;
+        memcpy(bytes + 12, &ip, sizeof(ip));
+    }
+    Key key;
+    memcpy(&key.high, bytes, sizeof(key.high));
+    memcpy(&key.low, bytes + sizeof(key.high), sizeof(key.low));
+    return key;
+}
+
+RateLimiterTable::Key RateLimiterTable::makeKey(std::string_view userId)
+{
+    // Two different hashes, so that users only share a limiter if both
+    // collide.
+    uint64_t fnv = 0xcbf29ce484222325ULL;
+    for (auto c : userId)
+    {
+        fnv ^= static_cast<unsigned char>(c);
+        fnv *= 0x100000001b3ULL;
+    }
+    return {static_cast<uint64_t>(std::hash<std::string_view>{}(userId)),
+            fnv};
+}
+
+RateLimiterTable::RateLimiterTable(RateLimiterType type,
+                                   size_t capacity,
+                                   std::chrono::duration<double> timeUnit,
+                                   size_t maxEntries,
+                                   bool multiThreads)
+    : type_(type),
+      capacity_(static_cast<uint32_t>((std::min)(
+          capacity,
+          static_cast<size_t>((std::numeric_limits<uint32_t>::max)())))),
+      timeUnit_((std::max)(
+          static_cast<int64_t>(std::llround(timeUnit.count() * 1000000)),
+          static_cast<int64_t>(1))),
+      idleTime_(type == RateLimiterType::kSlidingWindow ? 2 * timeUnit_
+                                                        : timeUnit_),
+      multiThreads_(multiThreads),
+      seed_(std::random_device{}())
+{
+    auto slots = roundUpToPowerOfTwo((std::max)(maxEntries, kProbeLength));
+    shardCount_ = (std::min)((std::max)(slots / kMinShardSlots, size_t(1)),
+                             kMaxShards);
+    auto slotsPerShard = slots / shardCount_;
+    slotMask_ = slotsPerShard - 1;
+    // The slots are allocated by the first request of each shard.
+    shards_ = std::make_unique<Shard[]>(shardCount_);
+}
+
+uint64_t RateLimiterTable::hashOf(const Key &key) const
+{
+    return mix(key.high ^ mix(key.low ^ seed_));
+}
+
+void RateLimiterTable::grow(Shard &shard) const
+{
+    auto size = shard.slots ? 2 * (shard.mask + 1)
+                            : (std::min)(kInitialShardSlots, slotMask_ + 1);
+    auto slots = std::make_unique<Slot[]>(size);
+    auto mask = size - 1;
+    if (shard.slots)
+    {
+        for (size_t i = 0; i <= shard.mask; ++i)
+        {
+            auto &slot = shard.slots[i];
+            if (slot.stamp == 0)
+                continue;
+            // The window of the client is twice as sparse in the new slots,
+            // the most recently updated client is kept if it is full.
+            auto hash = hashOf(slot.key);
+            Slot *target{nullptr};
+            for (size_t j = 0; j < kProbeLength; ++j)
+            {
+                auto &candidate = slots[(hash + j) & mask];
+                if (!target || candidate.stamp < target->stamp)
+                    target = &candidate;
+            }
+            if (target->stamp < slot.stamp)
+                *target = slot;
+        }
+    }
+    shard.slots = std::move(slots);
+    shard.mask = mask;
+}
+
+uint64_t RateLimiterTable::evictedCount() const
+{
+    uint64_t count{0};
+    for (size_t i = 0; i < shardCount_; ++i)
+    {
+        auto &shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count += shard.evicted;
+    }
+    return count;
+}
+
+bool RateLimiterTable::isAllowed(const Key &key, int64_t now)
+{
+    // A zero stamp marks the empty slots.
+    now = (std::max)(now, static_cast<int64_t>(1));
+    auto hash = hashOf(key);
+    auto &shard = shards_[(hash >> 32) & (shardCount_ - 1)];
+    std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+    if (multiThreads_)
+        lock.lock();
+
+    if (!shard.slots)
+        grow(shard);
+    Slot *victim{nullptr};
+    for (;;)
+    {
+        victim = nullptr;
+        for (size_t i = 0; i < kProbeLength; ++i)
+        {
+            auto &slot = shard.slots[(hash + i) & shard.mask];
+            if (slot.stamp != 0 && slot.key == key)
+            {
+                return update(slot, now);
+            }
+            // The slot with the oldest stamp is replaced, which is an empty
+            // slot if there is one, then the slot of a limiter that is the
+            // same as a new one if there is one.
+            if (!victim || slot.stamp < victim->stamp)
+            {
+                victim = &slot;
+            }
+        }
+        if (victim->stamp == 0 || now - victim->stamp >= idleTime_)
+            break;
+        if (shard.mask == slotMask_)
+        {
+            ++shard.evicted;
+            break;
+        }
+        // Make room rather than dropping a limiter in use.
+        grow(shard);
+    }
+    victim->key = key;
+    victim->stamp = now;
+    victim->previous = 0;
+    if (type_ == RateLimiterType::kTokenBucket)
+        victim->tokens = static_cast<float>(capacity_);
+    else
+        victim->current = 0;
+    return update(*victim, now);
+}
+
+// The same algorithms as the TokenBucketRateLimiter, FixedWindowRateLimiter
+// and SlidingWindowRateLimiter classes.
+bool RateLimiterTable::update(Slot &slot, int64_t now) const
+{
+    switch (type_)
+    {
+        case RateLimiterType::kTokenBucket:
+        {
+            auto tokens = slot.tokens + static_cast<double>(capacity_) *
+                                            (now - slot.stamp) / timeUnit_;
+            tokens = (std::min)(tokens, static_cast<double>(capacity_));
+            slot.stamp = now;
+            if (tokens > 1.0)
+            {
+                slot.tokens = static_cast<float>(tokens - 1.0);
+                return true;
+            }
+            slot.tokens = static_cast<float>(tokens);
+            return false;
+        }
+        case RateLimiterType::kFixedWindow:
+        {
+            if (now - slot.stamp >= timeUnit_)
+            {
+                slot.current = 0;
+                slot.stamp = now;
+            }
+            if (slot.current < capacity_)
+            {
+                ++slot.current;
+                return true;
+            }
+            return false;
+        }
+        case RateLimiterType::kSlidingWindow:
+        {
+            auto windows = (now - slot.stamp) / timeUnit_;
+            if (windows > 0)
+            {
+                slot.previous = windows == 1 ? slot.current : 0;
+                slot.current = 0;
+                slot.stamp += windows * timeUnit_;
+            }
+            auto coef = static_cast<double>(now - slot.stamp) / timeUnit_;
+            auto count = slot.previous * (1.0 - coef) + slot.current;
+            if (count < capacity_)
+            {
+                ++slot.current;
+                return true;
+            }
+            return false;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,163 @@
+/**
+ *
+ *  @file RateLimiterTable.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/RateLimiter.h>
+#include <trantor/net/InetAddress.h>
+#include <trantor/utils/NonCopyable.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace drogon
+{
+/**
+ * @brief The rate limiters of many clients (IP addresses or users) stored
+ * inline in a bounded hash table.
+ *
+ * The table is split into shards, each one protected by its own mutex when
+ * the table is used from several threads. A client is looked up in a short
+ * window of slots after its hash. When the client isn't there, it takes an
+ * empty slot, or the slot of a client whose limiter is back to its initial
+ * state. Else the shard doubles its size, until it reaches its share of the
+ * maximum size of the table, and then the least recently updated slot of the
+ * window is taken. The memory used by the table therefore follows the number
+ * of clients seen at the same time and is bounded, at the cost of resetting
+ * the limiters of the least active clients when more clients than the table
+ * holds are seen at the same time.
+ */
+class RateLimiterTable : public trantor::NonCopyable
+{
+  public:
+    /**
+     * @brief The key of a client, the IPv6 (or IPv4-mapped IPv6) address or
+     * a hash of the user id.
+     */
+    struct Key
+    {
+        uint64_t high;
+        uint64_t low;
+
+        bool operator==(const Key &other) const
+        {
+            return high == other.high && low == other.low;
+        }
+    };
+
+    static Key makeKey(const trantor::InetAddress &addr);
+    static Key makeKey(std::string_view userId);
+
+    /**
+     * @brief Create a table.
+     * @param type The algorithm of the limiters.
+     * @param capacity The maximum number of requests of a client in the time
+     * unit.
+     * @param timeUnit The time unit of the limiters.
+     * @param maxEntries The maximum number of clients in the table, rounded
+     * up to a power of two. Each client takes 32 bytes, the shards are
+     * allocated when they are first used and grow with the number of
+     * clients.
+     * @param multiThreads Lock the shards if the table is used from several
+     * threads.
+     */
+    RateLimiterTable(RateLimiterType type,
+                     size_t capacity,
+                     std::chrono::duration<double> timeUnit,
+                     size_t maxEntries,
+                     bool multiThreads);
+
+    /**
+     * @brief Check if a request of the client is allowed.
+     */
+    bool isAllowed(const Key &key)
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return isAllowed(
+            key,
+            std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+
+    /**
+     * @brief Check if a request of the client is allowed at the given time,
+     * in microseconds of the steady clock.
+     */
+    bool isAllowed(const Key &key, int64_t now);
+
+    /**
+     * @brief The maximum number of slots of the table.
+     */
+    size_t capacity() const
+    {
+        return shardCount_ * (slotMask_ + 1);
+    }
+
+    /**
+     * @brief The number of clients removed from the table to make room for
+     * new ones while their limiters were still in use.
+     */
+    uint64_t evictedCount() const;
+
+  private:
+    // The limiter of a client, 32 bytes including the key. A slot with a
+    // zero stamp is empty.
+    struct Slot
+    {
+        Key key;
+        // The time of the last refill of the token bucket, or the start of
+        // the current window.
+        int64_t stamp;
+
+        union
+        {
+            float tokens;
+            uint32_t current;
+        };
+
+        // The number of requests in the previous window of the sliding
+        // window algorithm.
+        uint32_t previous;
+    };
+
+    static_assert(sizeof(Slot) == 32, "The slots must be 32 bytes");
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        std::unique_ptr<Slot[]> slots;
+        // The number of slots minus one, the size is a power of two.
+        size_t mask{0};
+        uint64_t evicted{0};
+    };
+
+    bool update(Slot &slot, int64_t now) const;
+    uint64_t hashOf(const Key &key) const;
+    void grow(Shard &shard) const;
+
+    const RateLimiterType type_;
+    const uint32_t capacity_;
+    const int64_t timeUnit_;
+    // The time after which an unused limiter is the same as a new one.
+    const int64_t idleTime_;
+    const bool multiThreads_;
+    // Makes the positions of the clients in the table unpredictable.
+    const uint64_t seed_;
+    size_t shardCount_{1};
+    // The maximum number of slots of a shard minus one.
+    size_t slotMask_{0};
+    std::unique_ptr<Shard[]> shards_;
+};
+}  // namespace drogon
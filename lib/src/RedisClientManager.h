@@ -52,7 +52,8 @@ class RedisClientManager : public trantor::NonCopyable
                            size_t connectionNum,
                            bool isFast,
                            double timeout,
-                           unsigned int db);
+                           unsigned int db,
+                           bool loopAffinity);
     // bool areAllRedisClientsAvailable() const noexcept;
 
     ~RedisClientManager();
@@ -72,6 +73,7 @@ class RedisClientManager : public trantor::NonCopyable
         size_t connectionNumber_;
         double timeout_;
         unsigned int db_;
+        bool loopAffinity_;
     };
 
     std::vector<RedisInfo> redisInfos_;
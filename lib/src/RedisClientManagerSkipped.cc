@@ -35,7 +35,8 @@ void RedisClientManager::createRedisClient(const std::string & /*name*/,
                                            size_t /*connectionNum*/,
                                            bool /*isFast*/,
                                            double /*timeout*/,
-                                           unsigned int /*db*/)
+                                           unsigned int /*db*/,
+                                           bool /*loopAffinity*/)
 {
     LOG_FATAL << "Redis is not supported by drogon, please install the "
                  "hiredis library first.";
@@ -13,6 +13,7 @@
  */
 
 #include "drogon/nosql/RedisClient.h"
+#include "drogon/nosql/RedisSessionStore.h"
 
 namespace drogon
 {
@@ -29,5 +30,28 @@ std::shared_ptr<RedisClient> RedisClient::newRedisClient(
                  "hiredis library first.";
     abort();
 }
+
+std::shared_ptr<RedisClient> RedisClient::newRedisClusterClient(
+    const std::vector<trantor::InetAddress> & /*seedNodes*/,
+    size_t /*connectionsPerNode*/,
+    const std::string & /*password*/,
+    const std::string & /*username*/)
+{
+    LOG_FATAL << "Redis is not supported by drogon, please install the "
+                 "hiredis library first.";
+    abort();
+}
+
+std::shared_ptr<RedisSessionStore> RedisSessionStore::newRedisSessionStore(
+    const RedisClientPtr & /*client*/,
+    const std::string & /*keyPrefix*/,
+    size_t /*nearCacheSize*/,
+    double /*nearCacheTimeout*/,
+    double /*refreshInterval*/)
+{
+    LOG_FATAL << "Redis is not supported by drogon, please install the "
+                 "hiredis library first.";
+    abort();
+}
 }  // namespace nosql
 }  // namespace drogon
@@ -41,6 +41,13 @@ std::string RedisResult::asString() const noexcept(false)
     abort();
 }
 
+std::string_view RedisResult::asStringView() const noexcept(false)
+{
+    LOG_FATAL << "Redis is not supported by drogon, please install the "
+                 "hiredis library first.";
+    abort();
+}
+
 RedisResultType RedisResult::type() const noexcept
 {
     LOG_FATAL << "Redis is not supported by drogon, please install the "
@@ -55,6 +62,28 @@ std::vector<RedisResult> RedisResult::asArray() const noexcept(false)
     abort();
 }
 
+RedisArrayView RedisResult::asArrayView() const noexcept(false)
+{
+    LOG_FATAL << "Redis is not supported by drogon, please install the "
+                 "hiredis library first.";
+    abort();
+}
+
+RedisArrayView::RedisArrayView(redisReply * /*reply*/,
+                               std::shared_ptr<redisReply> /*handle*/)
+{
+    LOG_FATAL << "Redis is not supported by drogon, please install the "
+                 "hiredis library first.";
+    abort();
+}
+
+RedisResult RedisArrayView::operator[](size_t /*index*/) const noexcept
+{
+    LOG_FATAL << "Redis is not supported by drogon, please install the "
+                 "hiredis library first.";
+    abort();
+}
+
 long long RedisResult::asInteger() const noexcept(false)
 {
     LOG_FATAL << "Redis is not supported by drogon, please install the "
@@ -13,6 +13,7 @@
  */
 
 #include "SessionManager.h"
+#include "CacheMapSessionStore.h"
 
 using namespace drogon;
 
@@ -21,96 +22,48 @@ SessionManager::SessionManager(
     size_t timeout,
     const std::vector<AdviceStartSessionCallback> &startAdvices,
     const std::vector<AdviceDestroySessionCallback> &destroyAdvices,
-    IdGeneratorCallback idGeneratorCallback)
-    : loop_(loop),
-      timeout_(timeout),
+    IdGeneratorCallback idGeneratorCallback,
+    std::shared_ptr<SessionStore> store)
+    : storePtr_(std::move(store)),
+      isCustomStore_(storePtr_ != nullptr),
       sessionStartAdvices_(startAdvices),
-      sessionDestroyAdvices_(destroyAdvices),
       idGeneratorCallback_(idGeneratorCallback)
 {
-    if (timeout_ > 0)
+    if (!storePtr_)
     {
-        size_t wheelNum = 1;
-        size_t bucketNum = 0;
-        if (timeout_ < 500)
-        {
-            bucketNum = timeout_ + 1;
-        }
-        else
-        {
-            auto tmpTimeout = timeout_;
-            bucketNum = 100;
-            while (tmpTimeout > 100)
-            {
-                ++wheelNum;
-                tmpTimeout = tmpTimeout / 100;
-            }
-        }
-
-        sessionMapPtr_ = std::unique_ptr<CacheMap<std::string, SessionPtr>>(
-            new CacheMap<std::string, SessionPtr>(
-                loop_,
-                1.0,
-                wheelNum,
-                bucketNum,
-                [this](const std::string &key) {
-                    for (auto &advice : sessionStartAdvices_)
-                    {
-                        advice(key);
-                    }
-                },
-                [this](const std::string &key) {
-                    for (auto &advice : sessionDestroyAdvices_)
-                    {
-                        advice(key);
-                    }
-                }));
+        storePtr_ = std::make_shared<CacheMapSessionStore>(startAdvices,
+                                                           destroyAdvices);
     }
-    else if (timeout_ == 0)
+    storePtr_->init(loop, timeout);
+}
+
+SessionPtr SessionManager::findSession(const std::string &sessionID,
+                                       bool needToSet)
+{
+    assert(!sessionID.empty());
+    auto sessionPtr = storePtr_->findSession(sessionID, needToSet);
+    // The default store calls the advices when sessions are put into its
+    // cache map, other stores only know the sessions of new clients.
+    if (isCustomStore_ && needToSet)
     {
-        sessionMapPtr_ = std::unique_ptr<CacheMap<std::string, SessionPtr>>(
-            new CacheMap<std::string, SessionPtr>(
-                loop_,
-                0,
-                0,
-                0,
-                [this](const std::string &key) {
-                    for (auto &advice : sessionStartAdvices_)
-                    {
-                        advice(key);
-                    }
-                },
-                [this](const std::string &key) {
-                    for (auto &advice : sessionDestroyAdvices_)
-                    {
-                        advice(key);
-                    }
-                }));
+        for (auto &advice : sessionStartAdvices_)
+        {
+            advice(sessionID);
+        }
     }
+    return sessionPtr;
 }
 
-SessionPtr SessionManager::getSession(const std::string &sessionID,
-                                      bool needToSet)
+void SessionManager::loadSession(const std::string &sessionID,
+                                 SessionStore::SessionCallback &&callback)
 {
     assert(!sessionID.empty());
-    SessionPtr sessionPtr;
-    sessionMapPtr_->modify(
-        sessionID,
-        [&sessionPtr, &sessionID, needToSet](SessionPtr &sessionInCache) {
-            if (sessionInCache)
-            {
-                sessionPtr = sessionInCache;
-            }
-            else
-            {
-                sessionPtr =
-                    std::shared_ptr<Session>(new Session(sessionID, needToSet));
-                sessionInCache = sessionPtr;
-            }
-        },
-        timeout_);
+    storePtr_->loadSession(sessionID, std::move(callback));
+}
 
-    return sessionPtr;
+void SessionManager::saveSession(const SessionPtr &sessionPtr)
+{
+    storePtr_->saveSession(sessionPtr);
 }
 
 void SessionManager::changeSessionId(const SessionPtr &sessionPtr)
@@ -118,11 +71,5 @@ void SessionManager::changeSessionId(const SessionPtr &sessionPtr)
     auto oldId = sessionPtr->sessionId();
     auto newId = idGeneratorCallback_();
     sessionPtr->setSessionId(newId);
-    sessionMapPtr_->insert(newId, sessionPtr, timeout_);
-    // For requests sent before setting the new session ID to the client, we
-    // reserve the old session slot for a period of time.
-    sessionMapPtr_->runAfter(10, [this, oldId = std::move(oldId)]() {
-        LOG_TRACE << "remove the old slot of the session";
-        sessionMapPtr_->erase(oldId);
-    });
+    storePtr_->changeSessionId(sessionPtr, oldId);
 }
@@ -15,14 +15,13 @@
 #pragma once
 
 #include <drogon/Session.h>
+#include <drogon/SessionStore.h>
 #include <drogon/drogon_callbacks.h>
-#include <drogon/CacheMap.h>
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/net/EventLoop.h>
 #include <functional>
 #include <memory>
 #include <string>
-#include <mutex>
 #include <vector>
 
 namespace drogon
@@ -32,27 +31,37 @@ class SessionManager : public trantor::NonCopyable
   public:
     using IdGeneratorCallback = std::function<std::string()>;
 
+    /**
+     * @param store The session store, sessions are kept in a CacheMap if it
+     * is nullptr.
+     */
     SessionManager(
         trantor::EventLoop *loop,
         size_t timeout,
         const std::vector<AdviceStartSessionCallback> &startAdvices,
         const std::vector<AdviceDestroySessionCallback> &destroyAdvices,
-        IdGeneratorCallback idGeneratorCallback);
+        IdGeneratorCallback idGeneratorCallback,
+        std::shared_ptr<SessionStore> store = nullptr);
 
     ~SessionManager()
     {
-        sessionMapPtr_.reset();
+        storePtr_.reset();
     }
 
-    SessionPtr getSession(const std::string &sessionID, bool needToSet);
+    /**
+     * @brief Return the session if it can be found without waiting, otherwise
+     * return nullptr and the loadSession() method should be called.
+     */
+    SessionPtr findSession(const std::string &sessionID, bool needToSet);
+    void loadSession(const std::string &sessionID,
+                     SessionStore::SessionCallback &&callback);
+    void saveSession(const SessionPtr &sessionPtr);
     void changeSessionId(const SessionPtr &sessionPtr);
 
   private:
-    std::unique_ptr<CacheMap<std::string, SessionPtr>> sessionMapPtr_;
-    trantor::EventLoop *loop_;
-    size_t timeout_;
+    std::shared_ptr<SessionStore> storePtr_;
+    bool isCustomStore_;
     const std::vector<AdviceStartSessionCallback> &sessionStartAdvices_;
-    const std::vector<AdviceDestroySessionCallback> &sessionDestroyAdvices_;
     IdGeneratorCallback idGeneratorCallback_;
 };
 }  // namespace drogon
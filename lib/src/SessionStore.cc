@@ -0,0 +1,361 @@
+/**
+ *
+ *  @file SessionStore.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include <drogon/SessionStore.h>
+#include <json/json.h>
+#include <cstring>
+#include <mutex>
+
+using namespace drogon;
+
+namespace
+{
+// The layout of encoded sessions is a version byte followed by entries of
+// <varint key length><key><type tag><value>. Integers are varints (zigzag
+// encoded for signed types), floating point numbers are their bits in little
+// endian, strings and JSON texts are prefixed with their varint lengths.
+constexpr char kEncodingVersion = 1;
+
+enum ValueTag : char
+{
+    kBool = 0,
+    kInt,
+    kUInt,
+    kLong,
+    kULong,
+    kLongLong,
+    kULongLong,
+    kFloat,
+    kDouble,
+    kString,
+    kJson
+};
+
+void putVarint(std::string &buf, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<char>(value));
+}
+
+void putSigned(std::string &buf, int64_t value)
+{
+    putVarint(buf,
+              (static_cast<uint64_t>(value) << 1) ^
+                  static_cast<uint64_t>(value >> 63));
+}
+
+void putBits(std::string &buf, uint64_t bits, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        buf.push_back(static_cast<char>(bits >> (i * 8)));
+    }
+}
+
+void putString(std::string &buf, std::string_view str)
+{
+    putVarint(buf, str.length());
+    buf.append(str.data(), str.length());
+}
+
+bool getVarint(std::string_view &data, uint64_t &value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (data.empty())
+            return false;
+        auto byte = static_cast<unsigned char>(data[0]);
+        data.remove_prefix(1);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool getSigned(std::string_view &data, int64_t &value)
+{
+    uint64_t raw;
+    if (!getVarint(data, raw))
+        return false;
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+bool getBits(std::string_view &data, uint64_t &bits, size_t bytes)
+{
+    if (data.length() < bytes)
+        return false;
+    bits = 0;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        bits |= static_cast<uint64_t>(static_cast<unsigned char>(data[i]))
+                << (i * 8);
+    }
+    data.remove_prefix(bytes);
+    return true;
+}
+
+bool getString(std::string_view &data, std::string_view &str)
+{
+    uint64_t length;
+    if (!getVarint(data, length) || data.length() < length)
+        return false;
+    str = data.substr(0, length);
+    data.remove_prefix(length);
+    return true;
+}
+
+bool encodeValue(std::string &buf, const std::any &value)
+{
+    auto &type = value.type();
+    if (type == typeid(std::string))
+    {
+        buf.push_back(kString);
+        putString(buf, std::any_cast<const std::string &>(value));
+    }
+    else if (type == typeid(const char *))
+    {
+        buf.push_back(kString);
+        putString(buf, std::any_cast<const char *>(value));
+    }
+    else if (type == typeid(bool))
+    {
+        buf.push_back(kBool);
+        buf.push_back(std::any_cast<bool>(value) ? 1 : 0);
+    }
+    else if (type == typeid(int))
+    {
+        buf.push_back(kInt);
+        putSigned(buf, std::any_cast<int>(value));
+    }
+    else if (type == typeid(unsigned int))
+    {
+        buf.push_back(kUInt);
+        putVarint(buf, std::any_cast<unsigned int>(value));
+    }
+    else if (type == typeid(long))
+    {
+        buf.push_back(kLong);
+        putSigned(buf, std::any_cast<long>(value));
+    }
+    else if (type == typeid(unsigned long))
+    {
+        buf.push_back(kULong);
+        putVarint(buf, std::any_cast<unsigned long>(value));
+    }
+    else if (type == typeid(long long))
+    {
+        buf.push_back(kLongLong);
+        putSigned(buf, std::any_cast<long long>(value));
+    }
+    else if (type == typeid(unsigned long long))
+    {
+        buf.push_back(kULongLong);
+        putVarint(buf, std::any_cast<unsigned long long>(value));
+    }
+    else if (type == typeid(float))
+    {
+        auto number = std::any_cast<float>(value);
+        uint32_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        buf.push_back(kFloat);
+        putBits(buf, bits, sizeof(bits));
+    }
+    else if (type == typeid(double))
+    {
+        auto number = std::any_cast<double>(value);
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        buf.push_back(kDouble);
+        putBits(buf, bits, sizeof(bits));
+    }
+    else if (type == typeid(Json::Value))
+    {
+        static std::once_flag once;
+        static Json::StreamWriterBuilder builder;
+        std::call_once(once, []() {
+            builder["commentStyle"] = "None";
+            builder["indentation"] = "";
+            builder["emitUTF8"] = true;
+        });
+        buf.push_back(kJson);
+        putString(buf,
+                  Json::writeString(builder,
+                                    std::any_cast<const Json::Value &>(value)));
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool decodeValue(std::string_view &data, std::any &value)
+{
+    if (data.empty())
+        return false;
+    auto tag = data[0];
+    data.remove_prefix(1);
+    int64_t signedValue;
+    uint64_t unsignedValue;
+    switch (tag)
+    {
+        case kBool:
+            if (data.empty())
+                return false;
+            value = (data[0] != 0);
+            data.remove_prefix(1);
+            return true;
+        case kInt:
+        case kLong:
+        case kLongLong:
+            if (!getSigned(data, signedValue))
+                return false;
+            if (tag == kInt)
+                value = static_cast<int>(signedValue);
+            else if (tag == kLong)
+                value = static_cast<long>(signedValue);
+            else
+                value = static_cast<long long>(signedValue);
+            return true;
+        case kUInt:
+        case kULong:
+        case kULongLong:
+            if (!getVarint(data, unsignedValue))
+                return false;
+            if (tag == kUInt)
+                value = static_cast<unsigned int>(unsignedValue);
+            else if (tag == kULong)
+                value = static_cast<unsigned long>(unsignedValue);
+            else
+                value = static_cast<unsigned long long>(unsignedValue);
+            return true;
+        case kFloat:
+        {
+            if (!getBits(data, unsignedValue, sizeof(float)))
+                return false;
+            auto bits = static_cast<uint32_t>(unsignedValue);
+            float number;
+            memcpy(&number, &bits, sizeof(number));
+            value = number;
+            return true;
+        }
+        case kDouble:
+        {
+            if (!getBits(data, unsignedValue, sizeof(double)))
+                return false;
+            double number;
+            memcpy(&number, &unsignedValue, sizeof(number));
+            value = number;
+            return true;
+        }
+        case kString:
+        {
+            std::string_view str;
+            if (!getString(data, str))
+                return false;
+            value = std::string(str);
+            return true;
+        }
+        case kJson:
+        {
+            static std::once_flag once;
+            static Json::CharReaderBuilder builder;
+            std::call_once(once, []() {
+                builder["collectComments"] = false;
+            });
+            std::string_view str;
+            if (!getString(data, str))
+                return false;
+            Json::Value json;
+            JSONCPP_STRING errs;
+            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            if (!reader->parse(str.data(),
+                               str.data() + str.length(),
+                               &json,
+                               &errs))
+            {
+                LOG_DEBUG << errs;
+                return false;
+            }
+            value = std::move(json);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+}  // namespace
+
+SessionPtr SessionStore::newSession(const std::string &sessionId,
+                                    bool needToSet)
+{
+    return std::shared_ptr<Session>(new Session(sessionId, needToSet));
+}
+
+bool SessionStore::checkDirty(const SessionPtr &sessionPtr)
+{
+    std::lock_guard<std::mutex> lock(sessionPtr->mutex_);
+    auto dirty = sessionPtr->dirty_;
+    sessionPtr->dirty_ = false;
+    return dirty;
+}
+
+std::string SessionStore::encodeSession(const SessionPtr &sessionPtr)
+{
+    std::string buf;
+    buf.push_back(kEncodingVersion);
+    std::lock_guard<std::mutex> lock(sessionPtr->mutex_);
+    for (auto &item : sessionPtr->sessionMap_)
+    {
+        auto length = buf.length();
+        putString(buf, item.first);
+        if (!encodeValue(buf, item.second))
+        {
+            LOG_ERROR << "The value of the session key '" << item.first
+                      << "' can't be serialized, type: "
+                      << item.second.type().name();
+            buf.resize(length);
+        }
+    }
+    sessionPtr->dirty_ = false;
+    return buf;
+}
+
+bool SessionStore::decodeSession(const SessionPtr &sessionPtr,
+                                 std::string_view data)
+{
+    if (data.empty() || data[0] != kEncodingVersion)
+        return false;
+    data.remove_prefix(1);
+    Session::SessionMap sessionMap;
+    while (!data.empty())
+    {
+        std::string_view key;
+        std::any value;
+        if (!getString(data, key) || !decodeValue(data, value))
+            return false;
+        sessionMap[std::string(key)] = std::move(value);
+    }
+    std::lock_guard<std::mutex> lock(sessionPtr->mutex_);
+    sessionPtr->sessionMap_ = std::move(sessionMap);
+    sessionPtr->dirty_ = false;
+    return true;
+}
@@ -320,6 +320,73 @@ static bool getFileStat(const std::string &filePath, FileStat &myStat)
     return false;
 }
 
+// The body is sent as the headers of the parts and the ranges of the file
+// with sendfile, so its length is known before anything is read. Like in
+// newFileResponse(), the ranges are read into the body instead if sendfile is
+// disabled or they are small.
+static HttpResponsePtr newMultiRangeFileResponse(
+    const std::string &filePath,
+    const std::vector<FileRange> &ranges,
+    size_t fileSize,
+    std::string_view mime)
+{
+    if (mime.empty())
+    {
+        mime = "application/octet-stream";
+    }
+    auto boundary = utils::genRandomString(32);
+    auto totalSize = std::to_string(fileSize);
+    std::vector<HttpResponseImpl::SendfilePart> parts;
+    parts.reserve(ranges.size());
+    size_t rangesLength = 0;
+    for (auto &range : ranges)
+    {
+        rangesLength += range.end - range.start;
+        std::string header;
+        if (!parts.empty())
+        {
+            header.append("\r\n");
+        }
+        header.append("--").append(boundary);
+        header.append("\r\nContent-Type: ").append(mime);
+        header.append("\r\nContent-Range: bytes ")
+            .append(std::to_string(range.start))
+            .append("-")
+            .append(std::to_string(range.end - 1))
+            .append("/")
+            .append(totalSize)
+            .append("\r\n\r\n");
+        parts.push_back(
+            {std::move(header), range.start, range.end - range.start});
+    }
+    auto resp = std::make_shared<HttpResponseImpl>();
+    resp->setStatusCode(k206PartialContent);
+    static_cast<HttpResponse *>(resp.get())
+        ->setContentTypeCodeAndCustomString(
+            CT_CUSTOM, "multipart/byteranges; boundary=" + boundary);
+    resp->setSendfile(filePath);
+    resp->setSendfileParts(std::move(parts), "\r\n--" + boundary + "--\r\n");
+    auto &appImpl = HttpAppFrameworkImpl::instance();
+    if (appImpl.useSendfile() && rangesLength > appImpl.sendfileThreshold())
+    {
+        return resp;
+    }
+    if (trantor::EventLoop::getEventLoopOfCurrentThread())
+    {
+        // Don't block the event loop, the parts are read by the file IO
+        // service before the response is sent.
+        resp->setFileBodyDeferred(true);
+        return resp;
+    }
+    std::string body;
+    if (!resp->readFileBody(body))
+    {
+        return HttpResponse::newNotFoundResponse();
+    }
+    resp->setDeferredFileBody(std::move(body));
+    return resp;
+}
+
 void StaticFileRouter::sendStaticFileResponse(
     const std::string &filePath,
     const HttpRequestImplPtr &req,
@@ -364,23 +431,26 @@ void StaticFileRouter::sendStaticFileResponse(
             std::vector<FileRange> ranges;
             switch (parseRangeHeader(rangeStr, fileStat.fileSize_, ranges))
             {
-                // TODO: support only single range now
-                // Contributions are welcomed.
                 case FileRangeParseResult::SinglePart:
                 case FileRangeParseResult::MultiPart:
                 {
                     auto firstRange = ranges.front();
                     auto ct = fileNameToContentTypeAndMime(filePath);
                     auto resp =
-                        HttpResponse::newFileResponse(filePath,
-                                                      firstRange.start,
-                                                      firstRange.end -
-                                                          firstRange.start,
-                                                      true,
-                                                      "",
-                                                      ct.first,
-                                                      std::string(ct.second),
-                                                      req);
+                        ranges.size() > 1
+                            ? newMultiRangeFileResponse(filePath,
+                                                        ranges,
+                                                        fileStat.fileSize_,
+                                                        ct.second)
+                            : HttpResponse::newFileResponse(
+                                  filePath,
+                                  firstRange.start,
+                                  firstRange.end - firstRange.start,
+                                  true,
+                                  "",
+                                  ct.first,
+                                  std::string(ct.second),
+                                  req);
                     if (!fileStat.modifiedTimeStr_.empty())
                     {
                         resp->addHeader("Last-Modified",
@@ -0,0 +1,191 @@
+#include <drogon/utils/monitoring/Summary.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+using namespace drogon;
+using namespace drogon::monitoring;
+
+// The parameters are checked before any member depending on them is
+// initialized.
+static const std::vector<double> &checkParameters(
+    const std::vector<double> &quantiles,
+    double relativeAccuracy,
+    double minValue,
+    double maxValue)
+{
+    for (auto q : quantiles)
+    {
+        if (!(q >= 0 && q <= 1))
+        {
+            throw std::runtime_error("The quantiles must be between 0 and 1");
+        }
+    }
+    if (!(relativeAccuracy > 0 && relativeAccuracy < 1))
+    {
+        throw std::runtime_error(
+            "The relative accuracy must be between 0 and 1");
+    }
+    if (!(minValue > 0 && maxValue > minValue && std::isfinite(maxValue)))
+    {
+        throw std::runtime_error(
+            "The value range must be positive and not empty");
+    }
+    return quantiles;
+}
+
+Summary::Summary(const std::string &name,
+                 const std::vector<std::string> &labelNames,
+                 const std::vector<std::string> &labelValues,
+                 const std::vector<double> &quantiles,
+                 double relativeAccuracy,
+                 double minValue,
+                 double maxValue) noexcept(false)
+    : Metric(name, labelNames, labelValues),
+      quantiles_(
+          checkParameters(quantiles, relativeAccuracy, minValue, maxValue)),
+      relativeAccuracy_(relativeAccuracy),
+      minValue_(minValue),
+      maxValue_(maxValue),
+      gamma_((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+      logGamma_(std::log(gamma_)),
+      minIndex_(
+          static_cast<int64_t>(std::ceil(std::log(minValue) / logGamma_))),
+      // The underflow bucket, the logarithmic buckets and the overflow
+      // bucket.
+      counts_(static_cast<size_t>(
+                  static_cast<int64_t>(
+                      std::ceil(std::log(maxValue) / logGamma_)) -
+                  minIndex_ + 3),
+              kShardCount)
+{
+}
+
+size_t Summary::bucketIndex(double value) const
+{
+    if (!(value >= minValue_))
+        return 0;
+    if (value > maxValue_)
+        return counts_.size() - 1;
+    // The bucket k holds the values in (gamma^(k-1), gamma^k].
+    auto index =
+        static_cast<int64_t>(std::ceil(std::log(value) / logGamma_)) -
+        minIndex_ + 1;
+    return static_cast<size_t>(std::clamp<int64_t>(
+        index, 1, static_cast<int64_t>(counts_.size()) - 2));
+}
+
+double Summary::bucketValue(size_t index) const
+{
+    if (index == 0)
+        return 0;
+    if (index == counts_.size() - 1)
+        return maxValue_;
+    // The value whose relative distance to both bounds of the bucket is at
+    // most the relative accuracy.
+    auto k = static_cast<int64_t>(index) + minIndex_ - 1;
+    return 2 * std::exp(static_cast<double>(k) * logGamma_) / (gamma_ + 1);
+}
+
+void Summary::observe(double value)
+{
+    counts_.add(bucketIndex(value));
+    sum_.add(value);
+}
+
+void Summary::merge(const Summary &other) noexcept(false)
+{
+    if (relativeAccuracy_ != other.relativeAccuracy_ ||
+        minValue_ != other.minValue_ || maxValue_ != other.maxValue_)
+    {
+        throw std::runtime_error(
+            "Only summaries with the same accuracy and range can be merged");
+    }
+    for (size_t i = 0; i < counts_.size(); ++i)
+    {
+        auto count = other.counts_.value(i);
+        if (count > 0)
+            counts_.add(i, count);
+    }
+    sum_.add(other.sum_.value());
+}
+
+uint64_t Summary::count() const
+{
+    uint64_t total{0};
+    for (size_t i = 0; i < counts_.size(); ++i)
+    {
+        total += counts_.value(i);
+    }
+    return total;
+}
+
+double Summary::sum() const
+{
+    return sum_.value();
+}
+
+void Summary::reset()
+{
+    counts_.reset();
+    sum_.reset();
+}
+
+double Summary::quantile(double q) const
+{
+    std::vector<uint64_t> counts(counts_.size());
+    uint64_t total{0};
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        counts[i] = counts_.value(i);
+        total += counts[i];
+    }
+    return quantile(counts, total, q);
+}
+
+double Summary::quantile(const std::vector<uint64_t> &counts,
+                         uint64_t total,
+                         double q) const
+{
+    if (total == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    // The value of rank q * (total - 1), counting from 0.
+    auto rank = q * static_cast<double>(total - 1);
+    uint64_t cumulative{0};
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        cumulative += counts[i];
+        if (static_cast<double>(cumulative) > rank)
+            return bucketValue(i);
+    }
+    return bucketValue(counts.size() - 1);
+}
+
+std::vector<Sample> Summary::collect() const
+{
+    std::vector<Sample> samples;
+    std::vector<uint64_t> counts(counts_.size());
+    uint64_t total{0};
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        counts[i] = counts_.value(i);
+        total += counts[i];
+    }
+    for (auto q : quantiles_)
+    {
+        Sample sample;
+        sample.name = name_;
+        sample.exLabels.emplace_back("quantile", std::to_string(q));
+        sample.value = quantile(counts, total, q);
+        samples.emplace_back(std::move(sample));
+    }
+    Sample sumSample;
+    sumSample.name = name_ + "_sum";
+    sumSample.value = sum_.value();
+    samples.emplace_back(std::move(sumSample));
+    Sample countSample;
+    countSample.name = name_ + "_count";
+    countSample.value = static_cast<double>(total);
+    samples.emplace_back(std::move(countSample));
+    return samples;
+}
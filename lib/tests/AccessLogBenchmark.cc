@@ -0,0 +1,71 @@
+/**
+ * Measures the time AccessLogger takes to format a line in the text, JSON and
+ * logfmt output formats, with and without copying the data of the line from
+ * the request and the response.
+ *
+ * Usage: access_log_benchmark [lines]
+ */
+#include "../src/AccessLogFormat.h"
+#include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace drogon;
+using namespace drogon::plugin;
+
+template <typename Func>
+static void run(const std::string &name, size_t lines, Func &&func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lines; ++i)
+    {
+        func();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() * 1e9 / lines << " ns/line"
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t lines = 1000000;
+    if (argc > 1)
+        lines = std::strtoull(argv[1], nullptr, 10);
+    const std::string format =
+        "$request_date $method $url [$body_bytes_received] ($remote_addr - "
+        "$local_addr) $status $body_bytes_sent $processing_time "
+        "$http_user-agent";
+    auto req = HttpRequest::newHttpRequest();
+    req->setPath("/api/v1/items/42");
+    req->addHeader("user-agent", "Mozilla/5.0 (X11; Linux x86_64) \"bench\"");
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setBody(std::string(512, 'x'));
+
+    const std::pair<const char *, AccessLogFormatter::Style> styles[] = {
+        {"text", AccessLogFormatter::Style::Text},
+        {"json", AccessLogFormatter::Style::Json},
+        {"logfmt", AccessLogFormatter::Style::Logfmt}};
+    for (auto &style : styles)
+    {
+        AccessLogFormatter formatter(parseAccessLogFormat(format),
+                                     style.second);
+        AccessLogFormatContext context(AccessLogDateFormatter(true, true, ""));
+        AccessLogEntry entry;
+        std::string line;
+        formatter.capture(entry, req, resp, false);
+        run(std::string("format, ") + style.first, lines, [&]() {
+            line.clear();
+            formatter.format(entry, context, line);
+        });
+        run(std::string("capture and format, ") + style.first, lines, [&]() {
+            formatter.capture(entry, req, resp, false);
+            line.clear();
+            formatter.format(entry, context, line);
+        });
+        std::cout << line;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * Measures the throughput of Histogram::observe(), Summary::observe() and
+ * Counter::increment() when they are called from 1, 8 and 32 threads at the
+ * same time.
+ *
+ * Usage: metrics_benchmark [operations per thread]
+ */
+#include <drogon/utils/monitoring/Counter.h>
+#include <drogon/utils/monitoring/Histogram.h>
+#include <drogon/utils/monitoring/Summary.h>
+#include <trantor/net/EventLoopThread.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace drogon::monitoring;
+
+template <typename Func>
+static void run(const std::string &name,
+                size_t threadsCount,
+                size_t operations,
+                Func &&func)
+{
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < threadsCount; ++i)
+    {
+        threads.emplace_back([&func, operations]() {
+            for (size_t j = 0; j < operations; ++j)
+            {
+                func(j);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    auto total = static_cast<double>(operations * threadsCount);
+    std::cout << name << ", " << threadsCount << " threads: "
+              << static_cast<uint64_t>(total / elapsed.count())
+              << " ops/s, " << elapsed.count() * 1e9 / total << " ns/op"
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t operations = 1000000;
+    if (argc > 1)
+        operations = std::strtoull(argv[1], nullptr, 10);
+    trantor::EventLoopThread loopThread;
+    loopThread.run();
+    std::vector<double> boundaries{0.0001, 0.0005, 0.001, 0.005, 0.01,
+                                   0.05,   0.1,    0.5,   1,     5};
+    for (size_t threadsCount : {1, 8, 32})
+    {
+        auto histogram =
+            std::make_shared<Histogram>("latency",
+                                        std::vector<std::string>{},
+                                        std::vector<std::string>{},
+                                        boundaries,
+                                        std::chrono::seconds(60),
+                                        6,
+                                        loopThread.getLoop());
+        run("Histogram::observe()",
+            threadsCount,
+            operations,
+            [&histogram](size_t i) {
+                histogram->observe(static_cast<double>(i % 1000) * 0.001);
+            });
+        auto summary = std::make_shared<Summary>("latency",
+                                                 std::vector<std::string>{},
+                                                 std::vector<std::string>{});
+        run("Summary::observe()",
+            threadsCount,
+            operations,
+            [&summary](size_t i) {
+                summary->observe(static_cast<double>(i % 1000) * 0.001);
+            });
+        auto counter = std::make_shared<Counter>("requests",
+                                                 std::vector<std::string>{},
+                                                 std::vector<std::string>{});
+        run("Counter::increment()",
+            threadsCount,
+            operations,
+            [&counter](size_t) { counter->increment(); });
+    }
+    return 0;
+}
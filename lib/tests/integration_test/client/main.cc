@@ -829,6 +829,29 @@ void doTest(const HttpClientPtr &client, std::shared_ptr<test::Case> TEST_CTX)
                             CHECK(resp->getBody() == "01234567890123456789");
                         });
 
+    // Overlapping ranges are coalesced into one part
+    req = HttpRequest::newHttpRequest();
+    req->setPath("/range-test.txt");
+    req->addHeader("range", "bytes=20-29,0-9,5-14");
+    client->sendRequest(
+        req, [req, TEST_CTX](ReqResult result, const HttpResponsePtr &resp) {
+            REQUIRE(result == ReqResult::Ok);
+            CHECK(resp->getStatusCode() == k206PartialContent);
+            auto contentType = resp->getHeader("content-type");
+            REQUIRE(contentType.find("multipart/byteranges; boundary=") == 0);
+            auto boundary = contentType.substr(contentType.find('=') + 1);
+            CHECK(resp->getBody() ==
+                  "--" + boundary +
+                      "\r\nContent-Type: text/plain; charset=utf-8"
+                      "\r\nContent-Range: bytes 0-14/1000000\r\n\r\n"
+                      "012345678901234\r\n--" +
+                      boundary +
+                      "\r\nContent-Type: text/plain; charset=utf-8"
+                      "\r\nContent-Range: bytes 20-29/1000000\r\n\r\n"
+                      "0123456789\r\n--" +
+                      boundary + "--\r\n");
+        });
+
     // Using .. to access a upper directory should be permitted as long as
     // it never leaves the document root
     req = HttpRequest::newHttpRequest();
@@ -1207,6 +1230,37 @@ DROGON_TEST(HttpTest)
     doTest(client, TEST_CTX);
 }
 
+DROGON_TEST(ServerMetricsTest)
+{
+    auto client = HttpClient::newHttpClient("http://127.0.0.1:8848");
+    auto req = HttpRequest::newHttpRequest();
+    req->setPath("/");
+    client->sendRequest(
+        req,
+        [client, TEST_CTX](ReqResult result, const HttpResponsePtr &resp) {
+            REQUIRE(result == ReqResult::Ok);
+            REQUIRE(resp->getStatusCode() == k200OK);
+            auto req = HttpRequest::newHttpRequest();
+            req->setPath("/metrics");
+            client->sendRequest(req,
+                                [TEST_CTX](ReqResult result,
+                                           const HttpResponsePtr &resp) {
+                                    REQUIRE(result == ReqResult::Ok);
+                                    auto body = resp->getBody();
+                                    CHECK(body.find(
+                                              "drogon_http_requests_total{"
+                                              "route=\"/\",method=\"GET\","
+                                              "status=\"2xx\"}") !=
+                                          std::string_view::npos);
+                                    CHECK(body.find(
+                                              "drogon_http_handler_seconds_"
+                                              "count{route=\"/\","
+                                              "method=\"GET\"}") !=
+                                          std::string_view::npos);
+                                });
+        });
+}
+
 DROGON_TEST(HttpsTest)
 {
     if (!app().supportSSL())
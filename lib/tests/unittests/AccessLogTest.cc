@@ -0,0 +1,214 @@
+#include "../../lib/src/AccessLogFormat.h"
+#include "../../lib/src/AsyncAccessLogWriter.h"
+#include <drogon/drogon_test.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+using namespace drogon;
+using namespace drogon::plugin;
+
+DROGON_TEST(AccessLogFormatTest)
+{
+    auto items = parseAccessLogFormat("$method $url [$unknown] $http_host $");
+    REQUIRE(items.size() == 6);
+    CHECK(items[0].field == AccessLogField::Method);
+    CHECK(items[1].field == AccessLogField::Text);
+    CHECK(items[1].argument == " ");
+    CHECK(items[2].field == AccessLogField::Url);
+    // Unknown placeholders are kept as text.
+    CHECK(items[3].field == AccessLogField::Text);
+    CHECK(items[3].argument == " [$unknown] ");
+    CHECK(items[4].field == AccessLogField::RequestHeader);
+    CHECK(items[4].argument == "host");
+    CHECK(items[5].field == AccessLogField::Text);
+    CHECK(items[5].argument == " $\n");
+
+    items = parseAccessLogFormat("$status");
+    REQUIRE(items.size() == 2);
+    CHECK(items[1].argument == "\n");
+}
+
+DROGON_TEST(AccessLogDateFormatterTest)
+{
+    AccessLogDateFormatter formatter(false, true, "");
+    trantor::Date date(1700000000123456);
+    CHECK(formatter.format(date) == date.toFormattedString(true));
+    // The seconds are cached, only the microseconds change.
+    auto later = date.after(0.5);
+    CHECK(formatter.format(later) == later.toFormattedString(true));
+    auto nextSecond = date.after(1);
+    CHECK(formatter.format(nextSecond) == nextSecond.toFormattedString(true));
+
+    AccessLogDateFormatter customFormatter(false, false, "%Y-%m-%d %H:%M:%S");
+    CHECK(customFormatter.format(date) ==
+          date.toCustomFormattedString("%Y-%m-%d %H:%M:%S", false));
+}
+
+static AccessLogEntry newEntry()
+{
+    AccessLogEntry entry;
+    entry.date = 1700000000500000;
+    entry.requestDate = 1700000000250000;
+    entry.threadNumber = 7;
+    entry.requestLength = 0;
+    entry.responseLength = 1024;
+    entry.method = "GET";
+    entry.version = "HTTP/1.1";
+    entry.statusCode = 404;
+    return entry;
+}
+
+DROGON_TEST(AccessLogFormatterTest)
+{
+    AccessLogFormatContext context(AccessLogDateFormatter(false, true, ""));
+    auto format = "$method $url $status_code $body_bytes_sent "
+                  "$processing_time $http_user-agent";
+    auto entry = newEntry();
+    entry.texts = {"/a b", "x=1", "say \"hi\"\n"};
+
+    std::string line;
+    AccessLogFormatter text(parseAccessLogFormat(format),
+                            AccessLogFormatter::Style::Text);
+    text.format(entry, context, line);
+    CHECK(line == "GET /a b?x=1 404 1024 0.25 user-agent: say \"hi\"\n\n");
+
+    line.clear();
+    AccessLogFormatter json(parseAccessLogFormat(format),
+                            AccessLogFormatter::Style::Json);
+    json.format(entry, context, line);
+    CHECK(line ==
+          "{\"method\":\"GET\",\"url\":\"/a b?x=1\",\"status_code\":404,"
+          "\"body_bytes_sent\":1024,\"processing_time\":0.25,"
+          "\"http_user-agent\":\"say \\\"hi\\\"\\n\"}\n");
+
+    line.clear();
+    AccessLogFormatter logfmt(parseAccessLogFormat(format),
+                              AccessLogFormatter::Style::Logfmt);
+    logfmt.format(entry, context, line);
+    CHECK(line ==
+          "method=GET url=\"/a b?x=1\" status_code=404 body_bytes_sent=1024 "
+          "processing_time=0.25 http_user-agent=\"say \\\"hi\\\"\\n\"\n");
+
+    // Empty values are quoted in logfmt, missing ones are empty.
+    line.clear();
+    entry.texts = {"/", ""};
+    logfmt.format(entry, context, line);
+    CHECK(line == "method=GET url=/ status_code=404 body_bytes_sent=1024 "
+                  "processing_time=0.25 http_user-agent=\"\"\n");
+}
+
+DROGON_TEST(AccessLogProcessingTimeTest)
+{
+    AccessLogFormatContext context(AccessLogDateFormatter(false, true, ""));
+    AccessLogFormatter formatter(parseAccessLogFormat("$processing_time"),
+                                 AccessLogFormatter::Style::Text);
+    auto entry = newEntry();
+    // The same output as streaming the seconds as a double.
+    for (int64_t duration : {0LL,
+                             15LL,
+                             99LL,
+                             100LL,
+                             250000LL,
+                             1000000LL,
+                             1234567LL,
+                             999999999999LL,
+                             1000000000000LL,
+                             1234567890123LL,
+                             -15LL,
+                             -250000LL})
+    {
+        entry.date = entry.requestDate + duration;
+        std::string line;
+        formatter.format(entry, context, line);
+        char expected[32];
+        snprintf(expected,
+                 sizeof(expected),
+                 "%.12g\n",
+                 static_cast<double>(duration) / 1000000.0);
+        CHECK(line == expected);
+    }
+}
+
+DROGON_TEST(AsyncAccessLogWriterTest)
+{
+    std::mutex mutex;
+    std::string output;
+    AsyncAccessLogWriter writer(
+        std::make_shared<AccessLogFormatter>(
+            parseAccessLogFormat("$method $url $status_code $http_x-id"),
+            AccessLogFormatter::Style::Text),
+        1024,
+        false,
+        AccessLogDateFormatter(false, true, ""),
+        [&mutex, &output](const std::string &lines) {
+            std::lock_guard<std::mutex> lock(mutex);
+            output.append(lines);
+        });
+    auto req = HttpRequest::newHttpRequest();
+    req->setMethod(Post);
+    req->setPath("/api/items");
+    req->addHeader("x-id", "42");
+    auto resp = HttpResponse::newHttpResponse();
+    resp->setStatusCode(k201Created);
+    for (int i = 0; i < 100; ++i)
+    {
+        writer.push(req, resp);
+    }
+    writer.stop();
+    CHECK(writer.droppedCount() == 0);
+    CHECK(std::count(output.begin(), output.end(), '\n') == 100);
+    CHECK(output.find("POST /api/items 201 x-id: 42\n") == 0);
+}
+
+DROGON_TEST(AsyncAccessLogWriterThreadsTest)
+{
+    std::mutex mutex;
+    std::string output;
+    auto makeWriter = [&mutex, &output]() {
+        return std::make_unique<AsyncAccessLogWriter>(
+            std::make_shared<AccessLogFormatter>(
+                parseAccessLogFormat("$method"),
+                AccessLogFormatter::Style::Text),
+            1024,
+            false,
+            AccessLogDateFormatter(false, true, ""),
+            [&mutex, &output](const std::string &lines) {
+                std::lock_guard<std::mutex> lock(mutex);
+                output.append(lines);
+            });
+    };
+    auto first = makeWriter();
+    auto second = makeWriter();
+    auto req = HttpRequest::newHttpRequest();
+    auto resp = HttpResponse::newHttpResponse();
+    // The rings of a thread are kept for each writer.
+    for (int i = 0; i < 100; ++i)
+    {
+        first->push(req, resp);
+        second->push(req, resp);
+    }
+    // The lines of exited threads are still written.
+    for (int i = 0; i < 10; ++i)
+    {
+        std::thread([&first, &req, &resp]() {
+            for (int j = 0; j < 10; ++j)
+            {
+                first->push(req, resp);
+            }
+        }).join();
+    }
+    first->stop();
+    second->stop();
+    CHECK(first->droppedCount() == 0);
+    CHECK(second->droppedCount() == 0);
+    CHECK(std::count(output.begin(), output.end(), '\n') == 300);
+    // The rings of the stopped writers are dropped when the thread switches
+    // to a new writer.
+    first.reset();
+    auto third = makeWriter();
+    third->push(req, resp);
+    third->stop();
+    CHECK(std::count(output.begin(), output.end(), '\n') == 301);
+}
@@ -0,0 +1,145 @@
+#include <drogon/drogon_test.h>
+#include <drogon/utils/monitoring/Counter.h>
+#include <drogon/utils/monitoring/Gauge.h>
+#include <drogon/utils/monitoring/Histogram.h>
+#include <drogon/utils/monitoring/Summary.h>
+#include <cmath>
+#include <trantor/net/EventLoopThread.h>
+#include <thread>
+
+using namespace drogon::monitoring;
+
+DROGON_TEST(CounterTest)
+{
+    auto counter = std::make_shared<Counter>("requests_total",
+                                             std::vector<std::string>{},
+                                             std::vector<std::string>{});
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([counter]() {
+            for (int j = 0; j < 1000; ++j)
+            {
+                counter->increment();
+                counter->increment(0.5);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    auto samples = counter->collect();
+    REQUIRE(samples.size() == 1);
+    CHECK(samples[0].value == 12000);
+    counter->reset();
+    CHECK(counter->collect()[0].value == 0);
+}
+
+DROGON_TEST(GaugeTest)
+{
+    Gauge gauge("connections", {}, {});
+    gauge.set(3);
+    gauge.increment();
+    gauge.increment(2);
+    gauge.decrement();
+    gauge.decrement(0.5);
+    CHECK(gauge.collect()[0].value == 4.5);
+    gauge.reset();
+    CHECK(gauge.collect()[0].value == 0);
+}
+
+DROGON_TEST(HistogramTest)
+{
+    trantor::EventLoopThread loopThread;
+    loopThread.run();
+    auto histogram =
+        std::make_shared<Histogram>("latency",
+                                    std::vector<std::string>{},
+                                    std::vector<std::string>{},
+                                    std::vector<double>{1, 2, 5},
+                                    std::chrono::seconds(0),
+                                    0,
+                                    loopThread.getLoop());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([histogram]() {
+            // One value in each bucket, two of them on the bounds.
+            for (int j = 0; j < 1000; ++j)
+            {
+                histogram->observe(0.5);
+                histogram->observe(2);
+                histogram->observe(5);
+                histogram->observe(10);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    auto samples = histogram->collect();
+    REQUIRE(samples.size() == 6);
+    CHECK(samples[0].exLabels[0].second == std::to_string(1.0));
+    CHECK(samples[0].value == 8000);
+    CHECK(samples[1].value == 16000);
+    CHECK(samples[2].value == 24000);
+    CHECK(samples[3].exLabels[0].second == "+Inf");
+    CHECK(samples[3].value == 32000);
+    CHECK(samples[4].name == "latency_sum");
+    CHECK(samples[4].value == 8000 * 17.5);
+    CHECK(samples[5].name == "latency_count");
+    CHECK(samples[5].value == 32000);
+}
+
+DROGON_TEST(SummaryTest)
+{
+    auto summary = std::make_shared<Summary>("latency",
+                                             std::vector<std::string>{},
+                                             std::vector<std::string>{},
+                                             std::vector<double>{0.5, 0.99},
+                                             0.01);
+    CHECK(std::isnan(summary->quantile(0.5)));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([summary]() {
+            // 50 us to 5 s
+            for (int j = 1; j <= 1000; ++j)
+            {
+                summary->observe(0.00005 * j * j * 0.1);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    CHECK(summary->count() == 8000);
+    auto withinAccuracy = [](double estimate, double exact) {
+        return std::abs(estimate - exact) <= exact * 0.01 + 1e-12;
+    };
+    CHECK(withinAccuracy(summary->quantile(0.5), 0.00005 * 500 * 500 * 0.1));
+    CHECK(withinAccuracy(summary->quantile(0.99), 0.00005 * 990 * 990 * 0.1));
+    CHECK(withinAccuracy(summary->quantile(1), 5));
+    auto samples = summary->collect();
+    REQUIRE(samples.size() == 4);
+    CHECK(samples[0].name == "latency");
+    CHECK(samples[0].exLabels[0].first == "quantile");
+    CHECK(samples[0].exLabels[0].second == std::to_string(0.5));
+    CHECK(samples[1].value == summary->quantile(0.99));
+    CHECK(samples[2].name == "latency_sum");
+    CHECK(samples[3].name == "latency_count");
+    CHECK(samples[3].value == 8000);
+
+    // Values out of the range are clamped.
+    Summary other("latency", {}, {}, {0.5}, 0.01);
+    other.observe(0);
+    other.observe(1e6);
+    CHECK(other.quantile(0) == 0);
+    CHECK(other.quantile(1) == 1e4);
+    summary->merge(other);
+    CHECK(summary->count() == 8002);
+    CHECK(summary->quantile(1) == 1e4);
+
+    Summary coarse("latency", {}, {}, {0.5}, 0.05);
+    CHECK_THROWS(summary->merge(coarse));
+    CHECK_THROWS(Summary("latency", {}, {}, {1.5}));
+    summary->reset();
+    CHECK(summary->count() == 0);
+}
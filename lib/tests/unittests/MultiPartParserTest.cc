@@ -130,3 +130,58 @@ DROGON_TEST(MultiPartStreamParser)
     check(7);
     check(20);
 }
+
+DROGON_TEST(MultiPartStreamParserBoundaryInContent)
+{
+    // A long boundary, so that the search skips bytes of the content.
+    static const std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    static const std::string ct =
+        "multipart/form-data; boundary=\"" + boundary + "\"";
+    // Parts of the boundary, and bytes of it at every offset of the search
+    // window.
+    std::string content = "\r\n--" + boundary.substr(0, 20) + "\r\n-\r";
+    for (size_t i = 0; i < boundary.size(); ++i)
+    {
+        content.append(i, 'x');
+        content.append("\r\n--").append(boundary, 0, i);
+        content.append(boundary, i + 1, std::string::npos);
+    }
+    content.append("--").append(boundary).append("\r");
+    const std::string data = "--" + boundary +
+                             "\r\n"
+                             "Content-Disposition: form-data; name=\"key1\"; "
+                             "filename=\"file1\"\r\n"
+                             "\r\n" +
+                             content + "\r\n--" + boundary +
+                             "\r\n"
+                             "Content-Disposition: form-data; name=\"key2\"\r\n"
+                             "\r\n"
+                             "value2\r\n--" +
+                             boundary + "--";
+
+    for (size_t step : {1, 5, 40, 1000})
+    {
+        drogon::MultipartStreamParser parser(ct);
+        std::vector<std::string> names;
+        std::vector<std::string> values;
+        auto headerCb = [&names, &values](drogon::MultipartHeader hdr) {
+            names.push_back(hdr.name);
+            values.emplace_back();
+        };
+        auto dataCb = [&values](const char *data, size_t length) {
+            values.back().append(data, length);
+        };
+        for (size_t i = 0; i < data.length() && parser.isValid(); i += step)
+        {
+            auto length = (std::min)(step, data.length() - i);
+            parser.parse(data.data() + i, length, headerCb, dataCb);
+        }
+        CHECK(parser.isValid());
+        CHECK(parser.isFinished());
+        MANDATE(names.size() == 2);
+        CHECK(names[0] == "key1");
+        CHECK(values[0] == content);
+        CHECK(names[1] == "key2");
+        CHECK(values[1] == "value2");
+    }
+}
@@ -0,0 +1,155 @@
+#include "../../lib/src/CacheFile.h"
+#include "../../lib/src/HttpFileImpl.h"
+#include "../../lib/src/MultipartUploadWriter.h"
+#include <drogon/drogon.h>
+#include <drogon/drogon_test.h>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
+
+using namespace drogon;
+
+static std::string readFile(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void waitForWriting(CacheFile &file)
+{
+    std::promise<void> written;
+    file.whenWritten([&written]() { written.set_value(); });
+    written.get_future().wait();
+}
+
+// Larger than a few write chunks, with a pattern to check the order.
+static std::string makeContent(size_t length)
+{
+    std::string content;
+    content.reserve(length);
+    for (size_t i = 0; content.size() < length; ++i)
+    {
+        content.append(std::to_string(i)).append(1, ',');
+    }
+    content.resize(length);
+    return content;
+}
+
+DROGON_TEST(CacheFileTest)
+{
+    auto dir = std::filesystem::current_path() / "test_cache_file_dir";
+    std::filesystem::create_directories(dir);
+    auto content = makeContent(1500 * 1000);
+
+    auto path = dir / "cache";
+    auto movedPath = dir / "moved";
+    {
+        CacheFile file(path.string());
+        REQUIRE(file.isOpen());
+        for (size_t i = 0; i < content.size(); i += 1000)
+        {
+            file.append(content.data() + i, 1000);
+        }
+        waitForWriting(file);
+        CHECK(file.getStringView() == content);
+        CHECK(file.moveTo(movedPath));
+        CHECK(!std::filesystem::exists(path));
+        // The file can't be moved twice.
+        CHECK(!file.moveTo(dir / "other"));
+        CHECK(file.getStringView() == content);
+    }
+    // Moved files are not deleted.
+    CHECK(readFile(movedPath) == content);
+
+    {
+        // The file is deleted by the file IO thread if chunks are still being
+        // written.
+        CacheFile file(path.string());
+        file.append(content);
+    }
+    for (int i = 0; i < 100 && std::filesystem::exists(path); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(!std::filesystem::exists(path));
+
+    std::filesystem::remove_all(dir);
+}
+
+DROGON_TEST(HttpFileSaveByRenaming)
+{
+    auto dir = std::filesystem::current_path() / "test_cache_file_dir";
+    std::filesystem::create_directories(dir);
+    auto path = dir / "cache";
+    auto cacheFilePtr = std::make_shared<CacheFile>(path.string());
+    REQUIRE(cacheFilePtr->isOpen());
+    cacheFilePtr->append("Hello; World");
+
+    HttpFileImpl file;
+    file.setFileName("test_file_name");
+    file.setCacheFile(cacheFilePtr);
+    CHECK(file.fileContent() == "Hello; World");
+    CHECK(file.saveAs((dir / "saved").string()) == 0);
+    // The temporary file is renamed instead of copied.
+    CHECK(!std::filesystem::exists(path));
+    CHECK(readFile(dir / "saved") == "Hello; World");
+    // The content is copied when the file is saved again.
+    CHECK(file.saveAs((dir / "copy").string()) == 0);
+    CHECK(readFile(dir / "copy") == "Hello; World");
+
+    std::filesystem::remove_all(dir);
+}
+
+DROGON_TEST(MultipartUploadWriterTest)
+{
+    auto &uploadPath = app().getUploadPath();
+    for (int i = 0; i < 256; ++i)
+    {
+        char dirName[4];
+        snprintf(dirName, sizeof(dirName), "%02X", i);
+        std::filesystem::create_directories(uploadPath + "/tmp/" + dirName);
+    }
+    auto content = makeContent(300 * 1000);
+    const std::string body =
+        "--12345\r\n"
+        "Content-Disposition: form-data; name=\"key1\"; filename=\"file1\"\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n" +
+        content +
+        "\r\n--12345\r\n"
+        "Content-Disposition: form-data; name=\"key2\"\r\n"
+        "\r\n"
+        "value2\r\n"
+        "--12345--";
+
+    MultipartUploadWriter writer("multipart/form-data; boundary=\"12345\"");
+    REQUIRE(writer.isValid());
+    for (size_t i = 0; i < body.size(); i += 4096)
+    {
+        auto length = (std::min)(body.size() - i, size_t(4096));
+        writer.append(body.data() + i, length);
+    }
+    CHECK(writer.isValid());
+    CHECK(writer.isFinished());
+    CHECK(writer.parameters().size() == 1);
+    CHECK(writer.parameters().at("key2") == "value2");
+    MANDATE(writer.files().size() == 1);
+
+    std::promise<void> written;
+    writer.whenWritten([&written]() { written.set_value(); });
+    written.get_future().wait();
+    auto &file = *writer.files()[0];
+    CHECK(file.getItemName() == "key1");
+    CHECK(file.getFileName() == "file1");
+    CHECK(file.getContentType() == CT_TEXT_PLAIN);
+    CHECK(file.fileContent() == content);
+
+    auto dir = std::filesystem::current_path() / "test_uploads_dir";
+    CHECK(file.save(dir.string()) == 0);
+    CHECK(readFile(dir / "file1") == content);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,123 @@
+#include "../../lib/src/RateLimiterTable.h"
+#include <drogon/drogon_test.h>
+
+using namespace drogon;
+
+static constexpr int64_t kSecond = 1000000;
+
+DROGON_TEST(RateLimiterTableKeyTest)
+{
+    auto v4 = RateLimiterTable::makeKey(trantor::InetAddress("10.0.0.1", 80));
+    CHECK(v4 == RateLimiterTable::makeKey(trantor::InetAddress("10.0.0.1", 0)));
+    CHECK(!(v4 ==
+            RateLimiterTable::makeKey(trantor::InetAddress("10.0.0.2", 80))));
+    // IPv4 addresses are mapped into IPv6 addresses.
+    CHECK(v4 == RateLimiterTable::makeKey(
+                    trantor::InetAddress("::ffff:10.0.0.1", 80, true)));
+    CHECK(RateLimiterTable::makeKey("alice") ==
+          RateLimiterTable::makeKey("alice"));
+    CHECK(!(RateLimiterTable::makeKey("alice") ==
+            RateLimiterTable::makeKey("bob")));
+}
+
+DROGON_TEST(RateLimiterTableAlgorithmTest)
+{
+    auto key = RateLimiterTable::makeKey("user");
+    auto other = RateLimiterTable::makeKey("other");
+    int64_t start = 100 * kSecond;
+
+    RateLimiterTable fixedWindow(
+        RateLimiterType::kFixedWindow, 3, std::chrono::seconds(1), 64, true);
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(fixedWindow.isAllowed(key, start + i));
+    }
+    CHECK(!fixedWindow.isAllowed(key, start + 10));
+    // The clients are limited separately.
+    CHECK(fixedWindow.isAllowed(other, start + 10));
+    CHECK(fixedWindow.isAllowed(key, start + kSecond));
+
+    RateLimiterTable tokenBucket(
+        RateLimiterType::kTokenBucket, 4, std::chrono::seconds(1), 64, true);
+    // Like the TokenBucketRateLimiter, a request needs more than one token.
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(tokenBucket.isAllowed(key, start));
+    }
+    CHECK(!tokenBucket.isAllowed(key, start));
+    // Half a second refills two tokens.
+    CHECK(tokenBucket.isAllowed(key, start + kSecond / 2));
+    CHECK(tokenBucket.isAllowed(key, start + kSecond / 2));
+    CHECK(!tokenBucket.isAllowed(key, start + kSecond / 2));
+
+    RateLimiterTable slidingWindow(
+        RateLimiterType::kSlidingWindow, 4, std::chrono::seconds(1), 64, true);
+    for (int i = 0; i < 4; ++i)
+    {
+        CHECK(slidingWindow.isAllowed(key, start));
+    }
+    CHECK(!slidingWindow.isAllowed(key, start + kSecond / 2));
+    // A quarter of the previous window is still counted.
+    auto later = start + kSecond + 3 * kSecond / 4;
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(slidingWindow.isAllowed(key, later));
+    }
+    CHECK(!slidingWindow.isAllowed(key, later));
+    // Two windows later, nothing is counted.
+    for (int i = 0; i < 4; ++i)
+    {
+        CHECK(slidingWindow.isAllowed(key, start + 4 * kSecond));
+    }
+}
+
+DROGON_TEST(RateLimiterTableEvictionTest)
+{
+    RateLimiterTable table(
+        RateLimiterType::kFixedWindow, 1, std::chrono::seconds(1), 16, false);
+    REQUIRE(table.capacity() == 16);
+    int64_t now = 100 * kSecond;
+    auto first = RateLimiterTable::makeKey("0");
+    CHECK(table.isAllowed(first, now));
+    CHECK(!table.isAllowed(first, now));
+    for (int i = 1; i < 16; ++i)
+    {
+        CHECK(table.isAllowed(RateLimiterTable::makeKey(std::to_string(i)),
+                              now + i));
+    }
+    CHECK(table.evictedCount() == 0);
+    // The table is full, the least recently updated client is dropped.
+    CHECK(table.isAllowed(RateLimiterTable::makeKey("16"), now + 16));
+    CHECK(table.evictedCount() == 1);
+    CHECK(table.isAllowed(first, now + 17));
+    CHECK(table.evictedCount() == 2);
+
+    // Limiters back to their initial state are replaced without counting
+    // them as evicted.
+    for (int i = 20; i < 36; ++i)
+    {
+        CHECK(table.isAllowed(RateLimiterTable::makeKey(std::to_string(i)),
+                              now + 2 * kSecond));
+    }
+    CHECK(table.evictedCount() == 2);
+}
+
+DROGON_TEST(RateLimiterTableGrowthTest)
+{
+    RateLimiterTable table(
+        RateLimiterType::kFixedWindow, 1, std::chrono::seconds(1), 4096, false);
+    REQUIRE(table.capacity() == 4096);
+    int64_t now = 100 * kSecond;
+    // The shards start small and grow instead of dropping limiters in use.
+    for (int i = 0; i < 1000; ++i)
+    {
+        CHECK(table.isAllowed(RateLimiterTable::makeKey(std::to_string(i)),
+                              now));
+    }
+    CHECK(table.evictedCount() == 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        CHECK(!table.isAllowed(RateLimiterTable::makeKey(std::to_string(i)),
+                               now));
+    }
+}
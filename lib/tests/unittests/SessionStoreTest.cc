@@ -0,0 +1,77 @@
+#include <drogon/SessionStore.h>
+#include <drogon/drogon_test.h>
+#include <json/json.h>
+#include <string>
+
+namespace
+{
+// Expose the helpers of SessionStore to the test.
+class TestSessionStore : public drogon::SessionStore
+{
+  public:
+    using SessionStore::checkDirty;
+    using SessionStore::decodeSession;
+    using SessionStore::encodeSession;
+    using SessionStore::newSession;
+
+    drogon::SessionPtr findSession(const std::string &, bool) override
+    {
+        return nullptr;
+    }
+
+    void loadSession(const std::string &, SessionCallback &&) override
+    {
+    }
+
+    void saveSession(const drogon::SessionPtr &) override
+    {
+    }
+
+    void changeSessionId(const drogon::SessionPtr &,
+                         const std::string &) override
+    {
+    }
+};
+}  // namespace
+
+DROGON_TEST(SessionStoreTest)
+{
+    auto session = TestSessionStore::newSession("id", false);
+    CHECK(TestSessionStore::checkDirty(session) == false);
+    session->insert("name", std::string("drogon"));
+    session->insert("literal", "text");
+    session->insert("flag", true);
+    session->insert("count", -42);
+    session->insert("size", static_cast<unsigned long long>(1) << 40);
+    session->insert("ratio", 0.25);
+    Json::Value json;
+    json["a"] = 1;
+    session->insert("json", json);
+    CHECK(TestSessionStore::checkDirty(session) == true);
+    CHECK(TestSessionStore::checkDirty(session) == false);
+    session->modify<int>("count", [](int &count) { ++count; });
+    CHECK(TestSessionStore::checkDirty(session) == true);
+    // Reading data doesn't mark the session
+    CHECK(session->get<int>("count") == -41);
+    CHECK(TestSessionStore::checkDirty(session) == false);
+
+    auto data = TestSessionStore::encodeSession(session);
+    auto loaded = TestSessionStore::newSession("id", false);
+    REQUIRE(TestSessionStore::decodeSession(loaded, data));
+    CHECK(TestSessionStore::checkDirty(loaded) == false);
+    CHECK(loaded->get<std::string>("name") == "drogon");
+    CHECK(loaded->get<std::string>("literal") == "text");
+    CHECK(loaded->get<bool>("flag") == true);
+    CHECK(loaded->get<int>("count") == -41);
+    CHECK(loaded->get<unsigned long long>("size") ==
+          static_cast<unsigned long long>(1) << 40);
+    CHECK(loaded->get<double>("ratio") == 0.25);
+    CHECK(loaded->get<Json::Value>("json")["a"].asInt() == 1);
+
+    // Malformed data doesn't change the session
+    CHECK(TestSessionStore::decodeSession(loaded,
+                                          data.substr(0, data.size() - 1)) ==
+          false);
+    CHECK(TestSessionStore::decodeSession(loaded, "") == false);
+    CHECK(loaded->get<std::string>("name") == "drogon");
+}
@@ -0,0 +1,96 @@
+#include "../../orm_lib/src/CachedDbClientImpl.h"
+#include "../../orm_lib/src/ReadWriteSplitClient.h"
+#include "../../orm_lib/src/SqlTokenizer.h"
+#include <drogon/drogon_test.h>
+
+using namespace drogon::orm;
+
+DROGON_TEST(SqlTokenizerTest)
+{
+    auto tokens = tokenizeSql(
+        "SELECT \"For\", 'it''s', E'\\'', $$ update $$, $1 -- into\n"
+        "FROM public.\"My Table\" /* for /* nested */ update */");
+    REQUIRE(tokens.size() == 12);
+    CHECK(tokens[0].isWord("select"));
+    CHECK(tokens[1].type_ == SqlToken::Type::QuotedName);
+    CHECK(tokens[1].text_ == "For");
+    CHECK(tokens[2].isSymbol(','));
+    CHECK(tokens[3].type_ == SqlToken::Type::Literal);
+    CHECK(tokens[5].type_ == SqlToken::Type::Literal);
+    CHECK(tokens[7].type_ == SqlToken::Type::Literal);
+    CHECK(tokens[9].type_ == SqlToken::Type::Literal);
+    CHECK(tokens[10].isWord("from"));
+    CHECK(tokens[11].type_ == SqlToken::Type::QuotedName);
+    CHECK(tokens[11].text_ == "My Table");
+}
+
+DROGON_TEST(ReadOnlySqlTest)
+{
+    const std::pair<const char *, bool> statements[] = {
+        {"select 1", true},
+        {"  SELECT * FROM users WHERE id = $1", true},
+        {"(select a from t) union (select a from u)", true},
+        {"select updated_at from users", true},
+        {"select * from shares", true},
+        {"select block_id from blocks", true},
+        {"select clock_timestamp()", true},
+        {"select * from notes where note = 'into'", true},
+        {"select \"into\", \"for\" from t", true},
+        {"select 1 -- for update", true},
+        {"select 1 /* nextval('s') */", true},
+        {"select * from t where x in (select y from u)", true},
+        {"select key from t for update", false},
+        {"select * from t FOR NO KEY UPDATE", false},
+        {"select * from t for share", false},
+        {"select * from t for key share", false},
+        {"select * from t lock in share mode", false},
+        {"select * into t2 from t", false},
+        {"select nextval('seq')", false},
+        {"select pg_catalog.setval('seq', 1)", false},
+        {"select pg_advisory_lock(1)", false},
+        {"select last_insert_rowid()", false},
+        {"SELECT changes(), total_changes()", false},
+        {"select currval('seq')", false},
+        {"select lastval()", false},
+        {"select LAST_INSERT_ID()", false},
+        {"select changes from t", true},
+        {"insert into t values (1)", false},
+        {"update t set a = 1", false},
+        {"with t as (delete from u returning *) select * from t", false},
+        {"selectx from t", false},
+        {"/* replica */ with t as (select 1) select * from t", true},
+        {"/*primary*/ select 1", false},
+    };
+    for (auto &[sql, readOnly] : statements)
+    {
+        CHECK(ReadWriteSplitClient::isReadOnlySql(sql) == readOnly);
+    }
+}
+
+DROGON_TEST(TablesOfSqlTest)
+{
+    using Tables = std::vector<std::string>;
+    const std::pair<const char *, Tables> statements[] = {
+        {"select updated_at from public.Users u where u.id = $1", {"users"}},
+        {"select * from a, b as bb, \"C\"", {"a", "b", "c"}},
+        {"select * from a join b on a.id = b.id left join c using (id)",
+         {"a", "b", "c"}},
+        {"select * from (a join b on a.id = b.id)", {"a", "b"}},
+        {"select * from ((a join b on a.x = b.x) join c on b.y = c.y), d",
+         {"a", "b", "c", "d"}},
+        {"select * from a join (b join c on b.x = c.x) on a.y = b.y",
+         {"a", "b", "c"}},
+        {"select * from (select * from a) s join b on s.x = b.x", {"a", "b"}},
+        {"select * from generate_series(1, 10)", {}},
+        {"select * from t where note = 'from x'", {"t"}},
+        {"select * from t for update of t skip locked", {"t"}},
+        {"insert into t (a) values (1)", {"t"}},
+        {"update only t set a = 1", {"t"}},
+        {"delete from t where a in (select a from u)", {"t", "u"}},
+        {"truncate table t", {"t"}},
+    };
+    for (auto &[sql, tables] : statements)
+    {
+        CHECK(CachedDbClientImpl::tablesOf(sql) == tables);
+    }
+}
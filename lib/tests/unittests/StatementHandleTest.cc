@@ -0,0 +1,100 @@
+#include "../../orm_lib/src/DbConnection.h"
+#include <drogon/drogon_test.h>
+
+using namespace drogon::orm;
+
+namespace
+{
+// A connection that runs its statements until complete() is called
+class FakeConnection : public DbConnection
+{
+  public:
+    FakeConnection() : DbConnection(nullptr)
+    {
+    }
+
+    void execSql(std::string_view &&,
+                 size_t,
+                 std::vector<const char *> &&,
+                 std::vector<int> &&,
+                 std::vector<int> &&,
+                 ResultCallback &&,
+                 std::function<void(const std::exception_ptr &)> &&) override
+    {
+        isWorking_ = true;
+        startStatement();
+    }
+
+    void batchSql(std::deque<std::shared_ptr<SqlCmd>> &&) override
+    {
+    }
+
+    void disconnect() override
+    {
+    }
+
+    void cancel(uint64_t statementId) override
+    {
+        if (isWorking_ && isRunning(statementId))
+            cancelled_.push_back(statementId);
+    }
+
+    void complete()
+    {
+        isWorking_ = false;
+        finishStatement();
+    }
+
+    std::vector<uint64_t> cancelled_;
+};
+
+void run(const std::shared_ptr<FakeConnection> &conn, StatementHandle &handle)
+{
+    handle.send(conn);
+    conn->execSql("select 1",
+                  0,
+                  {},
+                  {},
+                  {},
+                  [](const Result &) {},
+                  [](const std::exception_ptr &) {});
+}
+}  // namespace
+
+DROGON_TEST(StatementHandleTest)
+{
+    auto conn = std::make_shared<FakeConnection>();
+
+    // A timeout or a CancelToken after the result doesn't cancel the next
+    // statement.
+    StatementHandle first;
+    run(conn, first);
+    conn->complete();
+    first.finish();
+    StatementHandle second;
+    run(conn, second);
+    first.cancel();
+    CHECK(conn->cancelled_.empty());
+
+    // Neither does a cancel that comes before the result is delivered to the
+    // handle.
+    conn->complete();
+    StatementHandle third;
+    run(conn, third);
+    second.cancel();
+    CHECK(conn->cancelled_.empty());
+
+    third.cancel();
+    REQUIRE(conn->cancelled_.size() == 1);
+    CHECK(conn->cancelled_[0] == 3u);
+    conn->complete();
+
+    // The connection is idle.
+    conn->cancel(3);
+    CHECK(conn->cancelled_.size() == 1);
+
+    // A cancelled statement isn't sent.
+    StatementHandle fourth;
+    fourth.cancel();
+    CHECK(!fourth.send(conn));
+}
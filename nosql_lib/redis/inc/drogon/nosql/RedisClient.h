@@ -23,6 +23,7 @@
 #include <memory>
 #include <functional>
 #include <future>
+#include <vector>
 #ifdef __cpp_impl_coroutine
 #include <drogon/utils/coroutine.h>
 #endif
@@ -31,6 +32,9 @@ namespace drogon
 {
 namespace nosql
 {
+using RedisBatchCallback =
+    std::function<void(const std::vector<RedisResult> &)>;
+
 #ifdef __cpp_impl_coroutine
 class RedisClient;
 class RedisTransaction;
@@ -65,6 +69,35 @@ struct [[nodiscard]] RedisAwaiter : public CallbackAwaiter<RedisResult>
     RedisFunction function_;
 };
 
+struct [[nodiscard]] RedisBatchAwaiter
+    : public CallbackAwaiter<std::vector<RedisResult>>
+{
+    using BatchFunction =
+        std::function<void(RedisBatchCallback &&, RedisExceptionCallback &&)>;
+
+    explicit RedisBatchAwaiter(BatchFunction &&function)
+        : function_(std::move(function))
+    {
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        function_(
+            [handle, this](const std::vector<RedisResult> &results) {
+                this->setValue(results);
+                handle.resume();
+            },
+            [handle, this](const RedisException &e) {
+                LOG_ERROR << e.what();
+                this->setException(std::make_exception_ptr(e));
+                handle.resume();
+            });
+    }
+
+  private:
+    BatchFunction function_;
+};
+
 struct [[nodiscard]] RedisTransactionAwaiter
     : public CallbackAwaiter<std::shared_ptr<RedisTransaction>>
 {
@@ -82,6 +115,81 @@ struct [[nodiscard]] RedisTransactionAwaiter
 
 class RedisTransaction;
 
+/**
+ * @brief This class represents a batch of redis commands. The commands are
+ * formatted into one buffer, written to one connection at once and their
+ * replies are returned together.
+ */
+class DROGON_EXPORT RedisBatch
+{
+  public:
+    /**
+     * @brief Add a command to the batch.
+     *
+     * @param command The command, it can contain the same placeholders as the
+     * command of RedisClient::execCommandAsync().
+     * @param ... The command parameters.
+     * @note A RedisException with the kInternalError code is thrown if the
+     * command can't be formatted.
+     */
+    virtual void addCommand(std::string_view command, ...) noexcept(false) = 0;
+
+    /**
+     * @brief Return the number of commands in the batch.
+     */
+    virtual size_t size() const noexcept = 0;
+
+    /**
+     * @brief Send the commands of the batch, a batch can be executed once.
+     *
+     * @param resultCallback The callback is called with the replies, in the
+     * order of the commands. A command that fails on the server gets a reply
+     * of the kError type, it doesn't fail the other commands.
+     * @param exceptionCallback The callback is called if the replies can't be
+     * received, for example when the connection is broken or the execution
+     * times out.
+     * For example:
+     * @code
+       auto batch = redisClientPtr->newBatch();
+       for (auto &key : keys)
+       {
+           batch->addCommand("get %s", key.data());
+       }
+       batch->execute([](const std::vector<RedisResult> &results) {
+           ...
+       }, [](const RedisException &err) {
+           std::cerr << err.what() << std::endl;
+       });
+       @endcode
+     * @note The results share the replies of the batch, they can be kept
+     * after the callback returns.
+     */
+    virtual void execute(RedisBatchCallback &&resultCallback,
+                         RedisExceptionCallback &&exceptionCallback) = 0;
+
+#ifdef __cpp_impl_coroutine
+    /**
+     * @brief Send the commands of the batch and await the replies in a
+     * coroutine.
+     *
+     * @return internal::RedisBatchAwaiter that can be awaited in a coroutine.
+     * @note The results keep the replies of the batch, so they are valid after
+     * the coroutine is suspended again.
+     */
+    internal::RedisBatchAwaiter executeCoro()
+    {
+        return internal::RedisBatchAwaiter(
+            [this](RedisBatchCallback &&resultCallback,
+                   RedisExceptionCallback &&exceptionCallback) {
+                execute(std::move(resultCallback),
+                        std::move(exceptionCallback));
+            });
+    }
+#endif
+
+    virtual ~RedisBatch() = default;
+};
+
 /**
  * @brief This class represents a redis client that contains several connections
  * to a redis server.
@@ -105,6 +213,29 @@ class DROGON_EXPORT RedisClient
         const std::string &password = "",
         unsigned int db = 0,
         const std::string &username = "");
+
+    /**
+     * @brief Create a new client of a redis cluster.
+     *
+     * @param seedNodes The addresses of some nodes of the cluster, the other
+     * nodes are discovered with the CLUSTER SLOTS command.
+     * @param connectionsPerNode The number of connections to each master.
+     * @param password The password to authenticate if necessary.
+     * @param username The username to authenticate if necessary.
+     * @return std::shared_ptr<RedisClient>
+     * @note Commands are sent to the master that owns the slot of their keys,
+     * MOVED and ASK redirections are followed and the slot map is refreshed
+     * when the cluster changes. MGET, MSET, DEL, UNLINK, EXISTS and TOUCH
+     * are split per slot, other commands whose keys are in different slots
+     * fail with a CROSSSLOT error. Transactions are not supported, and
+     * commands without keys are sent to any master.
+     */
+    static std::shared_ptr<RedisClient> newRedisClusterClient(
+        const std::vector<trantor::InetAddress> &seedNodes,
+        size_t connectionsPerNode = 1,
+        const std::string &password = "",
+        const std::string &username = "");
+
     /**
      * @brief Execute a redis command
      *
@@ -209,6 +340,20 @@ class DROGON_EXPORT RedisClient
      */
     virtual std::shared_ptr<RedisSubscriber> newSubscriber() noexcept = 0;
 
+    /**
+     * @brief Create a batch of commands, see RedisBatch.
+     *
+     * @return std::shared_ptr<RedisBatch>
+     * @note All the commands of a batch are sent to one connection, unlike the
+     * same number of execCommandAsync() calls. A null pointer is returned if
+     * batches are not supported by this client.
+     */
+    virtual std::shared_ptr<RedisBatch> newBatch() noexcept
+    {
+        LOG_ERROR << "Batches are not supported by this client";
+        return nullptr;
+    }
+
     /**
      * @brief Create a redis transaction object.
      *
@@ -241,6 +386,32 @@ class DROGON_EXPORT RedisClient
      */
     virtual void setTimeout(double timeout) = 0;
 
+    /**
+     * @brief Cache the replies of read-only commands in the process, such as
+     * GET, HGET, HGETALL, SMEMBERS, etc. The connections of the client are
+     * switched to RESP3 and the server pushes an invalidation message to them
+     * when a cached key is modified (see the CLIENT TRACKING command of
+     * redis).
+     *
+     * @param maxEntries The maximum number of cached replies, the least
+     * recently used ones are removed first.
+     * @param broadcast If true, the server sends the invalidation messages of
+     * all the keys with the prefixes instead of tracking the keys read by
+     * each connection (the BCAST mode).
+     * @param prefixes Only the keys with these prefixes are cached, all keys
+     * are cached if it is empty.
+     * @note It requires redis 6.0 and hiredis 1.0.0 or later. Call it once,
+     * before executing the commands to be cached. The commands of
+     * transactions and batches are never cached.
+     */
+    virtual void enableClientCache(
+        size_t /*maxEntries*/,
+        bool /*broadcast*/ = false,
+        const std::vector<std::string> & /*prefixes*/ = {})
+    {
+        LOG_ERROR << "The client cache is not supported by this client";
+    }
+
     virtual ~RedisClient() = default;
 
     /**
@@ -264,12 +435,22 @@ class DROGON_EXPORT RedisClient
             auto result = co_await redisClient->execCommandCoro("get %s",
      "keyname");
             std::cout << result.getStringForDisplaying() << "\n";
+            // The views of the result don't copy the reply
+            auto items = co_await redisClient->execCommandCoro("lrange %s 0 -1",
+     "listname");
+            for (auto item : items.asArrayView())
+            {
+                std::cout << item.asStringView() << "\n";
+            }
         }
         catch(const RedisException &err)
         {
             std::cout << err.what() << "\n";
         }
        @endcode
+     * @note With hiredis 1.0.0 or later, the awaited result keeps its reply,
+     * so it and its views can be used after the coroutine is suspended again.
+     * Otherwise they are only valid until then.
      */
     template <typename... Arguments>
     internal::RedisAwaiter execCommandCoro(std::string_view command,
@@ -356,6 +537,7 @@ class DROGON_EXPORT RedisTransaction : public RedisClient
 
 using RedisClientPtr = std::shared_ptr<RedisClient>;
 using RedisTransactionPtr = std::shared_ptr<RedisTransaction>;
+using RedisBatchPtr = std::shared_ptr<RedisBatch>;
 
 #ifdef __cpp_impl_coroutine
 inline void internal::RedisTransactionAwaiter::await_suspend(
@@ -15,8 +15,11 @@
 #pragma once
 
 #include <drogon/exports.h>
+#include <cstddef>
+#include <iterator>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 
@@ -36,11 +39,17 @@ enum class RedisResultType
     kError
 };
 
+class RedisArrayView;
+
 /**
  * @brief This class represents a redis reply with no error.
- * @note Limited by the hiredis library, the RedisResult object is only
- * available in the context of the result callback, one can't hold or copy or
- * move a RedisResult object for later use after the callback is returned.
+ * @note When drogon is built with hiredis 1.0.0 or later, the results passed
+ * to the callbacks of commands share the ownership of their replies, so they
+ * can be copied and kept after the callbacks return, as well as the string
+ * views and array views obtained from them. Otherwise, limited by the hiredis
+ * library, the RedisResult object is only available in the context of the
+ * result callback, one can't hold or copy or move a RedisResult object for
+ * later use after the callback is returned.
  */
 class DROGON_EXPORT RedisResult
 {
@@ -49,6 +58,15 @@ class DROGON_EXPORT RedisResult
     {
     }
 
+    /**
+     * @brief Construct a result of the reply (the reply itself or one of its
+     * elements) kept alive by the handle.
+     */
+    RedisResult(redisReply *result, std::shared_ptr<redisReply> handle)
+        : result_(result), handle_(std::move(handle))
+    {
+    }
+
     ~RedisResult() = default;
 
     /**
@@ -67,6 +85,16 @@ class DROGON_EXPORT RedisResult
      */
     std::string asString() const noexcept(false);
 
+    /**
+     * @brief Get the string value of the result without copying it.
+     *
+     * @return std::string_view
+     * @note The view refers to the reply, see the note of the class for its
+     * lifetime. Calling the method of a result object whose type is not
+     * kString, kStatus or kError throws a runtime exception.
+     */
+    std::string_view asStringView() const noexcept(false);
+
     /**
      * @brief Get the array value of the result.
      *
@@ -76,6 +104,20 @@ class DROGON_EXPORT RedisResult
      */
     std::vector<RedisResult> asArray() const noexcept(false);
 
+    /**
+     * @brief Get a view of the elements of the result without building a
+     * vector, for example:
+     * @code
+       for (auto item : result.asArrayView())
+       {
+           std::cout << item.asStringView() << "\n";
+       }
+       @endcode
+     * @note Calling the method of a result object whose type is not kArray
+     * type throws a runtime exception.
+     */
+    RedisArrayView asArrayView() const noexcept(false);
+
     /**
      * @brief Get the integer value of the result.
      *
@@ -122,6 +164,94 @@ class DROGON_EXPORT RedisResult
 
   private:
     redisReply *result_;
+    std::shared_ptr<redisReply> handle_;
+};
+
+/**
+ * @brief The elements of an array result, each element is a RedisResult that
+ * shares the reply of the array.
+ */
+class DROGON_EXPORT RedisArrayView
+{
+  public:
+    class Iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = RedisResult;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = RedisResult;
+
+        Iterator(const RedisArrayView *view, size_t index)
+            : view_(view), index_(index)
+        {
+        }
+
+        RedisResult operator*() const
+        {
+            return (*view_)[index_];
+        }
+
+        Iterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto iter = *this;
+            ++index_;
+            return iter;
+        }
+
+        bool operator==(const Iterator &other) const
+        {
+            return view_ == other.view_ && index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+      private:
+        const RedisArrayView *view_;
+        size_t index_;
+    };
+
+    RedisArrayView(redisReply *reply, std::shared_ptr<redisReply> handle);
+
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /**
+     * @brief The element at the index, which must be less than size().
+     */
+    RedisResult operator[](size_t index) const noexcept;
+
+    Iterator begin() const noexcept
+    {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() const noexcept
+    {
+        return Iterator(this, size_);
+    }
+
+  private:
+    redisReply *reply_;
+    std::shared_ptr<redisReply> handle_;
+    size_t size_;
 };
 
 using RedisResultCallback = std::function<void(const RedisResult &)>;
@@ -0,0 +1,63 @@
+/**
+ *
+ *  @file RedisSessionStore.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/exports.h>
+#include <drogon/SessionStore.h>
+#include <drogon/nosql/RedisClient.h>
+#include <memory>
+#include <string>
+
+namespace drogon
+{
+namespace nosql
+{
+/**
+ * @brief A session store that keeps sessions in redis, so that they can be
+ * shared by several application processes.
+ *
+ * A session is written back only if it is modified when the request is
+ * handled, the TTLs of other used sessions are refreshed in batches. Sessions
+ * with the same ID modified by several processes at the same time are saved
+ * in the last-writer-wins way.
+ * @note The session destroying advices are not called because sessions are
+ * expired by the redis server.
+ */
+class DROGON_EXPORT RedisSessionStore : public SessionStore
+{
+  public:
+    /**
+     * @brief Create a redis session store.
+     *
+     * @param client The redis client.
+     * @param keyPrefix The prefix of the keys of sessions.
+     * @param nearCacheSize The max number of sessions cached in the process,
+     * the near cache is disabled if it's 0.
+     * @param nearCacheTimeout The number of seconds for which a cached session
+     * is used without being loaded again. Changes of the session made by other
+     * processes are not seen in this period.
+     * @param refreshInterval The number of seconds between two batches of TTL
+     * refreshing.
+     * @return std::shared_ptr<RedisSessionStore>
+     */
+    static std::shared_ptr<RedisSessionStore> newRedisSessionStore(
+        const RedisClientPtr &client,
+        const std::string &keyPrefix = "drogon:session:",
+        size_t nearCacheSize = 0,
+        double nearCacheTimeout = 1.0,
+        double refreshInterval = 1.0);
+};
+}  // namespace nosql
+}  // namespace drogon
@@ -0,0 +1,176 @@
+/**
+ *
+ *  @file RedisBatchImpl.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RedisBatchImpl.h"
+#include "RedisReplyUtils.h"
+#include "../../lib/src/TaskTimeoutFlag.h"
+#include <hiredis/hiredis.h>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+
+using namespace drogon::nosql;
+using namespace drogon::nosql::internal;
+
+RedisBatchImpl::RedisBatchImpl(Sender &&sender,
+                               trantor::EventLoop *loop,
+                               double timeout) noexcept
+    : sender_(std::move(sender)), loop_(loop), timeout_(timeout)
+{
+}
+
+void RedisBatchImpl::addCommand(std::string_view command, ...) noexcept(false)
+{
+    char *cmd;
+    va_list args;
+    va_start(args, command);
+    auto len = redisvFormatCommand(&cmd, command.data(), args);
+    va_end(args);
+    if (len == -1)
+    {
+        throw RedisException(RedisErrorCode::kInternalError, "Out of memory");
+    }
+    else if (len == -2)
+    {
+        throw RedisException(RedisErrorCode::kInternalError,
+                             "Invalid format string");
+    }
+    else if (len <= 0)
+    {
+        throw RedisException(RedisErrorCode::kInternalError,
+                             "Unknown format error");
+    }
+    commands_.append(cmd, static_cast<size_t>(len));
+    free(cmd);
+    lengths_.push_back(static_cast<size_t>(len));
+}
+
+void RedisBatchImpl::execute(RedisBatchCallback &&resultCallback,
+                             RedisExceptionCallback &&exceptionCallback)
+{
+    if (executed_)
+    {
+        exceptionCallback(RedisException(RedisErrorCode::kInternalError,
+                                         "The batch has been executed"));
+        return;
+    }
+    executed_ = true;
+    if (lengths_.empty())
+    {
+        resultCallback({});
+        return;
+    }
+    if (timeout_ <= 0.0)
+    {
+        sender_(std::move(commands_),
+                std::move(lengths_),
+                std::move(resultCallback),
+                std::move(exceptionCallback));
+        return;
+    }
+    auto expCbPtr =
+        std::make_shared<RedisExceptionCallback>(std::move(exceptionCallback));
+    auto timeoutFlagPtr = std::make_shared<TaskTimeoutFlag>(
+        loop_, std::chrono::duration<double>(timeout_), [expCbPtr]() {
+            if (*expCbPtr)
+            {
+                (*expCbPtr)(RedisException(RedisErrorCode::kTimeout,
+                                           "Command execution timeout"));
+            }
+        });
+    sender_(
+        std::move(commands_),
+        std::move(lengths_),
+        [resultCallback = std::move(resultCallback),
+         timeoutFlagPtr](const std::vector<RedisResult> &results) {
+            if (timeoutFlagPtr->done())
+            {
+                return;
+            }
+            if (resultCallback)
+            {
+                resultCallback(results);
+            }
+        },
+        [expCbPtr, timeoutFlagPtr](const RedisException &err) {
+            if (timeoutFlagPtr->done())
+            {
+                return;
+            }
+            if (*expCbPtr)
+            {
+                (*expCbPtr)(err);
+            }
+        });
+    timeoutFlagPtr->runTimer();
+}
+
+RedisBatchReplies::RedisBatchReplies(size_t count,
+                                     RedisBatchCallback &&resultCallback,
+                                     RedisExceptionCallback &&exceptionCallback)
+    : replies_(makeReply(REDIS_REPLY_ARRAY),
+               [](redisReply *reply) { freeReplyObject(reply); }),
+      pending_(count),
+      resultCallback_(std::move(resultCallback)),
+      exceptionCallback_(std::move(exceptionCallback))
+{
+    replies_->elements = count;
+    replies_->element =
+        static_cast<redisReply **>(calloc(count, sizeof(redisReply *)));
+}
+
+void RedisBatchReplies::setResult(size_t index, const RedisResult &result)
+{
+    setReply(index, copyReply(result));
+}
+
+void RedisBatchReplies::setException(size_t index, const RedisException &err)
+{
+    // An error reply is the result of its command, other errors fail the
+    // batch.
+    if (err.code() == RedisErrorCode::kRedisError)
+    {
+        setReply(index, makeStringReply(REDIS_REPLY_ERROR, err.what()));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_)
+            return;
+        failed_ = true;
+    }
+    if (exceptionCallback_)
+    {
+        exceptionCallback_(err);
+    }
+}
+
+void RedisBatchReplies::setReply(size_t index, redisReply *reply)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_ || replies_->element[index])
+        {
+            freeReplyObject(reply);
+            return;
+        }
+        replies_->element[index] = reply;
+        if (--pending_ > 0)
+            return;
+    }
+    if (resultCallback_)
+    {
+        resultCallback_(RedisResult(replies_.get(), replies_).asArray());
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ *
+ *  @file RedisBatchImpl.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/nosql/RedisClient.h>
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/net/EventLoop.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct redisReply;
+
+namespace drogon
+{
+namespace nosql
+{
+class RedisBatchImpl final : public RedisBatch
+{
+  public:
+    /**
+     * @brief Send the formatted commands, the lengths give the length of each
+     * command in the buffer.
+     */
+    using Sender =
+        std::function<void(std::string &&commands,
+                           std::vector<size_t> &&lengths,
+                           RedisBatchCallback &&resultCallback,
+                           RedisExceptionCallback &&exceptionCallback)>;
+
+    /**
+     * @brief Construct a batch, the commands fail with a kTimeout exception
+     * if their replies are not received in timeout seconds and timeout is
+     * positive. The timer runs in the loop.
+     */
+    RedisBatchImpl(Sender &&sender,
+                   trantor::EventLoop *loop,
+                   double timeout) noexcept;
+    void addCommand(std::string_view command, ...) noexcept(false) override;
+
+    size_t size() const noexcept override
+    {
+        return lengths_.size();
+    }
+
+    void execute(RedisBatchCallback &&resultCallback,
+                 RedisExceptionCallback &&exceptionCallback) override;
+
+  private:
+    Sender sender_;
+    trantor::EventLoop *loop_;
+    double timeout_;
+    std::string commands_;
+    std::vector<size_t> lengths_;
+    bool executed_{false};
+};
+
+/**
+ * @brief The replies of a batch. It keeps a copy of each reply until all of
+ * them are received, then calls the result callback with all the replies, or
+ * the exception callback once if a command fails without a reply.
+ */
+class RedisBatchReplies : public trantor::NonCopyable
+{
+  public:
+    RedisBatchReplies(size_t count,
+                      RedisBatchCallback &&resultCallback,
+                      RedisExceptionCallback &&exceptionCallback);
+    void setResult(size_t index, const RedisResult &result);
+    void setException(size_t index, const RedisException &err);
+
+  private:
+    std::mutex mutex_;
+    std::shared_ptr<redisReply> replies_;
+    size_t pending_;
+    bool failed_{false};
+    RedisBatchCallback resultCallback_;
+    RedisExceptionCallback exceptionCallback_;
+
+    void setReply(size_t index, redisReply *reply);
+};
+}  // namespace nosql
+}  // namespace drogon
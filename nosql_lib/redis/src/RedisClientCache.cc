@@ -0,0 +1,205 @@
+/**
+ *
+ *  @file RedisClientCache.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RedisClientCache.h"
+#include "RedisConnection.h"
+#include "RedisReplyUtils.h"
+#include <hiredis/hiredis.h>
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+using namespace drogon::nosql;
+
+namespace
+{
+// The read-only commands with one key (the first argument), whose replies only
+// change when the key is modified.
+const std::unordered_set<std::string> &cacheableCommands()
+{
+    static const std::unordered_set<std::string> commands{
+        "bitcount", "exists",    "get",      "getbit",    "getrange",
+        "hexists",  "hget",      "hgetall",  "hkeys",     "hlen",
+        "hmget",    "hstrlen",   "hvals",    "lindex",    "llen",
+        "lrange",   "scard",     "sismember", "smembers", "smismember",
+        "strlen",   "type",      "zcard",    "zcount",    "zmscore",
+        "zrange",   "zrank",     "zrevrange", "zrevrank", "zscore"};
+    return commands;
+}
+
+bool equalsIgnoreCase(std::string_view str, std::string_view lowerStr)
+{
+    return str.length() == lowerStr.length() &&
+           std::equal(str.begin(),
+                      str.end(),
+                      lowerStr.begin(),
+                      [](char a, char b) {
+                          return std::tolower(static_cast<unsigned char>(a)) ==
+                                 b;
+                      });
+}
+}  // namespace
+
+RedisClientCache::RedisClientCache(size_t maxEntries,
+                                   bool broadcast,
+                                   std::vector<std::string> prefixes)
+    : maxEntries_(maxEntries), prefixes_(std::move(prefixes))
+{
+    std::vector<std::string_view> arguments{"CLIENT", "TRACKING", "ON"};
+    if (broadcast)
+    {
+        arguments.emplace_back("BCAST");
+        for (auto &prefix : prefixes_)
+        {
+            arguments.emplace_back("PREFIX");
+            arguments.emplace_back(prefix);
+        }
+    }
+    trackingCommand_ = RedisConnection::formatCommand(arguments);
+}
+
+std::string_view RedisClientCache::cacheableKey(
+    const std::vector<std::string_view> &arguments) const
+{
+    if (arguments.size() < 2)
+        return {};
+    std::string name(arguments[0]);
+    std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    // EXISTS counts the keys given to it
+    if (cacheableCommands().count(name) == 0 ||
+        (name == "exists" && arguments.size() != 2))
+        return {};
+    auto key = arguments[1];
+    if (prefixes_.empty())
+        return key;
+    for (auto &prefix : prefixes_)
+    {
+        if (key.substr(0, prefix.length()) == prefix)
+            return key;
+    }
+    return {};
+}
+
+bool RedisClientCache::get(const std::string &command,
+                           const RedisResultCallback &callback)
+{
+    std::shared_ptr<redisReply> reply;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = commands_.find(command);
+        if (iter == commands_.end())
+            return false;
+        entries_.splice(entries_.begin(), entries_, iter->second);
+        reply = iter->second->reply;
+    }
+    // The result keeps the reply if the entry is removed
+    callback(RedisResult(reply.get(), reply));
+    return true;
+}
+
+void RedisClientCache::put(const std::string &command,
+                           std::string_view key,
+                           const RedisResult &result)
+{
+    if (maxEntries_ == 0)
+        return;
+    std::shared_ptr<redisReply> reply(internal::copyReply(result),
+                                      [](redisReply *r) {
+                                          freeReplyObject(r);
+                                      });
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = commands_.find(command);
+    if (iter != commands_.end())
+    {
+        iter->second->reply = std::move(reply);
+        entries_.splice(entries_.begin(), entries_, iter->second);
+        return;
+    }
+    entries_.push_front(Entry{command, std::string(key), std::move(reply)});
+    auto entry = entries_.begin();
+    commands_.emplace(entry->command, entry);
+    keys_.emplace(entry->key, entry);
+    while (entries_.size() > maxEntries_)
+    {
+        eraseInLock(std::prev(entries_.end()));
+    }
+}
+
+void RedisClientCache::handlePush(const RedisResult &message)
+{
+    if (message.type() != RedisResultType::kArray)
+        return;
+    auto elements = message.asArray();
+    if (elements.size() < 2 ||
+        elements[0].type() != RedisResultType::kString ||
+        !equalsIgnoreCase(elements[0].asString(), "invalidate"))
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (elements[1].isNil())
+    {
+        // Sent when the database is flushed
+        keys_.clear();
+        commands_.clear();
+        entries_.clear();
+        return;
+    }
+    if (elements[1].type() != RedisResultType::kArray)
+        return;
+    for (auto &key : elements[1].asArray())
+    {
+        if (key.type() == RedisResultType::kString)
+            invalidateInLock(key.asString());
+    }
+}
+
+void RedisClientCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    keys_.clear();
+    commands_.clear();
+    entries_.clear();
+}
+
+void RedisClientCache::eraseInLock(EntryIterator iter)
+{
+    commands_.erase(iter->command);
+    auto range = keys_.equal_range(iter->key);
+    for (auto keyIter = range.first; keyIter != range.second; ++keyIter)
+    {
+        if (keyIter->second == iter)
+        {
+            keys_.erase(keyIter);
+            break;
+        }
+    }
+    entries_.erase(iter);
+}
+
+void RedisClientCache::invalidateInLock(std::string_view key)
+{
+    auto range = keys_.equal_range(key);
+    std::vector<EntryIterator> entries;
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        entries.push_back(iter->second);
+    }
+    keys_.erase(range.first, range.second);
+    for (auto &entry : entries)
+    {
+        commands_.erase(entry->command);
+        entries_.erase(entry);
+    }
+}
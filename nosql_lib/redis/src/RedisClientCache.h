@@ -0,0 +1,100 @@
+/**
+ *
+ *  @file RedisClientCache.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/nosql/RedisResult.h>
+#include <trantor/utils/NonCopyable.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct redisReply;
+
+namespace drogon
+{
+namespace nosql
+{
+/**
+ * @brief The replies of read-only commands cached in the process, the entries
+ * of a key are removed when the server sends an invalidation message of it.
+ * The connections of the client must have the tracking enabled, see
+ * RedisConnection::enableTracking().
+ */
+class RedisClientCache : public trantor::NonCopyable
+{
+  public:
+    RedisClientCache(size_t maxEntries,
+                     bool broadcast,
+                     std::vector<std::string> prefixes);
+
+    /**
+     * @brief The formatted CLIENT TRACKING command sent to the connections.
+     */
+    const std::string &trackingCommand() const
+    {
+        return trackingCommand_;
+    }
+
+    /**
+     * @brief The key of the command if its reply can be cached, or an empty
+     * string_view.
+     */
+    std::string_view cacheableKey(
+        const std::vector<std::string_view> &arguments) const;
+
+    /**
+     * @brief Call the callback with the cached reply of the formatted command
+     * if there is one.
+     * @return false if the reply is not in the cache.
+     */
+    bool get(const std::string &command, const RedisResultCallback &callback);
+    void put(const std::string &command,
+             std::string_view key,
+             const RedisResult &result);
+
+    /**
+     * @brief Handle a push message of the server, the entries of the keys in
+     * an invalidation message are removed.
+     */
+    void handlePush(const RedisResult &message);
+    void clear();
+
+  private:
+    struct Entry
+    {
+        std::string command;
+        std::string key;
+        std::shared_ptr<redisReply> reply;
+    };
+    using EntryIterator = std::list<Entry>::iterator;
+
+    std::mutex mutex_;
+    // The most recently used entries are at the front
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, EntryIterator> commands_;
+    std::unordered_multimap<std::string_view, EntryIterator> keys_;
+    const size_t maxEntries_;
+    const std::vector<std::string> prefixes_;
+    std::string trackingCommand_;
+
+    void eraseInLock(EntryIterator iter);
+    void invalidateInLock(std::string_view key);
+};
+}  // namespace nosql
+}  // namespace drogon
@@ -16,6 +16,8 @@
 #include "RedisClientImpl.h"
 #include "RedisSubscriberImpl.h"
 #include "RedisTransactionImpl.h"
+#include "RedisBatchImpl.h"
+#include "RedisClientCache.h"
 #include "../../lib/src/TaskTimeoutFlag.h"
 
 using namespace drogon::nosql;
@@ -74,6 +76,7 @@ RedisConnectionPtr RedisClientImpl::newConnection(trantor::EventLoop *loop)
         {
             {
                 std::lock_guard<std::mutex> lock(thisPtr->connectionsMutex_);
+                thisPtr->enableTrackingInLock(conn);
                 thisPtr->readyConnections_.push_back(conn);
             }
             thisPtr->handleNextTask(conn);
@@ -85,6 +88,11 @@ RedisConnectionPtr RedisClientImpl::newConnection(trantor::EventLoop *loop)
         if (thisPtr)
         {
             std::lock_guard<std::mutex> lock(thisPtr->connectionsMutex_);
+            if (thisPtr->cache_)
+            {
+                // The invalidation messages sent to the connection are lost
+                thisPtr->cache_->clear();
+            }
             thisPtr->connections_.erase(conn);
             for (auto iter = thisPtr->readyConnections_.begin();
                  iter != thisPtr->readyConnections_.end();
@@ -177,6 +185,26 @@ void RedisClientImpl::execCommandAsync(
     std::string_view command,
     ...) noexcept
 {
+    if (cacheEnabled_.load(std::memory_order_acquire))
+    {
+        std::string formattedCmd;
+        try
+        {
+            va_list args;
+            va_start(args, command);
+            formattedCmd = RedisConnection::getFormattedCommand(command, args);
+            va_end(args);
+        }
+        catch (const RedisException &err)
+        {
+            exceptionCallback(err);
+            return;
+        }
+        execCachedCommandAsync(std::move(formattedCmd),
+                               std::move(resultCallback),
+                               std::move(exceptionCallback));
+        return;
+    }
     if (timeout_ > 0.0)
     {
         va_list args;
@@ -235,6 +263,215 @@ void RedisClientImpl::execCommandAsync(
     }
 }
 
+void RedisClientImpl::execFormattedCommandAsync(
+    std::string &&command,
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback,
+    bool asking) noexcept
+{
+    auto send = [asking](const RedisConnectionPtr &connPtr,
+                         std::string &&command,
+                         RedisResultCallback &&resultCallback,
+                         RedisExceptionCallback &&exceptionCallback) {
+        if (asking)
+        {
+            connPtr->sendAskingCommand(std::move(command),
+                                       std::move(resultCallback),
+                                       std::move(exceptionCallback));
+        }
+        else
+        {
+            connPtr->sendFormattedCommand(std::move(command),
+                                          std::move(resultCallback),
+                                          std::move(exceptionCallback));
+        }
+    };
+    execOnConnection([send,
+                      resultCallback = std::move(resultCallback),
+                      exceptionCallback = std::move(exceptionCallback),
+                      command = std::move(command)](
+                         const RedisConnectionPtr &connPtr) mutable {
+        send(connPtr,
+             std::move(command),
+             std::move(resultCallback),
+             std::move(exceptionCallback));
+    });
+}
+
+void RedisClientImpl::enableClientCache(
+    size_t maxEntries,
+    bool broadcast,
+    const std::vector<std::string> &prefixes)
+{
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    if (cache_)
+    {
+        LOG_ERROR << "The client cache has been enabled";
+        return;
+    }
+    cache_ =
+        std::make_shared<RedisClientCache>(maxEntries, broadcast, prefixes);
+    // The connections used by transactions are enabled when they are released
+    for (auto &conn : readyConnections_)
+    {
+        enableTrackingInLock(conn);
+    }
+    cacheEnabled_.store(true, std::memory_order_release);
+}
+
+void RedisClientImpl::enableTrackingInLock(const RedisConnectionPtr &connPtr)
+{
+    if (!cache_)
+        return;
+    std::weak_ptr<RedisClientCache> weakCache = cache_;
+    connPtr->enableTracking(std::string(cache_->trackingCommand()),
+                            [weakCache](const RedisResult &message) {
+                                auto cache = weakCache.lock();
+                                if (cache)
+                                    cache->handlePush(message);
+                            });
+}
+
+void RedisClientImpl::execCachedCommandAsync(
+    std::string &&command,
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback)
+{
+    auto key =
+        cache_->cacheableKey(RedisConnection::parseFormattedCommand(command));
+    if (!key.empty() && cache_->get(command, resultCallback))
+    {
+        return;
+    }
+    if (timeout_ > 0.0)
+    {
+        auto timeoutFlagPtr = std::make_shared<TaskTimeoutFlag>(
+            loops_.getNextLoop(),
+            std::chrono::duration<double>(timeout_),
+            [exceptionCallback]() {
+                exceptionCallback(
+                    RedisException(RedisErrorCode::kTimeout,
+                                   "Command execution timeout"));
+            });
+        resultCallback = [resultCallback = std::move(resultCallback),
+                          timeoutFlagPtr](const RedisResult &result) {
+            if (!timeoutFlagPtr->done())
+                resultCallback(result);
+        };
+        exceptionCallback = [exceptionCallback = std::move(exceptionCallback),
+                             timeoutFlagPtr](const RedisException &err) {
+            if (!timeoutFlagPtr->done())
+                exceptionCallback(err);
+        };
+        timeoutFlagPtr->runTimer();
+    }
+    if (key.empty())
+    {
+        execFormattedCommandAsync(std::move(command),
+                                  std::move(resultCallback),
+                                  std::move(exceptionCallback));
+        return;
+    }
+    std::string keyStr(key);
+    execOnConnection([cache = cache_,
+                      key = std::move(keyStr),
+                      command = std::move(command),
+                      resultCallback = std::move(resultCallback),
+                      exceptionCallback = std::move(exceptionCallback)](
+                         const RedisConnectionPtr &connPtr) mutable {
+        std::weak_ptr<RedisConnection> weakConnPtr = connPtr;
+        auto cachedCommand = command;
+        connPtr->sendFormattedCommand(
+            std::move(command),
+            [cache = std::move(cache),
+             weakConnPtr,
+             key = std::move(key),
+             command = std::move(cachedCommand),
+             resultCallback = std::move(resultCallback)](
+                const RedisResult &result) {
+                // Replies received before the server accepts the tracking
+                // command would not be invalidated.
+                auto connPtr = weakConnPtr.lock();
+                if (connPtr && connPtr->isTracking())
+                {
+                    cache->put(command, key, result);
+                }
+                resultCallback(result);
+            },
+            std::move(exceptionCallback));
+    });
+}
+
+void RedisClientImpl::execOnConnection(
+    std::function<void(const RedisConnectionPtr &)> &&task)
+{
+    RedisConnectionPtr connPtr;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        if (readyConnections_.empty())
+        {
+            LOG_TRACE << "no connection available, push command to buffer";
+            tasks_.emplace_back(
+                std::make_shared<
+                    std::function<void(const RedisConnectionPtr &)>>(
+                    std::move(task)));
+            return;
+        }
+        if (connectionPos_ >= readyConnections_.size())
+        {
+            connPtr = readyConnections_[0];
+            connectionPos_ = 1;
+        }
+        else
+        {
+            connPtr = readyConnections_[connectionPos_++];
+        }
+    }
+    task(connPtr);
+}
+
+std::shared_ptr<RedisBatch> RedisClientImpl::newBatch() noexcept
+{
+    std::weak_ptr<RedisClientImpl> thisWeakPtr = shared_from_this();
+    return std::make_shared<RedisBatchImpl>(
+        [thisWeakPtr](std::string &&commands,
+                      std::vector<size_t> &&lengths,
+                      RedisBatchCallback &&resultCallback,
+                      RedisExceptionCallback &&exceptionCallback) {
+            auto thisPtr = thisWeakPtr.lock();
+            if (!thisPtr)
+            {
+                exceptionCallback(
+                    RedisException(RedisErrorCode::kNoConnectionAvailable,
+                                   "The redis client has been destroyed"));
+                return;
+            }
+            thisPtr->execBatchAsync(std::move(commands),
+                                    std::move(lengths),
+                                    std::move(resultCallback),
+                                    std::move(exceptionCallback));
+        },
+        loops_.getNextLoop(),
+        timeout_);
+}
+
+void RedisClientImpl::execBatchAsync(std::string &&commands,
+                                     std::vector<size_t> &&lengths,
+                                     RedisBatchCallback &&resultCallback,
+                                     RedisExceptionCallback &&exceptionCallback)
+{
+    execOnConnection([commands = std::move(commands),
+                      lengths = std::move(lengths),
+                      resultCallback = std::move(resultCallback),
+                      exceptionCallback = std::move(exceptionCallback)](
+                         const RedisConnectionPtr &connPtr) mutable {
+        connPtr->sendBatch(std::move(commands),
+                           std::move(lengths),
+                           std::move(resultCallback),
+                           std::move(exceptionCallback));
+    });
+}
+
 RedisClientImpl::~RedisClientImpl()
 {
     closeAll();
@@ -352,6 +589,7 @@ std::shared_ptr<RedisTransaction> RedisClientImpl::makeTransaction(
                 {
                     std::lock_guard<std::mutex> lock(
                         thisPtr->connectionsMutex_);
+                    thisPtr->enableTrackingInLock(connPtr);
                     thisPtr->readyConnections_.push_back(connPtr);
                 }
                 thisPtr->handleNextTask(connPtr);
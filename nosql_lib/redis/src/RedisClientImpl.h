@@ -19,6 +19,7 @@
 #include <drogon/nosql/RedisClient.h>
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/net/EventLoopThreadPool.h>
+#include <atomic>
 #include <vector>
 #include <unordered_set>
 #include <list>
@@ -29,6 +30,7 @@ namespace drogon
 namespace nosql
 {
 class RedisConnection;
+class RedisClientCache;
 using RedisConnectionPtr = std::shared_ptr<RedisConnection>;
 
 class RedisClientImpl final
@@ -46,8 +48,25 @@ class RedisClientImpl final
                           RedisExceptionCallback &&exceptionCallback,
                           std::string_view command,
                           ...) noexcept override;
+    /**
+     * @brief Execute a formatted command, after an ASKING command on the same
+     * connection if asking is true. The cluster client routes commands to the
+     * nodes with it.
+     */
+    void execFormattedCommandAsync(std::string &&command,
+                                   RedisResultCallback &&resultCallback,
+                                   RedisExceptionCallback &&exceptionCallback,
+                                   bool asking = false) noexcept;
+    /**
+     * @brief Execute the formatted commands of a batch on one connection.
+     */
+    void execBatchAsync(std::string &&commands,
+                        std::vector<size_t> &&lengths,
+                        RedisBatchCallback &&resultCallback,
+                        RedisExceptionCallback &&exceptionCallback);
     ~RedisClientImpl() override;
     std::shared_ptr<RedisSubscriber> newSubscriber() noexcept override;
+    std::shared_ptr<RedisBatch> newBatch() noexcept override;
 
     RedisTransactionPtr newTransaction() noexcept(false) override
     {
@@ -75,6 +94,10 @@ class RedisClientImpl final
         timeout_ = timeout;
     }
 
+    void enableClientCache(size_t maxEntries,
+                           bool broadcast,
+                           const std::vector<std::string> &prefixes) override;
+
     void init();
     void closeAll() override;
 
@@ -92,6 +115,8 @@ class RedisClientImpl final
     double timeout_{-1.0};
     std::list<std::shared_ptr<std::function<void(const RedisConnectionPtr &)>>>
         tasks_;
+    std::shared_ptr<RedisClientCache> cache_;
+    std::atomic<bool> cacheEnabled_{false};
 
     RedisConnectionPtr newConnection(trantor::EventLoop *loop);
     RedisConnectionPtr newSubscribeConnection(
@@ -101,6 +126,17 @@ class RedisClientImpl final
     std::shared_ptr<RedisTransaction> makeTransaction(
         const RedisConnectionPtr &connPtr);
     void handleNextTask(const RedisConnectionPtr &connPtr);
+
+    /**
+     * @brief Run the task with a ready connection, or when a connection is
+     * ready.
+     */
+    void execOnConnection(
+        std::function<void(const RedisConnectionPtr &)> &&task);
+    void enableTrackingInLock(const RedisConnectionPtr &connPtr);
+    void execCachedCommandAsync(std::string &&command,
+                                RedisResultCallback &&resultCallback,
+                                RedisExceptionCallback &&exceptionCallback);
     void execCommandAsyncWithTimeout(std::string_view command,
                                      RedisResultCallback &&resultCallback,
                                      RedisExceptionCallback &&exceptionCallback,
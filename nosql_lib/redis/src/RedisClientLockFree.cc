@@ -16,6 +16,7 @@
 #include "RedisClientLockFree.h"
 #include "RedisSubscriberImpl.h"
 #include "RedisTransactionImpl.h"
+#include "RedisBatchImpl.h"
 #include "../../lib/src/TaskTimeoutFlag.h"
 using namespace drogon::nosql;
 
@@ -204,6 +205,142 @@ void RedisClientLockFree::execCommandAsync(
     }
 }
 
+void RedisClientLockFree::execFormattedCommandAsync(
+    std::string &&command,
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback)
+{
+    loop_->assertInLoopThread();
+    if (timeout_ > 0.0)
+    {
+        auto timeoutFlagPtr = std::make_shared<TaskTimeoutFlag>(
+            loop_,
+            std::chrono::duration<double>(timeout_),
+            [exceptionCallback]() {
+                exceptionCallback(
+                    RedisException(RedisErrorCode::kTimeout,
+                                   "Command execution timeout"));
+            });
+        resultCallback = [resultCallback = std::move(resultCallback),
+                          timeoutFlagPtr](const RedisResult &result) {
+            if (!timeoutFlagPtr->done())
+                resultCallback(result);
+        };
+        exceptionCallback = [exceptionCallback = std::move(exceptionCallback),
+                             timeoutFlagPtr](const RedisException &err) {
+            if (!timeoutFlagPtr->done())
+                exceptionCallback(err);
+        };
+        timeoutFlagPtr->runTimer();
+    }
+    if (!readyConnections_.empty())
+    {
+        RedisConnectionPtr connPtr;
+        if (connectionPos_ >= readyConnections_.size())
+        {
+            connPtr = readyConnections_[0];
+            connectionPos_ = 1;
+        }
+        else
+        {
+            connPtr = readyConnections_[connectionPos_++];
+        }
+        connPtr->sendFormattedCommand(std::move(command),
+                                      std::move(resultCallback),
+                                      std::move(exceptionCallback));
+        return;
+    }
+    LOG_TRACE << "no connection available, push command to buffer";
+    tasks_.emplace_back(
+        std::make_shared<std::function<void(const RedisConnectionPtr &)>>(
+            [resultCallback = std::move(resultCallback),
+             exceptionCallback = std::move(exceptionCallback),
+             command = std::move(command)](
+                const RedisConnectionPtr &connPtr) mutable {
+                connPtr->sendFormattedCommand(std::move(command),
+                                              std::move(resultCallback),
+                                              std::move(exceptionCallback));
+            }));
+}
+
+std::shared_ptr<RedisBatch> RedisClientLockFree::newBatch() noexcept
+{
+    std::weak_ptr<RedisClientLockFree> thisWeakPtr = shared_from_this();
+    return std::make_shared<RedisBatchImpl>(
+        [thisWeakPtr, loop = loop_](
+            std::string &&commands,
+            std::vector<size_t> &&lengths,
+            RedisBatchCallback &&resultCallback,
+            RedisExceptionCallback &&exceptionCallback) {
+            // A batch may be executed in another thread when the client is
+            // shared by the IO loops, see RedisClientLoopAffinity.
+            loop->runInLoop([thisWeakPtr,
+                             commands = std::move(commands),
+                             lengths = std::move(lengths),
+                             resultCallback = std::move(resultCallback),
+                             exceptionCallback =
+                                 std::move(exceptionCallback)]() mutable {
+                auto thisPtr = thisWeakPtr.lock();
+                if (!thisPtr)
+                {
+                    exceptionCallback(RedisException(
+                        RedisErrorCode::kNoConnectionAvailable,
+                        "The redis client has been destroyed"));
+                    return;
+                }
+                thisPtr->execBatchAsync(std::move(commands),
+                                        std::move(lengths),
+                                        std::move(resultCallback),
+                                        std::move(exceptionCallback));
+            });
+        },
+        loop_,
+        timeout_);
+}
+
+void RedisClientLockFree::execBatchAsync(
+    std::string &&commands,
+    std::vector<size_t> &&lengths,
+    RedisBatchCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback)
+{
+    loop_->assertInLoopThread();
+    RedisConnectionPtr connPtr;
+    if (!readyConnections_.empty())
+    {
+        if (connectionPos_ >= readyConnections_.size())
+        {
+            connPtr = readyConnections_[0];
+            connectionPos_ = 1;
+        }
+        else
+        {
+            connPtr = readyConnections_[connectionPos_++];
+        }
+    }
+    if (connPtr)
+    {
+        connPtr->sendBatch(std::move(commands),
+                           std::move(lengths),
+                           std::move(resultCallback),
+                           std::move(exceptionCallback));
+        return;
+    }
+    LOG_TRACE << "no connection available, push batch to buffer";
+    tasks_.emplace_back(
+        std::make_shared<std::function<void(const RedisConnectionPtr &)>>(
+            [commands = std::move(commands),
+             lengths = std::move(lengths),
+             resultCallback = std::move(resultCallback),
+             exceptionCallback = std::move(exceptionCallback)](
+                const RedisConnectionPtr &connPtr) mutable {
+                connPtr->sendBatch(std::move(commands),
+                                   std::move(lengths),
+                                   std::move(resultCallback),
+                                   std::move(exceptionCallback));
+            }));
+}
+
 RedisClientLockFree::~RedisClientLockFree()
 {
     closeAll();
@@ -46,8 +46,16 @@ class RedisClientLockFree final
                           RedisExceptionCallback &&exceptionCallback,
                           std::string_view command,
                           ...) noexcept override;
+    /**
+     * @brief Execute a formatted command, it must be called in the loop
+     * thread of the client.
+     */
+    void execFormattedCommandAsync(std::string &&command,
+                                   RedisResultCallback &&resultCallback,
+                                   RedisExceptionCallback &&exceptionCallback);
     ~RedisClientLockFree() override;
     std::shared_ptr<RedisSubscriber> newSubscriber() noexcept override;
+    std::shared_ptr<RedisBatch> newBatch() noexcept override;
 
     RedisTransactionPtr newTransaction() override
     {
@@ -70,6 +78,11 @@ class RedisClientLockFree final
 
     void closeAll() override;
 
+    trantor::EventLoop *getLoop() const
+    {
+        return loop_;
+    }
+
   private:
     trantor::EventLoop *loop_;
     std::unordered_set<RedisConnectionPtr> connections_;
@@ -90,6 +103,10 @@ class RedisClientLockFree final
     std::shared_ptr<RedisTransaction> makeTransaction(
         const RedisConnectionPtr &connPtr);
     void handleNextTask(const RedisConnectionPtr &connPtr);
+    void execBatchAsync(std::string &&commands,
+                        std::vector<size_t> &&lengths,
+                        RedisBatchCallback &&resultCallback,
+                        RedisExceptionCallback &&exceptionCallback);
     void execCommandAsyncWithTimeout(std::string_view command,
                                      RedisResultCallback &&resultCallback,
                                      RedisExceptionCallback &&exceptionCallback,
@@ -0,0 +1,172 @@
+/**
+ *
+ *  @file RedisClientLoopAffinity.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RedisClientLoopAffinity.h"
+#include "RedisConnection.h"
+#include <future>
+
+using namespace drogon::nosql;
+
+RedisClientLoopAffinity::RedisClientLoopAffinity(
+    const trantor::InetAddress &serverAddress,
+    size_t connectionsPerLoop,
+    const std::vector<trantor::EventLoop *> &loops,
+    const std::string &username,
+    const std::string &password,
+    unsigned int db)
+{
+    assert(!loops.empty());
+    clients_.reserve(loops.size());
+    for (auto loop : loops)
+    {
+        clients_.emplace_back(std::make_shared<RedisClientLockFree>(
+            serverAddress, connectionsPerLoop, loop, username, password, db));
+    }
+}
+
+RedisClientLoopAffinity::~RedisClientLoopAffinity()
+{
+    closeAll();
+}
+
+RedisClientLockFree *RedisClientLoopAffinity::getLoopClient() const
+{
+    auto loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+    if (!loop)
+        return nullptr;
+    auto index = loop->index();
+    if (index < clients_.size() && clients_[index]->getLoop() == loop)
+        return clients_[index].get();
+    for (auto &client : clients_)
+    {
+        if (client->getLoop() == loop)
+            return client.get();
+    }
+    return nullptr;
+}
+
+const RedisClientLoopAffinity::ClientPtr &
+RedisClientLoopAffinity::getNextClient()
+{
+    return clients_[clientPos_.fetch_add(1, std::memory_order_relaxed) %
+                    clients_.size()];
+}
+
+void RedisClientLoopAffinity::execCommandAsync(
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback,
+    std::string_view command,
+    ...) noexcept
+{
+    std::string formattedCmd;
+    va_list args;
+    va_start(args, command);
+    try
+    {
+        formattedCmd = RedisConnection::getFormattedCommand(command, args);
+    }
+    catch (const RedisException &err)
+    {
+        va_end(args);
+        exceptionCallback(err);
+        return;
+    }
+    va_end(args);
+    if (auto client = getLoopClient())
+    {
+        client->execFormattedCommandAsync(std::move(formattedCmd),
+                                          std::move(resultCallback),
+                                          std::move(exceptionCallback));
+        return;
+    }
+    auto &client = getNextClient();
+    client->getLoop()->queueInLoop(
+        [client,
+         formattedCmd = std::move(formattedCmd),
+         resultCallback = std::move(resultCallback),
+         exceptionCallback = std::move(exceptionCallback)]() mutable {
+            client->execFormattedCommandAsync(std::move(formattedCmd),
+                                              std::move(resultCallback),
+                                              std::move(exceptionCallback));
+        });
+}
+
+std::shared_ptr<RedisSubscriber>
+RedisClientLoopAffinity::newSubscriber() noexcept
+{
+    if (auto client = getLoopClient())
+        return client->newSubscriber();
+    return getNextClient()->newSubscriber();
+}
+
+std::shared_ptr<RedisBatch> RedisClientLoopAffinity::newBatch() noexcept
+{
+    if (auto client = getLoopClient())
+        return client->newBatch();
+    return getNextClient()->newBatch();
+}
+
+RedisTransactionPtr RedisClientLoopAffinity::newTransaction() noexcept(false)
+{
+    if (getLoopClient())
+    {
+        LOG_ERROR << "You can't use the synchronous interface in the IO loops "
+                     "of the redis client, please use the asynchronous "
+                     "version (newTransactionAsync)";
+        throw RedisException(RedisErrorCode::kInternalError,
+                             "Synchronous interface in the IO loop");
+    }
+    std::promise<RedisTransactionPtr> prom;
+    auto f = prom.get_future();
+    newTransactionAsync([&prom](const RedisTransactionPtr &transPtr) {
+        prom.set_value(transPtr);
+    });
+    auto trans = f.get();
+    if (!trans)
+    {
+        throw RedisException(
+            RedisErrorCode::kTimeout,
+            "Timeout, no connection available for transaction");
+    }
+    return trans;
+}
+
+void RedisClientLoopAffinity::newTransactionAsync(
+    const std::function<void(const RedisTransactionPtr &)> &callback)
+{
+    if (auto client = getLoopClient())
+    {
+        client->newTransactionAsync(callback);
+        return;
+    }
+    auto &client = getNextClient();
+    client->getLoop()->queueInLoop(
+        [client, callback]() { client->newTransactionAsync(callback); });
+}
+
+void RedisClientLoopAffinity::setTimeout(double timeout)
+{
+    for (auto &client : clients_)
+    {
+        client->setTimeout(timeout);
+    }
+}
+
+void RedisClientLoopAffinity::closeAll()
+{
+    for (auto &client : clients_)
+    {
+        client->getLoop()->runInLoop([client]() { client->closeAll(); });
+    }
+}
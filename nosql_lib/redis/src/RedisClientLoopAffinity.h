@@ -0,0 +1,74 @@
+/**
+ *
+ *  @file RedisClientLoopAffinity.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+#pragma once
+
+#include "RedisClientLockFree.h"
+#include <drogon/nosql/RedisClient.h>
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/net/EventLoop.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace drogon
+{
+namespace nosql
+{
+/**
+ * @brief A client whose connections are created on the given IO loops (the
+ * ones of the application), with a RedisClientLockFree for each loop. A
+ * command executed in one of the loops is sent by a connection of that loop,
+ * so the callbacks are called in the same thread without any lock. The
+ * commands executed in other threads are dispatched to the loops in turn.
+ */
+class RedisClientLoopAffinity final
+    : public RedisClient,
+      public trantor::NonCopyable,
+      public std::enable_shared_from_this<RedisClientLoopAffinity>
+{
+  public:
+    RedisClientLoopAffinity(const trantor::InetAddress &serverAddress,
+                            size_t connectionsPerLoop,
+                            const std::vector<trantor::EventLoop *> &loops,
+                            const std::string &username = "",
+                            const std::string &password = "",
+                            unsigned int db = 0);
+    void execCommandAsync(RedisResultCallback &&resultCallback,
+                          RedisExceptionCallback &&exceptionCallback,
+                          std::string_view command,
+                          ...) noexcept override;
+    ~RedisClientLoopAffinity() override;
+    std::shared_ptr<RedisSubscriber> newSubscriber() noexcept override;
+    std::shared_ptr<RedisBatch> newBatch() noexcept override;
+    RedisTransactionPtr newTransaction() noexcept(false) override;
+    void newTransactionAsync(
+        const std::function<void(const RedisTransactionPtr &)> &callback)
+        override;
+    void setTimeout(double timeout) override;
+    void closeAll() override;
+
+  private:
+    using ClientPtr = std::shared_ptr<RedisClientLockFree>;
+    std::vector<ClientPtr> clients_;
+    std::atomic<size_t> clientPos_{0};
+
+    /**
+     * @brief The client of the current loop, or nullptr if the current thread
+     * is not one of the loops.
+     */
+    RedisClientLockFree *getLoopClient() const;
+    const ClientPtr &getNextClient();
+};
+}  // namespace nosql
+}  // namespace drogon
@@ -14,6 +14,7 @@
 
 #include "../../lib/src/RedisClientManager.h"
 #include "RedisClientLockFree.h"
+#include "RedisClientLoopAffinity.h"
 #include "RedisClientImpl.h"
 
 #include <algorithm>
@@ -49,6 +50,21 @@ void RedisClientManager::createRedisClients(
                 }
             });
         }
+        else if (redisInfo.loopAffinity_)
+        {
+            auto clientPtr = std::make_shared<RedisClientLoopAffinity>(
+                trantor::InetAddress(redisInfo.addr_, redisInfo.port_),
+                redisInfo.connectionNumber_,
+                ioLoops,
+                redisInfo.username_,
+                redisInfo.password_,
+                redisInfo.db_);
+            if (redisInfo.timeout_ > 0.0)
+            {
+                clientPtr->setTimeout(redisInfo.timeout_);
+            }
+            redisClientsMap_[redisInfo.name_] = std::move(clientPtr);
+        }
         else
         {
             auto clientPtr = std::make_shared<RedisClientImpl>(
@@ -75,7 +91,8 @@ void RedisClientManager::createRedisClient(const std::string &name,
                                            const size_t connectionNum,
                                            const bool isFast,
                                            double timeout,
-                                           unsigned int db)
+                                           unsigned int db,
+                                           bool loopAffinity)
 {
     RedisInfo info;
     info.name_ = name;
@@ -87,6 +104,7 @@ void RedisClientManager::createRedisClient(const std::string &name,
     info.isFast_ = isFast;
     info.timeout_ = timeout;
     info.db_ = db;
+    info.loopAffinity_ = loopAffinity;
 
     redisInfos_.emplace_back(std::move(info));
 }
@@ -0,0 +1,981 @@
+/**
+ *
+ *  @file RedisClusterClient.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RedisClusterClient.h"
+#include "RedisConnection.h"
+#include "RedisBatchImpl.h"
+#include "../../lib/src/TaskTimeoutFlag.h"
+#include <hiredis/hiredis.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+
+using namespace drogon::nosql;
+
+namespace
+{
+constexpr size_t kMaxRedirections = 5;
+constexpr double kRefreshInterval = 1.0;
+constexpr double kRefreshTimeout = 5.0;
+constexpr double kTryAgainDelay = 0.1;
+
+// CRC16-CCITT (XMODEM), the checksum redis cluster uses for key slots
+constexpr std::array<uint16_t, 256> makeCrc16Table()
+{
+    std::array<uint16_t, 256> table{};
+    for (size_t i = 0; i < 256; ++i)
+    {
+        auto crc = static_cast<uint16_t>(i << 8);
+        for (int j = 0; j < 8; ++j)
+        {
+            crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021
+                                                       : crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint16_t, 256> kCrc16Table = makeCrc16Table();
+
+uint16_t crc16(std::string_view data)
+{
+    uint16_t crc = 0;
+    for (auto c : data)
+    {
+        crc = static_cast<uint16_t>(
+            (crc << 8) ^
+            kCrc16Table[((crc >> 8) ^ static_cast<uint8_t>(c)) & 0xff]);
+    }
+    return crc;
+}
+
+struct KeySpec
+{
+    // The index of the first key, 0 if the command has no keys
+    int first;
+    // The index of the last key, negative values count from the end
+    int last;
+    int step;
+    // The index of the argument that gives the number of the keys following
+    // it, 0 if there is none
+    int numKeys;
+};
+
+// Commands not listed have one key, the first argument
+const std::unordered_map<std::string_view, KeySpec> &keySpecs()
+{
+    static const std::unordered_map<std::string_view, KeySpec> specs{
+        {"ping", {0, 0, 0, 0}},
+        {"echo", {0, 0, 0, 0}},
+        {"info", {0, 0, 0, 0}},
+        {"time", {0, 0, 0, 0}},
+        {"dbsize", {0, 0, 0, 0}},
+        {"flushall", {0, 0, 0, 0}},
+        {"flushdb", {0, 0, 0, 0}},
+        {"keys", {0, 0, 0, 0}},
+        {"scan", {0, 0, 0, 0}},
+        {"randomkey", {0, 0, 0, 0}},
+        {"script", {0, 0, 0, 0}},
+        {"function", {0, 0, 0, 0}},
+        {"cluster", {0, 0, 0, 0}},
+        {"config", {0, 0, 0, 0}},
+        {"command", {0, 0, 0, 0}},
+        {"client", {0, 0, 0, 0}},
+        {"publish", {0, 0, 0, 0}},
+        {"wait", {0, 0, 0, 0}},
+        {"lastsave", {0, 0, 0, 0}},
+        {"slowlog", {0, 0, 0, 0}},
+        {"del", {1, -1, 1, 0}},
+        {"unlink", {1, -1, 1, 0}},
+        {"exists", {1, -1, 1, 0}},
+        {"touch", {1, -1, 1, 0}},
+        {"mget", {1, -1, 1, 0}},
+        {"watch", {1, -1, 1, 0}},
+        {"sinter", {1, -1, 1, 0}},
+        {"sunion", {1, -1, 1, 0}},
+        {"sdiff", {1, -1, 1, 0}},
+        {"sinterstore", {1, -1, 1, 0}},
+        {"sunionstore", {1, -1, 1, 0}},
+        {"sdiffstore", {1, -1, 1, 0}},
+        {"pfcount", {1, -1, 1, 0}},
+        {"pfmerge", {1, -1, 1, 0}},
+        {"mset", {1, -1, 2, 0}},
+        {"msetnx", {1, -1, 2, 0}},
+        {"rename", {1, 2, 1, 0}},
+        {"renamenx", {1, 2, 1, 0}},
+        {"smove", {1, 2, 1, 0}},
+        {"rpoplpush", {1, 2, 1, 0}},
+        {"lmove", {1, 2, 1, 0}},
+        {"blmove", {1, 2, 1, 0}},
+        {"brpoplpush", {1, 2, 1, 0}},
+        {"copy", {1, 2, 1, 0}},
+        {"lcs", {1, 2, 1, 0}},
+        {"zrangestore", {1, 2, 1, 0}},
+        {"geosearchstore", {1, 2, 1, 0}},
+        {"blpop", {1, -2, 1, 0}},
+        {"brpop", {1, -2, 1, 0}},
+        {"bzpopmin", {1, -2, 1, 0}},
+        {"bzpopmax", {1, -2, 1, 0}},
+        {"bitop", {2, -1, 1, 0}},
+        {"eval", {0, 0, 0, 2}},
+        {"evalsha", {0, 0, 0, 2}},
+        {"eval_ro", {0, 0, 0, 2}},
+        {"evalsha_ro", {0, 0, 0, 2}},
+        {"fcall", {0, 0, 0, 2}},
+        {"fcall_ro", {0, 0, 0, 2}},
+        {"zunionstore", {1, 1, 1, 2}},
+        {"zinterstore", {1, 1, 1, 2}},
+        {"zdiffstore", {1, 1, 1, 2}},
+        {"zunion", {0, 0, 0, 1}},
+        {"zinter", {0, 0, 0, 1}},
+        {"zdiff", {0, 0, 0, 1}},
+        {"zintercard", {0, 0, 0, 1}},
+        {"sintercard", {0, 0, 0, 1}},
+        {"lmpop", {0, 0, 0, 1}},
+        {"zmpop", {0, 0, 0, 1}},
+        {"blmpop", {0, 0, 0, 2}},
+        {"bzmpop", {0, 0, 0, 2}}};
+    return specs;
+}
+
+std::string lowerName(std::string_view name)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) {
+        return static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    });
+    return lower;
+}
+
+// The indexes of the keys in the arguments of a command
+std::vector<size_t> keyIndexes(const std::string &name,
+                               const std::vector<std::string_view> &arguments)
+{
+    std::vector<size_t> indexes;
+    auto argc = static_cast<int>(arguments.size());
+    if (name == "xread" || name == "xreadgroup")
+    {
+        // XREAD ... STREAMS key [key ...] id [id ...]
+        for (int i = 1; i < argc; ++i)
+        {
+            if (lowerName(arguments[i]) == "streams")
+            {
+                int count = (argc - i - 1) / 2;
+                for (int j = 1; j <= count; ++j)
+                    indexes.push_back(i + j);
+                break;
+            }
+        }
+        return indexes;
+    }
+    auto iter = keySpecs().find(name);
+    if (iter == keySpecs().end())
+    {
+        if (argc > 1)
+            indexes.push_back(1);
+        return indexes;
+    }
+    auto &spec = iter->second;
+    if (spec.first > 0)
+    {
+        int last = spec.last < 0 ? argc + spec.last : spec.last;
+        for (int i = spec.first; i <= last && i < argc; i += spec.step)
+            indexes.push_back(i);
+    }
+    if (spec.numKeys > 0 && spec.numKeys < argc)
+    {
+        int count = atoi(std::string(arguments[spec.numKeys]).c_str());
+        for (int i = spec.numKeys + 1; i <= spec.numKeys + count && i < argc;
+             ++i)
+            indexes.push_back(i);
+    }
+    return indexes;
+}
+
+// Call the callback with a reply built from its RESP encoding
+void deliverReply(const std::string &reply,
+                  const RedisResultCallback &resultCallback,
+                  const RedisExceptionCallback &exceptionCallback)
+{
+    std::unique_ptr<redisReader, decltype(&redisReaderFree)> reader(
+        redisReaderCreate(), &redisReaderFree);
+    void *result = nullptr;
+    if (!reader ||
+        redisReaderFeed(reader.get(), reply.data(), reply.length()) !=
+            REDIS_OK ||
+        redisReaderGetReply(reader.get(), &result) != REDIS_OK || !result)
+    {
+        exceptionCallback(RedisException(RedisErrorCode::kInternalError,
+                                         "Failed to merge the replies"));
+        return;
+    }
+    std::shared_ptr<redisReply> handle(static_cast<redisReply *>(result),
+                                       [](redisReply *reply) {
+                                           freeReplyObject(reply);
+                                       });
+    resultCallback(RedisResult(handle.get(), handle));
+}
+}  // namespace
+
+// A multi-key command whose keys are in several slots, it is sent to every
+// slot with the keys of that slot and the replies are merged.
+struct RedisClusterClient::SplitCommand
+{
+    std::mutex mutex;
+    std::string name;
+    size_t pending{0};
+    bool failed{false};
+    long long count{0};
+    // The RESP encoded values of MGET, in the order of the keys
+    std::vector<std::string> values;
+    RedisResultCallback resultCallback;
+    RedisExceptionCallback exceptionCallback;
+};
+
+std::shared_ptr<RedisClient> RedisClient::newRedisClusterClient(
+    const std::vector<trantor::InetAddress> &seedNodes,
+    size_t connectionsPerNode,
+    const std::string &password,
+    const std::string &username)
+{
+    auto client = std::make_shared<RedisClusterClient>(seedNodes,
+                                                       connectionsPerNode,
+                                                       username,
+                                                       password);
+    client->init();
+    return client;
+}
+
+RedisClusterClient::RedisClusterClient(
+    std::vector<trantor::InetAddress> seedNodes,
+    size_t connectionsPerNode,
+    std::string username,
+    std::string password)
+    : loopThread_("RedisClusterLoop"),
+      slots_(kSlotsNumber),
+      username_(std::move(username)),
+      password_(std::move(password)),
+      connectionsPerNode_(connectionsPerNode)
+{
+    for (auto &addr : seedNodes)
+    {
+        seedNodes_.push_back(addr.toIpPort());
+    }
+}
+
+void RedisClusterClient::init()
+{
+    loopThread_.run();
+    {
+        std::lock_guard<std::mutex> lock(nodesMutex_);
+        for (auto &addr : seedNodes_)
+        {
+            auto pos = addr.rfind(':');
+            getNodeInLock(addr.substr(0, pos),
+                          static_cast<uint16_t>(atoi(addr.c_str() + pos + 1)));
+        }
+    }
+    refreshTopology();
+}
+
+RedisClusterClient::~RedisClusterClient()
+{
+    closeAll();
+}
+
+void RedisClusterClient::closeAll()
+{
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    for (auto &node : nodes_)
+    {
+        node.second->closeAll();
+    }
+    nodes_.clear();
+    slots_.assign(kSlotsNumber, nullptr);
+}
+
+uint16_t RedisClusterClient::keySlot(std::string_view key)
+{
+    auto start = key.find('{');
+    if (start != std::string_view::npos)
+    {
+        auto end = key.find('}', start + 1);
+        if (end != std::string_view::npos && end != start + 1)
+        {
+            key = key.substr(start + 1, end - start - 1);
+        }
+    }
+    return crc16(key) & (kSlotsNumber - 1);
+}
+
+RedisClusterClient::NodePtr RedisClusterClient::getNodeInLock(
+    const std::string &host,
+    uint16_t port)
+{
+    auto address = host + ":" + std::to_string(port);
+    auto iter = nodes_.find(address);
+    if (iter != nodes_.end())
+    {
+        return iter->second;
+    }
+    LOG_TRACE << "new redis cluster node " << address;
+    auto node = std::make_shared<RedisClientImpl>(
+        trantor::InetAddress(host, port, host.find(':') != std::string::npos),
+        connectionsPerNode_,
+        username_,
+        password_);
+    node->init();
+    nodes_.emplace(std::move(address), node);
+    return node;
+}
+
+RedisClusterClient::NodePtr RedisClusterClient::getSlotOwner(int slot)
+{
+    {
+        std::lock_guard<std::mutex> lock(nodesMutex_);
+        if (slot >= 0 && slots_[slot])
+        {
+            return slots_[slot];
+        }
+    }
+    // Commands without keys, or sent before the slots are known. In the
+    // latter case the node redirects them to the owner.
+    std::string address;
+    return getNextNode(address);
+}
+
+RedisClusterClient::NodePtr RedisClusterClient::getNextNode(
+    std::string &address)
+{
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    if (nodes_.empty())
+    {
+        return nullptr;
+    }
+    auto iter = nodes_.begin();
+    std::advance(iter, nodePos_++ % nodes_.size());
+    address = iter->first;
+    return iter->second;
+}
+
+void RedisClusterClient::execCommandAsync(
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback,
+    std::string_view command,
+    ...) noexcept
+{
+    std::string formattedCmd;
+    va_list args;
+    va_start(args, command);
+    try
+    {
+        formattedCmd = RedisConnection::getFormattedCommand(command, args);
+    }
+    catch (const RedisException &err)
+    {
+        va_end(args);
+        exceptionCallback(err);
+        return;
+    }
+    va_end(args);
+
+    std::shared_ptr<TaskTimeoutFlag> timeoutFlagPtr;
+    if (timeout_ > 0.0)
+    {
+        auto expCbPtr = std::make_shared<RedisExceptionCallback>(
+            std::move(exceptionCallback));
+        timeoutFlagPtr = std::make_shared<TaskTimeoutFlag>(
+            loopThread_.getLoop(),
+            std::chrono::duration<double>(timeout_),
+            [expCbPtr]() {
+                if (*expCbPtr)
+                {
+                    (*expCbPtr)(RedisException(RedisErrorCode::kTimeout,
+                                               "Command execution timeout"));
+                }
+            });
+        resultCallback = [resultCallback = std::move(resultCallback),
+                          timeoutFlagPtr](const RedisResult &result) {
+            if (timeoutFlagPtr->done())
+            {
+                return;
+            }
+            if (resultCallback)
+            {
+                resultCallback(result);
+            }
+        };
+        exceptionCallback = [expCbPtr,
+                             timeoutFlagPtr](const RedisException &err) {
+            if (timeoutFlagPtr->done())
+            {
+                return;
+            }
+            if (*expCbPtr)
+            {
+                (*expCbPtr)(err);
+            }
+        };
+    }
+
+    auto arguments = RedisConnection::parseFormattedCommand(formattedCmd);
+    auto name = arguments.empty() ? std::string() : lowerName(arguments[0]);
+    auto indexes = keyIndexes(name, arguments);
+    std::vector<int> slots;
+    slots.reserve(indexes.size());
+    bool crossSlot = false;
+    for (auto index : indexes)
+    {
+        slots.push_back(keySlot(arguments[index]));
+        crossSlot = crossSlot || slots.back() != slots.front();
+    }
+    if (!crossSlot)
+    {
+        execFormattedCommand(std::move(formattedCmd),
+                             slots.empty() ? -1 : slots.front(),
+                             std::move(resultCallback),
+                             std::move(exceptionCallback));
+    }
+    else if (name == "mget" || name == "mset" || name == "del" ||
+             name == "unlink" || name == "exists" || name == "touch")
+    {
+        splitCommand(arguments,
+                     indexes,
+                     slots,
+                     std::move(resultCallback),
+                     std::move(exceptionCallback));
+    }
+    else
+    {
+        exceptionCallback(
+            RedisException(RedisErrorCode::kRedisError,
+                           "CROSSSLOT Keys in request don't hash to the same "
+                           "slot"));
+    }
+    if (timeoutFlagPtr)
+    {
+        timeoutFlagPtr->runTimer();
+    }
+}
+
+void RedisClusterClient::execFormattedCommand(
+    std::string &&command,
+    int slot,
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback)
+{
+    auto cmd = std::make_shared<ClusterCommand>();
+    cmd->command = std::move(command);
+    cmd->slot = slot;
+    cmd->resultCallback = std::move(resultCallback);
+    cmd->exceptionCallback = std::move(exceptionCallback);
+    sendCommand(cmd, getSlotOwner(slot), false);
+}
+
+void RedisClusterClient::splitCommand(
+    const std::vector<std::string_view> &arguments,
+    const std::vector<size_t> &keyIndexes,
+    const std::vector<int> &keySlots,
+    RedisResultCallback &&resultCallback,
+    RedisExceptionCallback &&exceptionCallback)
+{
+    // The positions of the keys in keyIndexes, grouped by slot
+    std::vector<std::pair<int, std::vector<size_t>>> groups;
+    for (size_t i = 0; i < keySlots.size(); ++i)
+    {
+        auto iter = std::find_if(groups.begin(),
+                                 groups.end(),
+                                 [slot = keySlots[i]](const auto &group) {
+                                     return group.first == slot;
+                                 });
+        if (iter == groups.end())
+        {
+            groups.emplace_back(keySlots[i], std::vector<size_t>{i});
+        }
+        else
+        {
+            iter->second.push_back(i);
+        }
+    }
+    auto split = std::make_shared<SplitCommand>();
+    split->name = lowerName(arguments[0]);
+    split->pending = groups.size();
+    split->resultCallback = std::move(resultCallback);
+    split->exceptionCallback = std::move(exceptionCallback);
+    if (split->name == "mget")
+    {
+        split->values.resize(keyIndexes.size());
+    }
+    auto finish = [split]() {
+        std::string reply;
+        if (split->name == "mget")
+        {
+            reply.append("*")
+                .append(std::to_string(split->values.size()))
+                .append("\r\n");
+            for (auto &value : split->values)
+            {
+                reply.append(value);
+            }
+        }
+        else if (split->name == "mset")
+        {
+            reply = "+OK\r\n";
+        }
+        else
+        {
+            reply = ":" + std::to_string(split->count) + "\r\n";
+        }
+        deliverReply(reply, split->resultCallback, split->exceptionCallback);
+    };
+    auto fail = [split](const RedisException &err) {
+        {
+            std::lock_guard<std::mutex> lock(split->mutex);
+            if (split->failed)
+                return;
+            split->failed = true;
+        }
+        split->exceptionCallback(err);
+    };
+    for (auto &group : groups)
+    {
+        std::vector<std::string_view> subArguments{arguments[0]};
+        for (auto pos : group.second)
+        {
+            subArguments.push_back(arguments[keyIndexes[pos]]);
+            if (split->name == "mset")
+            {
+                subArguments.push_back(arguments[keyIndexes[pos] + 1]);
+            }
+        }
+        execFormattedCommand(
+            RedisConnection::formatCommand(subArguments),
+            group.first,
+            [split, positions = std::move(group.second), finish, fail](
+                const RedisResult &result) {
+                bool done = false;
+                try
+                {
+                    std::lock_guard<std::mutex> lock(split->mutex);
+                    if (split->failed)
+                        return;
+                    if (split->name == "mget")
+                    {
+                        auto values = result.asArray();
+                        for (size_t i = 0;
+                             i < values.size() && i < positions.size();
+                             ++i)
+                        {
+                            auto &value = split->values[positions[i]];
+                            if (values[i].isNil())
+                            {
+                                value = "$-1\r\n";
+                            }
+                            else
+                            {
+                                auto str = values[i].asString();
+                                value.append("$")
+                                    .append(std::to_string(str.length()))
+                                    .append("\r\n")
+                                    .append(str)
+                                    .append("\r\n");
+                            }
+                        }
+                    }
+                    else if (result.type() == RedisResultType::kInteger)
+                    {
+                        split->count += result.asInteger();
+                    }
+                    done = --split->pending == 0;
+                }
+                catch (const std::exception &e)
+                {
+                    fail(RedisException(RedisErrorCode::kBadType, e.what()));
+                    return;
+                }
+                if (done)
+                {
+                    finish();
+                }
+            },
+            fail);
+    }
+}
+
+std::shared_ptr<RedisBatch> RedisClusterClient::newBatch() noexcept
+{
+    std::weak_ptr<RedisClusterClient> weakThis = shared_from_this();
+    return std::make_shared<RedisBatchImpl>(
+        [weakThis](std::string &&commands,
+                   std::vector<size_t> &&lengths,
+                   RedisBatchCallback &&resultCallback,
+                   RedisExceptionCallback &&exceptionCallback) {
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr)
+            {
+                exceptionCallback(
+                    RedisException(RedisErrorCode::kNoConnectionAvailable,
+                                   "The redis client has been destroyed"));
+                return;
+            }
+            thisPtr->execBatch(std::move(commands),
+                               std::move(lengths),
+                               std::move(resultCallback),
+                               std::move(exceptionCallback));
+        },
+        loopThread_.getLoop(),
+        timeout_);
+}
+
+void RedisClusterClient::execBatch(std::string &&commands,
+                                   std::vector<size_t> &&lengths,
+                                   RedisBatchCallback &&resultCallback,
+                                   RedisExceptionCallback &&exceptionCallback)
+{
+    // The commands are grouped by node, each group is sent as a batch. The
+    // commands of a group that are redirected are sent again one by one.
+    struct NodeBatch
+    {
+        NodePtr node;
+        std::string commands;
+        std::vector<size_t> lengths;
+        std::vector<size_t> indexes;
+        std::vector<int> slots;
+    };
+    auto replies =
+        std::make_shared<RedisBatchReplies>(lengths.size(),
+                                            std::move(resultCallback),
+                                            std::move(exceptionCallback));
+    auto allCommands = std::make_shared<std::string>(std::move(commands));
+    // The commands in allCommands, which is not modified any more
+    auto views = std::make_shared<std::vector<std::string_view>>();
+    views->reserve(lengths.size());
+    std::vector<NodeBatch> batches;
+    size_t offset = 0;
+    for (size_t i = 0; i < lengths.size(); ++i)
+    {
+        std::string_view command(allCommands->data() + offset, lengths[i]);
+        views->push_back(command);
+        offset += lengths[i];
+        auto arguments = RedisConnection::parseFormattedCommand(command);
+        auto name = arguments.empty() ? std::string() : lowerName(arguments[0]);
+        auto indexes = keyIndexes(name, arguments);
+        int slot = indexes.empty() ? -1 : keySlot(arguments[indexes[0]]);
+        auto node = getSlotOwner(slot);
+        if (!node)
+        {
+            replies->setException(
+                i,
+                RedisException(RedisErrorCode::kNoConnectionAvailable,
+                               "No node of the redis cluster is available"));
+            return;
+        }
+        auto iter = std::find_if(batches.begin(),
+                                 batches.end(),
+                                 [&node](const NodeBatch &batch) {
+                                     return batch.node == node;
+                                 });
+        if (iter == batches.end())
+        {
+            batches.push_back(NodeBatch{node, {}, {}, {}, {}});
+            iter = batches.end() - 1;
+        }
+        iter->commands.append(command);
+        iter->lengths.push_back(lengths[i]);
+        iter->indexes.push_back(i);
+        iter->slots.push_back(slot);
+    }
+    std::weak_ptr<RedisClusterClient> weakThis = shared_from_this();
+    for (auto &batch : batches)
+    {
+        auto firstIndex = batch.indexes.front();
+        batch.node->execBatchAsync(
+            std::move(batch.commands),
+            std::move(batch.lengths),
+            [weakThis,
+             replies,
+             allCommands,
+             views,
+             indexes = std::move(batch.indexes),
+             slots = std::move(batch.slots)](
+                const std::vector<RedisResult> &results) {
+                for (size_t j = 0; j < results.size() && j < indexes.size();
+                     ++j)
+                {
+                    auto index = indexes[j];
+                    if (results[j].type() != RedisResultType::kError)
+                    {
+                        replies->setResult(index, results[j]);
+                        continue;
+                    }
+                    auto message = results[j].asString();
+                    auto thisPtr = weakThis.lock();
+                    if (!thisPtr || (message.compare(0, 6, "MOVED ") != 0 &&
+                                     message.compare(0, 4, "ASK ") != 0 &&
+                                     message.compare(0, 8, "TRYAGAIN") != 0))
+                    {
+                        replies->setResult(index, results[j]);
+                        continue;
+                    }
+                    auto cmd = std::make_shared<ClusterCommand>();
+                    cmd->command = std::string((*views)[index]);
+                    cmd->slot = slots[j];
+                    cmd->resultCallback = [replies,
+                                           index](const RedisResult &result) {
+                        replies->setResult(index, result);
+                    };
+                    cmd->exceptionCallback =
+                        [replies, index](const RedisException &err) {
+                            replies->setException(index, err);
+                        };
+                    thisPtr->handleError(
+                        cmd,
+                        RedisException(RedisErrorCode::kRedisError,
+                                       std::move(message)));
+                }
+            },
+            [replies, firstIndex](const RedisException &err) {
+                replies->setException(firstIndex, err);
+            });
+    }
+}
+
+void RedisClusterClient::sendCommand(const ClusterCommandPtr &command,
+                                     const NodePtr &node,
+                                     bool asking)
+{
+    if (!node)
+    {
+        command->exceptionCallback(
+            RedisException(RedisErrorCode::kNoConnectionAvailable,
+                           "No node of the redis cluster is available"));
+        return;
+    }
+    std::weak_ptr<RedisClusterClient> weakThis = shared_from_this();
+    node->execFormattedCommandAsync(
+        std::string(command->command),
+        [command](const RedisResult &result) {
+            command->resultCallback(result);
+        },
+        [weakThis, command](const RedisException &err) {
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr)
+            {
+                command->exceptionCallback(err);
+                return;
+            }
+            thisPtr->handleError(command, err);
+        },
+        asking);
+}
+
+void RedisClusterClient::handleError(const ClusterCommandPtr &command,
+                                     const RedisException &err)
+{
+    std::string_view message(err.what());
+    if (err.code() == RedisErrorCode::kConnectionBroken ||
+        (err.code() == RedisErrorCode::kRedisError &&
+         message.compare(0, 11, "CLUSTERDOWN") == 0))
+    {
+        refreshTopology();
+    }
+    if (err.code() != RedisErrorCode::kRedisError ||
+        command->redirections >= kMaxRedirections)
+    {
+        command->exceptionCallback(err);
+        return;
+    }
+    if (message.compare(0, 8, "TRYAGAIN") == 0)
+    {
+        // The keys of a multi-key command are being migrated
+        ++command->redirections;
+        std::weak_ptr<RedisClusterClient> weakThis = shared_from_this();
+        loopThread_.getLoop()->runAfter(kTryAgainDelay, [weakThis, command]() {
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr)
+            {
+                return;
+            }
+            thisPtr->sendCommand(command,
+                                 thisPtr->getSlotOwner(command->slot),
+                                 false);
+        });
+        return;
+    }
+    // MOVED <slot> <host>:<port> or ASK <slot> <host>:<port>
+    bool moved = message.compare(0, 6, "MOVED ") == 0;
+    bool ask = message.compare(0, 4, "ASK ") == 0;
+    auto slotPos = moved ? 6 : 4;
+    auto addrPos = message.find(' ', slotPos);
+    auto portPos = message.rfind(':');
+    if ((!moved && !ask) || addrPos == std::string_view::npos ||
+        portPos == std::string_view::npos || portPos <= addrPos + 1)
+    {
+        command->exceptionCallback(err);
+        return;
+    }
+    auto slot = atoi(message.data() + slotPos);
+    std::string host(message.substr(addrPos + 1, portPos - addrPos - 1));
+    auto port = static_cast<uint16_t>(atoi(message.data() + portPos + 1));
+    NodePtr node;
+    {
+        std::lock_guard<std::mutex> lock(nodesMutex_);
+        node = getNodeInLock(host, port);
+        if (moved && slot >= 0 && slot < static_cast<int>(kSlotsNumber))
+        {
+            slots_[slot] = node;
+        }
+    }
+    if (moved)
+    {
+        refreshTopology();
+    }
+    ++command->redirections;
+    sendCommand(command, node, ask);
+}
+
+void RedisClusterClient::refreshTopology()
+{
+    if (refreshing_.exchange(true))
+    {
+        refreshRequested_ = true;
+        return;
+    }
+    std::string address;
+    auto node = getNextNode(address);
+    if (!node)
+    {
+        refreshing_ = false;
+        return;
+    }
+    auto host = address.substr(0, address.rfind(':'));
+    std::weak_ptr<RedisClusterClient> weakThis = shared_from_this();
+    auto timeoutFlagPtr = std::make_shared<TaskTimeoutFlag>(
+        loopThread_.getLoop(),
+        std::chrono::duration<double>(kRefreshTimeout),
+        [weakThis, address]() {
+            LOG_ERROR << "Timeout when getting the slots from " << address;
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr)
+                return;
+            thisPtr->refreshRequested_ = true;
+            thisPtr->endRefreshing();
+        });
+    node->execFormattedCommandAsync(
+        "*2\r\n$7\r\nCLUSTER\r\n$5\r\nSLOTS\r\n",
+        [weakThis, host, timeoutFlagPtr](const RedisResult &result) {
+            if (timeoutFlagPtr->done())
+                return;
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr)
+                return;
+            try
+            {
+                thisPtr->updateTopology(result, host);
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR << "Invalid reply of CLUSTER SLOTS: " << e.what();
+                thisPtr->refreshRequested_ = true;
+            }
+            thisPtr->endRefreshing();
+        },
+        [weakThis, address, timeoutFlagPtr](const RedisException &err) {
+            if (timeoutFlagPtr->done())
+                return;
+            LOG_ERROR << "Failed to get the slots from " << address << ": "
+                      << err.what();
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr)
+                return;
+            // Ask another node next time
+            thisPtr->refreshRequested_ = true;
+            thisPtr->endRefreshing();
+        });
+    timeoutFlagPtr->runTimer();
+}
+
+void RedisClusterClient::updateTopology(const RedisResult &result,
+                                        const std::string &queriedHost)
+{
+    // Each item is [start slot, end slot, [host, port, id], replicas...]
+    std::vector<NodePtr> slots(kSlotsNumber);
+    std::lock_guard<std::mutex> lock(nodesMutex_);
+    for (auto &range : result.asArray())
+    {
+        auto fields = range.asArray();
+        if (fields.size() < 3)
+            continue;
+        auto start = fields[0].asInteger();
+        auto end = fields[1].asInteger();
+        auto master = fields[2].asArray();
+        if (master.size() < 2 || start < 0 || start > end ||
+            end >= static_cast<long long>(kSlotsNumber))
+            continue;
+        auto host = master[0].asString();
+        // An empty or unknown endpoint means the node that is queried
+        if (host.empty() || host == "?")
+            host = queriedHost;
+        auto node =
+            getNodeInLock(host, static_cast<uint16_t>(master[1].asInteger()));
+        std::fill(slots.begin() + start, slots.begin() + end + 1, node);
+    }
+    slots_.swap(slots);
+}
+
+void RedisClusterClient::endRefreshing()
+{
+    // The refreshes requested in the meantime are done in one go later, so
+    // that a burst of MOVED replies doesn't flood the cluster.
+    std::weak_ptr<RedisClusterClient> weakThis = shared_from_this();
+    loopThread_.getLoop()->runAfter(kRefreshInterval, [weakThis]() {
+        auto thisPtr = weakThis.lock();
+        if (!thisPtr)
+            return;
+        thisPtr->refreshing_ = false;
+        if (thisPtr->refreshRequested_.exchange(false))
+        {
+            thisPtr->refreshTopology();
+        }
+    });
+}
+
+std::shared_ptr<RedisSubscriber> RedisClusterClient::newSubscriber() noexcept
+{
+    // Messages published in a cluster are forwarded to all the nodes
+    std::string address;
+    auto node = getNextNode(address);
+    if (!node)
+    {
+        LOG_ERROR << "No node of the redis cluster is available";
+        return nullptr;
+    }
+    return node->newSubscriber();
+}
+
+RedisTransactionPtr RedisClusterClient::newTransaction() noexcept(false)
+{
+    throw RedisException(
+        RedisErrorCode::kInternalError,
+        "Transactions are not supported by the redis cluster client");
+}
+
+void RedisClusterClient::newTransactionAsync(
+    const std::function<void(const RedisTransactionPtr &)> &callback)
+{
+    LOG_ERROR << "Transactions are not supported by the redis cluster client";
+    callback(nullptr);
+}
@@ -0,0 +1,131 @@
+/**
+ *
+ *  @file RedisClusterClient.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include "RedisClientImpl.h"
+#include <drogon/nosql/RedisClient.h>
+#include <trantor/utils/NonCopyable.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace drogon
+{
+namespace nosql
+{
+/**
+ * @brief A client of a redis cluster. It keeps a RedisClientImpl for each
+ * master and sends every command to the master that owns the slot of its keys.
+ */
+class RedisClusterClient final
+    : public RedisClient,
+      public trantor::NonCopyable,
+      public std::enable_shared_from_this<RedisClusterClient>
+{
+  public:
+    static constexpr size_t kSlotsNumber = 16384;
+
+    RedisClusterClient(std::vector<trantor::InetAddress> seedNodes,
+                       size_t connectionsPerNode,
+                       std::string username = "",
+                       std::string password = "");
+    void execCommandAsync(RedisResultCallback &&resultCallback,
+                          RedisExceptionCallback &&exceptionCallback,
+                          std::string_view command,
+                          ...) noexcept override;
+    ~RedisClusterClient() override;
+    std::shared_ptr<RedisSubscriber> newSubscriber() noexcept override;
+    std::shared_ptr<RedisBatch> newBatch() noexcept override;
+    RedisTransactionPtr newTransaction() noexcept(false) override;
+    void newTransactionAsync(
+        const std::function<void(const RedisTransactionPtr &)> &callback)
+        override;
+
+    void setTimeout(double timeout) override
+    {
+        timeout_ = timeout;
+    }
+
+    void init();
+    void closeAll() override;
+
+    /**
+     * @brief The slot of a key, only the part between the first '{' and the
+     * next '}' is hashed if it is not empty.
+     */
+    static uint16_t keySlot(std::string_view key);
+
+  private:
+    using NodePtr = std::shared_ptr<RedisClientImpl>;
+
+    struct ClusterCommand
+    {
+        std::string command;
+        int slot{-1};
+        size_t redirections{0};
+        RedisResultCallback resultCallback;
+        RedisExceptionCallback exceptionCallback;
+    };
+    using ClusterCommandPtr = std::shared_ptr<ClusterCommand>;
+
+    struct SplitCommand;
+
+    trantor::EventLoopThread loopThread_;
+    std::mutex nodesMutex_;
+    std::unordered_map<std::string, NodePtr> nodes_;
+    std::vector<NodePtr> slots_;
+    std::vector<std::string> seedNodes_;
+    size_t nodePos_{0};
+    const std::string username_;
+    const std::string password_;
+    const size_t connectionsPerNode_;
+    double timeout_{-1.0};
+    std::atomic<bool> refreshing_{false};
+    std::atomic<bool> refreshRequested_{false};
+
+    NodePtr getNodeInLock(const std::string &host, uint16_t port);
+    NodePtr getSlotOwner(int slot);
+    NodePtr getNextNode(std::string &address);
+
+    void execFormattedCommand(std::string &&command,
+                              int slot,
+                              RedisResultCallback &&resultCallback,
+                              RedisExceptionCallback &&exceptionCallback);
+    void splitCommand(const std::vector<std::string_view> &arguments,
+                      const std::vector<size_t> &keyIndexes,
+                      const std::vector<int> &keySlots,
+                      RedisResultCallback &&resultCallback,
+                      RedisExceptionCallback &&exceptionCallback);
+    void execBatch(std::string &&commands,
+                   std::vector<size_t> &&lengths,
+                   RedisBatchCallback &&resultCallback,
+                   RedisExceptionCallback &&exceptionCallback);
+    void sendCommand(const ClusterCommandPtr &command,
+                     const NodePtr &node,
+                     bool asking);
+    void handleError(const ClusterCommandPtr &command,
+                     const RedisException &err);
+    void refreshTopology();
+    void updateTopology(const RedisResult &result,
+                        const std::string &queriedHost);
+    void endRefreshing();
+};
+}  // namespace nosql
+}  // namespace drogon
@@ -13,6 +13,7 @@
  */
 
 #include "RedisConnection.h"
+#include "RedisBatchImpl.h"
 #include <drogon/nosql/RedisResult.h>
 #include <future>
 #include <string.h>
@@ -43,8 +44,18 @@ void RedisConnection::startConnectionInLoop()
     loop_->assertInLoopThread();
     assert(!redisContext_);
 
+#ifdef REDIS_OPT_NOAUTOFREEREPLIES
+    // The replies are freed by the results that share them, see
+    // handleResult()
+    auto ip = serverAddr_.toIp();
+    redisOptions options{};
+    REDIS_OPTIONS_SET_TCP(&options, ip.c_str(), serverAddr_.toPort());
+    options.options |= REDIS_OPT_NOAUTOFREEREPLIES;
+    redisContext_ = ::redisAsyncConnectWithOptions(&options);
+#else
     redisContext_ =
         ::redisAsyncConnect(serverAddr_.toIp().c_str(), serverAddr_.toPort());
+#endif
     status_ = ConnectStatus::kConnecting;
     if (redisContext_->err)
     {
@@ -95,12 +106,7 @@ void RedisConnection::startConnectionInLoop()
                 {
                     if (thisPtr->db_ == 0)
                     {
-                        thisPtr->status_ = ConnectStatus::kConnected;
-                        if (thisPtr->connectCallback_)
-                        {
-                            thisPtr->connectCallback_(
-                                thisPtr->shared_from_this());
-                        }
+                        thisPtr->handleConnected();
                     }
                 }
                 else
@@ -118,11 +124,7 @@ void RedisConnection::startConnectionInLoop()
                                 {
                                     if (thisPtr->db_ == 0)
                                     {
-                                        thisPtr->status_ =
-                                            ConnectStatus::kConnected;
-                                        if (thisPtr->connectCallback_)
-                                            thisPtr->connectCallback_(
-                                                thisPtr->shared_from_this());
+                                        thisPtr->handleConnected();
                                     }
                                 }
                                 else
@@ -156,11 +158,7 @@ void RedisConnection::startConnectionInLoop()
                                 {
                                     if (thisPtr->db_ == 0)
                                     {
-                                        thisPtr->status_ =
-                                            ConnectStatus::kConnected;
-                                        if (thisPtr->connectCallback_)
-                                            thisPtr->connectCallback_(
-                                                thisPtr->shared_from_this());
+                                        thisPtr->handleConnected();
                                     }
                                 }
                                 else
@@ -196,12 +194,7 @@ void RedisConnection::startConnectionInLoop()
                                 return;
                             if (r.asString() == "OK")
                             {
-                                thisPtr->status_ = ConnectStatus::kConnected;
-                                if (thisPtr->connectCallback_)
-                                {
-                                    thisPtr->connectCallback_(
-                                        thisPtr->shared_from_this());
-                                }
+                                thisPtr->handleConnected();
                             }
                             else
                             {
@@ -238,6 +231,95 @@ void RedisConnection::startConnectionInLoop()
         });
 }
 
+void RedisConnection::handleConnected()
+{
+    if (!trackingCommand_.empty())
+    {
+        startTrackingInLoop();
+    }
+    status_ = ConnectStatus::kConnected;
+    if (connectCallback_)
+    {
+        connectCallback_(shared_from_this());
+    }
+}
+
+void RedisConnection::enableTracking(
+    std::string &&trackingCommand,
+    std::function<void(const RedisResult &)> &&pushCallback)
+{
+    auto enableInLoop = [thisPtr = shared_from_this(),
+                         trackingCommand = std::move(trackingCommand),
+                         pushCallback = std::move(pushCallback)]() mutable {
+        thisPtr->trackingCommand_ = std::move(trackingCommand);
+        thisPtr->pushCallback_ = std::move(pushCallback);
+        if (thisPtr->status_ == ConnectStatus::kConnected)
+        {
+            thisPtr->startTrackingInLoop();
+        }
+    };
+    if (loop_->isInLoopThread())
+    {
+        enableInLoop();
+    }
+    else
+    {
+        loop_->queueInLoop(std::move(enableInLoop));
+    }
+}
+
+void RedisConnection::startTrackingInLoop()
+{
+    loop_->assertInLoopThread();
+#ifdef REDIS_REPLY_PUSH
+    redisAsyncSetPushCallback(redisContext_,
+                              [](redisAsyncContext *context, void *r) {
+                                  auto thisPtr = static_cast<RedisConnection *>(
+                                      context->ev.data);
+                                  if (thisPtr)
+                                  {
+                                      thisPtr->handlePush(
+                                          static_cast<redisReply *>(r));
+                                  }
+                              });
+    // The invalidation messages are pushed to the connection that reads the
+    // keys, which requires RESP3. Both commands are sent before any other
+    // command of the connection.
+    std::weak_ptr<RedisConnection> weakThisPtr = shared_from_this();
+    sendCommandInLoop(
+        "*2\r\n$5\r\nHELLO\r\n$1\r\n3\r\n",
+        [weakThisPtr](const RedisResult &) {
+            auto thisPtr = weakThisPtr.lock();
+            if (thisPtr)
+                thisPtr->resp3_ = true;
+        },
+        [](const RedisException &err) {
+            LOG_ERROR << "Failed to switch to RESP3: " << err.what();
+        });
+    sendCommandInLoop(
+        trackingCommand_,
+        [weakThisPtr](const RedisResult &r) {
+            auto thisPtr = weakThisPtr.lock();
+            if (thisPtr)
+                thisPtr->tracking_ = thisPtr->resp3_ && r.asString() == "OK";
+        },
+        [](const RedisException &err) {
+            LOG_ERROR << "Failed to enable the client tracking: "
+                      << err.what();
+        });
+#else
+    LOG_ERROR << "The client tracking requires hiredis 1.0.0 or later";
+#endif
+}
+
+void RedisConnection::handlePush(redisReply *message)
+{
+    if (pushCallback_)
+    {
+        pushCallback_(RedisResult(message));
+    }
+}
+
 void RedisConnection::handleDisconnect()
 {
     LOG_TRACE << "handleDisconnect";
@@ -254,6 +336,7 @@ void RedisConnection::handleDisconnect()
         exceptionCallbacks_.pop();
     }
     status_ = ConnectStatus::kEnd;
+    tracking_ = false;
     channel_->disableAll();
     channel_->remove();
     redisContext_->ev.addWrite = nullptr;
@@ -313,8 +396,88 @@ void RedisConnection::handleRedisWrite()
     }
 }
 
+std::vector<std::string_view> RedisConnection::parseFormattedCommand(
+    std::string_view command)
+{
+    std::vector<std::string_view> arguments;
+    if (command.empty() || command[0] != '*')
+        return arguments;
+    char *end;
+    auto count = strtol(command.data() + 1, &end, 10);
+    size_t pos = end - command.data() + 2;
+    arguments.reserve(count > 0 ? count : 0);
+    for (long i = 0; i < count; ++i)
+    {
+        if (pos >= command.length() || command[pos] != '$')
+            return {};
+        auto length = strtol(command.data() + pos + 1, &end, 10);
+        pos = end - command.data() + 2;
+        if (length < 0 ||
+            pos + static_cast<size_t>(length) > command.length())
+            return {};
+        arguments.emplace_back(command.data() + pos, length);
+        pos += static_cast<size_t>(length) + 2;
+    }
+    return arguments;
+}
+
+std::string RedisConnection::formatCommand(
+    const std::vector<std::string_view> &arguments)
+{
+    std::string command;
+    command.append("*").append(std::to_string(arguments.size())).append("\r\n");
+    for (auto &argument : arguments)
+    {
+        command.append("$")
+            .append(std::to_string(argument.size()))
+            .append("\r\n")
+            .append(argument)
+            .append("\r\n");
+    }
+    return command;
+}
+
+void RedisConnection::sendBatch(std::string &&commands,
+                                std::vector<size_t> &&lengths,
+                                RedisBatchCallback &&resultCallback,
+                                RedisExceptionCallback &&exceptionCallback)
+{
+    auto replies =
+        std::make_shared<RedisBatchReplies>(lengths.size(),
+                                            std::move(resultCallback),
+                                            std::move(exceptionCallback));
+    auto sendInLoop = [this,
+                       replies,
+                       commands = std::move(commands),
+                       lengths = std::move(lengths)]() {
+        // hiredis appends the commands to its output buffer, which is written
+        // when the socket is writable, so the batch is sent at once.
+        size_t offset = 0;
+        for (size_t i = 0; i < lengths.size(); ++i)
+        {
+            sendCommandInLoop(
+                std::string_view(commands.data() + offset, lengths[i]),
+                [replies, i](const RedisResult &result) {
+                    replies->setResult(i, result);
+                },
+                [replies, i](const RedisException &err) {
+                    replies->setException(i, err);
+                });
+            offset += lengths[i];
+        }
+    };
+    if (loop_->isInLoopThread())
+    {
+        sendInLoop();
+    }
+    else
+    {
+        loop_->queueInLoop(std::move(sendInLoop));
+    }
+}
+
 void RedisConnection::sendCommandInLoop(
-    const std::string &command,
+    std::string_view command,
     RedisResultCallback &&resultCallback,
     RedisExceptionCallback &&exceptionCallback)
 {
@@ -328,19 +491,36 @@ void RedisConnection::sendCommandInLoop(
             thisPtr->handleResult(static_cast<redisReply *>(r));
         },
         nullptr,
-        command.c_str(),
+        command.data(),
         command.length());
 }
 
 void RedisConnection::handleResult(redisReply *result)
 {
+#ifdef REDIS_OPT_NOAUTOFREEREPLIES
+    std::shared_ptr<redisReply> handle(result, [](redisReply *reply) {
+        if (reply)
+            freeReplyObject(reply);
+    });
+#else
+    std::shared_ptr<redisReply> handle;
+#endif
+#ifdef REDIS_REPLY_PUSH
+    // Push messages are not the replies of commands, hiredis passes them to
+    // the push callback but older versions pass them here.
+    if (result && result->type == REDIS_REPLY_PUSH)
+    {
+        handlePush(result);
+        return;
+    }
+#endif
     auto commandCallback = std::move(resultCallbacks_.front());
     resultCallbacks_.pop();
     auto exceptionCallback = std::move(exceptionCallbacks_.front());
     exceptionCallbacks_.pop();
     if (result && result->type != REDIS_REPLY_ERROR)
     {
-        commandCallback(RedisResult(result));
+        commandCallback(RedisResult(result, std::move(handle)));
     }
     else
     {
@@ -446,6 +626,13 @@ void RedisConnection::sendUnsubscribeInLoop(
 void RedisConnection::handleSubscribeResult(redisReply *result,
                                             SubscribeContext *subCtx)
 {
+#ifdef REDIS_OPT_NOAUTOFREEREPLIES
+    std::unique_ptr<redisReply, void (*)(redisReply *)> guard(
+        result, [](redisReply *reply) {
+            if (reply)
+                freeReplyObject(reply);
+        });
+#endif
     if (result && result->type == REDIS_REPLY_ARRAY && result->elements >= 3 &&
         result->element[0]->type == REDIS_REPLY_STRING)
     {
@@ -16,6 +16,7 @@
 #include <string_view>
 #include <drogon/nosql/RedisException.h>
 #include <drogon/nosql/RedisResult.h>
+#include <drogon/nosql/RedisClient.h>
 #include <drogon/utils/Utilities.h>
 #include <trantor/utils/NonCopyable.h>
 #include <trantor/net/InetAddress.h>
@@ -25,6 +26,7 @@
 #include <hiredis/hiredis.h>
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "SubscribeContext.h"
 
@@ -96,6 +98,19 @@ class RedisConnection : public trantor::NonCopyable,
         return fullCommand;
     }
 
+    /**
+     * @brief The arguments of a command formatted by getFormattedCommand(),
+     * the result is empty if the command is malformed.
+     */
+    static std::vector<std::string_view> parseFormattedCommand(
+        std::string_view command);
+
+    /**
+     * @brief Format a command from its arguments.
+     */
+    static std::string formatCommand(
+        const std::vector<std::string_view> &arguments);
+
     void sendFormattedCommand(std::string &&command,
                               RedisResultCallback &&resultCallback,
                               RedisExceptionCallback &&exceptionCallback)
@@ -120,6 +135,45 @@ class RedisConnection : public trantor::NonCopyable,
         }
     }
 
+    /**
+     * @brief Send an ASKING command followed by the command, the cluster
+     * client uses it to follow an ASK redirection. Both are queued together
+     * so that no other command is sent between them.
+     */
+    void sendAskingCommand(std::string &&command,
+                           RedisResultCallback &&resultCallback,
+                           RedisExceptionCallback &&exceptionCallback)
+    {
+        auto sendInLoop = [this,
+                           callback = std::move(resultCallback),
+                           exceptionCallback = std::move(exceptionCallback),
+                           command = std::move(command)]() mutable {
+            sendCommandInLoop("*1\r\n$6\r\nASKING\r\n",
+                              [](const RedisResult &) {},
+                              [](const RedisException &) {});
+            sendCommandInLoop(command,
+                              std::move(callback),
+                              std::move(exceptionCallback));
+        };
+        if (loop_->isInLoopThread())
+        {
+            sendInLoop();
+        }
+        else
+        {
+            loop_->queueInLoop(std::move(sendInLoop));
+        }
+    }
+
+    /**
+     * @brief Send the formatted commands of a batch, they are written to the
+     * socket together.
+     */
+    void sendBatch(std::string &&commands,
+                   std::vector<size_t> &&lengths,
+                   RedisBatchCallback &&resultCallback,
+                   RedisExceptionCallback &&exceptionCallback);
+
     void sendvCommand(std::string_view command,
                       RedisResultCallback &&resultCallback,
                       RedisExceptionCallback &&exceptionCallback,
@@ -185,6 +239,26 @@ class RedisConnection : public trantor::NonCopyable,
         return loop_;
     }
 
+    /**
+     * @brief Switch the connection to RESP3 and send the formatted CLIENT
+     * TRACKING command, now if the connection is established or when it is.
+     * The push messages of the server, such as invalidation messages, are
+     * passed to the callback in the loop thread of the connection.
+     * @note It requires redis 6.0 and hiredis 1.0.0 or later.
+     */
+    void enableTracking(
+        std::string &&trackingCommand,
+        std::function<void(const RedisResult &)> &&pushCallback);
+
+    /**
+     * @brief Return true if the server accepted the tracking command, it
+     * must be called in the loop thread of the connection.
+     */
+    bool isTracking() const
+    {
+        return tracking_;
+    }
+
   private:
     redisAsyncContext *redisContext_{nullptr};
     const trantor::InetAddress serverAddr_;
@@ -200,6 +274,10 @@ class RedisConnection : public trantor::NonCopyable,
     std::queue<RedisResultCallback> resultCallbacks_;
     std::queue<RedisExceptionCallback> exceptionCallbacks_;
     ConnectStatus status_{ConnectStatus::kNone};
+    std::string trackingCommand_;
+    std::function<void(const RedisResult &)> pushCallback_;
+    bool resp3_{false};
+    bool tracking_{false};
 
     // used to keep the lifetime of context object
     std::unordered_map<unsigned long long, std::shared_ptr<SubscribeContext>>
@@ -214,13 +292,16 @@ class RedisConnection : public trantor::NonCopyable,
     void handleRedisRead();
     void handleRedisWrite();
     void handleResult(redisReply *result);
-    void sendCommandInLoop(const std::string &command,
+    void sendCommandInLoop(std::string_view command,
                            RedisResultCallback &&resultCallback,
                            RedisExceptionCallback &&exceptionCallback);
     void sendSubscribeInLoop(const std::shared_ptr<SubscribeContext> &subCtx);
     void sendUnsubscribeInLoop(const std::shared_ptr<SubscribeContext> &subCtx);
     void handleSubscribeResult(redisReply *result, SubscribeContext *subCtx);
 
+    void handleConnected();
+    void startTrackingInLoop();
+    void handlePush(redisReply *message);
     void handleDisconnect();
 };
 
@@ -0,0 +1,73 @@
+/**
+ *
+ *  @file RedisReplyUtils.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RedisReplyUtils.h"
+#include <hiredis/hiredis.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace drogon::nosql;
+
+redisReply *drogon::nosql::internal::makeReply(int type)
+{
+    auto reply = static_cast<redisReply *>(calloc(1, sizeof(redisReply)));
+    reply->type = type;
+    return reply;
+}
+
+redisReply *drogon::nosql::internal::makeStringReply(int type,
+                                                   const std::string &str)
+{
+    auto reply = makeReply(type);
+    reply->str = static_cast<char *>(malloc(str.length() + 1));
+    memcpy(reply->str, str.data(), str.length());
+    reply->str[str.length()] = '\0';
+    reply->len = str.length();
+    return reply;
+}
+
+redisReply *drogon::nosql::internal::copyReply(const RedisResult &result)
+{
+    switch (result.type())
+    {
+        case RedisResultType::kInteger:
+        {
+            auto reply = makeReply(REDIS_REPLY_INTEGER);
+            reply->integer = result.asInteger();
+            return reply;
+        }
+        case RedisResultType::kString:
+            return makeStringReply(REDIS_REPLY_STRING, result.asString());
+        case RedisResultType::kStatus:
+            return makeStringReply(REDIS_REPLY_STATUS, result.asString());
+        case RedisResultType::kArray:
+        {
+            auto elements = result.asArray();
+            auto reply = makeReply(REDIS_REPLY_ARRAY);
+            reply->elements = elements.size();
+            reply->element = static_cast<redisReply **>(
+                calloc(elements.size(), sizeof(redisReply *)));
+            for (size_t i = 0; i < elements.size(); ++i)
+            {
+                reply->element[i] = copyReply(elements[i]);
+            }
+            return reply;
+        }
+        case RedisResultType::kNil:
+            return makeReply(REDIS_REPLY_NIL);
+        case RedisResultType::kError:
+        default:
+            return makeStringReply(REDIS_REPLY_ERROR, result.asString());
+    }
+}
@@ -0,0 +1,42 @@
+/**
+ *
+ *  @file RedisReplyUtils.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/nosql/RedisResult.h>
+#include <string>
+
+struct redisReply;
+
+namespace drogon
+{
+namespace nosql
+{
+namespace internal
+{
+/**
+ * @brief The replies made by these functions are allocated like the ones of
+ * hiredis, so they are freed by freeReplyObject().
+ */
+redisReply *makeReply(int type);
+redisReply *makeStringReply(int type, const std::string &str);
+
+/**
+ * @brief A deep copy of the reply of the result, it outlives the callback that
+ * the result is passed to.
+ */
+redisReply *copyReply(const RedisResult &result);
+}  // namespace internal
+}  // namespace nosql
+}  // namespace drogon
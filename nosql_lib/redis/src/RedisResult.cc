@@ -38,6 +38,17 @@ std::string RedisResult::getStringForDisplayingWithIndent(
             return "(nil)";
         case REDIS_REPLY_INTEGER:
             return std::to_string(result_->integer);
+#ifdef REDIS_REPLY_PUSH
+        case REDIS_REPLY_BOOL:
+            return result_->integer ? "(true)" : "(false)";
+        case REDIS_REPLY_DOUBLE:
+        case REDIS_REPLY_BIGNUM:
+        case REDIS_REPLY_VERB:
+            return std::string{result_->str, result_->len};
+        case REDIS_REPLY_MAP:
+        case REDIS_REPLY_SET:
+        case REDIS_REPLY_PUSH:
+#endif
         case REDIS_REPLY_ARRAY:
         {
             std::string ret;
@@ -81,6 +92,17 @@ std::string RedisResult::asString() const noexcept(false)
     }
 }
 
+std::string_view RedisResult::asStringView() const noexcept(false)
+{
+    auto rtype = type();
+    if (rtype == RedisResultType::kString ||
+        rtype == RedisResultType::kStatus || rtype == RedisResultType::kError)
+    {
+        return std::string_view(result_->str, result_->len);
+    }
+    throw RedisException(RedisErrorCode::kBadType, "bad type");
+}
+
 RedisResultType RedisResult::type() const noexcept
 {
     switch (result_->type)
@@ -95,6 +117,20 @@ RedisResultType RedisResult::type() const noexcept
             return RedisResultType::kNil;
         case REDIS_REPLY_STATUS:
             return RedisResultType::kStatus;
+#ifdef REDIS_REPLY_PUSH
+        // The types of RESP3 (hiredis 1.0 or later), the elements of a map
+        // are its keys and values in turn.
+        case REDIS_REPLY_DOUBLE:
+        case REDIS_REPLY_BIGNUM:
+        case REDIS_REPLY_VERB:
+            return RedisResultType::kString;
+        case REDIS_REPLY_MAP:
+        case REDIS_REPLY_SET:
+        case REDIS_REPLY_PUSH:
+            return RedisResultType::kArray;
+        case REDIS_REPLY_BOOL:
+            return RedisResultType::kInteger;
+#endif
         case REDIS_REPLY_ERROR:
         default:
             return RedisResultType::kError;
@@ -109,13 +145,33 @@ std::vector<RedisResult> RedisResult::asArray() const noexcept(false)
         std::vector<RedisResult> array;
         for (size_t i = 0; i < result_->elements; ++i)
         {
-            array.emplace_back(result_->element[i]);
+            array.emplace_back(result_->element[i], handle_);
         }
         return array;
     }
     throw RedisException(RedisErrorCode::kBadType, "bad type");
 }
 
+RedisArrayView RedisResult::asArrayView() const noexcept(false)
+{
+    if (type() == RedisResultType::kArray)
+    {
+        return RedisArrayView(result_, handle_);
+    }
+    throw RedisException(RedisErrorCode::kBadType, "bad type");
+}
+
+RedisArrayView::RedisArrayView(redisReply *reply,
+                               std::shared_ptr<redisReply> handle)
+    : reply_(reply), handle_(std::move(handle)), size_(reply->elements)
+{
+}
+
+RedisResult RedisArrayView::operator[](size_t index) const noexcept
+{
+    return RedisResult(reply_->element[index], handle_);
+}
+
 long long RedisResult::asInteger() const noexcept(false)
 {
     if (type() == RedisResultType::kInteger)
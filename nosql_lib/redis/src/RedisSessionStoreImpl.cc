@@ -0,0 +1,284 @@
+/**
+ *
+ *  @file RedisSessionStoreImpl.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "RedisSessionStoreImpl.h"
+#include <cassert>
+
+using namespace drogon;
+using namespace drogon::nosql;
+
+std::shared_ptr<RedisSessionStore> RedisSessionStore::newRedisSessionStore(
+    const RedisClientPtr &client,
+    const std::string &keyPrefix,
+    size_t nearCacheSize,
+    double nearCacheTimeout,
+    double refreshInterval)
+{
+    return std::make_shared<RedisSessionStoreImpl>(client,
+                                                   keyPrefix,
+                                                   nearCacheSize,
+                                                   nearCacheTimeout,
+                                                   refreshInterval);
+}
+
+RedisSessionStoreImpl::RedisSessionStoreImpl(RedisClientPtr client,
+                                             std::string keyPrefix,
+                                             size_t nearCacheSize,
+                                             double nearCacheTimeout,
+                                             double refreshInterval)
+    : client_(std::move(client)),
+      keyPrefix_(std::move(keyPrefix)),
+      nearCacheSize_(nearCacheSize),
+      nearCacheTimeout_(nearCacheTimeout),
+      refreshInterval_(refreshInterval)
+{
+    assert(client_);
+}
+
+RedisSessionStoreImpl::~RedisSessionStoreImpl()
+{
+    if (loop_ && refreshTimerId_ != 0)
+    {
+        loop_->invalidateTimer(refreshTimerId_);
+    }
+}
+
+void RedisSessionStoreImpl::init(trantor::EventLoop *loop, size_t timeout)
+{
+    loop_ = loop;
+    timeout_ = timeout;
+    if (timeout_ == 0)
+    {
+        return;
+    }
+    std::weak_ptr<RedisSessionStoreImpl> weakPtr = shared_from_this();
+    refreshTimerId_ = loop_->runEvery(refreshInterval_, [weakPtr]() {
+        auto thisPtr = weakPtr.lock();
+        if (thisPtr)
+        {
+            thisPtr->refreshSessions();
+        }
+    });
+}
+
+SessionPtr RedisSessionStoreImpl::findSession(const std::string &sessionId,
+                                              bool isNew)
+{
+    if (isNew)
+    {
+        // A new client, there is nothing to load. The empty session is not
+        // written to redis until it is modified.
+        auto sessionPtr = newSession(sessionId, true);
+        cacheSession(sessionId, sessionPtr);
+        return sessionPtr;
+    }
+    if (nearCacheSize_ == 0)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = cachedSessionMap_.find(sessionId);
+    if (iter == cachedSessionMap_.end())
+    {
+        return nullptr;
+    }
+    auto cachedIter = iter->second;
+    if (cachedIter->expiry < trantor::Date::now())
+    {
+        cachedSessionMap_.erase(iter);
+        cachedSessions_.erase(cachedIter);
+        return nullptr;
+    }
+    cachedSessions_.splice(cachedSessions_.begin(),
+                           cachedSessions_,
+                           cachedIter);
+    return cachedIter->sessionPtr;
+}
+
+void RedisSessionStoreImpl::loadSession(const std::string &sessionId,
+                                        SessionCallback &&callback)
+{
+    std::weak_ptr<RedisSessionStoreImpl> weakPtr = shared_from_this();
+    auto key = keyPrefix_ + sessionId;
+    client_->execCommandAsync(
+        [weakPtr, sessionId, callback](const RedisResult &result) {
+            auto sessionPtr = newSession(sessionId, false);
+            if (result.type() == RedisResultType::kString &&
+                !decodeSession(sessionPtr, result.asStringView()))
+            {
+                LOG_ERROR << "Malformed data of the session " << sessionId;
+            }
+            auto thisPtr = weakPtr.lock();
+            if (thisPtr)
+            {
+                thisPtr->cacheSession(sessionId, sessionPtr);
+            }
+            callback(sessionPtr);
+        },
+        [sessionId, callback](const RedisException &err) {
+            // An empty session with the ID would overwrite the stored one
+            // when it's modified, so the request fails instead.
+            LOG_ERROR << "Failed to load the session " << sessionId << ": "
+                      << err.what();
+            callback(nullptr);
+        },
+        "get %b",
+        key.data(),
+        key.length());
+}
+
+void RedisSessionStoreImpl::saveSession(const SessionPtr &sessionPtr)
+{
+    auto sessionId = sessionPtr->sessionId();
+    if (checkDirty(sessionPtr))
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sessionsToRefresh_.erase(sessionId);
+        }
+        writeSession(sessionId, encodeSession(sessionPtr));
+        return;
+    }
+    if (timeout_ > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessionsToRefresh_.insert(std::move(sessionId));
+    }
+}
+
+void RedisSessionStoreImpl::changeSessionId(const SessionPtr &sessionPtr,
+                                            const std::string &oldId)
+{
+    auto sessionId = sessionPtr->sessionId();
+    writeSession(sessionId, encodeSession(sessionPtr));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uncacheSessionInLock(oldId);
+        sessionsToRefresh_.erase(oldId);
+    }
+    cacheSession(sessionId, sessionPtr);
+    // For requests sent before setting the new session ID to the client, we
+    // reserve the old session for a period of time.
+    auto oldKey = keyPrefix_ + oldId;
+    client_->execCommandAsync(
+        [](const RedisResult & /*result*/) {},
+        [oldKey](const RedisException &err) {
+            LOG_ERROR << "Failed to expire the session " << oldKey << ": "
+                      << err.what();
+        },
+        "expire %b 10",
+        oldKey.data(),
+        oldKey.length());
+}
+
+void RedisSessionStoreImpl::cacheSession(const std::string &sessionId,
+                                         const SessionPtr &sessionPtr)
+{
+    if (nearCacheSize_ == 0)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    uncacheSessionInLock(sessionId);
+    if (cachedSessions_.size() >= nearCacheSize_)
+    {
+        cachedSessionMap_.erase(cachedSessions_.back().sessionId);
+        cachedSessions_.pop_back();
+    }
+    cachedSessions_.push_front(
+        {sessionId, sessionPtr, trantor::Date::now().after(nearCacheTimeout_)});
+    cachedSessionMap_.emplace(cachedSessions_.front().sessionId,
+                              cachedSessions_.begin());
+}
+
+void RedisSessionStoreImpl::uncacheSessionInLock(const std::string &sessionId)
+{
+    auto iter = cachedSessionMap_.find(sessionId);
+    if (iter != cachedSessionMap_.end())
+    {
+        auto cachedIter = iter->second;
+        cachedSessionMap_.erase(iter);
+        cachedSessions_.erase(cachedIter);
+    }
+}
+
+void RedisSessionStoreImpl::writeSession(const std::string &sessionId,
+                                         const std::string &data)
+{
+    auto key = keyPrefix_ + sessionId;
+    auto exceptionCallback = [key](const RedisException &err) {
+        LOG_ERROR << "Failed to save the session " << key << ": "
+                  << err.what();
+    };
+    if (timeout_ > 0)
+    {
+        client_->execCommandAsync([](const RedisResult & /*result*/) {},
+                                  std::move(exceptionCallback),
+                                  "set %b %b ex %llu",
+                                  key.data(),
+                                  key.length(),
+                                  data.data(),
+                                  data.length(),
+                                  static_cast<unsigned long long>(timeout_));
+    }
+    else
+    {
+        client_->execCommandAsync([](const RedisResult & /*result*/) {},
+                                  std::move(exceptionCallback),
+                                  "set %b %b",
+                                  key.data(),
+                                  key.length(),
+                                  data.data(),
+                                  data.length());
+    }
+}
+
+void RedisSessionStoreImpl::refreshSessions()
+{
+    std::unordered_set<std::string> sessionIds;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessionIds.swap(sessionsToRefresh_);
+    }
+    if (sessionIds.empty())
+    {
+        return;
+    }
+    auto batch = client_->newBatch();
+    if (!batch)
+    {
+        return;
+    }
+    try
+    {
+        for (auto &sessionId : sessionIds)
+        {
+            auto key = keyPrefix_ + sessionId;
+            batch->addCommand("expire %b %llu",
+                              key.data(),
+                              key.length(),
+                              static_cast<unsigned long long>(timeout_));
+        }
+    }
+    catch (const RedisException &err)
+    {
+        LOG_ERROR << "Failed to refresh sessions: " << err.what();
+        return;
+    }
+    batch->execute([](const std::vector<RedisResult> & /*results*/) {},
+                   [](const RedisException &err) {
+                       LOG_ERROR << "Failed to refresh sessions: "
+                                 << err.what();
+                   });
+}
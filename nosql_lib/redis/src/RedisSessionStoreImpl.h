@@ -0,0 +1,83 @@
+/**
+ *
+ *  @file RedisSessionStoreImpl.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/nosql/RedisSessionStore.h>
+#include <trantor/utils/Date.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace drogon
+{
+namespace nosql
+{
+class RedisSessionStoreImpl final
+    : public RedisSessionStore,
+      public std::enable_shared_from_this<RedisSessionStoreImpl>
+{
+  public:
+    RedisSessionStoreImpl(RedisClientPtr client,
+                          std::string keyPrefix,
+                          size_t nearCacheSize,
+                          double nearCacheTimeout,
+                          double refreshInterval);
+    ~RedisSessionStoreImpl() override;
+
+    void init(trantor::EventLoop *loop, size_t timeout) override;
+    SessionPtr findSession(const std::string &sessionId, bool isNew) override;
+    void loadSession(const std::string &sessionId,
+                     SessionCallback &&callback) override;
+    void saveSession(const SessionPtr &sessionPtr) override;
+    void changeSessionId(const SessionPtr &sessionPtr,
+                         const std::string &oldId) override;
+
+  private:
+    struct CachedSession
+    {
+        std::string sessionId;
+        SessionPtr sessionPtr;
+        trantor::Date expiry;
+    };
+    using CachedSessionList = std::list<CachedSession>;
+
+    const RedisClientPtr client_;
+    const std::string keyPrefix_;
+    const size_t nearCacheSize_;
+    const double nearCacheTimeout_;
+    const double refreshInterval_;
+    trantor::EventLoop *loop_{nullptr};
+    size_t timeout_{0};
+    trantor::TimerId refreshTimerId_{0};
+
+    std::mutex mutex_;
+    // The near cache, the most recently used sessions are in the front.
+    CachedSessionList cachedSessions_;
+    std::unordered_map<std::string_view, CachedSessionList::iterator>
+        cachedSessionMap_;
+    std::unordered_set<std::string> sessionsToRefresh_;
+
+    void cacheSession(const std::string &sessionId,
+                      const SessionPtr &sessionPtr);
+    void uncacheSessionInLock(const std::string &sessionId);
+    void writeSession(const std::string &sessionId, const std::string &data);
+    void refreshSessions();
+};
+}  // namespace nosql
+}  // namespace drogon
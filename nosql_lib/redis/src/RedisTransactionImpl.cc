@@ -13,6 +13,7 @@
  */
 
 #include "RedisTransactionImpl.h"
+#include "RedisBatchImpl.h"
 #include "../../lib/src/TaskTimeoutFlag.h"
 using namespace drogon::nosql;
 
@@ -107,6 +108,37 @@ void RedisTransactionImpl::execCommandAsync(
     }
 }
 
+std::shared_ptr<RedisBatch> RedisTransactionImpl::newBatch() noexcept
+{
+    std::weak_ptr<RedisTransactionImpl> weakThis = shared_from_this();
+    return std::make_shared<RedisBatchImpl>(
+        [weakThis](std::string &&commands,
+                   std::vector<size_t> &&lengths,
+                   RedisBatchCallback &&resultCallback,
+                   RedisExceptionCallback &&exceptionCallback) {
+            auto thisPtr = weakThis.lock();
+            if (!thisPtr || thisPtr->isExecutedOrCancelled_)
+            {
+                exceptionCallback(
+                    RedisException(RedisErrorCode::kTransactionCancelled,
+                                   "Transaction was cancelled"));
+                return;
+            }
+            thisPtr->connPtr_->sendBatch(
+                std::move(commands),
+                std::move(lengths),
+                std::move(resultCallback),
+                [thisPtr, exceptionCallback = std::move(exceptionCallback)](
+                    const RedisException &err) {
+                    LOG_ERROR << err.what();
+                    thisPtr->isExecutedOrCancelled_ = true;
+                    exceptionCallback(err);
+                });
+        },
+        connPtr_->getLoop(),
+        timeout_);
+}
+
 void RedisTransactionImpl::doBegin()
 {
     assert(!isExecutedOrCancelled_);
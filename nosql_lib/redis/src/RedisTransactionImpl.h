@@ -42,6 +42,8 @@ class RedisTransactionImpl final
         return nullptr;
     }
 
+    std::shared_ptr<RedisBatch> newBatch() noexcept override;
+
     std::shared_ptr<RedisTransaction> newTransaction() override
     {
         return shared_from_this();
@@ -0,0 +1,138 @@
+#define DROGON_TEST_MAIN
+#include <drogon/nosql/RedisClient.h>
+#include <drogon/drogon_test.h>
+#include <drogon/drogon.h>
+#include <iostream>
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace drogon::nosql;
+
+// The test runs against a cluster started by the create-cluster script of the
+// redis source tree (utils/create-cluster), which listens on ports 30001-30006.
+RedisClientPtr redisClient;
+
+DROGON_TEST(RedisClusterTest)
+{
+    redisClient = drogon::nosql::RedisClient::newRedisClusterClient(
+        {trantor::InetAddress("127.0.0.1", 30001),
+         trantor::InetAddress("127.0.0.1", 30002)},
+        1);
+    REQUIRE(redisClient != nullptr);
+    redisClient->setTimeout(5.0);
+
+    // 1. Keys of different slots are sent to their owners
+    for (int i = 0; i < 20; ++i)
+    {
+        auto key = "cluster_key_" + std::to_string(i);
+        redisClient->execCommandSync(
+            [](const RedisResult &r) { return r.asString(); },
+            "set %s %d",
+            key.data(),
+            i);
+        auto value = redisClient->execCommandSync(
+            [](const RedisResult &r) { return r.asString(); },
+            "get %s",
+            key.data());
+        CHECK(value == std::to_string(i));
+    }
+
+    // 2. Keys with the same hash tag are in the same slot
+    redisClient->execCommandAsync(
+        [TEST_CTX](const RedisResult &r) {
+            MANDATE(r.asString() == "OK");
+        },
+        [TEST_CTX](const RedisException &err) { MANDATE(err.what()); },
+        "mset {user1}.name %s {user1}.age %d",
+        "drogon",
+        8);
+    redisClient->execCommandAsync(
+        [TEST_CTX](const RedisResult &r) {
+            auto values = r.asArray();
+            MANDATE(values.size() == 2UL);
+            MANDATE(values[0].asString() == "drogon");
+            MANDATE(values[1].asString() == "8");
+        },
+        [TEST_CTX](const RedisException &err) { MANDATE(err.what()); },
+        "mget {user1}.name {user1}.age");
+
+    // 3. MGET across slots keeps the order of the keys
+    try
+    {
+        auto values = redisClient->execCommandSync(
+            [](const RedisResult &r) {
+                std::vector<std::string> values;
+                for (auto &item : r.asArray())
+                {
+                    values.push_back(item.isNil() ? "nil" : item.asString());
+                }
+                return values;
+            },
+            "mget cluster_key_3 not_exists cluster_key_1 cluster_key_7");
+        MANDATE(values.size() == 4UL);
+        CHECK(values[0] == "3");
+        CHECK(values[1] == "nil");
+        CHECK(values[2] == "1");
+        CHECK(values[3] == "7");
+    }
+    catch (const RedisException &err)
+    {
+        FAULT(err.what());
+    }
+
+    // 4. DEL across slots returns the sum of the counts
+    try
+    {
+        auto count = redisClient->execCommandSync(
+            [](const RedisResult &r) { return r.asInteger(); },
+            "del cluster_key_0 cluster_key_1 cluster_key_2 not_exists");
+        CHECK(count == 3);
+    }
+    catch (const RedisException &err)
+    {
+        FAULT(err.what());
+    }
+
+    // 5. Other multi-key commands must have their keys in one slot
+    redisClient->execCommandAsync(
+        [TEST_CTX](const RedisResult &r) { FAULT("No CROSSSLOT error"); },
+        [TEST_CTX](const RedisException &err) {
+            MANDATE(std::string(err.what()).find("CROSSSLOT") == 0);
+        },
+        "sunion cluster_set_1 cluster_set_2");
+
+    // 6. Keys of scripts are given by numkeys
+    try
+    {
+        auto value = redisClient->execCommandSync(
+            [](const RedisResult &r) { return r.asString(); },
+            "eval %s 1 cluster_key_5",
+            "return redis.call('get', KEYS[1])");
+        CHECK(value == "5");
+    }
+    catch (const RedisException &err)
+    {
+        FAULT(err.what());
+    }
+}
+
+int main(int argc, char **argv)
+{
+#ifndef USE_REDIS
+    LOG_DEBUG << "Drogon is built without Redis. No tests executed.";
+    return 0;
+#endif
+    std::promise<void> p1;
+    std::future<void> f1 = p1.get_future();
+
+    std::thread thr([&]() {
+        p1.set_value();
+        drogon::app().run();
+    });
+
+    f1.get();
+    int testStatus = drogon::test::run(argc, argv);
+    drogon::app().getLoop()->queueInLoop([]() { drogon::app().quit(); });
+    thr.join();
+    return testStatus;
+}
@@ -1,5 +1,6 @@
 #define DROGON_TEST_MAIN
 #include <drogon/nosql/RedisClient.h>
+#include <drogon/nosql/RedisSessionStore.h>
 #include <drogon/drogon_test.h>
 #include <drogon/drogon.h>
 #include <iostream>
@@ -181,6 +182,131 @@ DROGON_TEST(RedisTest)
     {
         MANDATE(err.what());
     }
+
+    // 13. Test batch
+    auto batch = redisClient->newBatch();
+    for (int i = 0; i < 3; ++i)
+    {
+        batch->addCommand("set batch_key_%d %d", i, i);
+    }
+    batch->addCommand("get %s", "batch_key_1");
+    batch->addCommand("lpush %s %s", "batch_key_1", "value");
+    batch->addCommand("get %s", "not_exists");
+    CHECK(batch->size() == 6UL);
+    batch->execute(
+        [TEST_CTX](const std::vector<RedisResult> &results) {
+            MANDATE(results.size() == 6UL);
+            CHECK(results[0].asString() == "OK");
+            CHECK(results[3].asString() == "1");
+            // A failed command doesn't fail the batch
+            CHECK(results[4].type() == RedisResultType::kError);
+            CHECK(results[5].isNil());
+        },
+        [TEST_CTX](const RedisException &err) { FAULT(err.what()); });
+    batch->execute(
+        [TEST_CTX](const std::vector<RedisResult> &) {
+            FAULT("A batch is executed twice");
+        },
+        [TEST_CTX](const RedisException &err) {
+            CHECK(err.code() == RedisErrorCode::kInternalError);
+        });
+
+#ifdef __cpp_impl_coroutine
+    auto coro_batch_test = [TEST_CTX]() -> drogon::Task<> {
+        // 14
+        try
+        {
+            auto batch = redisClient->newBatch();
+            batch->addCommand("get %s", "batch_key_0");
+            batch->addCommand("get %s", "batch_key_2");
+            auto results = co_await batch->executeCoro();
+            MANDATE(results.size() == 2UL);
+            CHECK(results[0].asString() == "0");
+            CHECK(results[1].asString() == "2");
+        }
+        catch (const RedisException &err)
+        {
+            FAULT(err.what());
+        }
+    };
+    drogon::sync_wait(coro_batch_test());
+#endif
+
+    // 15. Test client cache
+    auto cachedClient = drogon::nosql::RedisClient::newRedisClient(
+        trantor::InetAddress("127.0.0.1", 6379), 1);
+    cachedClient->enableClientCache(100);
+    try
+    {
+        auto getValue = [&cachedClient]() {
+            return cachedClient->execCommandSync(
+                [](const RedisResult &r) { return r.asString(); },
+                "get %s",
+                "cached_key");
+        };
+        redisClient->execCommandSync(
+            [](const RedisResult &r) { return r.asString(); },
+            "set cached_key %s",
+            "1");
+        CHECK(getValue() == "1");
+        CHECK(getValue() == "1");
+        // The server invalidates the cached reply
+        redisClient->execCommandSync(
+            [](const RedisResult &r) { return r.asString(); },
+            "set cached_key %s",
+            "2");
+        std::this_thread::sleep_for(100ms);
+        CHECK(getValue() == "2");
+        // Replies of RESP3 types are read as the ones of RESP2
+        auto fields = cachedClient->execCommandSync(
+            [](const RedisResult &r) { return r.asArray().size(); },
+            "hgetall %s",
+            "not_exists");
+        CHECK(fields == 0UL);
+    }
+    catch (const RedisException &err)
+    {
+        FAULT(err.what());
+    }
+
+    // 16. Test views of results
+    redisClient->execCommandAsync(
+        [TEST_CTX](const RedisResult &r) { MANDATE(r.asInteger() == 3); },
+        [TEST_CTX](const RedisException &err) { MANDATE(err.what()); },
+        "rpush view_list a bb ccc");
+    redisClient->execCommandAsync(
+        [TEST_CTX](const RedisResult &r) {
+            auto items = r.asArrayView();
+            MANDATE(items.size() == 3UL);
+            CHECK(items[1].asStringView() == "bb");
+            std::string joined;
+            for (auto item : items)
+            {
+                joined.append(item.asStringView());
+            }
+            CHECK(joined == "abbccc");
+            CHECK_THROWS_AS(items[0].asArrayView(), RedisException);
+        },
+        [TEST_CTX](const RedisException &err) { MANDATE(err.what()); },
+        "lrange view_list 0 -1");
+    redisClient->execCommandAsync(
+        [TEST_CTX](const RedisResult &r) { MANDATE(r.asInteger() == 1); },
+        [TEST_CTX](const RedisException &err) { MANDATE(err.what()); },
+        "del view_list");
+}
+
+DROGON_TEST(RedisSessionStoreTest)
+{
+    // Nothing listens on the port, loading a session fails rather than
+    // returning an empty session that would overwrite the stored one.
+    auto client = drogon::nosql::RedisClient::newRedisClient(
+        trantor::InetAddress("127.0.0.1", 1), 1);
+    client->setTimeout(0.5);
+    auto store = RedisSessionStore::newRedisSessionStore(client);
+    store->loadSession("session_id",
+                       [TEST_CTX](const drogon::SessionPtr &sessionPtr) {
+                           CHECK(sessionPtr == nullptr);
+                       });
 }
 
 int main(int argc, char **argv)
@@ -177,12 +177,7 @@ class BaseBuilder
             }
             else
             {
-                std::vector<T> ret;
-                for (const Row &row : r)
-                {
-                    ret.emplace_back(T(row));
-                }
-                return ret;
+                return internal::RowDecoder<T>::decodeModels(r);
             }
         }
         else
@@ -0,0 +1,92 @@
+/**
+ *
+ *  @file CachedDbClient.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/exports.h>
+#include <drogon/orm/DbClient.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+struct QueryCacheOptions
+{
+    /// Seconds a result stays in the cache, zero or negative keeps it until
+    /// it is invalidated or evicted.
+    double ttl{1.0};
+    /// The maximum number of cached results, the oldest ones are evicted
+    /// first.
+    size_t maxEntries{10000};
+    /// Only results of statements that read these tables are cached. If
+    /// empty, results of every read-only statement that reads a table are
+    /// cached.
+    std::vector<std::string> tables;
+    /// A PostgreSQL NOTIFY channel. A notification on this channel
+    /// invalidates the table named by its payload, or the whole cache if the
+    /// payload is empty. Leave empty to disable.
+    std::string notifyChannel;
+};
+
+class CachedDbClient;
+using CachedDbClientPtr = std::shared_ptr<CachedDbClient>;
+
+/**
+ * @brief A database client that caches the results of read-only statements
+ * executed through another client.
+ *
+ * Results are keyed by the SQL and the bound parameters, and tagged with the
+ * tables the statement reads. A write executed through this client (or
+ * through a transaction created by it) invalidates the results of the tables
+ * it writes, a write without recognizable tables invalidates everything.
+ * Cached results are shared, a hit only copies a reference and calls the
+ * result callback immediately in the calling thread.
+ *
+ * Writes made by other clients or processes are not seen, use a short TTL,
+ * invalidate() or a NOTIFY channel (e.g. from a trigger) for such tables.
+ *
+ * Mappers constructed with a cached client use the cache for their finders.
+ */
+class DROGON_EXPORT CachedDbClient : public DbClient
+{
+  public:
+    /**
+     * @brief Create a cached client in front of @p client.
+     */
+    static CachedDbClientPtr newCachedClient(
+        const DbClientPtr &client,
+        const QueryCacheOptions &options = QueryCacheOptions());
+
+    /// Remove the results of the statements that read @p table.
+    virtual void invalidate(const std::string &table) = 0;
+
+    /// Remove all results.
+    virtual void clear() = 0;
+
+    /// The number of cached results.
+    virtual size_t size() const = 0;
+
+    /// The number of statements answered from the cache.
+    virtual uint64_t hits() const = 0;
+
+    /// The number of cacheable statements sent to the database.
+    virtual uint64_t misses() const = 0;
+};
+
+}  // namespace orm
+}  // namespace drogon
@@ -0,0 +1,74 @@
+/**
+ *
+ *  @file CancelToken.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/exports.h>
+#include <trantor/utils/NonCopyable.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+/**
+ * @brief A token that cancels the statements it is passed to. Statements
+ * waiting for a connection are dropped and running ones are cancelled on the
+ * server, in both cases the exception callback is called with a
+ * CancelledError.
+ *
+ * For example, cancel the queries of an HTTP request when the client goes
+ * away:
+ * @code
+   auto token = std::make_shared<drogon::orm::CancelToken>();
+   req->addAbortCallback([token]() { token->cancel(); });
+   *client << "select * from reports where owner=$1"_sqlLiteral << owner
+           << token >>
+       [callback](const Result &r) { ... } >>
+       [](const DrogonDbException &e) { ... };
+   @endcode
+ * The exception callback may be called in the thread that cancels the token.
+ * A token keeps the callbacks of the statements it was passed to, so use one
+ * per request instead of a long-lived one.
+ */
+class DROGON_EXPORT CancelToken : public trantor::NonCopyable
+{
+  public:
+    /**
+     * @brief Cancel the statements, it can be called in any thread and more
+     * than once.
+     */
+    void cancel();
+
+    bool isCancelled() const;
+
+    /**
+     * @brief Call the callback when the token is cancelled, or right away if
+     * it has been.
+     */
+    void onCancel(std::function<void()> &&callback);
+
+  private:
+    mutable std::mutex mutex_;
+    bool cancelled_{false};
+    std::vector<std::function<void()>> callbacks_;
+};
+
+using CancelTokenPtr = std::shared_ptr<CancelToken>;
+
+}  // namespace orm
+}  // namespace drogon
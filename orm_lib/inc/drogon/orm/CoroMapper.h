@@ -344,11 +344,7 @@ class CoroMapper : public Mapper<T>
                 binder << this->offset_;
             this->clear();
             binder >> [callback = std::move(callback)](const Result &r) {
-                std::vector<T> ret;
-                for (auto const &row : r)
-                {
-                    ret.push_back(T(row));
-                }
+                auto ret = internal::RowDecoder<T>::decodeModels(r);
                 callback(ret);
             };
             binder >> std::move(errCallback);
@@ -15,13 +15,17 @@
 #pragma once
 
 #include <drogon/exports.h>
+#include <drogon/orm/CancelToken.h>
 #include <drogon/orm/Exception.h>
 #include <drogon/orm/Field.h>
 #include <drogon/orm/Result.h>
 #include <drogon/orm/ResultIterator.h>
 #include <drogon/orm/Row.h>
 #include <drogon/orm/RowIterator.h>
+#include <drogon/orm/RowDecoder.h>
 #include <drogon/orm/SqlBinder.h>
+#include <array>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <future>
@@ -42,6 +46,42 @@ using ExceptionCallback = std::function<void(const DrogonDbException &)>;
 
 class Transaction;
 class DbClient;
+class CachedDbClientImpl;
+
+/**
+ * @brief Thresholds of the auto-batch mode of PostgreSQL clients, see
+ * DbClient::setBatchOptions().
+ */
+struct BatchOptions
+{
+    /// The maximum number of queries between two synchronization points.
+    size_t maxBatchSize{256};
+    /// Queries longer than this many bytes are always followed by a
+    /// synchronization point.
+    size_t maxSqlLength{1024};
+    /// Seconds a connection waits for more queries before sending the
+    /// queued ones, so that queries of concurrent requests share one
+    /// synchronization point. Zero or negative sends them at the end of the
+    /// current event loop iteration.
+    double batchWindow{0.0};
+};
+
+/**
+ * @brief Counters of the synchronization points sent by PostgreSQL
+ * pipeline connections, see DbClient::batchStatistics().
+ */
+struct BatchStatistics
+{
+    /// The number of batches (synchronization points) sent.
+    uint64_t batches{0};
+    /// The number of queries sent in these batches.
+    uint64_t queries{0};
+    /// The size of the largest batch.
+    uint64_t maxBatchSize{0};
+    /// sizeHistogram[i] is the number of batches with a size in
+    /// [2^i, 2^(i+1)), the last bucket also counts larger batches.
+    std::array<uint64_t, 10> sizeHistogram{};
+};
 
 namespace internal
 {
@@ -70,6 +110,17 @@ struct [[nodiscard]] SqlAwaiter : public CallbackAwaiter<Result>
     internal::SqlBinder binder_;
 };
 
+template <typename... Types>
+struct [[nodiscard]] QueryAwaiter : public SqlAwaiter
+{
+    using SqlAwaiter::SqlAwaiter;
+
+    std::vector<QueryRow<Types...> > await_resume() const noexcept(false)
+    {
+        return decodeRows<Types...>(SqlAwaiter::await_resume());
+    }
+};
+
 struct [[nodiscard]] TransactionAwaiter
     : public CallbackAwaiter<std::shared_ptr<Transaction> >
 {
@@ -113,14 +164,41 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
      * - client_encoding: The character set to be used on database connections.
      *
      * For other key words on PostgreSQL, see the PostgreSQL documentation.
-     * Only a pair of key values is valid for Sqlite3, and its keyword is
-     * 'filename'.
+     * For Sqlite3, the keyword 'filename' is the database file, other key
+     * words are applied as PRAGMAs on each connection. When 'journal_mode' is
+     * 'wal' and @p connNum is greater than 1, one connection is used for
+     * writes and transactions, the others are read-only and run SELECT
+     * statements in parallel.
      *
      * @param connNum: The number of connections to database server;
      */
     static std::shared_ptr<DbClient> newPgClient(const std::string &connInfo,
                                                  size_t connNum,
                                                  bool autoBatch = false);
+    /// Create a PostgreSQL client that uses read-only replicas
+    /**
+     * @param connInfo: The connection string of the primary server.
+     * @param replicaConnInfos: The connection strings of the replicas.
+     * @param connNum: The number of connections to each server.
+     * @param replicaCheckInterval: Seconds between two health checks of the
+     * replicas, zero or negative disables the checks.
+     * @param maxReplicaLag: Replicas lagging behind the primary by more than
+     * this many seconds don't receive queries, zero or negative means no
+     * limit.
+     *
+     * Writes and transactions are executed on the primary server. SELECT
+     * statements that don't lock rows are sent to the healthy replica with the
+     * fewest outstanding queries. A statement starting with the comment
+     * "replica" or "primary" (in a block comment) is always sent to a replica
+     * or to the primary server respectively.
+     */
+    static std::shared_ptr<DbClient> newPgClient(
+        const std::string &connInfo,
+        const std::vector<std::string> &replicaConnInfos,
+        size_t connNum,
+        bool autoBatch = false,
+        double replicaCheckInterval = 5.0,
+        double maxReplicaLag = -1.0);
     static std::shared_ptr<DbClient> newMysqlClient(const std::string &connInfo,
                                                     size_t connNum);
     static std::shared_ptr<DbClient> newSqlite3Client(
@@ -160,12 +238,43 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
                       FUNCTION1 &&rCallback,
                       FUNCTION2 &&exceptCallback,
                       Arguments &&...args) noexcept
+    {
+        execBinderAsync(*this << sql,
+                        std::forward<FUNCTION1>(rCallback),
+                        std::forward<FUNCTION2>(exceptCallback),
+                        std::forward<Arguments>(args)...);
+    }
+
+    /// The SQL is not copied, see SqlLiteral
+    template <typename FUNCTION1, typename FUNCTION2, typename... Arguments>
+    void execSqlAsync(SqlLiteral sql,
+                      FUNCTION1 &&rCallback,
+                      FUNCTION2 &&exceptCallback,
+                      Arguments &&...args) noexcept
+    {
+        execBinderAsync(*this << sql,
+                        std::forward<FUNCTION1>(rCallback),
+                        std::forward<FUNCTION2>(exceptCallback),
+                        std::forward<Arguments>(args)...);
+    }
+
+    /**
+     * @brief Asynchronously execute a statement that is cancelled with the
+     * token, see CancelToken.
+     */
+    template <typename FUNCTION1, typename FUNCTION2, typename... Arguments>
+    void execSqlAsync(const CancelTokenPtr &token,
+                      const std::string &sql,
+                      FUNCTION1 &&rCallback,
+                      FUNCTION2 &&exceptCallback,
+                      Arguments &&...args) noexcept
     {
         auto binder = *this << sql;
-        (void)std::initializer_list<int>{
-            (binder << std::forward<Arguments>(args), 0)...};
-        binder >> std::forward<FUNCTION1>(rCallback);
-        binder >> std::forward<FUNCTION2>(exceptCallback);
+        binder << token;
+        execBinderAsync(std::move(binder),
+                        std::forward<FUNCTION1>(rCallback),
+                        std::forward<FUNCTION2>(exceptCallback),
+                        std::forward<Arguments>(args)...);
     }
 
     /// Async and nonblocking method
@@ -173,16 +282,16 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
     std::future<Result> execSqlAsyncFuture(const std::string &sql,
                                            Arguments &&...args) noexcept
     {
-        auto binder = *this << sql;
-        (void)std::initializer_list<int>{
-            (binder << std::forward<Arguments>(args), 0)...};
-        std::shared_ptr<std::promise<Result> > prom =
-            std::make_shared<std::promise<Result> >();
-        binder >> [prom](const Result &r) { prom->set_value(r); };
-        binder >>
-            [prom](const std::exception_ptr &e) { prom->set_exception(e); };
-        binder.exec();
-        return prom->get_future();
+        return execBinderAsyncFuture(*this << sql,
+                                     std::forward<Arguments>(args)...);
+    }
+
+    template <typename... Arguments>
+    std::future<Result> execSqlAsyncFuture(SqlLiteral sql,
+                                           Arguments &&...args) noexcept
+    {
+        return execBinderAsyncFuture(*this << sql,
+                                     std::forward<Arguments>(args)...);
     }
 
     // Sync and blocking method
@@ -190,18 +299,14 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
     Result execSqlSync(const std::string &sql,
                        Arguments &&...args) noexcept(false)
     {
-        Result r(nullptr);
-        {
-            auto binder = *this << sql;
-            (void)std::initializer_list<int>{
-                (binder << std::forward<Arguments>(args), 0)...};
-            // Use blocking mode
-            binder << Mode::Blocking;
-
-            binder >> [&r](const Result &result) { r = result; };
-            binder.exec();  // exec may be throw exception;
-        }
-        return r;
+        return execBinderSync(*this << sql, std::forward<Arguments>(args)...);
+    }
+
+    template <typename... Arguments>
+    Result execSqlSync(SqlLiteral sql,
+                       Arguments &&...args) noexcept(false)
+    {
+        return execBinderSync(*this << sql, std::forward<Arguments>(args)...);
     }
 
 #ifdef __cpp_impl_coroutine
@@ -210,21 +315,134 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
                                      Arguments &&...args) noexcept
     {
         auto binder = *this << sql;
+        binder.reserveParameters(sizeof...(Arguments));
+        (void)std::initializer_list<int>{
+            (binder << std::forward<Arguments>(args), 0)...};
+        return internal::SqlAwaiter(std::move(binder));
+    }
+
+    template <typename... Arguments>
+    internal::SqlAwaiter execSqlCoro(SqlLiteral sql,
+                                     Arguments &&...args) noexcept
+    {
+        auto binder = *this << sql;
+        binder.reserveParameters(sizeof...(Arguments));
         (void)std::initializer_list<int>{
             (binder << std::forward<Arguments>(args), 0)...};
         return internal::SqlAwaiter(std::move(binder));
     }
 #endif
 
+    /**
+     * @brief Execute a query and decode its rows, for example:
+     * @code
+       for (auto &[id, name] :
+            client->query<int64_t, std::string>(
+                "select id, name from users"_sqlLiteral))
+       {
+       }
+       @endcode
+     * @tparam Types are the column types, each row is a std::tuple of them.
+     * A single type is the type of the rows instead: a struct with a
+     * RowFields specialization, a drogon_ctl model, a std::tuple or a single
+     * column type.
+     * @note The column count and types are checked once per result, a
+     * ConversionError is thrown if they don't match. Rows are decoded by
+     * column index. Null values are decoded as default values unless the
+     * type is a std::optional or a std::shared_ptr.
+     */
+    template <typename... Types, typename... Arguments>
+    std::vector<QueryRow<Types...> > query(const std::string &sql,
+                                          Arguments &&...args) noexcept(false)
+    {
+        return decodeRows<Types...>(
+            execSqlSync(sql, std::forward<Arguments>(args)...));
+    }
+
+    template <typename... Types, typename... Arguments>
+    std::vector<QueryRow<Types...> > query(SqlLiteral sql,
+                                          Arguments &&...args) noexcept(false)
+    {
+        return decodeRows<Types...>(
+            execSqlSync(sql, std::forward<Arguments>(args)...));
+    }
+
+    /**
+     * @brief The asynchronous version of query(). The rows are passed to
+     * rCallback as a std::vector<QueryRow<Types...>>, a decoding error is
+     * passed to exceptCallback.
+     */
+    template <typename... Types,
+              typename FUNCTION1,
+              typename FUNCTION2,
+              typename... Arguments>
+    void queryAsync(const std::string &sql,
+                    FUNCTION1 &&rCallback,
+                    FUNCTION2 &&exceptCallback,
+                    Arguments &&...args) noexcept
+    {
+        execSqlAsync(sql,
+                     decodingCallback<Types...>(
+                         std::forward<FUNCTION1>(rCallback), exceptCallback),
+                     std::forward<FUNCTION2>(exceptCallback),
+                     std::forward<Arguments>(args)...);
+    }
+
+    template <typename... Types,
+              typename FUNCTION1,
+              typename FUNCTION2,
+              typename... Arguments>
+    void queryAsync(SqlLiteral sql,
+                    FUNCTION1 &&rCallback,
+                    FUNCTION2 &&exceptCallback,
+                    Arguments &&...args) noexcept
+    {
+        execSqlAsync(sql,
+                     decodingCallback<Types...>(
+                         std::forward<FUNCTION1>(rCallback), exceptCallback),
+                     std::forward<FUNCTION2>(exceptCallback),
+                     std::forward<Arguments>(args)...);
+    }
+
+#ifdef __cpp_impl_coroutine
+    /// The coroutine version of query()
+    template <typename... Types, typename... Arguments>
+    internal::QueryAwaiter<Types...> queryCoro(const std::string &sql,
+                                               Arguments &&...args) noexcept
+    {
+        auto binder = *this << sql;
+        binder.reserveParameters(sizeof...(Arguments));
+        (void)std::initializer_list<int>{
+            (binder << std::forward<Arguments>(args), 0)...};
+        return internal::QueryAwaiter<Types...>(std::move(binder));
+    }
+
+    template <typename... Types, typename... Arguments>
+    internal::QueryAwaiter<Types...> queryCoro(SqlLiteral sql,
+                                               Arguments &&...args) noexcept
+    {
+        auto binder = *this << sql;
+        binder.reserveParameters(sizeof...(Arguments));
+        (void)std::initializer_list<int>{
+            (binder << std::forward<Arguments>(args), 0)...};
+        return internal::QueryAwaiter<Types...>(std::move(binder));
+    }
+#endif
+
     /// Streaming-like method for sql execution. For more information, see the
-    /// wiki page.
+    /// wiki page. Write literals with the _sqlLiteral suffix so they are not
+    /// copied, see SqlLiteral.
     internal::SqlBinder operator<<(const std::string &sql);
     internal::SqlBinder operator<<(std::string &&sql);
 
-    template <int N>
-    internal::SqlBinder operator<<(const char (&sql)[N])
+    internal::SqlBinder operator<<(const char *sql)
     {
-        return internal::SqlBinder(sql, N - 1, *this, type_);
+        return internal::SqlBinder(std::string(sql), *this, type_);
+    }
+
+    internal::SqlBinder operator<<(SqlLiteral sql)
+    {
+        return internal::SqlBinder(sql.data(), sql.length(), *this, type_);
     }
 
     internal::SqlBinder operator<<(const std::string_view &sql)
@@ -244,6 +462,10 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
      * executed. You can also use the setCommitCallback() method of a
      * transaction object to set the callback.
      * @note A TimeoutError exception is thrown if the operation is timed out.
+     * @note If libpq supports the pipeline mode, the statements of a
+     * PostgreSQL transaction are sent without waiting for the results of the
+     * previous ones. The first error rolls the transaction back, the
+     * statements sent after it fail with a TransactionRollback exception.
      */
     virtual std::shared_ptr<Transaction> newTransaction(
         const std::function<void(bool)> &commitCallback =
@@ -288,7 +510,9 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
      *
      * @param timeout in seconds, if the SQL result is not returned from the
      * server within the timeout, a TimeoutError exception with "SQL execution
-     * timeout" string is generated and returned to the caller.
+     * timeout" string is generated and returned to the caller. The statement
+     * is cancelled on the server, so its connection is released as soon as
+     * the server acknowledges the cancel.
      * @note set the timeout value to zero or negative for no limit on time. The
      * default value is -1.0, this means there is no time limit if this method
      * is not called.
@@ -341,8 +565,104 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
      * */
     // virtual void enableAutoBatch() = 0;
 
+    /**
+     * @brief Tune the auto-batch mode of a PostgreSQL client.
+     *
+     * With a positive batch window, a connection that receives a query waits
+     * up to that many seconds (e.g. 0.0001) for more queries before sending
+     * them, so that queries of many concurrent requests are pipelined and
+     * share one synchronization point. The batch is sent earlier once it
+     * reaches the maximum batch size. Identical statements in a batch are
+     * prepared only once.
+     * @note This method does nothing on clients without auto-batch mode.
+     */
+    virtual void setBatchOptions(const BatchOptions &options)
+    {
+        (void)options;
+    }
+
+    /**
+     * @brief Return the batch counters of a PostgreSQL client since it was
+     * created. Queries are counted in auto-batch mode or not, but only if
+     * libpq supports the pipeline mode, otherwise all counters are zero.
+     */
+    virtual BatchStatistics batchStatistics() const
+    {
+        return {};
+    }
+
   private:
+    // The number of placeholders is known from the arguments, so the
+    // parameter arrays are allocated once.
+    template <typename FUNCTION1, typename FUNCTION2, typename... Arguments>
+    static void execBinderAsync(internal::SqlBinder &&binder,
+                                FUNCTION1 &&rCallback,
+                                FUNCTION2 &&exceptCallback,
+                                Arguments &&...args) noexcept
+    {
+        binder.reserveParameters(sizeof...(Arguments));
+        (void)std::initializer_list<int>{
+            (binder << std::forward<Arguments>(args), 0)...};
+        binder >> std::forward<FUNCTION1>(rCallback);
+        binder >> std::forward<FUNCTION2>(exceptCallback);
+        binder.exec();
+    }
+
+    template <typename... Arguments>
+    static std::future<Result> execBinderAsyncFuture(
+        internal::SqlBinder &&binder,
+        Arguments &&...args) noexcept
+    {
+        binder.reserveParameters(sizeof...(Arguments));
+        (void)std::initializer_list<int>{
+            (binder << std::forward<Arguments>(args), 0)...};
+        std::shared_ptr<std::promise<Result> > prom =
+            std::make_shared<std::promise<Result> >();
+        binder >> [prom](const Result &r) { prom->set_value(r); };
+        binder >>
+            [prom](const std::exception_ptr &e) { prom->set_exception(e); };
+        binder.exec();
+        return prom->get_future();
+    }
+
+    template <typename... Arguments>
+    static Result execBinderSync(internal::SqlBinder &&binder,
+                                 Arguments &&...args) noexcept(false)
+    {
+        Result r(nullptr);
+        binder.reserveParameters(sizeof...(Arguments));
+        (void)std::initializer_list<int>{
+            (binder << std::forward<Arguments>(args), 0)...};
+        // Use blocking mode
+        binder << Mode::Blocking;
+
+        binder >> [&r](const Result &result) { r = result; };
+        binder.exec();  // exec may be throw exception;
+        return r;
+    }
+
+    template <typename... Types, typename FUNCTION1, typename FUNCTION2>
+    static auto decodingCallback(FUNCTION1 &&rCallback,
+                                 const FUNCTION2 &exceptCallback)
+    {
+        return [rCallback = std::forward<FUNCTION1>(rCallback),
+                exceptCallback](const Result &r) {
+            std::vector<QueryRow<Types...> > rows;
+            try
+            {
+                rows = decodeRows<Types...>(r);
+            }
+            catch (const DrogonDbException &e)
+            {
+                exceptCallback(e);
+                return;
+            }
+            rCallback(std::move(rows));
+        };
+    }
+
     friend internal::SqlBinder;
+    friend CachedDbClientImpl;
     virtual void execSql(
         const char *sql,
         size_t sqlLength,
@@ -353,6 +673,22 @@ class DROGON_EXPORT DbClient : public trantor::NonCopyable
         ResultCallback &&rcb,
         std::function<void(const std::exception_ptr &)> &&exceptCallback) = 0;
 
+    /**
+     * @brief Execute a statement that is cancelled with the token. Clients
+     * that know the connection of the statement cancel it on the server, this
+     * implementation only stops waiting for the result.
+     */
+    virtual void execCancellableSql(
+        const char *sql,
+        size_t sqlLength,
+        size_t paraNum,
+        std::vector<const char *> &&parameters,
+        std::vector<int> &&length,
+        std::vector<int> &&format,
+        ResultCallback &&rcb,
+        std::function<void(const std::exception_ptr &)> &&exceptCallback,
+        const CancelTokenPtr &token);
+
   protected:
     ClientType type_;
     std::string connectionInfo_;
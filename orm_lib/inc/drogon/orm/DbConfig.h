@@ -17,9 +17,20 @@
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace drogon::orm
 {
+/**
+ * @brief A read-only replica of a database server. It shares the database
+ * name, credentials and connection options of the primary server.
+ */
+struct ReplicaConfig
+{
+    std::string host;
+    unsigned short port;
+};
+
 struct PostgresConfig
 {
     std::string host;
@@ -34,6 +45,19 @@ struct PostgresConfig
     double timeout;
     bool autoBatch;
     std::unordered_map<std::string, std::string> connectOptions;
+    /// Read-only statements are sent to the replicas, writes and transactions
+    /// to the primary server. Not supported by fast clients.
+    std::vector<ReplicaConfig> replicas;
+    /// Seconds between two health checks of the replicas, zero or negative
+    /// disables the checks.
+    double replicaCheckInterval{5.0};
+    /// Replicas lagging behind the primary by more than this many seconds
+    /// don't receive queries, zero or negative means no limit.
+    double maxReplicaLag{-1.0};
+    /// Thresholds of the auto-batch mode, see DbClient::setBatchOptions().
+    size_t maxBatchSize{256};
+    size_t maxBatchSqlLength{1024};
+    double batchWindow{0.0};
 };
 
 struct MysqlConfig
@@ -56,6 +80,7 @@ struct Sqlite3Config
     std::string filename;
     std::string name;
     double timeout;
+    std::unordered_map<std::string, std::string> connectOptions;
 };
 
 using DbConfig = std::variant<PostgresConfig, MysqlConfig, Sqlite3Config>;
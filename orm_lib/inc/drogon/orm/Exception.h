@@ -230,6 +230,18 @@ class TimeoutError : public DrogonDbException, public std::logic_error
     DROGON_EXPORT explicit TimeoutError(const std::string &);
 };
 
+/// The statement was cancelled with a CancelToken.
+class CancelledError : public DrogonDbException, public std::logic_error
+{
+    const std::exception &base() const noexcept override
+    {
+        return *this;
+    }
+
+  public:
+    DROGON_EXPORT explicit CancelledError(const std::string &);
+};
+
 /// Error in usage of drogon orm library, similar to std::logic_error
 class UsageError : public DrogonDbException, public std::logic_error
 {
@@ -20,12 +20,16 @@
 #include <drogon/exports.h>
 #include <string_view>
 #include <drogon/orm/ArrayParser.h>
+#include <drogon/orm/Exception.h>
 #include <drogon/orm/Result.h>
 #include <drogon/orm/Row.h>
 #include <trantor/utils/Logger.h>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 #ifdef __linux__
 #include <arpa/inet.h>
@@ -159,6 +163,27 @@ class DROGON_EXPORT Field
 
   private:
     const Result result_;
+
+    // Throw a RangeError, which is a std::out_of_range like the ones of
+    // std::stoi(), instead of truncating the value.
+    template <typename T>
+    static T narrow(int64_t value)
+    {
+        bool inRange;
+        if (value < 0)
+            inRange = std::is_signed<T>::value &&
+                      value >= static_cast<int64_t>(
+                                   std::numeric_limits<T>::min());
+        else
+            inRange = static_cast<uint64_t>(value) <=
+                      static_cast<uint64_t>(std::numeric_limits<T>::max());
+        if (!inRange)
+        {
+            throw RangeError("The value " + std::to_string(value) +
+                             " is out of the range of the type");
+        }
+        return static_cast<T>(value);
+    }
 };
 
 template <>
@@ -183,6 +208,17 @@ inline float Field::as<float>() const
 {
     if (isNull())
         return 0.0;
+    double value;
+    if (result_.getDouble(row_, column_, value))
+    {
+        if (std::isfinite(value) &&
+            std::fabs(value) > std::numeric_limits<float>::max())
+        {
+            throw RangeError("The value " + std::to_string(value) +
+                             " is out of the range of float");
+        }
+        return static_cast<float>(value);
+    }
     return std::stof(result_.getValue(row_, column_));
 }
 
@@ -191,6 +227,9 @@ inline double Field::as<double>() const
 {
     if (isNull())
         return 0.0;
+    double value;
+    if (result_.getDouble(row_, column_, value))
+        return value;
     return std::stod(result_.getValue(row_, column_));
 }
 
@@ -212,6 +251,9 @@ inline int Field::as<int>() const
 {
     if (isNull())
         return 0;
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return narrow<int>(value);
     return std::stoi(result_.getValue(row_, column_));
 }
 
@@ -220,6 +262,9 @@ inline long Field::as<long>() const
 {
     if (isNull())
         return 0;
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return narrow<long>(value);
     return std::stol(result_.getValue(row_, column_));
 }
 
@@ -228,7 +273,10 @@ inline int8_t Field::as<int8_t>() const
 {
     if (isNull())
         return 0;
-    return static_cast<int8_t>(atoi(result_.getValue(row_, column_)));
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return narrow<int8_t>(value);
+    return narrow<int8_t>(std::stoll(result_.getValue(row_, column_)));
 }
 
 template <>
@@ -236,6 +284,9 @@ inline long long Field::as<long long>() const
 {
     if (isNull())
         return 0;
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return static_cast<long long>(value);
     return atoll(result_.getValue(row_, column_));
 }
 
@@ -244,8 +295,10 @@ inline unsigned int Field::as<unsigned int>() const
 {
     if (isNull())
         return 0;
-    return static_cast<unsigned int>(
-        std::stoul(result_.getValue(row_, column_)));
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return narrow<unsigned int>(value);
+    return narrow<unsigned int>(std::stoll(result_.getValue(row_, column_)));
 }
 
 template <>
@@ -253,6 +306,15 @@ inline unsigned long Field::as<unsigned long>() const
 {
     if (isNull())
         return 0;
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+    {
+        // A 64 bits value keeps the bits of the stored int64_t, like the
+        // text path does.
+        if (sizeof(unsigned long) < sizeof(int64_t))
+            return narrow<unsigned long>(value);
+        return static_cast<unsigned long>(value);
+    }
     return std::stoul(result_.getValue(row_, column_));
 }
 
@@ -261,7 +323,10 @@ inline uint8_t Field::as<uint8_t>() const
 {
     if (isNull())
         return 0;
-    return static_cast<uint8_t>(atoi(result_.getValue(row_, column_)));
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return narrow<uint8_t>(value);
+    return narrow<uint8_t>(std::stoll(result_.getValue(row_, column_)));
 }
 
 template <>
@@ -269,6 +334,9 @@ inline unsigned long long Field::as<unsigned long long>() const
 {
     if (isNull())
         return 0;
+    int64_t value;
+    if (result_.getInt64(row_, column_, value))
+        return static_cast<unsigned long long>(value);
     return std::stoull(result_.getValue(row_, column_));
 }
 
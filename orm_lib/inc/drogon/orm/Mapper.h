@@ -1002,12 +1002,7 @@ inline std::vector<T> Mapper<T>::findBy(const Criteria &criteria) noexcept(
         binder >> [&r](const Result &result) { r = result; };
         binder.exec();  // exec may be throw exception;
     }
-    std::vector<T> ret;
-    for (auto const &row : r)
-    {
-        ret.push_back(T(row));
-    }
-    return ret;
+    return internal::RowDecoder<T>::decodeModels(r);
 }
 
 template <typename T>
@@ -1050,11 +1045,7 @@ inline void Mapper<T>::findBy(const Criteria &criteria,
         binder << offset_;
     clear();
     binder >> [rcb](const Result &r) {
-        std::vector<T> ret;
-        for (auto const &row : r)
-        {
-            ret.push_back(T(row));
-        }
+        auto ret = internal::RowDecoder<T>::decodeModels(r);
         rcb(ret);
     };
     binder >> ecb;
@@ -1101,11 +1092,7 @@ inline std::future<std::vector<T>> Mapper<T>::findFutureBy(
     std::shared_ptr<std::promise<std::vector<T>>> prom =
         std::make_shared<std::promise<std::vector<T>>>();
     binder >> [prom](const Result &r) {
-        std::vector<T> ret;
-        for (auto const &row : r)
-        {
-            ret.push_back(T(row));
-        }
+        auto ret = internal::RowDecoder<T>::decodeModels(r);
         prom->set_value(ret);
     };
     binder >> [prom](const std::exception_ptr &e) { prom->set_exception(e); };
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <drogon/exports.h>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <future>
@@ -34,6 +35,11 @@ class Row;
 class ResultImpl;
 using ResultImplPtr = std::shared_ptr<ResultImpl>;
 
+namespace internal
+{
+class RowDecoderBase;
+}
+
 enum class SqlStatus
 {
     Ok,
@@ -148,6 +154,7 @@ class DROGON_EXPORT Result
 
     friend class Field;
     friend class Row;
+    friend class internal::RowDecoderBase;
     /// Number of given column (throws exception if it doesn't exist).
     RowSizeType columnNumber(const char colName[]) const;
 
@@ -163,6 +170,8 @@ class DROGON_EXPORT Result
     const char *getValue(SizeType row, RowSizeType column) const;
     bool isNull(SizeType row, RowSizeType column) const;
     FieldSizeType getLength(SizeType row, RowSizeType column) const;
+    bool getInt64(SizeType row, RowSizeType column, int64_t &value) const;
+    bool getDouble(SizeType row, RowSizeType column, double &value) const;
 };
 
 inline void swap(Result &one, Result &two) noexcept
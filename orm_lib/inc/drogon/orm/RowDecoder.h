@@ -0,0 +1,432 @@
+/**
+ *
+ *  @file RowDecoder.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/orm/Exception.h>
+#include <drogon/orm/Field.h>
+#include <drogon/orm/Result.h>
+#include <drogon/orm/ResultIterator.h>
+#include <drogon/orm/Row.h>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+/**
+ * @brief Specialize this template to decode rows into a struct with
+ * DbClient::query(). The value member lists pointers to the members that
+ * receive the columns, in column order, for example:
+ * @code
+   struct User
+   {
+       int64_t id;
+       std::string name;
+       std::optional<double> score;
+   };
+
+   template <>
+   struct drogon::orm::RowFields<User>
+   {
+       static constexpr auto value =
+           std::make_tuple(&User::id, &User::name, &User::score);
+   };
+   @endcode
+ * Members of type std::optional<T> or std::shared_ptr<T> are empty for null
+ * values.
+ */
+template <typename T>
+struct RowFields;
+
+namespace internal
+{
+template <typename T, typename = void>
+struct HasRowFields : std::false_type
+{
+};
+
+template <typename T>
+struct HasRowFields<T, std::void_t<decltype(RowFields<T>::value)>>
+    : std::true_type
+{
+};
+
+// Models generated by drogon_ctl, which can be constructed from a row by
+// column indexes or by column names.
+template <typename T, typename = void>
+struct IsModel : std::false_type
+{
+};
+
+template <typename T>
+struct IsModel<T,
+               std::void_t<decltype(T::getColumnNumber()),
+                           decltype(T::getColumnName(0)),
+                           decltype(T(std::declval<const Row &>(), -1))>>
+    : std::true_type
+{
+};
+
+template <typename... Types>
+struct QueryRowType
+{
+    using type = std::tuple<Types...>;
+};
+
+template <typename T>
+struct QueryRowType<T>
+{
+    using type = T;
+};
+
+inline bool isPgNumberType(int oid)
+{
+    switch (oid)
+    {
+        case 20:    // int8
+        case 21:    // int2
+        case 23:    // int4
+        case 26:    // oid
+        case 700:   // float4
+        case 701:   // float8
+        case 1700:  // numeric
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Decode one column into a value of type T. Only PostgreSQL reports
+ * column types (others report 0), so the check only rejects PostgreSQL
+ * columns that can't be converted to T.
+ */
+template <typename T>
+struct ColumnTraits
+{
+    static T decode(const Field &field)
+    {
+        return field.as<T>();
+    }
+
+    static bool accepts(int oid)
+    {
+        if (oid == 0)
+            return true;
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            return oid == 16 || isPgNumberType(oid);
+        }
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            return isPgNumberType(oid);
+        }
+        else
+        {
+            return true;
+        }
+    }
+};
+
+template <typename T>
+struct ColumnTraits<std::optional<T>>
+{
+    static std::optional<T> decode(const Field &field)
+    {
+        if (field.isNull())
+            return std::nullopt;
+        return ColumnTraits<T>::decode(field);
+    }
+
+    static bool accepts(int oid)
+    {
+        return ColumnTraits<T>::accepts(oid);
+    }
+};
+
+template <typename T>
+struct ColumnTraits<std::shared_ptr<T>>
+{
+    static std::shared_ptr<T> decode(const Field &field)
+    {
+        if (field.isNull())
+            return nullptr;
+        return std::make_shared<T>(ColumnTraits<T>::decode(field));
+    }
+
+    static bool accepts(int oid)
+    {
+        return ColumnTraits<T>::accepts(oid);
+    }
+};
+
+// A single value per row
+template <typename T, typename = void>
+struct RowLayout
+{
+    static constexpr size_t kColumns = 1;
+
+    template <size_t I>
+    using Column = T;
+
+    template <typename Cursors, size_t... Is>
+    static T make(const Cursors &cursors, std::index_sequence<Is...>)
+    {
+        return ColumnTraits<T>::decode(cursors[0]);
+    }
+};
+
+template <typename... Types>
+struct RowLayout<std::tuple<Types...>, void>
+{
+    static constexpr size_t kColumns = sizeof...(Types);
+
+    template <size_t I>
+    using Column = std::tuple_element_t<I, std::tuple<Types...>>;
+
+    template <typename Cursors, size_t... Is>
+    static std::tuple<Types...> make(const Cursors &cursors,
+                                     std::index_sequence<Is...>)
+    {
+        return std::tuple<Types...>(
+            ColumnTraits<Types>::decode(cursors[Is])...);
+    }
+};
+
+template <typename T>
+struct RowLayout<T, std::enable_if_t<HasRowFields<T>::value>>
+{
+    static constexpr size_t kColumns =
+        std::tuple_size_v<std::decay_t<decltype(RowFields<T>::value)>>;
+
+    template <size_t I>
+    using Column = std::decay_t<decltype(std::declval<T &>().*
+                                         std::get<I>(RowFields<T>::value))>;
+
+    template <typename Cursors, size_t... Is>
+    static T make(const Cursors &cursors, std::index_sequence<Is...>)
+    {
+        T row{};
+        (void)std::initializer_list<int>{
+            (row.*std::get<Is>(RowFields<T>::value) =
+                 ColumnTraits<Column<Is>>::decode(cursors[Is]),
+             0)...};
+        return row;
+    }
+};
+
+/**
+ * @brief A field that is moved from row to row, so that decoding a value
+ * neither creates a Field nor looks up a column name.
+ */
+class FieldCursor : public Field
+{
+  public:
+    FieldCursor(const Row &row, Row::SizeType column) noexcept
+        : Field(row, column)
+    {
+    }
+
+    void moveTo(Result::SizeType row) noexcept
+    {
+        row_ = row;
+    }
+};
+
+class RowDecoderBase
+{
+  protected:
+    static int columnType(const Result &result, Result::RowSizeType column)
+    {
+        return result.oid(column);
+    }
+
+    static bool sameName(const char *name, const std::string &expected)
+    {
+        size_t i = 0;
+        for (; name[i] != '\0' && i < expected.length(); ++i)
+        {
+            if (tolower((unsigned char)name[i]) !=
+                tolower((unsigned char)expected[i]))
+                return false;
+        }
+        return name[i] == '\0' && i == expected.length();
+    }
+};
+
+/**
+ * @brief Decode the rows of a result into values of type T, which is a
+ * std::tuple of column types, a struct with a RowFields specialization, a
+ * drogon_ctl model or a single column type.
+ *
+ * The column count and types are checked once per result, a
+ * ConversionError is thrown if they don't match. Rows are then decoded by
+ * column index.
+ */
+template <typename T>
+class RowDecoder : public RowDecoderBase
+{
+    using Layout = RowLayout<T>;
+    using Indexes = std::make_index_sequence<Layout::kColumns>;
+
+  public:
+    static std::vector<T> decode(const Result &result)
+    {
+        if constexpr (IsModel<T>::value && !HasRowFields<T>::value)
+        {
+            return decodeModels(result);
+        }
+        else
+        {
+            check(result, Indexes());
+            std::vector<T> rows;
+            if (result.empty())
+                return rows;
+            rows.reserve(result.size());
+            auto cursors = makeCursors(result[0], Indexes());
+            for (Result::SizeType i = 0; i < result.size(); ++i)
+            {
+                for (auto &cursor : cursors)
+                {
+                    cursor.moveTo(i);
+                }
+                rows.push_back(Layout::make(cursors, Indexes()));
+            }
+            return rows;
+        }
+    }
+
+    /**
+     * @brief Construct models from the rows. Models are constructed by column
+     * index if the columns of the result are the columns of the model in
+     * order, by column name if they are there in another order.
+     */
+    static std::vector<T> decodeModels(const Result &result)
+    {
+        std::vector<T> rows;
+        rows.reserve(result.size());
+        if constexpr (IsModel<T>::value)
+        {
+            std::intptr_t offset = modelOffset(result);
+            for (auto const &row : result)
+            {
+                rows.push_back(T(row, offset));
+            }
+        }
+        else
+        {
+            for (auto const &row : result)
+            {
+                rows.push_back(T(row));
+            }
+        }
+        return rows;
+    }
+
+  private:
+    template <size_t... Is>
+    static void check(const Result &result, std::index_sequence<Is...>)
+    {
+        if (result.columns() != Layout::kColumns)
+        {
+            throw ConversionError(
+                "The result has " + std::to_string(result.columns()) +
+                " columns, " + std::to_string(Layout::kColumns) +
+                " are decoded");
+        }
+        bool accepted[] = {true,
+                           ColumnTraits<typename Layout::template Column<
+                               Is>>::accepts(columnType(result, Is))...};
+        for (size_t i = 1; i < sizeof(accepted) / sizeof(bool); ++i)
+        {
+            if (!accepted[i])
+            {
+                throw ConversionError(
+                    std::string("The type of column ") +
+                    result.columnName(i - 1) +
+                    " can't be converted to the decoded type");
+            }
+        }
+    }
+
+    template <size_t... Is>
+    static std::array<FieldCursor, sizeof...(Is)> makeCursors(
+        const Row &row,
+        std::index_sequence<Is...>)
+    {
+        return {FieldCursor(row, Is)...};
+    }
+
+    static std::intptr_t modelOffset(const Result &result)
+    {
+        auto count = T::getColumnNumber();
+        if (result.columns() < count)
+            return 0;
+        bool inOrder = true;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!sameName(result.columnName(i), T::getColumnName(i)))
+            {
+                inOrder = false;
+                break;
+            }
+        }
+        if (inOrder)
+            return 0;
+        // Columns by names only if all of them are in the result
+        for (size_t i = 0; i < count; ++i)
+        {
+            bool found = false;
+            for (Result::RowSizeType j = 0; j < result.columns(); ++j)
+            {
+                if (sameName(result.columnName(j), T::getColumnName(i)))
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                return 0;
+        }
+        return -1;
+    }
+};
+
+}  // namespace internal
+
+/// A decoded row, a single value or a std::tuple of values
+template <typename... Types>
+using QueryRow = typename internal::QueryRowType<Types...>::type;
+
+/**
+ * @brief Decode the rows of a result, see DbClient::query().
+ */
+template <typename... Types>
+std::vector<QueryRow<Types...>> decodeRows(const Result &result)
+{
+    return internal::RowDecoder<QueryRow<Types...>>::decode(result);
+}
+
+}  // namespace orm
+}  // namespace drogon
@@ -14,6 +14,7 @@
 
 #pragma once
 #include <drogon/exports.h>
+#include <drogon/orm/CancelToken.h>
 #include <drogon/orm/DbTypes.h>
 #include <drogon/orm/Exception.h>
 #include <drogon/orm/Field.h>
@@ -26,14 +27,18 @@
 #include <trantor/utils/Logger.h>
 #include <trantor/utils/NonCopyable.h>
 #include <json/json.h>
+#include <array>
 #include <functional>
 #include <iostream>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <sstream>
 #include <string.h>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <optional>
 #ifdef _WIN32
@@ -116,6 +121,89 @@ enum class Mode
     Blocking
 };
 
+/**
+ * @brief A string parameter that is bound without being copied.
+ *
+ * The referenced string must stay alive and unchanged until the statement
+ * completes, e.g. a string owned by the caller of execSqlSync() or
+ * execSqlCoro(). Other string parameters are copied (or moved) into the
+ * statement.
+ */
+class StringRef
+{
+  public:
+    StringRef(const std::string &str)
+        : data_(str.c_str()), length_(str.length())
+    {
+    }
+
+    StringRef(const char *str) : data_(str), length_(strlen(str))
+    {
+    }
+
+    const char *data() const
+    {
+        return data_;
+    }
+
+    size_t length() const
+    {
+        return length_;
+    }
+
+  private:
+    // Always NUL-terminated, PostgreSQL reads text parameters as C strings
+    const char *data_;
+    size_t length_;
+};
+
+/**
+ * @brief A SQL string that the DbClient methods use without copying it,
+ * usually written with the _sqlLiteral suffix, for example:
+ * @code
+   *client << "select * from users where id = $1"_sqlLiteral << id >> ...;
+   client->execSqlAsync("select * from users where id = $1"_sqlLiteral, ...);
+   @endcode
+ * The string must stay alive and unchanged until the statement completes,
+ * which a string literal always does. Other SQL strings, including char
+ * arrays and plain string literals, are copied into the statement.
+ */
+class SqlLiteral
+{
+  public:
+    constexpr explicit SqlLiteral(const char *sql)
+        : data_(sql), length_(std::char_traits<char>::length(sql))
+    {
+    }
+
+    constexpr SqlLiteral(const char *sql, size_t length)
+        : data_(sql), length_(length)
+    {
+    }
+
+    constexpr const char *data() const
+    {
+        return data_;
+    }
+
+    constexpr size_t length() const
+    {
+        return length_;
+    }
+
+  private:
+    const char *data_;
+    size_t length_;
+};
+
+/**
+ * @brief User-defined literal to make a SqlLiteral, see above
+ */
+constexpr SqlLiteral operator""_sqlLiteral(const char *sql, size_t length)
+{
+    return SqlLiteral(sql, length);
+}
+
 namespace internal
 {
 template <typename T>
@@ -280,27 +368,116 @@ class CallbackHolder : public CallbackHolderBase
     }
 };
 
+/**
+ * @brief The SQL copy and the parameter values of a statement. It is
+ * allocated once per statement (and not at all for a SqlLiteral bound with
+ * null or StringRef parameters only) and is kept alive until the result
+ * arrives. The addresses of stored values never change.
+ */
+class ParameterBuffer : public trantor::NonCopyable
+{
+  public:
+    static constexpr size_t kInlineCount = 8;
+
+    std::string &sql()
+    {
+        return sql_;
+    }
+
+    /**
+     * @brief Store a value by value, small trivially copyable values use the
+     * inline slots, others are allocated separately.
+     */
+    template <typename T>
+    const T *store(const T &value)
+    {
+        if constexpr (std::is_trivially_copyable_v<T> &&
+                      sizeof(T) <= sizeof(Slot) && alignof(T) <= alignof(Slot))
+        {
+            Slot *slot;
+            if (valueCount_ < values_.size())
+            {
+                slot = &values_[valueCount_];
+            }
+            else
+            {
+                moreValues_.emplace_back();
+                slot = &moreValues_.back();
+            }
+            ++valueCount_;
+            return new (slot->data) T(value);
+        }
+        else
+        {
+            auto obj = std::make_shared<T>(value);
+            objs_.push_back(obj);
+            return obj.get();
+        }
+    }
+
+    const std::vector<char> *store(std::vector<char> &&value)
+    {
+        auto obj = std::make_shared<std::vector<char>>(std::move(value));
+        objs_.push_back(obj);
+        return obj.get();
+    }
+
+    const std::string *store(std::string &&str)
+    {
+        std::string *slot;
+        if (stringCount_ < strings_.size())
+        {
+            slot = &strings_[stringCount_];
+        }
+        else
+        {
+            moreStrings_.emplace_back();
+            slot = &moreStrings_.back();
+        }
+        ++stringCount_;
+        *slot = std::move(str);
+        return slot;
+    }
+
+  private:
+    struct Slot
+    {
+        alignas(8) unsigned char data[8];
+    };
+
+    std::string sql_;
+    std::array<Slot, kInlineCount> values_;
+    std::list<Slot> moreValues_;
+    size_t valueCount_{0};
+    std::array<std::string, kInlineCount> strings_;
+    std::list<std::string> moreStrings_;
+    size_t stringCount_{0};
+    std::vector<std::shared_ptr<void>> objs_;
+};
+
 class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
 {
     using self = SqlBinder;
 
   public:
     SqlBinder(const std::string &sql, DbClient &client, ClientType type)
-        : sqlPtr_(std::make_shared<std::string>(sql)),
-          sqlViewPtr_(sqlPtr_->data()),
-          sqlViewLength_(sqlPtr_->length()),
+        : buffer_(std::make_shared<ParameterBuffer>()),
           client_(client),
           type_(type)
     {
+        buffer_->sql() = sql;
+        sqlViewPtr_ = buffer_->sql().data();
+        sqlViewLength_ = buffer_->sql().length();
     }
 
     SqlBinder(std::string &&sql, DbClient &client, ClientType type)
-        : sqlPtr_(std::make_shared<std::string>(std::move(sql))),
-          sqlViewPtr_(sqlPtr_->data()),
-          sqlViewLength_(sqlPtr_->length()),
+        : buffer_(std::make_shared<ParameterBuffer>()),
           client_(client),
           type_(type)
     {
+        buffer_->sql() = std::move(sql);
+        sqlViewPtr_ = buffer_->sql().data();
+        sqlViewLength_ = buffer_->sql().length();
     }
 
     SqlBinder(const char *sql,
@@ -315,7 +492,7 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
     }
 
     SqlBinder(SqlBinder &&that) noexcept
-        : sqlPtr_(std::move(that.sqlPtr_)),
+        : buffer_(std::move(that.buffer_)),
           sqlViewPtr_(that.sqlViewPtr_),
           sqlViewLength_(that.sqlViewLength_),
           client_(that.client_),
@@ -323,8 +500,8 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
           parameters_(std::move(that.parameters_)),
           lengths_(std::move(that.lengths_)),
           formats_(std::move(that.formats_)),
-          objs_(std::move(that.objs_)),
           mode_(that.mode_),
+          cancelToken_(std::move(that.cancelToken_)),
           callbackHolder_(std::move(that.callbackHolder_)),
           exceptionCallback_(std::move(that.exceptionCallback_)),
           exceptionPtrCallback_(std::move(that.exceptionPtrCallback_)),
@@ -374,61 +551,52 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
     self &operator<<(T &&parameter)
     {
         using ParaType = std::remove_cv_t<std::remove_reference_t<T>>;
-        ++parametersNumber_;
-        std::shared_ptr<void> obj = std::make_shared<ParaType>(parameter);
         if (type_ == ClientType::PostgreSQL)
         {
+            const void *data;
             switch (sizeof(T))
             {
                 case 2:
-                    *std::static_pointer_cast<uint16_t>(obj) =
-                        htons((uint16_t)parameter);
+                    data = buffer().store(htons((uint16_t)parameter));
                     break;
                 case 4:
-                    *std::static_pointer_cast<uint32_t>(obj) =
-                        htonl((uint32_t)parameter);
+                    data = buffer().store(htonl((uint32_t)parameter));
                     break;
                 case 8:
-                    *std::static_pointer_cast<uint64_t>(obj) =
-                        htonll((uint64_t)parameter);
+                    data = buffer().store(htonll((uint64_t)parameter));
                     break;
                 case 1:
                 default:
+                    data = buffer().store<ParaType>(parameter);
                     break;
             }
-            objs_.push_back(obj);
-            parameters_.push_back((char *)obj.get());
-            lengths_.push_back(sizeof(T));
-            formats_.push_back(1);
+            addParameter(data, sizeof(T), 1);
         }
         else if (type_ == ClientType::Mysql)
         {
-            objs_.push_back(obj);
-            parameters_.push_back((char *)obj.get());
-            lengths_.push_back(0);
-            formats_.push_back(getMysqlTypeBySize(sizeof(T)));
+            addParameter(buffer().store<ParaType>(parameter),
+                         0,
+                         getMysqlTypeBySize(sizeof(T)));
         }
         else if (type_ == ClientType::Sqlite3)
         {
-            objs_.push_back(obj);
-            parameters_.push_back((char *)obj.get());
-            lengths_.push_back(0);
+            int format{Sqlite3TypeInt64};
             switch (sizeof(T))
             {
                 case 1:
-                    formats_.push_back(Sqlite3TypeChar);
+                    format = Sqlite3TypeChar;
                     break;
                 case 2:
-                    formats_.push_back(Sqlite3TypeShort);
+                    format = Sqlite3TypeShort;
                     break;
                 case 4:
-                    formats_.push_back(Sqlite3TypeInt);
+                    format = Sqlite3TypeInt;
                     break;
                 case 8:
-                    formats_.push_back(Sqlite3TypeInt64);
                 default:
                     break;
             }
+            addParameter(buffer().store<ParaType>(parameter), 0, format);
         }
         // LOG_TRACE << "Bind parameter:" << parameter;
         return *this;
@@ -466,6 +634,18 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
 
     self &operator<<(std::string &&str);
 
+    self &operator<<(const StringRef &str);
+
+    self &operator<<(StringRef &str)
+    {
+        return operator<<((const StringRef &)str);
+    }
+
+    self &operator<<(StringRef &&str)
+    {
+        return operator<<((const StringRef &)str);
+    }
+
     self &operator<<(trantor::Date date)
     {
         return operator<<(date.toDbStringLocal());
@@ -511,6 +691,25 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
         return *this;
     }
 
+    /// Cancel the statement with the token, see CancelToken
+    self &operator<<(const CancelTokenPtr &token)
+    {
+        cancelToken_ = token;
+        return *this;
+    }
+
+    self &operator<<(CancelTokenPtr &token)
+    {
+        cancelToken_ = token;
+        return *this;
+    }
+
+    self &operator<<(CancelTokenPtr &&token)
+    {
+        cancelToken_ = std::move(token);
+        return *this;
+    }
+
     template <typename T>
     self &operator<<(const std::optional<T> &parameter)
     {
@@ -578,11 +777,44 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
         return *this << static_cast<const Json::Value &>(j);
     }
 
+    /**
+     * @brief Reserve room for @p count parameters, so that binding them
+     * does not grow the parameter arrays.
+     */
+    void reserveParameters(size_t count)
+    {
+        parameters_.reserve(count);
+        lengths_.reserve(count);
+        formats_.reserve(count);
+    }
+
     void exec() noexcept(false);
 
   private:
     static int getMysqlTypeBySize(size_t size);
-    std::shared_ptr<std::string> sqlPtr_;
+
+    // Pass the statement to the client, with the token if there is one
+    void execSql(QueryCallback &&rcb, ExceptPtrCallback &&exceptCallback);
+
+    ParameterBuffer &buffer()
+    {
+        if (!buffer_)
+            buffer_ = std::make_shared<ParameterBuffer>();
+        return *buffer_;
+    }
+
+    void addParameter(const void *data, size_t length, int format)
+    {
+        if (parameters_.capacity() == 0)
+            reserveParameters(ParameterBuffer::kInlineCount);
+        ++parametersNumber_;
+        parameters_.push_back(static_cast<const char *>(data));
+        lengths_.push_back(static_cast<int>(length));
+        formats_.push_back(format);
+    }
+
+    // Owns the SQL (unless it is a literal or a view) and the parameters
+    std::shared_ptr<ParameterBuffer> buffer_;
     const char *sqlViewPtr_;
     size_t sqlViewLength_;
     DbClient &client_;
@@ -590,8 +822,8 @@ class DROGON_EXPORT SqlBinder : public trantor::NonCopyable
     std::vector<const char *> parameters_;
     std::vector<int> lengths_;
     std::vector<int> formats_;
-    std::vector<std::shared_ptr<void>> objs_;
     Mode mode_{Mode::NonBlocking};
+    CancelTokenPtr cancelToken_;
     std::shared_ptr<CallbackHolderBase> callbackHolder_;
     DrogonDbExceptionCallback exceptionCallback_;
     ExceptPtrCallback exceptionPtrCallback_;
@@ -0,0 +1,107 @@
+/**
+ *
+ *  @file BatchControl.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace drogon
+{
+namespace orm
+{
+/**
+ * @brief Batch options and counters shared by a client and its pipeline
+ * connections. Options may be changed from any thread, connections read them
+ * in their own event loops.
+ */
+class BatchControl
+{
+  public:
+    void setOptions(const BatchOptions &options)
+    {
+        maxBatchSize_.store(options.maxBatchSize, std::memory_order_relaxed);
+        maxSqlLength_.store(options.maxSqlLength, std::memory_order_relaxed);
+        batchWindow_.store(options.batchWindow, std::memory_order_relaxed);
+    }
+
+    size_t maxBatchSize() const
+    {
+        return maxBatchSize_.load(std::memory_order_relaxed);
+    }
+
+    size_t maxSqlLength() const
+    {
+        return maxSqlLength_.load(std::memory_order_relaxed);
+    }
+
+    double batchWindow() const
+    {
+        return batchWindow_.load(std::memory_order_relaxed);
+    }
+
+    void recordBatch(uint64_t size)
+    {
+        if (size == 0)
+            return;
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        queries_.fetch_add(size, std::memory_order_relaxed);
+        auto max = largestBatch_.load(std::memory_order_relaxed);
+        while (size > max &&
+               !largestBatch_.compare_exchange_weak(
+                   max, size, std::memory_order_relaxed))
+        {
+        }
+        size_t bucket = 0;
+        while (bucket + 1 < histogram_.size() && (size >> (bucket + 1)) != 0)
+        {
+            ++bucket;
+        }
+        histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    BatchStatistics statistics() const
+    {
+        BatchStatistics stats;
+        stats.batches = batches_.load(std::memory_order_relaxed);
+        stats.queries = queries_.load(std::memory_order_relaxed);
+        stats.maxBatchSize = largestBatch_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < histogram_.size(); ++i)
+        {
+            stats.sizeHistogram[i] =
+                histogram_[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+  private:
+    std::atomic<size_t> maxBatchSize_{BatchOptions{}.maxBatchSize};
+    std::atomic<size_t> maxSqlLength_{BatchOptions{}.maxSqlLength};
+    std::atomic<double> batchWindow_{BatchOptions{}.batchWindow};
+
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> queries_{0};
+    std::atomic<uint64_t> largestBatch_{0};
+    std::array<std::atomic<uint64_t>,
+               std::tuple_size<decltype(BatchStatistics::sizeHistogram)>::value>
+        histogram_{};
+};
+
+using BatchControlPtr = std::shared_ptr<BatchControl>;
+
+}  // namespace orm
+}  // namespace drogon
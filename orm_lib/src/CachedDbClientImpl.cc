@@ -0,0 +1,668 @@
+/**
+ *
+ *  @file CachedDbClientImpl.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "CachedDbClientImpl.h"
+#include "ReadWriteSplitClient.h"
+#include "SqlTokenizer.h"
+#include <drogon/orm/DbTypes.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace drogon::orm;
+
+namespace
+{
+// The lower case name of a Word or QuotedName token
+std::string lowerName(const SqlToken &token)
+{
+    auto name = token.text_;
+    std::transform(name.begin(),
+                   name.end(),
+                   name.begin(),
+                   [](unsigned char ch) { return tolower(ch); });
+    return name;
+}
+
+// Key words that can follow a table name, so they are not aliases
+const std::unordered_set<std::string> &keywords()
+{
+    static const std::unordered_set<std::string> words{
+        "and",     "as",        "cross",     "default", "except",
+        "fetch",   "for",       "from",      "full",    "group",
+        "having",  "inner",     "intersect", "into",    "join",
+        "lateral", "left",      "limit",     "natural", "nowait",
+        "of",      "offset",    "on",        "or",      "order",
+        "outer",   "returning", "right",     "select",  "set",
+        "skip",    "union",     "using",     "values",  "where",
+        "window"};
+    return words;
+}
+
+std::string normalizeTableName(const std::string &table)
+{
+    for (auto &token : tokenizeSql(table))
+    {
+        if (token.isName())
+            return lowerName(token);
+    }
+    return table;
+}
+
+// The number of bytes a bound parameter points to
+size_t parameterSize(ClientType type, int format, int length)
+{
+    if (length > 0 || type == ClientType::PostgreSQL)
+        return length > 0 ? static_cast<size_t>(length) : 0;
+    if (type == ClientType::Mysql)
+    {
+        switch (format)
+        {
+            case internal::MySqlTiny:
+                return 1;
+            case internal::MySqlShort:
+                return 2;
+            case internal::MySqlLong:
+                return 4;
+            case internal::MySqlLongLong:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+    switch (format)
+    {
+        case Sqlite3TypeChar:
+            return 1;
+        case Sqlite3TypeShort:
+            return 2;
+        case Sqlite3TypeInt:
+            return 4;
+        case Sqlite3TypeInt64:
+        case Sqlite3TypeDouble:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+template <typename T>
+void appendBytes(std::string &key, const T &value)
+{
+    key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/**
+ * @brief A transaction created by a cached client. Statements bypass the
+ * cache, the tables written by the transaction are invalidated when it is
+ * committed.
+ */
+class CachedTransaction : public Transaction,
+                          public std::enable_shared_from_this<CachedTransaction>
+{
+  public:
+    CachedTransaction(std::shared_ptr<CachedDbClientImpl> cache,
+                      std::shared_ptr<Transaction> trans,
+                      const std::function<void(bool)> &commitCallback)
+        : cache_(std::move(cache)), trans_(std::move(trans))
+    {
+        type_ = trans_->type();
+        connectionInfo_ = trans_->connectionInfo();
+        setCommitCallback(commitCallback);
+    }
+
+    void rollback() override
+    {
+        trans_->rollback();
+    }
+
+    void setCommitCallback(
+        const std::function<void(bool)> &commitCallback) override
+    {
+        trans_->setCommitCallback(
+            [cache = cache_, written = written_, commitCallback](
+                bool committed) {
+                if (committed)
+                {
+                    std::vector<std::string> tables;
+                    bool all;
+                    {
+                        std::lock_guard<std::mutex> lock(written->mutex_);
+                        tables = written->tables_;
+                        all = written->all_;
+                    }
+                    // An empty list invalidates everything
+                    if (all)
+                        cache->invalidate(std::vector<std::string>{});
+                    else if (!tables.empty())
+                        cache->invalidate(tables);
+                }
+                if (commitCallback)
+                    commitCallback(committed);
+            });
+    }
+
+    bool hasAvailableConnections() const noexcept override
+    {
+        return trans_->hasAvailableConnections();
+    }
+
+    void setTimeout(double timeout) override
+    {
+        trans_->setTimeout(timeout);
+    }
+
+    std::shared_ptr<Transaction> newTransaction(
+        const std::function<void(bool)> &) noexcept(false) override
+    {
+        return shared_from_this();
+    }
+
+    void newTransactionAsync(
+        const std::function<void(const std::shared_ptr<Transaction> &)>
+            &callback) override
+    {
+        callback(shared_from_this());
+    }
+
+  private:
+    void execSql(const char *sql,
+                 size_t sqlLength,
+                 size_t paraNum,
+                 std::vector<const char *> &&parameters,
+                 std::vector<int> &&length,
+                 std::vector<int> &&format,
+                 ResultCallback &&rcb,
+                 std::function<void(const std::exception_ptr &)>
+                     &&exceptCallback) override
+    {
+        std::string_view sqlView{sql, sqlLength};
+        if (!ReadWriteSplitClient::isReadOnlySql(sqlView))
+        {
+            auto tables = CachedDbClientImpl::tablesOf(sqlView);
+            std::lock_guard<std::mutex> lock(written_->mutex_);
+            if (tables.empty())
+                written_->all_ = true;
+            for (auto &table : tables)
+            {
+                if (std::find(written_->tables_.begin(),
+                              written_->tables_.end(),
+                              table) == written_->tables_.end())
+                    written_->tables_.push_back(std::move(table));
+            }
+        }
+        CachedDbClientImpl::forward(*trans_,
+                                    sql,
+                                    sqlLength,
+                                    paraNum,
+                                    std::move(parameters),
+                                    std::move(length),
+                                    std::move(format),
+                                    std::move(rcb),
+                                    std::move(exceptCallback));
+    }
+
+    struct WrittenTables
+    {
+        std::mutex mutex_;
+        std::vector<std::string> tables_;
+        // Set when a write without recognizable tables was executed
+        bool all_{false};
+    };
+
+    std::shared_ptr<CachedDbClientImpl> cache_;
+    std::shared_ptr<Transaction> trans_;
+    std::shared_ptr<WrittenTables> written_{std::make_shared<WrittenTables>()};
+};
+}  // namespace
+
+CachedDbClientPtr CachedDbClient::newCachedClient(
+    const DbClientPtr &client,
+    const QueryCacheOptions &options)
+{
+    assert(client);
+    auto cachedClient = std::make_shared<CachedDbClientImpl>(client, options);
+    cachedClient->init();
+    return cachedClient;
+}
+
+CachedDbClientImpl::CachedDbClientImpl(DbClientPtr client,
+                                       QueryCacheOptions options)
+    : client_(std::move(client)), options_(std::move(options))
+{
+    type_ = client_->type();
+    connectionInfo_ = client_->connectionInfo();
+    for (auto const &table : options_.tables)
+    {
+        cachedTables_.insert(normalizeTableName(table));
+    }
+}
+
+CachedDbClientImpl::~CachedDbClientImpl() noexcept
+{
+    if (listener_)
+    {
+        listener_->unlisten(options_.notifyChannel);
+    }
+}
+
+void CachedDbClientImpl::init()
+{
+    if (options_.notifyChannel.empty())
+        return;
+    if (type_ != ClientType::PostgreSQL || connectionInfo_.empty())
+    {
+        LOG_ERROR << "The notify channel of a query cache requires a "
+                     "PostgreSQL client, it is ignored";
+        return;
+    }
+    listener_ = DbListener::newPgListener(connectionInfo_);
+    if (!listener_)
+        return;
+    std::weak_ptr<CachedDbClientImpl> weakPtr = shared_from_this();
+    listener_->listen(options_.notifyChannel,
+                      [weakPtr](std::string, std::string payload) {
+                          auto thisPtr = weakPtr.lock();
+                          if (!thisPtr)
+                              return;
+                          if (payload.empty())
+                              thisPtr->clear();
+                          else
+                              thisPtr->invalidate(payload);
+                      });
+}
+
+void CachedDbClientImpl::forward(
+    DbClient &client,
+    const char *sql,
+    size_t sqlLength,
+    size_t paraNum,
+    std::vector<const char *> &&parameters,
+    std::vector<int> &&length,
+    std::vector<int> &&format,
+    ResultCallback &&rcb,
+    std::function<void(const std::exception_ptr &)> &&exceptCallback)
+{
+    client.execSql(sql,
+                   sqlLength,
+                   paraNum,
+                   std::move(parameters),
+                   std::move(length),
+                   std::move(format),
+                   std::move(rcb),
+                   std::move(exceptCallback));
+}
+
+void CachedDbClientImpl::execSql(
+    const char *sql,
+    size_t sqlLength,
+    size_t paraNum,
+    std::vector<const char *> &&parameters,
+    std::vector<int> &&length,
+    std::vector<int> &&format,
+    ResultCallback &&rcb,
+    std::function<void(const std::exception_ptr &)> &&exceptCallback)
+{
+    std::string_view sqlView{sql, sqlLength};
+    auto tables = tablesOf(sqlView);
+    if (!ReadWriteSplitClient::isReadOnlySql(sqlView))
+    {
+        // Invalidate before and after the write, so a read running
+        // concurrently doesn't store the old data.
+        invalidate(tables);
+        auto thisPtr = shared_from_this();
+        forward(
+            *client_,
+            sql,
+            sqlLength,
+            paraNum,
+            std::move(parameters),
+            std::move(length),
+            std::move(format),
+            [thisPtr, tables, rcb = std::move(rcb)](const Result &r) {
+                thisPtr->invalidate(tables);
+                rcb(r);
+            },
+            [thisPtr, tables, exceptCallback = std::move(exceptCallback)](
+                const std::exception_ptr &e) {
+                thisPtr->invalidate(tables);
+                exceptCallback(e);
+            });
+        return;
+    }
+    if (!isCacheable(tables))
+    {
+        forward(*client_,
+                sql,
+                sqlLength,
+                paraNum,
+                std::move(parameters),
+                std::move(length),
+                std::move(format),
+                std::move(rcb),
+                std::move(exceptCallback));
+        return;
+    }
+    auto key = makeKey(sql, sqlLength, parameters, length, format);
+    std::vector<uint64_t> generations;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto iter = entries_.find(key);
+        if (iter != entries_.end())
+        {
+            if (options_.ttl <= 0.0 ||
+                iter->second.expiry_ > std::chrono::steady_clock::now())
+            {
+                auto result = iter->second.result_;
+                lock.unlock();
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                rcb(result);
+                return;
+            }
+            removeEntry(iter);
+        }
+        generations = generationsOf(tables);
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto thisPtr = shared_from_this();
+    forward(*client_,
+            sql,
+            sqlLength,
+            paraNum,
+            std::move(parameters),
+            std::move(length),
+            std::move(format),
+            [thisPtr,
+             key = std::move(key),
+             tables = std::move(tables),
+             generations = std::move(generations),
+             rcb = std::move(rcb)](const Result &r) mutable {
+                thisPtr->store(std::move(key), tables, generations, r);
+                rcb(r);
+            },
+            std::move(exceptCallback));
+}
+
+std::shared_ptr<Transaction> CachedDbClientImpl::newTransaction(
+    const std::function<void(bool)> &commitCallback) noexcept(false)
+{
+    return std::make_shared<CachedTransaction>(shared_from_this(),
+                                               client_->newTransaction(),
+                                               commitCallback);
+}
+
+void CachedDbClientImpl::newTransactionAsync(
+    const std::function<void(const std::shared_ptr<Transaction> &)> &callback)
+{
+    client_->newTransactionAsync(
+        [thisPtr = shared_from_this(),
+         callback](const std::shared_ptr<Transaction> &trans) {
+            if (!trans)
+            {
+                callback(nullptr);
+                return;
+            }
+            callback(std::make_shared<CachedTransaction>(thisPtr,
+                                                         trans,
+                                                         nullptr));
+        });
+}
+
+void CachedDbClientImpl::closeAll()
+{
+    client_->closeAll();
+    clear();
+}
+
+void CachedDbClientImpl::invalidate(const std::string &table)
+{
+    invalidate(std::vector<std::string>{normalizeTableName(table)});
+}
+
+void CachedDbClientImpl::clear()
+{
+    invalidate(std::vector<std::string>{});
+}
+
+size_t CachedDbClientImpl::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void CachedDbClientImpl::invalidate(const std::vector<std::string> &tables)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tables.empty())
+    {
+        ++clearGeneration_;
+        entries_.clear();
+        order_.clear();
+        keysByTable_.clear();
+        return;
+    }
+    for (auto const &table : tables)
+    {
+        ++generations_[table];
+        auto iter = keysByTable_.find(table);
+        if (iter == keysByTable_.end())
+            continue;
+        // removeEntry() modifies the set
+        auto keys = std::move(iter->second);
+        keysByTable_.erase(iter);
+        for (auto const &key : keys)
+        {
+            auto entry = entries_.find(key);
+            if (entry != entries_.end())
+                removeEntry(entry);
+        }
+    }
+}
+
+bool CachedDbClientImpl::isCacheable(
+    const std::vector<std::string> &tables) const
+{
+    if (tables.empty() || options_.maxEntries == 0)
+        return false;
+    if (cachedTables_.empty())
+        return true;
+    for (auto const &table : tables)
+    {
+        if (cachedTables_.find(table) == cachedTables_.end())
+            return false;
+    }
+    return true;
+}
+
+std::string CachedDbClientImpl::makeKey(
+    const char *sql,
+    size_t sqlLength,
+    const std::vector<const char *> &parameters,
+    const std::vector<int> &length,
+    const std::vector<int> &format) const
+{
+    std::string key;
+    key.reserve(sqlLength + 1 + parameters.size() * 16);
+    key.append(sql, sqlLength);
+    key.push_back('\0');
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        appendBytes(key, format[i]);
+        if (parameters[i] == nullptr)
+        {
+            key.push_back('n');
+            continue;
+        }
+        auto size = parameterSize(type_, format[i], length[i]);
+        key.push_back('v');
+        appendBytes(key, size);
+        key.append(parameters[i], size);
+    }
+    return key;
+}
+
+void CachedDbClientImpl::store(std::string &&key,
+                               const std::vector<std::string> &tables,
+                               const std::vector<uint64_t> &generations,
+                               const Result &result)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generationsOf(tables) != generations ||
+        entries_.find(key) != entries_.end())
+        return;
+    while (entries_.size() >= options_.maxEntries && !order_.empty())
+    {
+        removeEntry(entries_.find(order_.front()));
+    }
+    auto expiry = std::chrono::steady_clock::now() +
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::duration<double>(
+                          options_.ttl > 0.0 ? options_.ttl : 0.0));
+    order_.push_back(key);
+    auto orderIter = std::prev(order_.end());
+    for (auto const &table : tables)
+    {
+        keysByTable_[table].insert(key);
+    }
+    entries_.emplace(std::move(key),
+                     Entry{result, expiry, tables, orderIter});
+}
+
+std::vector<uint64_t> CachedDbClientImpl::generationsOf(
+    const std::vector<std::string> &tables) const
+{
+    std::vector<uint64_t> generations;
+    generations.reserve(tables.size() + 1);
+    for (auto const &table : tables)
+    {
+        auto iter = generations_.find(table);
+        generations.push_back(iter == generations_.end() ? 0 : iter->second);
+    }
+    generations.push_back(clearGeneration_);
+    return generations;
+}
+
+void CachedDbClientImpl::removeEntry(EntryMap::iterator iter)
+{
+    order_.erase(iter->second.order_);
+    for (auto const &table : iter->second.tables_)
+    {
+        auto keys = keysByTable_.find(table);
+        if (keys == keysByTable_.end())
+            continue;
+        keys->second.erase(iter->first);
+        if (keys->second.empty())
+            keysByTable_.erase(keys);
+    }
+    entries_.erase(iter);
+}
+
+std::vector<std::string> CachedDbClientImpl::tablesOf(std::string_view sql)
+{
+    auto tokens = tokenizeSql(sql);
+    auto &words = keywords();
+    auto isName = [&tokens, &words](size_t i) {
+        return i < tokens.size() &&
+               (tokens[i].type_ == SqlToken::Type::QuotedName ||
+                (tokens[i].type_ == SqlToken::Type::Word &&
+                 words.find(tokens[i].text_) == words.end()));
+    };
+    // Key words that end a FROM list
+    static const std::unordered_set<std::string> listEnds{
+        "except",    "fetch", "for",    "group",  "having",
+        "intersect", "limit", "offset", "order",  "returning",
+        "select",    "set",   "union",  "values", "where",
+        "window"};
+    std::vector<std::string> tables;
+    // Whether each level of parentheses is a FROM list, in which commas
+    // separate tables. A parenthesized join, e.g. FROM (t1 JOIN t2 ON ...),
+    // is one.
+    std::vector<bool> inFrom{false};
+    // Whether the next name is a table, and if it follows FROM or JOIN
+    bool expectTable = false;
+    bool fromItem = false;
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        auto const &token = tokens[i];
+        if (token.isSymbol('('))
+        {
+            inFrom.push_back(expectTable && fromItem);
+            continue;
+        }
+        if (token.isSymbol(')'))
+        {
+            if (inFrom.size() > 1)
+                inFrom.pop_back();
+            expectTable = false;
+            continue;
+        }
+        if (token.isSymbol(','))
+        {
+            expectTable = fromItem = inFrom.back();
+            continue;
+        }
+        if (expectTable && (token.isWord("only") || token.isWord("if") ||
+                            token.isWord("not") || token.isWord("exists") ||
+                            token.isWord("table") || token.isWord("lateral")))
+            continue;
+        if (expectTable && isName(i))
+        {
+            expectTable = false;
+            // A set returning function, e.g. generate_series(1, 10)
+            if (fromItem && i + 1 < tokens.size() &&
+                tokens[i + 1].isSymbol('('))
+                continue;
+            auto table = lowerName(token);
+            if (std::find(tables.begin(), tables.end(), table) ==
+                tables.end())
+                tables.push_back(std::move(table));
+            // Skip the alias
+            if (i + 1 < tokens.size() && tokens[i + 1].isWord("as"))
+                ++i;
+            if (isName(i + 1))
+                ++i;
+            continue;
+        }
+        if (token.type_ != SqlToken::Type::Word)
+        {
+            expectTable = false;
+            continue;
+        }
+        auto const &word = token.text_;
+        expectTable = false;
+        if (word == "from" || word == "join")
+        {
+            if (word == "from")
+                inFrom.back() = true;
+            expectTable = fromItem = true;
+        }
+        else if (word == "truncate")
+        {
+            inFrom.back() = true;
+            expectTable = true;
+            fromItem = false;
+        }
+        else if (word == "into" || word == "update" || word == "table")
+        {
+            expectTable = true;
+            fromItem = false;
+        }
+        else if (listEnds.find(word) != listEnds.end())
+        {
+            inFrom.back() = false;
+        }
+    }
+    return tables;
+}
@@ -0,0 +1,165 @@
+/**
+ *
+ *  @file CachedDbClientImpl.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <drogon/orm/CachedDbClient.h>
+#include <drogon/orm/DbListener.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+class CachedDbClientImpl
+    : public CachedDbClient,
+      public std::enable_shared_from_this<CachedDbClientImpl>
+{
+  public:
+    CachedDbClientImpl(DbClientPtr client, QueryCacheOptions options);
+    ~CachedDbClientImpl() noexcept override;
+    void execSql(const char *sql,
+                 size_t sqlLength,
+                 size_t paraNum,
+                 std::vector<const char *> &&parameters,
+                 std::vector<int> &&length,
+                 std::vector<int> &&format,
+                 ResultCallback &&rcb,
+                 std::function<void(const std::exception_ptr &)>
+                     &&exceptCallback) override;
+    std::shared_ptr<Transaction> newTransaction(
+        const std::function<void(bool)> &commitCallback =
+            std::function<void(bool)>()) noexcept(false) override;
+    void newTransactionAsync(
+        const std::function<void(const std::shared_ptr<Transaction> &)>
+            &callback) override;
+
+    bool hasAvailableConnections() const noexcept override
+    {
+        return client_->hasAvailableConnections();
+    }
+
+    void setTimeout(double timeout) override
+    {
+        client_->setTimeout(timeout);
+    }
+
+    void setBatchOptions(const BatchOptions &options) override
+    {
+        client_->setBatchOptions(options);
+    }
+
+    BatchStatistics batchStatistics() const override
+    {
+        return client_->batchStatistics();
+    }
+
+    void closeAll() override;
+
+    void invalidate(const std::string &table) override;
+    void clear() override;
+    size_t size() const override;
+
+    uint64_t hits() const override
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t misses() const override
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    // Subscribe to the NOTIFY channel, must be called after the client is
+    // owned by a shared_ptr.
+    void init();
+
+    // Remove the results of the tables, or all results if the list is empty
+    void invalidate(const std::vector<std::string> &tables);
+
+    /**
+     * @brief Return the tables a statement reads or writes, in lower case
+     * and without schema names or quotes.
+     */
+    static std::vector<std::string> tablesOf(std::string_view sql);
+
+    // Execute a statement on another client (or transaction)
+    static void forward(
+        DbClient &client,
+        const char *sql,
+        size_t sqlLength,
+        size_t paraNum,
+        std::vector<const char *> &&parameters,
+        std::vector<int> &&length,
+        std::vector<int> &&format,
+        ResultCallback &&rcb,
+        std::function<void(const std::exception_ptr &)> &&exceptCallback);
+
+  private:
+    struct Entry
+    {
+        Result result_;
+        std::chrono::steady_clock::time_point expiry_;
+        std::vector<std::string> tables_;
+        std::list<std::string>::iterator order_;
+    };
+
+    using EntryMap = std::unordered_map<std::string, Entry>;
+
+    bool isCacheable(const std::vector<std::string> &tables) const;
+    std::string makeKey(const char *sql,
+                        size_t sqlLength,
+                        const std::vector<const char *> &parameters,
+                        const std::vector<int> &length,
+                        const std::vector<int> &format) const;
+    void store(std::string &&key,
+               const std::vector<std::string> &tables,
+               const std::vector<uint64_t> &generations,
+               const Result &result);
+    // The following methods must be called with mutex_ locked
+    std::vector<uint64_t> generationsOf(
+        const std::vector<std::string> &tables) const;
+    void removeEntry(EntryMap::iterator iter);
+
+    DbClientPtr client_;
+    QueryCacheOptions options_;
+    std::unordered_set<std::string> cachedTables_;
+    DbListenerPtr listener_;
+
+    mutable std::mutex mutex_;
+    EntryMap entries_;
+    // Keys in insertion order, the front one is evicted first
+    std::list<std::string> order_;
+    std::unordered_map<std::string, std::unordered_set<std::string>>
+        keysByTable_;
+    // Bumped on every invalidation, a result is only stored if the tables it
+    // reads were not invalidated while the statement was running.
+    std::unordered_map<std::string, uint64_t> generations_;
+    uint64_t clearGeneration_{0};
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace orm
+}  // namespace drogon
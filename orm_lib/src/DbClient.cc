@@ -13,8 +13,11 @@
  */
 
 #include "DbClientImpl.h"
+#include "ReadWriteSplitClient.h"
 #include <drogon/config.h>
 #include <drogon/orm/DbClient.h>
+#include <algorithm>
+#include <atomic>
 using namespace drogon::orm;
 using namespace drogon;
 
@@ -30,6 +33,87 @@ orm::internal::SqlBinder DbClient::operator<<(std::string &&sql)
     return orm::internal::SqlBinder(std::move(sql), *this, type_);
 }
 
+void DbClient::execCancellableSql(
+    const char *sql,
+    size_t sqlLength,
+    size_t paraNum,
+    std::vector<const char *> &&parameters,
+    std::vector<int> &&length,
+    std::vector<int> &&format,
+    ResultCallback &&rcb,
+    std::function<void(const std::exception_ptr &)> &&exceptCallback,
+    const CancelTokenPtr &token)
+{
+    if (token->isCancelled())
+    {
+        exceptCallback(std::make_exception_ptr(
+            CancelledError("SQL execution cancelled")));
+        return;
+    }
+    auto donePtr = std::make_shared<std::atomic<bool>>(false);
+    auto ecpPtr =
+        std::make_shared<std::function<void(const std::exception_ptr &)>>(
+            std::move(exceptCallback));
+    token->onCancel([donePtr, ecpPtr]() {
+        if (donePtr->exchange(true))
+            return;
+        (*ecpPtr)(std::make_exception_ptr(
+            CancelledError("SQL execution cancelled")));
+    });
+    execSql(
+        sql,
+        sqlLength,
+        paraNum,
+        std::move(parameters),
+        std::move(length),
+        std::move(format),
+        [donePtr, rcb = std::move(rcb)](const Result &result) {
+            if (donePtr->exchange(true))
+                return;
+            rcb(result);
+        },
+        [donePtr, ecpPtr](const std::exception_ptr &exception) {
+            if (donePtr->exchange(true))
+                return;
+            (*ecpPtr)(exception);
+        });
+}
+
+void CancelToken::cancel()
+{
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled_)
+            return;
+        cancelled_ = true;
+        callbacks.swap(callbacks_);
+    }
+    for (auto &callback : callbacks)
+    {
+        callback();
+    }
+}
+
+bool CancelToken::isCancelled() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_;
+}
+
+void CancelToken::onCancel(std::function<void()> &&callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!cancelled_)
+        {
+            callbacks_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback();
+}
+
 std::shared_ptr<DbClient> DbClient::newPgClient(const std::string &connInfo,
                                                 size_t connNum,
                                                 bool autoBatch)
@@ -53,6 +137,51 @@ std::shared_ptr<DbClient> DbClient::newPgClient(const std::string &connInfo,
 #endif
 }
 
+std::shared_ptr<DbClient> DbClient::newPgClient(
+    const std::string &connInfo,
+    const std::vector<std::string> &replicaConnInfos,
+    size_t connNum,
+    bool autoBatch,
+    double replicaCheckInterval,
+    double maxReplicaLag)
+{
+#if USE_POSTGRESQL
+    auto newClient = [connNum, autoBatch](const std::string &info) {
+        auto client = std::make_shared<DbClientImpl>(info,
+                                                     connNum,
+#if LIBPQ_SUPPORTS_BATCH_MODE
+                                                     ClientType::PostgreSQL,
+                                                     autoBatch);
+#else
+                                                     ClientType::PostgreSQL);
+#endif
+        client->init();
+        return client;
+    };
+    std::vector<std::shared_ptr<DbClientImpl>> readers;
+    for (auto const &replicaConnInfo : replicaConnInfos)
+    {
+        readers.push_back(newClient(replicaConnInfo));
+    }
+    auto client =
+        std::make_shared<ReadWriteSplitClient>(connInfo,
+                                               ClientType::PostgreSQL,
+                                               newClient(connInfo),
+                                               std::move(readers));
+    client->enableHealthCheck(replicaCheckInterval, maxReplicaLag);
+    return client;
+#else
+    LOG_FATAL << "PostgreSQL is not supported!";
+    exit(1);
+    (void)(connInfo);
+    (void)(replicaConnInfos);
+    (void)(connNum);
+    (void)(autoBatch);
+    (void)(replicaCheckInterval);
+    (void)(maxReplicaLag);
+#endif
+}
+
 std::shared_ptr<DbClient> DbClient::newMysqlClient(const std::string &connInfo,
                                                    size_t connNum)
 {
@@ -80,16 +209,44 @@ std::shared_ptr<DbClient> DbClient::newSqlite3Client(
     size_t connNum)
 {
 #if USE_SQLITE3
-    auto client = std::make_shared<DbClientImpl>(connInfo,
-                                                 connNum,
+    auto newClient = [](const std::string &info, size_t num) {
+        auto client = std::make_shared<DbClientImpl>(info,
+                                                     num,
 #if LIBPQ_SUPPORTS_BATCH_MODE
-                                                 ClientType::Sqlite3,
-                                                 false);
+                                                     ClientType::Sqlite3,
+                                                     false);
 #else
-                                                 ClientType::Sqlite3);
+                                                     ClientType::Sqlite3);
 #endif
-    client->init();
-    return client;
+        client->init();
+        return client;
+    };
+    bool walMode = false;
+    for (auto const &kv : DbConnection::parseConnString(connInfo))
+    {
+        auto key = kv.first;
+        auto value = kv.second;
+        auto toLower = [](unsigned char c) { return tolower(c); };
+        std::transform(key.begin(), key.end(), key.begin(), toLower);
+        std::transform(value.begin(), value.end(), value.begin(), toLower);
+        if (key == "journal_mode" && value == "wal")
+        {
+            walMode = true;
+        }
+    }
+    if (!walMode || connNum < 2)
+    {
+        return newClient(connInfo, connNum);
+    }
+    // In WAL mode readers don't block the writer and vice versa, so one
+    // connection is dedicated to writes and the others only run SELECTs.
+    auto writer = newClient(connInfo, 1);
+    std::vector<std::shared_ptr<DbClientImpl>> readers{
+        newClient(connInfo + " query_only=1", connNum - 1)};
+    return std::make_shared<ReadWriteSplitClient>(connInfo,
+                                                  ClientType::Sqlite3,
+                                                  std::move(writer),
+                                                  std::move(readers));
 #else
     LOG_FATAL << "Sqlite3 is not supported!";
     exit(1);
@@ -363,6 +363,12 @@ void DbClientImpl::handleNewTask(const DbConnectionPtr &connPtr)
     }
     if (cmd)
     {
+        if (cmd->handle_ && !cmd->handle_->send(connPtr))
+        {
+            // Cancelled while it was taken from the buffer
+            handleNewTask(connPtr);
+            return;
+        }
         connPtr->execSql(std::move(cmd->sql_),
                          cmd->parametersNumber_,
                          std::move(cmd->parameters_),
@@ -381,8 +387,10 @@ DbConnectionPtr DbClientImpl::newConnection(trantor::EventLoop *loop)
     {
 #if USE_POSTGRESQL
 #if LIBPQ_SUPPORTS_BATCH_MODE
-        connPtr =
-            std::make_shared<PgConnection>(loop, connectionInfo_, autoBatch_);
+        connPtr = std::make_shared<PgConnection>(loop,
+                                                 connectionInfo_,
+                                                 autoBatch_,
+                                                 batchControl_);
 #else
         connPtr = std::make_shared<PgConnection>(loop, connectionInfo_, false);
 #endif
@@ -488,46 +496,73 @@ void DbClientImpl::execSqlWithTimeout(
     std::vector<int> &&length,
     std::vector<int> &&format,
     ResultCallback &&rcb,
-    std::function<void(const std::exception_ptr &)> &&ecb)
+    std::function<void(const std::exception_ptr &)> &&ecb,
+    const CancelTokenPtr &token)
 {
     DbConnectionPtr conn;
-    assert(timeout_ > 0.0);
+    assert(timeout_ > 0.0 || token);
     auto cmd = std::make_shared<std::weak_ptr<SqlCmd>>();
+    auto handle = std::make_shared<StatementHandle>();
     bool busy = false;
     auto ecpPtr =
         std::make_shared<std::function<void(const std::exception_ptr &)>>(
             std::move(ecb));
-    auto timeoutFlagPtr = std::make_shared<drogon::TaskTimeoutFlag>(
-        loops_.getNextLoop(),
-        std::chrono::duration<double>(timeout_),
-        [cmd, ecpPtr, thisPtr = shared_from_this()]() {
-            auto cbPtr = (*cmd).lock();
-            if (cbPtr)
+    // Drop the statement if it is still in the buffer, otherwise cancel it
+    // on the server so that its connection is released right away.
+    auto cancelStatement = [cmd, handle, ecpPtr, thisPtr = shared_from_this()](
+                               const std::exception_ptr &error) {
+        auto cbPtr = (*cmd).lock();
+        if (cbPtr)
+        {
+            std::lock_guard<std::mutex> lock(thisPtr->connectionsMutex_);
+            for (auto iter = thisPtr->sqlCmdBuffer_.begin();
+                 iter != thisPtr->sqlCmdBuffer_.end();
+                 ++iter)
             {
-                std::lock_guard<std::mutex> lock(thisPtr->connectionsMutex_);
-                for (auto iter = thisPtr->sqlCmdBuffer_.begin();
-                     iter != thisPtr->sqlCmdBuffer_.end();
-                     ++iter)
+                if (*iter == cbPtr)
                 {
-                    if (*iter == cbPtr)
-                    {
-                        thisPtr->sqlCmdBuffer_.erase(iter);
-                        break;
-                    }
+                    thisPtr->sqlCmdBuffer_.erase(iter);
+                    break;
                 }
             }
-            (*ecpPtr)(
+        }
+        handle->cancel();
+        (*ecpPtr)(error);
+    };
+    auto timeoutFlagPtr = std::make_shared<drogon::TaskTimeoutFlag>(
+        loops_.getNextLoop(),
+        std::chrono::duration<double>(timeout_),
+        [cancelStatement]() {
+            cancelStatement(
                 std::make_exception_ptr(TimeoutError("SQL execution timeout")));
         });
-    auto resultCallback = [rcb = std::move(rcb),
-                           timeoutFlagPtr](const Result &result) {
+    auto startTimers = [&token, &timeoutFlagPtr, &cancelStatement, this]() {
+        if (timeout_ > 0.0)
+            timeoutFlagPtr->runTimer();
+        if (!token)
+            return;
+        std::weak_ptr<TaskTimeoutFlag> weakFlagPtr = timeoutFlagPtr;
+        token->onCancel([weakFlagPtr, cancelStatement]() {
+            auto flagPtr = weakFlagPtr.lock();
+            if (!flagPtr || flagPtr->done())
+                return;
+            cancelStatement(std::make_exception_ptr(
+                CancelledError("SQL execution cancelled")));
+        });
+    };
+    // The connection may run other statements once the result is returned,
+    // so a late cancel must not reach it.
+    auto resultCallback = [rcb = std::move(rcb), timeoutFlagPtr, handle](
+                              const Result &result) {
+        handle->finish();
         if (timeoutFlagPtr->done())
             return;
         rcb(result);
     };
 
-    auto exceptionCallback = [ecpPtr,
-                              timeoutFlagPtr](const std::exception_ptr &err) {
+    auto exceptionCallback = [ecpPtr, timeoutFlagPtr, handle](
+                                 const std::exception_ptr &err) {
+        handle->finish();
         if (timeoutFlagPtr->done())
             return;
         (*ecpPtr)(err);
@@ -554,6 +589,7 @@ void DbClientImpl::execSqlWithTimeout(
                                              std::move(format),
                                              std::move(resultCallback),
                                              std::move(exceptionCallback));
+                command->handle_ = handle;
                 sqlCmdBuffer_.emplace_back(command);
                 *cmd = command;
             }
@@ -568,6 +604,7 @@ void DbClientImpl::execSqlWithTimeout(
     }
     if (conn)
     {
+        handle->send(conn);
         conn->execSql(std::string_view{sql, sqlLength},
                       paraNum,
                       std::move(parameters),
@@ -575,7 +612,7 @@ void DbClientImpl::execSqlWithTimeout(
                       std::move(format),
                       std::move(resultCallback),
                       std::move(exceptionCallback));
-        timeoutFlagPtr->runTimer();
+        startTimers();
         return;
     }
 
@@ -586,5 +623,33 @@ void DbClientImpl::execSqlWithTimeout(
         return;
     }
 
-    timeoutFlagPtr->runTimer();
+    startTimers();
+}
+
+void DbClientImpl::execCancellableSql(
+    const char *sql,
+    size_t sqlLength,
+    size_t paraNum,
+    std::vector<const char *> &&parameters,
+    std::vector<int> &&length,
+    std::vector<int> &&format,
+    ResultCallback &&rcb,
+    std::function<void(const std::exception_ptr &)> &&exceptCallback,
+    const CancelTokenPtr &token)
+{
+    if (token->isCancelled())
+    {
+        exceptCallback(std::make_exception_ptr(
+            CancelledError("SQL execution cancelled")));
+        return;
+    }
+    execSqlWithTimeout(sql,
+                       sqlLength,
+                       paraNum,
+                       std::move(parameters),
+                       std::move(length),
+                       std::move(format),
+                       std::move(rcb),
+                       std::move(exceptCallback),
+                       token);
 }
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "BatchControl.h"
 #include "DbConnection.h"
 #include <drogon/orm/DbClient.h>
 #include <trantor/net/EventLoopThreadPool.h>
@@ -50,6 +51,16 @@ class DbClientImpl : public DbClient,
                  ResultCallback &&rcb,
                  std::function<void(const std::exception_ptr &)>
                      &&exceptCallback) override;
+    void execCancellableSql(
+        const char *sql,
+        size_t sqlLength,
+        size_t paraNum,
+        std::vector<const char *> &&parameters,
+        std::vector<int> &&length,
+        std::vector<int> &&format,
+        ResultCallback &&rcb,
+        std::function<void(const std::exception_ptr &)> &&exceptCallback,
+        const CancelTokenPtr &token) override;
     std::shared_ptr<Transaction> newTransaction(
         const std::function<void(bool)> &commitCallback =
             std::function<void(bool)>()) noexcept(false) override;
@@ -63,6 +74,18 @@ class DbClientImpl : public DbClient,
         timeout_ = timeout;
     }
 
+#if LIBPQ_SUPPORTS_BATCH_MODE
+    void setBatchOptions(const BatchOptions &options) override
+    {
+        batchControl_->setOptions(options);
+    }
+
+    BatchStatistics batchStatistics() const override
+    {
+        return batchControl_->statistics();
+    }
+#endif
+
     void init();
     void closeAll() override;
 
@@ -73,6 +96,7 @@ class DbClientImpl : public DbClient,
     double timeout_{-1.0};
 #if LIBPQ_SUPPORTS_BATCH_MODE
     bool autoBatch_{false};
+    BatchControlPtr batchControl_{std::make_shared<BatchControl>()};
 #endif
     DbConnectionPtr newConnection(trantor::EventLoop *loop);
 
@@ -92,6 +116,8 @@ class DbClientImpl : public DbClient,
     std::deque<std::shared_ptr<SqlCmd>> sqlCmdBuffer_;
 
     void handleNewTask(const DbConnectionPtr &connPtr);
+    // Execute a statement that is cancelled on the server when it times out
+    // or when the token is cancelled.
     void execSqlWithTimeout(
         const char *sql,
         size_t sqlLength,
@@ -100,7 +126,8 @@ class DbClientImpl : public DbClient,
         std::vector<int> &&length,
         std::vector<int> &&format,
         ResultCallback &&rcb,
-        std::function<void(const std::exception_ptr &)> &&exceptCallback);
+        std::function<void(const std::exception_ptr &)> &&exceptCallback,
+        const CancelTokenPtr &token = nullptr);
 };
 
 }  // namespace orm
@@ -373,6 +373,8 @@ void DbClientLockFree::handleNewTask(const DbConnectionPtr &conn)
         {
             std::shared_ptr<SqlCmd> cmd = std::move(sqlCmdBuffer_.front());
             sqlCmdBuffer_.pop_front();
+            if (cmd->handle_)
+                cmd->handle_->send(conn);
             conn->execSql(std::move(cmd->sql_),
                           cmd->parametersNumber_,
                           std::move(cmd->parameters_),
@@ -391,6 +393,8 @@ void DbClientLockFree::handleNewTask(const DbConnectionPtr &conn)
 #else
         std::shared_ptr<SqlCmd> cmd = std::move(sqlCmdBuffer_.front());
         sqlCmdBuffer_.pop_front();
+        if (cmd->handle_)
+            cmd->handle_->send(conn);
         conn->execSql(std::move(cmd->sql_),
                       cmd->parametersNumber_,
                       std::move(cmd->parameters_),
@@ -410,8 +414,10 @@ DbConnectionPtr DbClientLockFree::newConnection()
     {
 #if USE_POSTGRESQL
 #if LIBPQ_SUPPORTS_BATCH_MODE
-        connPtr =
-            std::make_shared<PgConnection>(loop_, connectionInfo_, autoBatch_);
+        connPtr = std::make_shared<PgConnection>(loop_,
+                                                 connectionInfo_,
+                                                 autoBatch_,
+                                                 batchControl_);
 #else
         connPtr = std::make_shared<PgConnection>(loop_, connectionInfo_, false);
 #endif
@@ -502,42 +508,75 @@ void DbClientLockFree::execSqlWithTimeout(
     std::vector<int> &&length,
     std::vector<int> &&format,
     ResultCallback &&rcb,
-    std::function<void(const std::exception_ptr &)> &&ecb)
+    std::function<void(const std::exception_ptr &)> &&ecb,
+    const CancelTokenPtr &token)
 {
     auto commandPtr = std::make_shared<std::weak_ptr<SqlCmd>>();
+    auto handle = std::make_shared<StatementHandle>();
     auto ecpPtr =
         std::make_shared<std::function<void(const std::exception_ptr &)>>(
             std::move(ecb));
-    auto timeoutFlagPtr = std::make_shared<drogon::TaskTimeoutFlag>(
-        loop_,
-        std::chrono::duration<double>(timeout_),
-        [commandPtr, ecpPtr, thisPtr = shared_from_this()]() {
-            auto cbPtr = (*commandPtr).lock();
-            if (cbPtr)
+    // Drop the statement if it is still in the buffer, otherwise cancel it
+    // on the server so that its connection is released right away.
+    auto cancelStatement = [commandPtr,
+                            handle,
+                            ecpPtr,
+                            thisPtr = shared_from_this()](
+                               const std::exception_ptr &error) {
+        auto cbPtr = (*commandPtr).lock();
+        if (cbPtr)
+        {
+            for (auto iter = thisPtr->sqlCmdBuffer_.begin();
+                 iter != thisPtr->sqlCmdBuffer_.end();
+                 ++iter)
             {
-                for (auto iter = thisPtr->sqlCmdBuffer_.begin();
-                     iter != thisPtr->sqlCmdBuffer_.end();
-                     ++iter)
+                if (*iter == cbPtr)
                 {
-                    if (*iter == cbPtr)
-                    {
-                        thisPtr->sqlCmdBuffer_.erase(iter);
-                        break;
-                    }
+                    thisPtr->sqlCmdBuffer_.erase(iter);
+                    break;
                 }
             }
-            (*ecpPtr)(
+        }
+        handle->cancel();
+        (*ecpPtr)(error);
+    };
+    auto timeoutFlagPtr = std::make_shared<drogon::TaskTimeoutFlag>(
+        loop_,
+        std::chrono::duration<double>(timeout_),
+        [cancelStatement]() {
+            cancelStatement(
                 std::make_exception_ptr(TimeoutError("SQL execution timeout")));
         });
-    auto resultCallback = [rcb = std::move(rcb),
-                           timeoutFlagPtr](const Result &result) {
+    auto startTimers = [&token, &timeoutFlagPtr, &cancelStatement, this]() {
+        if (timeout_ > 0.0)
+            timeoutFlagPtr->runTimer();
+        if (!token)
+            return;
+        std::weak_ptr<TaskTimeoutFlag> weakFlagPtr = timeoutFlagPtr;
+        token->onCancel([weakFlagPtr, cancelStatement, loop = loop_]() {
+            // The buffer is only accessed in the loop of the client
+            loop->runInLoop([weakFlagPtr, cancelStatement]() {
+                auto flagPtr = weakFlagPtr.lock();
+                if (!flagPtr || flagPtr->done())
+                    return;
+                cancelStatement(std::make_exception_ptr(
+                    CancelledError("SQL execution cancelled")));
+            });
+        });
+    };
+    // The connection may run other statements once the result is returned,
+    // so a late cancel must not reach it.
+    auto resultCallback = [rcb = std::move(rcb), timeoutFlagPtr, handle](
+                              const Result &result) {
+        handle->finish();
         if (timeoutFlagPtr->done())
             return;
         rcb(result);
     };
 
-    auto exceptionCallback = [ecpPtr,
-                              timeoutFlagPtr](const std::exception_ptr &err) {
+    auto exceptionCallback = [ecpPtr, timeoutFlagPtr, handle](
+                                 const std::exception_ptr &err) {
+        handle->finish();
         if (timeoutFlagPtr->done())
             return;
         (*ecpPtr)(err);
@@ -551,6 +590,7 @@ void DbClientLockFree::execSqlWithTimeout(
             if (!conn->isWorking() &&
                 (transSet_.empty() || transSet_.find(conn) == transSet_.end()))
             {
+                handle->send(conn);
                 conn->execSql(
                     std::string_view{sql, sqlLength},
                     paraNum,
@@ -571,7 +611,7 @@ void DbClientLockFree::execSqlWithTimeout(
                         }
                     },
                     std::move(exceptionCallback));
-                timeoutFlagPtr->runTimer();
+                startTimers();
                 return;
             }
         }
@@ -584,6 +624,7 @@ void DbClientLockFree::execSqlWithTimeout(
                     (transSet_.empty() ||
                      transSet_.find(conn) == transSet_.end()))
                 {
+                    handle->send(conn);
                     conn->execSql(
                         std::string_view{sql, sqlLength},
                         paraNum,
@@ -604,7 +645,7 @@ void DbClientLockFree::execSqlWithTimeout(
                             }
                         },
                         std::move(exceptionCallback));
-                    timeoutFlagPtr->runTimer();
+                    startTimers();
                     return;
                 }
             }
@@ -620,6 +661,8 @@ void DbClientLockFree::execSqlWithTimeout(
                 if (transSet_.empty() ||
                     transSet_.find(conn) == transSet_.end())
                 {
+                    // Statements of other queries share the connection, so
+                    // this one is not cancelled on the server.
                     conn->execSql(std::string_view{sql, sqlLength},
                                   paraNum,
                                   std::move(parameters),
@@ -627,7 +670,7 @@ void DbClientLockFree::execSqlWithTimeout(
                                   std::move(format),
                                   std::move(resultCallback),
                                   std::move(exceptionCallback));
-                    timeoutFlagPtr->runTimer();
+                    startTimers();
                     return;
                 }
             }
@@ -663,7 +706,37 @@ void DbClientLockFree::execSqlWithTimeout(
             }
         },
         std::move(exceptionCallback));
+    cmdPtr->handle_ = handle;
     sqlCmdBuffer_.emplace_back(cmdPtr);
     *commandPtr = cmdPtr;
-    timeoutFlagPtr->runTimer();
+    startTimers();
+}
+
+void DbClientLockFree::execCancellableSql(
+    const char *sql,
+    size_t sqlLength,
+    size_t paraNum,
+    std::vector<const char *> &&parameters,
+    std::vector<int> &&length,
+    std::vector<int> &&format,
+    ResultCallback &&rcb,
+    std::function<void(const std::exception_ptr &)> &&exceptCallback,
+    const CancelTokenPtr &token)
+{
+    loop_->assertInLoopThread();
+    if (token->isCancelled())
+    {
+        exceptCallback(std::make_exception_ptr(
+            CancelledError("SQL execution cancelled")));
+        return;
+    }
+    execSqlWithTimeout(sql,
+                       sqlLength,
+                       paraNum,
+                       std::move(parameters),
+                       std::move(length),
+                       std::move(format),
+                       std::move(rcb),
+                       std::move(exceptCallback),
+                       token);
 }
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "BatchControl.h"
 #include "DbConnection.h"
 #include <drogon/orm/DbClient.h>
 #include <trantor/net/EventLoopThreadPool.h>
@@ -53,6 +54,16 @@ class DbClientLockFree : public DbClient,
                  ResultCallback &&rcb,
                  std::function<void(const std::exception_ptr &)>
                      &&exceptCallback) override;
+    void execCancellableSql(
+        const char *sql,
+        size_t sqlLength,
+        size_t paraNum,
+        std::vector<const char *> &&parameters,
+        std::vector<int> &&length,
+        std::vector<int> &&format,
+        ResultCallback &&rcb,
+        std::function<void(const std::exception_ptr &)> &&exceptCallback,
+        const CancelTokenPtr &token) override;
     std::shared_ptr<Transaction> newTransaction(
         const std::function<void(bool)> &commitCallback =
             std::function<void(bool)>()) noexcept(false) override;
@@ -66,6 +77,18 @@ class DbClientLockFree : public DbClient,
         timeout_ = timeout;
     }
 
+#if LIBPQ_SUPPORTS_BATCH_MODE
+    void setBatchOptions(const BatchOptions &options) override
+    {
+        batchControl_->setOptions(options);
+    }
+
+    BatchStatistics batchStatistics() const override
+    {
+        return batchControl_->statistics();
+    }
+#endif
+
     void closeAll() override;
 
   private:
@@ -95,11 +118,13 @@ class DbClientLockFree : public DbClient,
         std::vector<int> &&length,
         std::vector<int> &&format,
         ResultCallback &&rcb,
-        std::function<void(const std::exception_ptr &)> &&ecb);
+        std::function<void(const std::exception_ptr &)> &&ecb,
+        const CancelTokenPtr &token = nullptr);
     void handleNewTask(const DbConnectionPtr &conn);
 #if LIBPQ_SUPPORTS_BATCH_MODE
     size_t connectionPos_{0};  // Used for pg batch mode.
     bool autoBatch_{false};
+    BatchControlPtr batchControl_{std::make_shared<BatchControl>()};
 #endif
 };
 
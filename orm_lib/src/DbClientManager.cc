@@ -48,6 +48,7 @@ static void initFastDbClients(IOThreadStorage<orm::DbClientPtr> &storage,
                               ClientType dbType,
                               size_t connNum,
                               bool autoBatch,
+                              const orm::BatchOptions &batchOptions,
                               double timeout)
 {
     storage.init([&](orm::DbClientPtr &c, size_t idx) {
@@ -67,6 +68,10 @@ static void initFastDbClients(IOThreadStorage<orm::DbClientPtr> &storage,
         {
             c->setTimeout(timeout);
         }
+        if (autoBatch)
+        {
+            c->setBatchOptions(batchOptions);
+        }
     });
 }
 
@@ -80,6 +85,16 @@ void DbClientManager::createDbClients(
         if (std::holds_alternative<PostgresConfig>(dbInfo.config_))
         {
             auto &cfg = std::get<PostgresConfig>(dbInfo.config_);
+            orm::BatchOptions batchOptions;
+            batchOptions.maxBatchSize = cfg.maxBatchSize;
+            batchOptions.maxSqlLength = cfg.maxBatchSqlLength;
+            batchOptions.batchWindow = cfg.batchWindow;
+            if (cfg.isFast && !cfg.replicas.empty())
+            {
+                LOG_WARN << "Replicas are not supported by fast database "
+                            "clients, all queries of "
+                         << cfg.name << " are sent to the primary server";
+            }
             if (cfg.isFast)
             {
                 dbFastClientsMap_[cfg.name] =
@@ -90,17 +105,36 @@ void DbClientManager::createDbClients(
                                   ClientType::PostgreSQL,
                                   cfg.connectionNumber,
                                   cfg.autoBatch,
+                                  batchOptions,
                                   cfg.timeout);
             }
+            else if (!dbInfo.replicaConnectionInfos_.empty())
+            {
+                dbClientsMap_[cfg.name] = drogon::orm::DbClient::newPgClient(
+                    dbInfo.connectionInfo_,
+                    dbInfo.replicaConnectionInfos_,
+                    cfg.connectionNumber,
+                    cfg.autoBatch,
+                    cfg.replicaCheckInterval,
+                    cfg.maxReplicaLag);
+            }
             else
             {
                 dbClientsMap_[cfg.name] =
                     drogon::orm::DbClient::newPgClient(dbInfo.connectionInfo_,
                                                        cfg.connectionNumber,
                                                        cfg.autoBatch);
+            }
+            if (!cfg.isFast)
+            {
+                auto &client = dbClientsMap_[cfg.name];
                 if (cfg.timeout > 0.0)
                 {
-                    dbClientsMap_[cfg.name]->setTimeout(cfg.timeout);
+                    client->setTimeout(cfg.timeout);
+                }
+                if (cfg.autoBatch)
+                {
+                    client->setBatchOptions(batchOptions);
                 }
             }
         }
@@ -118,6 +152,7 @@ void DbClientManager::createDbClients(
                                   ClientType::Mysql,
                                   cfg.connectionNumber,
                                   false,
+                                  {},
                                   cfg.timeout);
             }
             else
@@ -176,28 +211,38 @@ void DbClientManager::addDbClient(const DbConfig &config)
     {
 #if USE_POSTGRESQL
         auto &cfg = std::get<PostgresConfig>(config);
-        auto connStr = buildConnStr(cfg.host,
-                                    cfg.port,
-                                    cfg.databaseName,
-                                    cfg.username,
-                                    cfg.password,
-                                    cfg.characterSet);
-        // For valid connection options, see:
-        // https://www.postgresql.org/docs/16/libpq-connect.html#LIBPQ-CONNECT-OPTIONS
-        if (!cfg.connectOptions.empty())
-        {
-            std::string optionStr = " options='";
-            for (auto const &[key, value] : cfg.connectOptions)
+        auto pgConnStr = [&cfg](const std::string &host, unsigned short port) {
+            auto connStr = buildConnStr(host,
+                                        port,
+                                        cfg.databaseName,
+                                        cfg.username,
+                                        cfg.password,
+                                        cfg.characterSet);
+            // For valid connection options, see:
+            // https://www.postgresql.org/docs/16/libpq-connect.html#LIBPQ-CONNECT-OPTIONS
+            if (!cfg.connectOptions.empty())
             {
-                optionStr += " -c ";
-                optionStr += escapeConnString(key);
-                optionStr += "=";
-                optionStr += escapeConnString(value);
+                std::string optionStr = " options='";
+                for (auto const &[key, value] : cfg.connectOptions)
+                {
+                    optionStr += " -c ";
+                    optionStr += escapeConnString(key);
+                    optionStr += "=";
+                    optionStr += escapeConnString(value);
+                }
+                optionStr += "'";
+                connStr += optionStr;
             }
-            optionStr += "'";
-            connStr += optionStr;
+            return connStr;
+        };
+        std::vector<std::string> replicaConnStrs;
+        for (auto const &replica : cfg.replicas)
+        {
+            replicaConnStrs.push_back(pgConnStr(replica.host, replica.port));
         }
-        dbInfos_.emplace_back(DbInfo{connStr, config});
+        dbInfos_.emplace_back(DbInfo{pgConnStr(cfg.host, cfg.port),
+                                     config,
+                                     std::move(replicaConnStrs)});
 #else
         std::cout << "The PostgreSQL is not supported in current drogon build, "
                      "please install the development library first."
@@ -227,7 +272,16 @@ void DbClientManager::addDbClient(const DbConfig &config)
     {
 #if USE_SQLITE3
         auto cfg = std::get<Sqlite3Config>(config);
-        std::string connStr = "filename=" + cfg.filename;
+        std::string connStr = "filename=" + escapeConnString(cfg.filename);
+        // Options are applied as PRAGMAs on every connection, see
+        // https://www.sqlite.org/pragma.html
+        for (auto const &[key, value] : cfg.connectOptions)
+        {
+            connStr += " ";
+            connStr += escapeConnString(key);
+            connStr += "=";
+            connStr += escapeConnString(value);
+        }
         dbInfos_.emplace_back(DbInfo{connStr, config});
 #else
         std::cout << "The Sqlite3 is not supported in current drogon build, "
@@ -14,6 +14,7 @@
 
 #include "DbConnection.h"
 
+#include <trantor/net/EventLoopThread.h>
 #include <regex>
 
 using namespace drogon::orm;
@@ -55,3 +56,13 @@ std::map<std::string, std::string> DbConnection::parseConnString(
     }
     return params;
 }
+
+trantor::EventLoop *DbConnection::cancelLoop()
+{
+    // Cancel requests open a connection to the server and wait for the
+    // answer, so they are sent in a thread of their own.
+    static trantor::EventLoopThread loopThread("DbCancelLoop");
+    static std::once_flag once;
+    std::call_once(once, []() { loopThread.run(); });
+    return loopThread.getLoop();
+}
@@ -19,6 +19,7 @@
 #include <string_view>
 #include <trantor/net/EventLoop.h>
 #include <trantor/utils/NonCopyable.h>
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -45,6 +46,8 @@ enum class ConnectStatus
     Bad
 };
 
+class StatementHandle;
+
 struct SqlCmd
 {
     std::string_view sql_;
@@ -55,6 +58,8 @@ struct SqlCmd
     QueryCallback callback_;
     ExceptPtrCallback exceptionCallback_;
     std::string preparingStatement_;
+    // Set if the statement can be cancelled by a timeout or a CancelToken
+    std::shared_ptr<StatementHandle> handle_;
 #if LIBPQ_SUPPORTS_BATCH_MODE
     bool isChanging_{false};
 #endif
@@ -138,7 +143,63 @@ class DbConnection : public trantor::NonCopyable
         return isWorking_;
     }
 
+    /**
+     * @brief Return true if the connection sends a statement without waiting
+     * for the results of the previous ones, and returns the results in order.
+     */
+    virtual bool supportsPipelining() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Return the id of the next statement sent to the connection. The
+     * statements get increasing ids in the order in which they are sent.
+     * @note Call it right before execSql(), while no one else can send a
+     * statement to the connection.
+     */
+    uint64_t nextStatementId() const
+    {
+        return lastStatementId_ + 1;
+    }
+
+    /**
+     * @brief Cancel the statement with the id. The statement fails when the
+     * server acknowledges the cancel, so the connection becomes idle without
+     * waiting for the statement to finish. It can be called in any thread
+     * and does nothing unless the connection is still executing that
+     * statement.
+     */
+    virtual void cancel(uint64_t /*statementId*/)
+    {
+    }
+
+    static std::map<std::string, std::string> parseConnString(
+        const std::string &);
+
   protected:
+    // The loop in which blocking cancel requests are sent
+    static trantor::EventLoop *cancelLoop();
+
+    // Called in the loop of the connection when a statement is sent and when
+    // the connection becomes idle.
+    void startStatement()
+    {
+        runningStatementId_ = ++lastStatementId_;
+    }
+
+    void finishStatement()
+    {
+        runningStatementId_ = 0;
+    }
+
+    // Return true if the statement is the last one sent to the connection
+    // and the connection is still working. It can be called in any thread.
+    bool isRunning(uint64_t statementId) const
+    {
+        return statementId != 0 && runningStatementId_ == statementId;
+    }
+
     QueryCallback callback_;
     trantor::EventLoop *loop_;
     std::function<void()> idleCb_;
@@ -147,9 +208,67 @@ class DbConnection : public trantor::NonCopyable
     DbConnectionCallback okCallback_{[](const DbConnectionPtr &) {}};
     std::function<void(const std::exception_ptr &)> exceptionCallback_;
     bool isWorking_{false};
+    std::atomic<uint64_t> lastStatementId_{0};
+    std::atomic<uint64_t> runningStatementId_{0};
+};
 
-    static std::map<std::string, std::string> parseConnString(
-        const std::string &);
+/**
+ * @brief The connection a statement is sent to, so that a timeout or a
+ * CancelToken can cancel the statement on the server.
+ */
+class StatementHandle : public trantor::NonCopyable
+{
+  public:
+    /**
+     * @brief Record the connection the statement is sent to. Return false if
+     * the statement has been cancelled and must not be sent.
+     */
+    bool send(const DbConnectionPtr &conn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancelled_)
+            return false;
+        connection_ = conn;
+        statementId_ = conn->nextStatementId();
+        return true;
+    }
+
+    /**
+     * @brief Forget the connection when the result or the error of the
+     * statement is delivered, the connection may run other statements then.
+     */
+    void finish()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection_.reset();
+        statementId_ = 0;
+    }
+
+    /**
+     * @brief Cancel the statement on its connection if it is running,
+     * otherwise prevent it from being sent.
+     */
+    void cancel()
+    {
+        DbConnectionPtr conn;
+        uint64_t statementId;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cancelled_)
+                return;
+            cancelled_ = true;
+            conn = connection_.lock();
+            statementId = statementId_;
+        }
+        if (conn)
+            conn->cancel(statementId);
+    }
+
+  private:
+    std::mutex mutex_;
+    std::weak_ptr<DbConnection> connection_;
+    uint64_t statementId_{0};
+    bool cancelled_{false};
 };
 
 }  // namespace orm
@@ -120,6 +120,11 @@ TimeoutError::TimeoutError(const std::string &whatarg) : logic_error(whatarg)
 {
 }
 
+CancelledError::CancelledError(const std::string &whatarg)
+    : logic_error(whatarg)
+{
+}
+
 UsageError::UsageError(const std::string &whatarg) : logic_error(whatarg)
 {
 }
@@ -0,0 +1,364 @@
+/**
+ *
+ *  @file ReadWriteSplitClient.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "ReadWriteSplitClient.h"
+#include "SqlTokenizer.h"
+#include <drogon/orm/Exception.h>
+#include <drogon/orm/Field.h>
+#include <algorithm>
+#include <cctype>
+
+using namespace drogon;
+using namespace drogon::orm;
+
+ReadWriteSplitClient::Reader::Reader(std::shared_ptr<DbClientImpl> client)
+    : client_(std::move(client))
+{
+    auto params = DbConnection::parseConnString(client_->connectionInfo());
+    if (params.find("filename") != params.end())
+    {
+        name_ = params["filename"];
+    }
+    else
+    {
+        name_ = params["host"] + ":" + params["port"];
+    }
+}
+
+ReadWriteSplitClient::ReadWriteSplitClient(
+    const std::string &connInfo,
+    ClientType type,
+    std::shared_ptr<DbClientImpl> writer,
+    std::vector<std::shared_ptr<DbClientImpl>> readers)
+    : writer_(std::move(writer))
+{
+    assert(writer_);
+    type_ = type;
+    connectionInfo_ = connInfo;
+    for (auto &reader : readers)
+    {
+        readers_.push_back(std::make_shared<Reader>(std::move(reader)));
+    }
+}
+
+ReadWriteSplitClient::~ReadWriteSplitClient() noexcept
+{
+    closeAll();
+}
+
+// Functions that write (sequences and advisory locks), and functions that
+// read the id or the number of the rows the connection itself changed, which
+// a reader connection knows nothing about.
+static bool isWriterOnlyFunction(const std::string &name)
+{
+    return name == "nextval" || name == "setval" ||
+           name.compare(0, 11, "pg_advisory") == 0 || name == "currval" ||
+           name == "lastval" || name == "last_insert_id" ||
+           name == "last_insert_rowid" || name == "changes" ||
+           name == "total_changes";
+}
+
+bool ReadWriteSplitClient::isReadOnlySql(std::string_view sql)
+{
+    size_t pos = 0;
+    auto skipSpaces = [&sql, &pos]() {
+        while (pos < sql.length() &&
+               std::isspace(static_cast<unsigned char>(sql[pos])))
+            ++pos;
+    };
+    skipSpaces();
+    if (sql.substr(pos, 2) == "/*")
+    {
+        auto end = sql.find("*/", pos + 2);
+        if (end != std::string_view::npos)
+        {
+            std::string hint;
+            for (auto i = pos + 2; i < end; ++i)
+            {
+                auto c = static_cast<unsigned char>(sql[i]);
+                if (!std::isspace(c))
+                    hint.push_back((char)std::tolower(c));
+            }
+            if (hint == "replica")
+                return true;
+            if (hint == "primary")
+                return false;
+            pos = end + 2;
+            skipSpaces();
+        }
+    }
+    auto tokens = tokenizeSql(sql.substr(pos));
+    size_t i = 0;
+    while (i < tokens.size() && tokens[i].isSymbol('('))
+        ++i;
+    if (i >= tokens.size() || !tokens[i].isWord("select"))
+        return false;
+    const auto topLevel = i;
+    size_t depth = i;
+    auto isWord = [&tokens](size_t index, std::string_view word) {
+        return index < tokens.size() && tokens[index].isWord(word);
+    };
+    for (++i; i < tokens.size(); ++i)
+    {
+        auto const &token = tokens[i];
+        if (token.isSymbol('('))
+        {
+            ++depth;
+            continue;
+        }
+        if (token.isSymbol(')'))
+        {
+            if (depth > 0)
+                --depth;
+            continue;
+        }
+        if (token.type_ != SqlToken::Type::Word)
+            continue;
+        // SELECT ... INTO creates a table (or sets variables in MySQL)
+        if (token.text_ == "into" && depth <= topLevel)
+            return false;
+        // FOR UPDATE, FOR NO KEY UPDATE, FOR SHARE, FOR KEY SHARE
+        if (token.text_ == "for" &&
+            (isWord(i + 1, "update") || isWord(i + 1, "share") ||
+             isWord(i + 1, "no") || isWord(i + 1, "key")))
+            return false;
+        // MySQL's LOCK IN SHARE MODE
+        if (token.text_ == "lock" && isWord(i + 1, "in"))
+            return false;
+        if (i + 1 < tokens.size() && tokens[i + 1].isSymbol('(') &&
+            isWriterOnlyFunction(token.text_))
+            return false;
+    }
+    return true;
+}
+
+ReadWriteSplitClient::ReaderPtr ReadWriteSplitClient::pickReader() const
+{
+    ReaderPtr best;
+    size_t bestOutstanding = 0;
+    for (auto const &reader : readers_)
+    {
+        if (!reader->healthy_)
+            continue;
+        auto outstanding = reader->outstanding_.load();
+        if (!best || outstanding < bestOutstanding)
+        {
+            best = reader;
+            bestOutstanding = outstanding;
+        }
+    }
+    return best;
+}
+
+void ReadWriteSplitClient::execSql(
+    const char *sql,
+    size_t sqlLength,
+    size_t paraNum,
+    std::vector<const char *> &&parameters,
+    std::vector<int> &&length,
+    std::vector<int> &&format,
+    ResultCallback &&rcb,
+    std::function<void(const std::exception_ptr &)> &&exceptCallback)
+{
+    ReaderPtr reader;
+    if (!readers_.empty() && isReadOnlySql(std::string_view{sql, sqlLength}))
+    {
+        reader = pickReader();
+    }
+    if (!reader)
+    {
+        writer_->execSql(sql,
+                         sqlLength,
+                         paraNum,
+                         std::move(parameters),
+                         std::move(length),
+                         std::move(format),
+                         std::move(rcb),
+                         std::move(exceptCallback));
+        return;
+    }
+    if (readers_.size() == 1)
+    {
+        // Nothing to balance
+        reader->client_->execSql(sql,
+                                 sqlLength,
+                                 paraNum,
+                                 std::move(parameters),
+                                 std::move(length),
+                                 std::move(format),
+                                 std::move(rcb),
+                                 std::move(exceptCallback));
+        return;
+    }
+    ++reader->outstanding_;
+    reader->client_->execSql(
+        sql,
+        sqlLength,
+        paraNum,
+        std::move(parameters),
+        std::move(length),
+        std::move(format),
+        [reader, rcb = std::move(rcb)](const Result &result) {
+            --reader->outstanding_;
+            rcb(result);
+        },
+        [reader, exceptCallback = std::move(exceptCallback)](
+            const std::exception_ptr &exception) {
+            --reader->outstanding_;
+            exceptCallback(exception);
+        });
+}
+
+std::shared_ptr<Transaction> ReadWriteSplitClient::newTransaction(
+    const std::function<void(bool)> &commitCallback) noexcept(false)
+{
+    return writer_->newTransaction(commitCallback);
+}
+
+void ReadWriteSplitClient::newTransactionAsync(
+    const std::function<void(const std::shared_ptr<Transaction> &)> &callback)
+{
+    writer_->newTransactionAsync(callback);
+}
+
+bool ReadWriteSplitClient::hasAvailableConnections() const noexcept
+{
+    if (!writer_->hasAvailableConnections())
+        return false;
+    return readers_.empty() ||
+           std::any_of(readers_.begin(),
+                       readers_.end(),
+                       [](const ReaderPtr &reader) {
+                           return reader->client_->hasAvailableConnections();
+                       });
+}
+
+void ReadWriteSplitClient::setTimeout(double timeout)
+{
+    writer_->setTimeout(timeout);
+    for (auto const &reader : readers_)
+    {
+        reader->client_->setTimeout(timeout);
+    }
+}
+
+void ReadWriteSplitClient::setBatchOptions(const BatchOptions &options)
+{
+    writer_->setBatchOptions(options);
+    for (auto const &reader : readers_)
+    {
+        reader->client_->setBatchOptions(options);
+    }
+}
+
+BatchStatistics ReadWriteSplitClient::batchStatistics() const
+{
+    auto stats = writer_->batchStatistics();
+    for (auto const &reader : readers_)
+    {
+        auto readerStats = reader->client_->batchStatistics();
+        stats.batches += readerStats.batches;
+        stats.queries += readerStats.queries;
+        stats.maxBatchSize =
+            std::max(stats.maxBatchSize, readerStats.maxBatchSize);
+        for (size_t i = 0; i < stats.sizeHistogram.size(); ++i)
+        {
+            stats.sizeHistogram[i] += readerStats.sizeHistogram[i];
+        }
+    }
+    return stats;
+}
+
+void ReadWriteSplitClient::closeAll()
+{
+    checkLoopThread_.reset();
+    writer_->closeAll();
+    for (auto const &reader : readers_)
+    {
+        reader->client_->closeAll();
+    }
+}
+
+void ReadWriteSplitClient::enableHealthCheck(double interval, double maxLag)
+{
+    if (interval <= 0.0 || readers_.empty() || checkLoopThread_)
+        return;
+    checkLoopThread_ = std::make_unique<trantor::EventLoopThread>("DbCheck");
+    checkLoopThread_->run();
+    // The timer must not keep the client alive, it only holds the readers.
+    checkLoopThread_->getLoop()->runEvery(
+        interval, [readers = readers_, type = type_, maxLag]() {
+            for (auto const &reader : readers)
+            {
+                checkReader(reader, type, maxLag);
+            }
+        });
+}
+
+void ReadWriteSplitClient::checkReader(const ReaderPtr &reader,
+                                       ClientType type,
+                                       double maxLag)
+{
+    if (reader->checking_.exchange(true))
+    {
+        // The previous check hasn't been answered yet
+        if (reader->healthy_.exchange(false))
+        {
+            LOG_WARN << "Database replica doesn't respond: " << reader->name_;
+        }
+        return;
+    }
+    if (!reader->client_->hasAvailableConnections())
+    {
+        reader->healthy_ = false;
+        reader->checking_ = false;
+        return;
+    }
+    // Replay lag of a PostgreSQL standby: 0 if it isn't a standby, or if it
+    // is connected to the primary and has replayed everything it received
+    // (the primary may be idle, so the time of the last replayed
+    // transaction tells nothing), else the age of the last replayed
+    // transaction, which grows while the replay or the replication is
+    // stalled.
+    static const std::string pgLagSql =
+        "select case when not pg_is_in_recovery() then 0 "
+        "when pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() and "
+        "exists (select 1 from pg_stat_wal_receiver) then 0 "
+        "else coalesce(extract(epoch from now() - "
+        "pg_last_xact_replay_timestamp()), 0) end";
+    reader->client_->execSqlAsync(
+        type == ClientType::PostgreSQL ? pgLagSql : std::string("select 1"),
+        [reader, type, maxLag](const Result &r) {
+            bool healthy = true;
+            if (type == ClientType::PostgreSQL && maxLag > 0.0 &&
+                r.size() == 1 && !r[0][0].isNull())
+            {
+                auto lag = r[0][0].as<double>();
+                if (lag > maxLag)
+                {
+                    LOG_WARN << "Database replica " << reader->name_
+                             << " lags " << lag << "s behind";
+                    healthy = false;
+                }
+            }
+            reader->healthy_ = healthy;
+            reader->checking_ = false;
+        },
+        [reader](const DrogonDbException &e) {
+            LOG_WARN << "Database replica " << reader->name_
+                     << " check failed: " << e.base().what();
+            reader->healthy_ = false;
+            reader->checking_ = false;
+        });
+}
@@ -0,0 +1,118 @@
+/**
+ *
+ *  @file ReadWriteSplitClient.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include "DbClientImpl.h"
+#include <drogon/orm/DbClient.h>
+#include <trantor/net/EventLoopThread.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+/**
+ * @brief A database client that sends read-only statements to reader pools
+ * and everything else (writes, transactions) to a writer pool.
+ *
+ * It is used by Sqlite3 clients in WAL mode, where one writer connection and
+ * several read-only connections can work on the database file concurrently,
+ * and by PostgreSQL clients with streaming replicas, where every replica has
+ * its own pool. A read-only statement goes to the healthy reader with the
+ * fewest outstanding queries, or to the writer if no reader is healthy.
+ */
+class ReadWriteSplitClient : public DbClient
+{
+  public:
+    ReadWriteSplitClient(const std::string &connInfo,
+                         ClientType type,
+                         std::shared_ptr<DbClientImpl> writer,
+                         std::vector<std::shared_ptr<DbClientImpl>> readers);
+    ~ReadWriteSplitClient() noexcept override;
+    void execSql(const char *sql,
+                 size_t sqlLength,
+                 size_t paraNum,
+                 std::vector<const char *> &&parameters,
+                 std::vector<int> &&length,
+                 std::vector<int> &&format,
+                 ResultCallback &&rcb,
+                 std::function<void(const std::exception_ptr &)>
+                     &&exceptCallback) override;
+    std::shared_ptr<Transaction> newTransaction(
+        const std::function<void(bool)> &commitCallback =
+            std::function<void(bool)>()) noexcept(false) override;
+    void newTransactionAsync(
+        const std::function<void(const std::shared_ptr<Transaction> &)>
+            &callback) override;
+    bool hasAvailableConnections() const noexcept override;
+    void setTimeout(double timeout) override;
+    void setBatchOptions(const BatchOptions &options) override;
+    BatchStatistics batchStatistics() const override;
+    void closeAll() override;
+
+    /**
+     * @brief Check the readers every @p interval seconds. A reader that
+     * fails the check, doesn't answer before the next one, or (on PostgreSQL)
+     * replays the primary's WAL more than @p maxLag seconds late doesn't
+     * receive queries until it passes a check again.
+     */
+    void enableHealthCheck(double interval, double maxLag);
+
+    /**
+     * @brief Return true if the statement only reads data and may be executed
+     * by a reader.
+     *
+     * SELECT statements are considered read-only unless they lock rows
+     * (FOR UPDATE, FOR SHARE, ...), create a table (SELECT ... INTO) or call
+     * sequence or advisory lock functions. Key words are only looked for
+     * outside of string literals, quoted names and comments. A leading block
+     * comment that only contains the word "replica"
+     * or "primary" overrides the guess and sends the statement to a reader or
+     * to the writer respectively.
+     */
+    static bool isReadOnlySql(std::string_view sql);
+
+  private:
+    struct Reader
+    {
+        explicit Reader(std::shared_ptr<DbClientImpl> client);
+
+        std::shared_ptr<DbClientImpl> client_;
+        // host:port or file name, used in logs instead of the connection
+        // string that may contain a password
+        std::string name_;
+        std::atomic<size_t> outstanding_{0};
+        std::atomic<bool> healthy_{true};
+        std::atomic<bool> checking_{false};
+    };
+
+    using ReaderPtr = std::shared_ptr<Reader>;
+
+    ReaderPtr pickReader() const;
+    static void checkReader(const ReaderPtr &reader,
+                            ClientType type,
+                            double maxLag);
+
+    std::shared_ptr<DbClientImpl> writer_;
+    std::vector<ReaderPtr> readers_;
+    std::unique_ptr<trantor::EventLoopThread> checkLoopThread_;
+};
+
+}  // namespace orm
+}  // namespace drogon
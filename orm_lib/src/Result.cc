@@ -165,6 +165,20 @@ Result::FieldSizeType Result::getLength(Result::SizeType row,
     return resultPtr_->getLength(row, column);
 }
 
+bool Result::getInt64(Result::SizeType row,
+                      Result::RowSizeType column,
+                      int64_t &value) const
+{
+    return resultPtr_->getInt64(row, column, value);
+}
+
+bool Result::getDouble(Result::SizeType row,
+                       Result::RowSizeType column,
+                       double &value) const
+{
+    return resultPtr_->getDouble(row, column, value);
+}
+
 unsigned long long Result::insertId() const noexcept
 {
     return resultPtr_->insertId();
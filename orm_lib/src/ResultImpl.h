@@ -37,6 +37,31 @@ class ResultImpl : public trantor::NonCopyable
     virtual bool isNull(SizeType row, RowSizeType column) const = 0;
     virtual FieldSizeType getLength(SizeType row, RowSizeType column) const = 0;
 
+    /**
+     * @brief Drivers that keep numeric values unboxed override these to let
+     * Field::as<T>() skip parsing the text representation. They return false
+     * when the value isn't stored natively.
+     */
+    virtual bool getInt64(SizeType row,
+                          RowSizeType column,
+                          int64_t &value) const
+    {
+        (void)row;
+        (void)column;
+        (void)value;
+        return false;
+    }
+
+    virtual bool getDouble(SizeType row,
+                           RowSizeType column,
+                           double &value) const
+    {
+        (void)row;
+        (void)column;
+        (void)value;
+        return false;
+    }
+
     virtual unsigned long long insertId() const noexcept
     {
         return 0;
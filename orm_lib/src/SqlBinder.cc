@@ -31,18 +31,11 @@ void SqlBinder::exec()
     if (mode_ == Mode::NonBlocking)
     {
         // nonblocking mode,default mode
-        // Retain shared_ptrs of parameters until we get the result;
-        client_.execSql(
-            sqlViewPtr_,
-            sqlViewLength_,
-            parametersNumber_,
-            std::move(parameters_),
-            std::move(lengths_),
-            std::move(formats_),
+        // Retain the SQL and the parameters until we get the result;
+        execSql(
             [holder = std::move(callbackHolder_),
-             objs = std::move(objs_),
-             sqlptr = std::move(sqlPtr_)](const Result &r) mutable {
-                objs.clear();
+             buffer = std::move(buffer_)](const Result &r) mutable {
+                buffer.reset();
                 if (holder)
                 {
                     holder->execCallback(r);
@@ -80,13 +73,7 @@ void SqlBinder::exec()
         std::shared_ptr<std::promise<Result>> pro(new std::promise<Result>);
         auto f = pro->get_future();
 
-        client_.execSql(
-            sqlViewPtr_,
-            sqlViewLength_,
-            parametersNumber_,
-            std::move(parameters_),
-            std::move(lengths_),
-            std::move(formats_),
+        execSql(
             [pro](const Result &r) { pro->set_value(r); },
             [pro](const std::exception_ptr &exception) {
                 try
@@ -134,116 +121,91 @@ SqlBinder::~SqlBinder()
     }
 }
 
-SqlBinder &SqlBinder::operator<<(const std::string_view &str)
+void SqlBinder::execSql(QueryCallback &&rcb, ExceptPtrCallback &&exceptCallback)
 {
-    auto obj = std::make_shared<std::string>(str.data(), str.length());
-    parameters_.push_back(obj->data());
-    lengths_.push_back(static_cast<int>(obj->length()));
-    objs_.push_back(obj);
-    ++parametersNumber_;
-    if (type_ == ClientType::PostgreSQL)
+    if (cancelToken_)
     {
-        formats_.push_back(0);
+        client_.execCancellableSql(sqlViewPtr_,
+                                   sqlViewLength_,
+                                   parametersNumber_,
+                                   std::move(parameters_),
+                                   std::move(lengths_),
+                                   std::move(formats_),
+                                   std::move(rcb),
+                                   std::move(exceptCallback),
+                                   cancelToken_);
+        return;
     }
-    else if (type_ == ClientType::Mysql)
+    client_.execSql(sqlViewPtr_,
+                    sqlViewLength_,
+                    parametersNumber_,
+                    std::move(parameters_),
+                    std::move(lengths_),
+                    std::move(formats_),
+                    std::move(rcb),
+                    std::move(exceptCallback));
+}
+
+static int textFormat(ClientType type)
+{
+    switch (type)
     {
-        formats_.push_back(MySqlString);
+        case ClientType::PostgreSQL:
+            return 0;
+        case ClientType::Mysql:
+            return MySqlString;
+        case ClientType::Sqlite3:
+            return Sqlite3TypeText;
     }
-    else if (type_ == ClientType::Sqlite3)
+    return 0;
+}
+
+static int binaryFormat(ClientType type)
+{
+    switch (type)
     {
-        formats_.push_back(Sqlite3TypeText);
+        case ClientType::PostgreSQL:
+            return 1;
+        case ClientType::Mysql:
+            return MySqlString;
+        case ClientType::Sqlite3:
+            return Sqlite3TypeBlob;
     }
-    return *this;
+    return 0;
+}
+
+SqlBinder &SqlBinder::operator<<(const std::string_view &str)
+{
+    return operator<<(std::string(str.data(), str.length()));
 }
 
 SqlBinder &SqlBinder::operator<<(const std::string &str)
 {
-    auto obj = std::make_shared<std::string>(str);
-    objs_.push_back(obj);
-    ++parametersNumber_;
-    parameters_.push_back(obj->data());
-    lengths_.push_back(static_cast<int>(obj->length()));
-    if (type_ == ClientType::PostgreSQL)
-    {
-        formats_.push_back(0);
-    }
-    else if (type_ == ClientType::Mysql)
-    {
-        formats_.push_back(MySqlString);
-    }
-    else if (type_ == ClientType::Sqlite3)
-    {
-        formats_.push_back(Sqlite3TypeText);
-    }
-    return *this;
+    return operator<<(std::string(str));
 }
 
 SqlBinder &SqlBinder::operator<<(std::string &&str)
 {
-    std::shared_ptr<std::string> obj =
-        std::make_shared<std::string>(std::move(str));
-    objs_.push_back(obj);
-    ++parametersNumber_;
-    parameters_.push_back((char *)obj->c_str());
-    lengths_.push_back(static_cast<int>(obj->length()));
-    if (type_ == ClientType::PostgreSQL)
-    {
-        formats_.push_back(0);
-    }
-    else if (type_ == ClientType::Mysql)
-    {
-        formats_.push_back(MySqlString);
-    }
-    else if (type_ == ClientType::Sqlite3)
-    {
-        formats_.push_back(Sqlite3TypeText);
-    }
+    auto obj = buffer().store(std::move(str));
+    addParameter(obj->c_str(), obj->length(), textFormat(type_));
     return *this;
 }
 
-SqlBinder &SqlBinder::operator<<(const std::vector<char> &v)
+SqlBinder &SqlBinder::operator<<(const StringRef &str)
 {
-    std::shared_ptr<std::vector<char>> obj =
-        std::make_shared<std::vector<char>>(v);
-    objs_.push_back(obj);
-    ++parametersNumber_;
-    parameters_.push_back((char *)obj->data());
-    lengths_.push_back(static_cast<int>(obj->size()));
-    if (type_ == ClientType::PostgreSQL)
-    {
-        formats_.push_back(1);
-    }
-    else if (type_ == ClientType::Mysql)
-    {
-        formats_.push_back(MySqlString);
-    }
-    else if (type_ == ClientType::Sqlite3)
-    {
-        formats_.push_back(Sqlite3TypeBlob);
-    }
+    addParameter(str.data(), str.length(), textFormat(type_));
     return *this;
 }
 
+SqlBinder &SqlBinder::operator<<(const std::vector<char> &v)
+{
+    return operator<<(std::vector<char>(v));
+}
+
 SqlBinder &SqlBinder::operator<<(std::vector<char> &&v)
 {
-    std::shared_ptr<std::vector<char>> obj =
-        std::make_shared<std::vector<char>>(std::move(v));
-    objs_.push_back(obj);
-    ++parametersNumber_;
-    parameters_.push_back((char *)obj->data());
-    lengths_.push_back(static_cast<int>(obj->size()));
-    if (type_ == ClientType::PostgreSQL)
-    {
-        formats_.push_back(1);
-    }
-    else if (type_ == ClientType::Mysql)
-    {
-        formats_.push_back(MySqlString);
-    }
-    else if (type_ == ClientType::Sqlite3)
-    {
-        formats_.push_back(Sqlite3TypeBlob);
-    }
+    auto obj = buffer().store(std::move(v));
+    addParameter(obj->data(), obj->size(), binaryFormat(type_));
     return *this;
 }
 
@@ -251,12 +213,7 @@ SqlBinder &SqlBinder::operator<<(double f)
 {
     if (type_ == ClientType::Sqlite3)
     {
-        ++parametersNumber_;
-        auto obj = std::make_shared<double>(f);
-        objs_.push_back(obj);
-        formats_.push_back(Sqlite3TypeDouble);
-        lengths_.push_back(0);
-        parameters_.push_back((char *)(obj.get()));
+        addParameter(buffer().store(f), 0, Sqlite3TypeDouble);
         return *this;
     }
     return operator<<(std::to_string(f));
@@ -264,20 +221,17 @@ SqlBinder &SqlBinder::operator<<(double f)
 
 SqlBinder &SqlBinder::operator<<(std::nullptr_t)
 {
-    ++parametersNumber_;
-    parameters_.push_back(nullptr);
-    lengths_.push_back(0);
     if (type_ == ClientType::PostgreSQL)
     {
-        formats_.push_back(0);
+        addParameter(nullptr, 0, 0);
     }
     else if (type_ == ClientType::Mysql)
     {
-        formats_.push_back(MySqlNull);
+        addParameter(nullptr, 0, MySqlNull);
     }
     else if (type_ == ClientType::Sqlite3)
     {
-        formats_.push_back(Sqlite3TypeNull);
+        addParameter(nullptr, 0, Sqlite3TypeNull);
     }
     return *this;
 }
@@ -288,34 +242,30 @@ SqlBinder &SqlBinder::operator<<(DefaultValue dv)
     if (type_ == ClientType::PostgreSQL)
     {
         std::regex r("\\$" + std::to_string(parametersNumber_ + 1) + "\\b");
-        // initialize with empty, as the next line will make a copy anyway
-        if (!sqlPtr_)
-            sqlPtr_ = std::make_shared<std::string>();
-
-        *sqlPtr_ = std::regex_replace(sqlViewPtr_, r, "default");
+        auto &sql = buffer().sql();
+        sql = std::regex_replace(std::string(sqlViewPtr_, sqlViewLength_),
+                                 r,
+                                 "default");
 
         // decrement all other $n parameters by 1
         size_t i = parametersNumber_ + 2;
-        while ((sqlPtr_->find("$" + std::to_string(i))) != std::string::npos)
+        while ((sql.find("$" + std::to_string(i))) != std::string::npos)
         {
             r = "\\$" + std::to_string(i) + "\\b";
             // use sed format to avoid $n regex group substitution,
             // and use ->data() to compile in C++14 mode
-            *sqlPtr_ = std::regex_replace(sqlPtr_->data(),
-                                          r,
-                                          "$" + std::to_string(i - 1),
-                                          std::regex_constants::format_sed);
+            sql = std::regex_replace(sql.data(),
+                                     r,
+                                     "$" + std::to_string(i - 1),
+                                     std::regex_constants::format_sed);
             ++i;
         }
-        sqlViewPtr_ = sqlPtr_->data();
-        sqlViewLength_ = sqlPtr_->length();
+        sqlViewPtr_ = sql.data();
+        sqlViewLength_ = sql.length();
     }
     else if (type_ == ClientType::Mysql)
     {
-        ++parametersNumber_;
-        parameters_.push_back(nullptr);
-        lengths_.push_back(0);
-        formats_.push_back(DrogonDefaultValue);
+        addParameter(nullptr, 0, DrogonDefaultValue);
     }
     else if (type_ == ClientType::Sqlite3)
     {
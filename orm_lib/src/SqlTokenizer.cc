@@ -0,0 +1,208 @@
+/**
+ *
+ *  @file SqlTokenizer.cc
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#include "SqlTokenizer.h"
+#include <algorithm>
+#include <cctype>
+
+using namespace drogon::orm;
+
+namespace
+{
+bool isNameStart(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_' ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool isNameChar(char c)
+{
+    return isNameStart(c) || std::isdigit(static_cast<unsigned char>(c)) ||
+           c == '$';
+}
+
+// Return the position after the quoted text starting at pos, a doubled
+// quote is a quote inside the text.
+size_t skipQuoted(std::string_view sql, size_t pos, bool backslashEscapes)
+{
+    const auto quote = sql[pos];
+    ++pos;
+    while (pos < sql.size())
+    {
+        if (backslashEscapes && sql[pos] == '\\')
+        {
+            pos += 2;
+            continue;
+        }
+        if (sql[pos] == quote)
+        {
+            if (pos + 1 < sql.size() && sql[pos + 1] == quote)
+            {
+                pos += 2;
+                continue;
+            }
+            return pos + 1;
+        }
+        ++pos;
+    }
+    return sql.size();
+}
+
+// Return the position after the $tag$...$tag$ string starting at pos, or
+// pos if there is no dollar quote at pos.
+size_t skipDollarQuoted(std::string_view sql, size_t pos)
+{
+    auto end = pos + 1;
+    while (end < sql.size() && sql[end] != '$')
+    {
+        auto c = static_cast<unsigned char>(sql[end]);
+        if (!isNameStart(sql[end]) && !(end > pos + 1 && std::isdigit(c)))
+            return pos;
+        ++end;
+    }
+    if (end >= sql.size())
+        return pos;
+    auto tag = sql.substr(pos, end - pos + 1);
+    auto close = sql.find(tag, end + 1);
+    return close == std::string_view::npos ? sql.size() : close + tag.size();
+}
+}  // namespace
+
+std::vector<SqlToken> drogon::orm::tokenizeSql(std::string_view sql)
+{
+    std::vector<SqlToken> tokens;
+    const auto n = sql.size();
+    size_t i = 0;
+    while (i < n)
+    {
+        auto c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            ++i;
+        }
+        else if (c == '-' && i + 1 < n && sql[i + 1] == '-')
+        {
+            auto end = sql.find('\n', i);
+            i = end == std::string_view::npos ? n : end + 1;
+        }
+        else if (c == '/' && i + 1 < n && sql[i + 1] == '*')
+        {
+            // Block comments nest in PostgreSQL
+            size_t depth = 0;
+            while (i < n)
+            {
+                if (sql.compare(i, 2, "/*") == 0)
+                {
+                    ++depth;
+                    i += 2;
+                }
+                else if (sql.compare(i, 2, "*/") == 0)
+                {
+                    i += 2;
+                    if (--depth == 0)
+                        break;
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+        else if (c == '\'')
+        {
+            i = skipQuoted(sql, i, false);
+            tokens.push_back({SqlToken::Type::Literal, {}});
+        }
+        else if ((c == 'e' || c == 'E') && i + 1 < n && sql[i + 1] == '\'')
+        {
+            // A string with C-style escapes
+            i = skipQuoted(sql, i + 1, true);
+            tokens.push_back({SqlToken::Type::Literal, {}});
+        }
+        else if (c == '$')
+        {
+            auto end = skipDollarQuoted(sql, i);
+            if (end == i)
+            {
+                // A $1 placeholder
+                ++end;
+                while (end < n &&
+                       std::isdigit(static_cast<unsigned char>(sql[end])))
+                    ++end;
+            }
+            i = end;
+            tokens.push_back({SqlToken::Type::Literal, {}});
+        }
+        else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                 (c == '.' && i + 1 < n &&
+                  std::isdigit(static_cast<unsigned char>(sql[i + 1]))))
+        {
+            while (i < n && (isNameChar(sql[i]) || sql[i] == '.'))
+                ++i;
+            tokens.push_back({SqlToken::Type::Literal, {}});
+        }
+        else if (isNameStart(c) || c == '"' || c == '`')
+        {
+            SqlToken token;
+            while (i < n)
+            {
+                if (sql[i] == '"' || sql[i] == '`')
+                {
+                    const auto quote = sql[i];
+                    auto end = skipQuoted(sql, i, false);
+                    token = {SqlToken::Type::QuotedName, {}};
+                    for (auto j = i + 1; j < end; ++j)
+                    {
+                        if (sql[j] == quote)
+                            ++j;  // The closing or a doubled quote
+                        if (j < end)
+                            token.text_.push_back(sql[j]);
+                    }
+                    i = end;
+                }
+                else
+                {
+                    auto start = i;
+                    while (i < n && isNameChar(sql[i]))
+                        ++i;
+                    token = {SqlToken::Type::Word,
+                             std::string(sql.substr(start, i - start))};
+                    std::transform(token.text_.begin(),
+                                   token.text_.end(),
+                                   token.text_.begin(),
+                                   [](unsigned char ch) {
+                                       return static_cast<char>(
+                                           std::tolower(ch));
+                                   });
+                }
+                // Keep the last part of a qualified name
+                if (i + 1 < n && sql[i] == '.' &&
+                    (isNameStart(sql[i + 1]) || sql[i + 1] == '"' ||
+                     sql[i + 1] == '`'))
+                {
+                    ++i;
+                    continue;
+                }
+                break;
+            }
+            tokens.push_back(std::move(token));
+        }
+        else
+        {
+            tokens.push_back({SqlToken::Type::Symbol, std::string(1, c)});
+            ++i;
+        }
+    }
+    return tokens;
+}
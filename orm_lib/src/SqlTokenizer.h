@@ -0,0 +1,67 @@
+/**
+ *
+ *  @file SqlTokenizer.h
+ *  @author An Tao
+ *
+ *  Copyright 2018, An Tao.  All rights reserved.
+ *  https://github.com/an-tao/drogon
+ *  Use of this source code is governed by a MIT license
+ *  that can be found in the License file.
+ *
+ *  Drogon
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace drogon
+{
+namespace orm
+{
+struct SqlToken
+{
+    enum class Type
+    {
+        // A key word or an unquoted name, in lower case
+        Word,
+        // A "quoted" or `quoted` name, as written
+        QuotedName,
+        // A string, a number or a $1 placeholder, without its text
+        Literal,
+        // Any other character
+        Symbol
+    };
+
+    Type type_;
+    std::string text_;
+
+    bool isWord(std::string_view word) const
+    {
+        return type_ == Type::Word && text_ == word;
+    }
+
+    bool isSymbol(char c) const
+    {
+        return type_ == Type::Symbol && text_.size() == 1 && text_[0] == c;
+    }
+
+    bool isName() const
+    {
+        return type_ == Type::Word || type_ == Type::QuotedName;
+    }
+};
+
+/**
+ * @brief Split a statement into tokens. Comments are skipped, and string
+ * literals (including E'...' and $tag$...$tag$ strings) and quoted names
+ * never produce words, so their content can't be mistaken for key words.
+ * A qualified name (schema.table) becomes one token with the last part only.
+ */
+std::vector<SqlToken> tokenizeSql(std::string_view sql);
+
+}  // namespace orm
+}  // namespace drogon
@@ -26,6 +26,7 @@ TransactionImpl::TransactionImpl(ClientType type,
                                  std::function<void()> usedUpCallback)
     : connectionPtr_(connPtr),
       usedUpCallback_(std::move(usedUpCallback)),
+      pipelined_(connPtr->supportsPipelining()),
       loop_(connPtr->loop()),
       commitCallback_(std::move(commitCallback))
 {
@@ -95,7 +96,7 @@ void TransactionImpl::execSqlInLoop(
     std::function<void(const std::exception_ptr &)> &&exceptCallback)
 {
     loop_->assertInLoopThread();
-    if (!isCommitedOrRolledback_)
+    if (!isCommitedOrRolledback_ && !rollbackSent_)
     {
         if (timeout_ > 0.0)
         {
@@ -109,7 +110,23 @@ void TransactionImpl::execSqlInLoop(
             return;
         }
         auto thisPtr = shared_from_this();
-        if (!isWorking_)
+        if (pipelined_)
+        {
+            // The callbacks keep the transaction alive, so it is committed
+            // after the results of all its statements arrive.
+            connectionPtr_->execSql(
+                std::move(sql),
+                paraNum,
+                std::move(parameters),
+                std::move(length),
+                std::move(format),
+                std::move(rcb),
+                [exceptCallback = std::move(exceptCallback),
+                 thisPtr](const std::exception_ptr &ePtr) {
+                    thisPtr->handlePipelinedError(ePtr, exceptCallback);
+                });
+        }
+        else if (!isWorking_)
         {
             isWorking_ = true;
             thisPtr_ = thisPtr;
@@ -155,8 +172,29 @@ void TransactionImpl::rollback()
     auto thisPtr = shared_from_this();
 
     loop_->runInLoop([thisPtr]() {
-        if (thisPtr->isCommitedOrRolledback_)
+        if (thisPtr->isCommitedOrRolledback_ || thisPtr->rollbackSent_)
             return;
+        if (thisPtr->pipelined_)
+        {
+            // Sent after the statements already in the pipeline, the
+            // connection is returned once it is idle again.
+            thisPtr->rollbackSent_ = true;
+            thisPtr->connectionPtr_->execSql(
+                "rollback",
+                0,
+                {},
+                {},
+                {},
+                [thisPtr](const Result &) {
+                    LOG_TRACE << "Transaction roll back!";
+                    thisPtr->isCommitedOrRolledback_ = true;
+                },
+                [thisPtr](const std::exception_ptr &) {
+                    LOG_ERROR << "Transaction roll back error";
+                    thisPtr->isCommitedOrRolledback_ = true;
+                });
+            return;
+        }
         if (thisPtr->isWorking_)
         {
             // push sql cmd to buffer;
@@ -202,6 +240,17 @@ void TransactionImpl::rollback()
 void TransactionImpl::execNewTask()
 {
     loop_->assertInLoopThread();
+    if (pipelined_)
+    {
+        // Nothing is buffered, the connection is idle after a rollback or
+        // between statements.
+        if (isCommitedOrRolledback_ && usedUpCallback_)
+        {
+            usedUpCallback_();
+            usedUpCallback_ = std::function<void()>();
+        }
+        return;
+    }
     thisPtr_.reset();
     assert(isWorking_);
     if (!isCommitedOrRolledback_)
@@ -212,6 +261,8 @@ void TransactionImpl::execNewTask()
             auto cmd = std::move(sqlCmdBuffer_.front());
             sqlCmdBuffer_.pop_front();
             auto conn = connectionPtr_;
+            if (cmd->handle_)
+                cmd->handle_->send(conn);
             conn->execSql(
                 std::move(cmd->sql_),
                 cmd->parametersNumber_,
@@ -265,6 +316,26 @@ void TransactionImpl::execNewTask()
     }
 }
 
+void TransactionImpl::handlePipelinedError(
+    const std::exception_ptr &ePtr,
+    const ExceptPtrCallback &exceptCallback)
+{
+    if (rollbackSent_)
+    {
+        // The statement was sent before the rollback, the server rejects it
+        // because of an earlier error in the transaction.
+        if (exceptCallback)
+        {
+            exceptCallback(std::make_exception_ptr(
+                TransactionRollback("The transaction has been rolled back")));
+        }
+        return;
+    }
+    rollback();
+    if (exceptCallback)
+        exceptCallback(ePtr);
+}
+
 void TransactionImpl::doBegin()
 {
     loop_->queueInLoop([thisPtr = shared_from_this()]() {
@@ -277,8 +348,11 @@ void TransactionImpl::doBegin()
         });
         assert(!thisPtr->isWorking_);
         assert(!thisPtr->isCommitedOrRolledback_);
-        thisPtr->isWorking_ = true;
-        thisPtr->thisPtr_ = thisPtr;
+        if (!thisPtr->pipelined_)
+        {
+            thisPtr->isWorking_ = true;
+            thisPtr->thisPtr_ = thisPtr;
+        }
         thisPtr->connectionPtr_->execSql(
             "begin",
             0,
@@ -305,13 +379,14 @@ void TransactionImpl::execSqlInLoopWithTimeout(
     auto thisPtr = shared_from_this();
     std::weak_ptr<TransactionImpl> weakPtr = thisPtr;
     auto commandPtr = std::make_shared<std::weak_ptr<SqlCmd>>();
+    auto handle = std::make_shared<StatementHandle>();
     auto ecpPtr =
         std::make_shared<std::function<void(const std::exception_ptr &)>>(
             std::move(ecb));
     auto timeoutFlagPtr = std::make_shared<drogon::TaskTimeoutFlag>(
         loop_,
         std::chrono::duration<double>(timeout_),
-        [commandPtr, weakPtr, ecpPtr]() {
+        [commandPtr, weakPtr, ecpPtr, handle]() {
             auto thisPtr = weakPtr.lock();
             if (!thisPtr)
                 return;
@@ -329,6 +404,9 @@ void TransactionImpl::execSqlInLoopWithTimeout(
                     }
                 }
             }
+            // If the statement is running, cancel it so that the rollback
+            // doesn't wait for it to finish.
+            handle->cancel();
             thisPtr->rollback();
             if (*ecpPtr)
             {
@@ -336,24 +414,46 @@ void TransactionImpl::execSqlInLoopWithTimeout(
                     TimeoutError("SQL execution timeout")));
             }
         });
-    auto resultCallback = [rcb = std::move(rcb),
-                           timeoutFlagPtr](const drogon::orm::Result &result) {
+    auto resultCallback = [rcb = std::move(rcb), timeoutFlagPtr, handle](
+                              const drogon::orm::Result &result) {
+        handle->finish();
         if (timeoutFlagPtr->done())
             return;
         rcb(result);
     };
-    if (!isWorking_)
+    if (pipelined_)
+    {
+        handle->send(connectionPtr_);
+        connectionPtr_->execSql(std::move(sql),
+                                paraNum,
+                                std::move(parameters),
+                                std::move(length),
+                                std::move(format),
+                                std::move(resultCallback),
+                                [ecpPtr, timeoutFlagPtr, thisPtr, handle](
+                                    const std::exception_ptr &ePtr) {
+                                    handle->finish();
+                                    // Rolled back by the timeout
+                                    if (timeoutFlagPtr->done())
+                                        return;
+                                    thisPtr->handlePipelinedError(ePtr,
+                                                                  *ecpPtr);
+                                });
+    }
+    else if (!isWorking_)
     {
         isWorking_ = true;
         thisPtr_ = thisPtr;
+        handle->send(connectionPtr_);
         connectionPtr_->execSql(std::move(sql),
                                 paraNum,
                                 std::move(parameters),
                                 std::move(length),
                                 std::move(format),
                                 std::move(resultCallback),
-                                [ecpPtr, timeoutFlagPtr, thisPtr](
+                                [ecpPtr, timeoutFlagPtr, thisPtr, handle](
                                     const std::exception_ptr &ePtr) {
+                                    handle->finish();
                                     thisPtr->rollback();
                                     if (timeoutFlagPtr->done())
                                         return;
@@ -374,7 +474,8 @@ void TransactionImpl::execSqlInLoopWithTimeout(
         cmdPtr->formats_ = std::move(format);
         cmdPtr->callback_ = std::move(resultCallback);
         cmdPtr->exceptionCallback_ =
-            [ecpPtr, timeoutFlagPtr](const std::exception_ptr &ePtr) {
+            [ecpPtr, timeoutFlagPtr, handle](const std::exception_ptr &ePtr) {
+                handle->finish();
                 if (timeoutFlagPtr->done())
                     return;
                 if (*ecpPtr)
@@ -383,6 +484,7 @@ void TransactionImpl::execSqlInLoopWithTimeout(
                 }
             };
 
+        cmdPtr->handle_ = handle;
         cmdPtr->thisPtr_ = thisPtr;
         thisPtr->sqlCmdBuffer_.push_back(cmdPtr);
         *commandPtr = cmdPtr;
@@ -128,7 +128,14 @@ class TransactionImpl : public Transaction,
     std::function<void()> usedUpCallback_;
     bool isCommitedOrRolledback_{false};
     bool isWorking_{false};
+    // Statements are sent to a pipeline connection as soon as they are
+    // executed, instead of after the result of the previous one.
+    const bool pipelined_;
+    // A rollback has been sent to the pipeline
+    bool rollbackSent_{false};
     void execNewTask();
+    void handlePipelinedError(const std::exception_ptr &ePtr,
+                              const ExceptPtrCallback &exceptCallback);
 
     struct SqlCmd
     {
@@ -140,6 +147,8 @@ class TransactionImpl : public Transaction,
         QueryCallback callback_;
         ExceptPtrCallback exceptionCallback_;
         bool isRollbackCmd_{false};
+        // Set if the statement is cancelled on timeout
+        std::shared_ptr<StatementHandle> handle_;
         std::shared_ptr<TransactionImpl> thisPtr_;
     };
 
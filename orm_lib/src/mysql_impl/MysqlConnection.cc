@@ -191,6 +191,52 @@ void MysqlConnection::disconnect()
     f.get();
 }
 
+void MysqlConnection::cancel(uint64_t statementId)
+{
+    auto thisPtr = shared_from_this();
+    loop_->runInLoop([thisPtr, statementId]() {
+        if (!thisPtr->isRunning(statementId) || !thisPtr->mysqlPtr_)
+            return;
+        auto threadId = mysql_thread_id(thisPtr->mysqlPtr_.get());
+        // The statement is killed from another connection, which is opened
+        // with blocking calls.
+        cancelLoop()->queueInLoop([thisPtr, threadId, statementId]() {
+            static thread_local MysqlThreadEnv threadEnv;
+            std::unique_ptr<MYSQL, void (*)(MYSQL *)> mysql(mysql_init(nullptr),
+                                                            mysql_close);
+            if (!mysql)
+                return;
+            auto &host = thisPtr->host_;
+            auto &user = thisPtr->user_;
+            auto &passwd = thisPtr->passwd_;
+            auto &port = thisPtr->port_;
+            if (!mysql_real_connect(mysql.get(),
+                                    host.empty() ? nullptr : host.c_str(),
+                                    user.empty() ? nullptr : user.c_str(),
+                                    passwd.empty() ? nullptr : passwd.c_str(),
+                                    nullptr,
+                                    port.empty() ? 3306 : atol(port.c_str()),
+                                    nullptr,
+                                    0))
+            {
+                LOG_ERROR << "Failed to connect to cancel the statement: "
+                          << mysql_error(mysql.get());
+                return;
+            }
+            // KILL QUERY stops whatever the connection is running, the
+            // statement may have finished while connecting.
+            if (!thisPtr->isRunning(statementId))
+                return;
+            auto sql = "KILL QUERY " + std::to_string(threadId);
+            if (mysql_real_query(mysql.get(), sql.data(), sql.length()) != 0)
+            {
+                LOG_ERROR << "Failed to cancel the statement: "
+                          << mysql_error(mysql.get());
+            }
+        });
+    });
+}
+
 void MysqlConnection::handleTimeout()
 {
     int status = 0;
@@ -436,6 +482,7 @@ void MysqlConnection::execSqlInLoop(
 
     callback_ = std::move(rcb);
     isWorking_ = true;
+    startStatement();
     exceptionCallback_ = std::move(exceptCallback);
     sql_.clear();
     if (paraNum > 0)
@@ -531,6 +578,7 @@ void MysqlConnection::outputError()
 
         callback_ = nullptr;
         isWorking_ = false;
+        finishStatement();
         if (errorNo != CR_SERVER_GONE_ERROR && errorNo != CR_SERVER_LOST)
         {
             idleCb_();
@@ -617,6 +665,7 @@ void MysqlConnection::getResult(MYSQL_RES *res)
             callback_ = nullptr;
             exceptionCallback_ = nullptr;
             isWorking_ = false;
+            finishStatement();
             idleCb_();
         }
         else
@@ -94,6 +94,8 @@ class MysqlConnection : public DbConnection,
 
     void disconnect() override;
 
+    void cancel(uint64_t statementId) override;
+
   private:
     class MysqlEnv
     {
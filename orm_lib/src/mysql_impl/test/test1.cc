@@ -28,7 +28,7 @@ int main()
     //     };
     // }
     LOG_TRACE << "begin";
-    *clientPtr << "select * from users where id!=139 order by id"
+    *clientPtr << "select * from users where id!=139 order by id"_sqlLiteral
                << Mode::Blocking >>
         [](const Result &r) {
             std::cout << "rows:" << r.size() << std::endl;
@@ -53,7 +53,8 @@ int main()
         };
     LOG_TRACE << "end";
     LOG_TRACE << "begin";
-    *clientPtr << "select * from users where id=? and user_id=? order by id"
+    *clientPtr << "select * from users where id=? and user_id=? "
+                  "order by id"_sqlLiteral
                << 139 << "233" << Mode::Blocking >>
         [](const Result &r) {
             std::cout << "rows:" << r.size() << std::endl;
@@ -69,8 +70,8 @@ int main()
         [](const DrogonDbException &e) {
             std::cerr << e.base().what() << std::endl;
         };
-    *clientPtr << "update users set time=? where id>?" << trantor::Date::date()
-               << 1000 << Mode::Blocking >>
+    *clientPtr << "update users set time=? where id>?"_sqlLiteral
+               << trantor::Date::date() << 1000 << Mode::Blocking >>
         [](const Result &r) {
             std::cout << "update " << r.affectedRows() << " rows" << std::endl;
         } >>
@@ -93,7 +94,7 @@ int main()
                 std::cout << "committed!!!!!!" << std::endl;
             }
         });
-        *trans << "update users set file=? where id != ?"
+        *trans << "update users set file=? where id != ?"_sqlLiteral
                << "hehaha" << 1000 >>
             [](const Result &r) {
                 std::cout << "hahaha update " << r.affectedRows() << " rows"
@@ -105,13 +106,15 @@ int main()
             };
     }
     LOG_DEBUG << "out of transaction block";
-    *clientPtr << "select * from users where id=1000" >> [](const Result &r) {
-        std::cout << "file:" << r[0]["file"].as<std::string>() << std::endl;
-    } >> [](const DrogonDbException &e) {
-        std::cerr << e.base().what() << std::endl;
-    };
+    *clientPtr << "select * from users where id=1000"_sqlLiteral >>
+        [](const Result &r) {
+            std::cout << "file:" << r[0]["file"].as<std::string>() << std::endl;
+        } >>
+        [](const DrogonDbException &e) {
+            std::cerr << e.base().what() << std::endl;
+        };
 
-    *clientPtr << "select * from users limit ? offset ?" << 2 << 2 >>
+    *clientPtr << "select * from users limit ? offset ?"_sqlLiteral << 2 << 2 >>
         [](const Result &r) {
             std::cout << "select " << r.size() << " records" << std::endl;
             for (auto row : r)
@@ -28,16 +28,14 @@ namespace drogon
 {
 namespace orm
 {
-static const unsigned int maxBatchCount = 256;
-
 Result makeResult(std::shared_ptr<PGresult> &&r = nullptr)
 {
     return Result(std::make_shared<PostgreSQLResultImpl>(std::move(r)));
 }
 
-bool checkSql(const std::string_view &sql_)
+bool checkSql(const std::string_view &sql_, size_t maxSqlLength)
 {
-    if (sql_.length() > 1024)
+    if (sql_.length() > maxSqlLength)
         return true;
     std::string sql{sql_.data(), sql_.length()};
     std::transform(sql.begin(), sql.end(), sql.begin(), [](unsigned char c) {
@@ -79,13 +77,16 @@ int PgConnection::flush()
 
 PgConnection::PgConnection(trantor::EventLoop *loop,
                            const std::string &connInfo,
-                           bool autoBatch)
+                           bool autoBatch,
+                           BatchControlPtr batchControl)
     : DbConnection(loop),
       autoBatch_(autoBatch),
       connectionPtr_(
           std::shared_ptr<PGconn>(PQconnectStart(connInfo.c_str()),
                                   [](PGconn *conn) { PQfinish(conn); })),
-      channel_(loop, PQsocket(connectionPtr_.get()))
+      channel_(loop, PQsocket(connectionPtr_.get())),
+      batchControl_(batchControl ? std::move(batchControl)
+                                 : std::make_shared<BatchControl>())
 {
 }
 
@@ -173,6 +174,47 @@ void PgConnection::disconnect()
     f.get();
 }
 
+void PgConnection::cancel(uint64_t statementId)
+{
+    auto thisPtr = shared_from_this();
+    loop_->runInLoop([thisPtr, statementId]() {
+        // The server cancels whatever is running, so a statement is only
+        // cancelled if it is the only one in the pipeline.
+        auto pending = thisPtr->batchCommandsForWaitingResults_.size() +
+                       thisPtr->batchSqlCommands_.size();
+        if (pending == 1 && thisPtr->isRunning(statementId))
+            thisPtr->sendCancel(statementId);
+    });
+}
+
+void PgConnection::sendCancel(uint64_t statementId)
+{
+    loop_->assertInLoopThread();
+    if (!connectionPtr_)
+        return;
+    auto cancel = PQgetCancel(connectionPtr_.get());
+    if (!cancel)
+        return;
+    // PQcancel() blocks until the server acknowledges the request. It is
+    // only sent if the statement is still running and no other statement has
+    // been added to the pipeline since.
+    std::weak_ptr<PgConnection> weakPtr = shared_from_this();
+    cancelLoop()->queueInLoop([cancel, weakPtr, statementId]() {
+        auto thisPtr = weakPtr.lock();
+        if (!thisPtr || !thisPtr->isRunning(statementId))
+        {
+            PQfreeCancel(cancel);
+            return;
+        }
+        char errbuf[256];
+        if (!PQcancel(cancel, errbuf, sizeof(errbuf)))
+        {
+            LOG_ERROR << "Failed to cancel the statement: " << errbuf;
+        }
+        PQfreeCancel(cancel);
+    });
+}
+
 void PgConnection::pgPoll()
 {
     loop_->assertInLoopThread();
@@ -234,6 +276,7 @@ void PgConnection::execSqlInLoop(
 {
     LOG_TRACE << sql;
     isWorking_ = true;
+    startStatement();
     batchSqlCommands_.emplace_back(
         std::make_shared<SqlCmd>(std::move(sql),
                                  paraNum,
@@ -242,10 +285,32 @@ void PgConnection::execSqlInLoop(
                                  std::move(format),
                                  std::move(rcb),
                                  std::move(exceptCallback)));
-    if (batchSqlCommands_.size() == 1 && !channel_.isWriting())
+    if (channel_.isWriting())
     {
-        loop_->queueInLoop(
-            [thisPtr = shared_from_this()]() { thisPtr->sendBatchedSql(); });
+        // The write callback sends the queued commands
+        return;
+    }
+    if (autoBatch_ &&
+        batchSqlCommands_.size() >= batchControl_->maxBatchSize())
+    {
+        sendBatchedSql();
+        return;
+    }
+    if (!sendingScheduled_)
+    {
+        // Give other requests handled in this loop (or within the batch
+        // window) the chance to add their commands to the same batch.
+        sendingScheduled_ = true;
+        auto send = [thisPtr = shared_from_this()]() {
+            thisPtr->sendingScheduled_ = false;
+            if (!thisPtr->batchSqlCommands_.empty())
+                thisPtr->sendBatchedSql();
+        };
+        auto window = autoBatch_ ? batchControl_->batchWindow() : 0.0;
+        if (window > 0.0)
+            loop_->runAfter(window, std::move(send));
+        else
+            loop_->queueInLoop(std::move(send));
     }
 }
 
@@ -254,10 +319,13 @@ int PgConnection::sendBatchEnd()
     if (!PQpipelineSync(connectionPtr_.get()))
     {
         isWorking_ = false;
+        finishStatement();
         handleFatalError(true);
         handleClosed();
         return 0;
     }
+    batchControl_->recordBatch(batchCount_);
+    batchCount_ = 0;
     return 1;
 }
 
@@ -288,7 +356,24 @@ void PgConnection::sendBatchedSql()
         if (cmd->preparingStatement_.empty())
         {
             auto iter = preparedStatementsMap_.find(cmd->sql_);
-            if (iter == preparedStatementsMap_.end())
+            auto preparing = preparingStatementsMap_.end();
+            if (iter == preparedStatementsMap_.end() &&
+                !preparingStatementsMap_.empty())
+            {
+                preparing = preparingStatementsMap_.find(
+                    std::string{cmd->sql_.data(), cmd->sql_.length()});
+            }
+            if (preparing != preparingStatementsMap_.end())
+            {
+                // Prepared earlier in the pipeline, the server handles it
+                // before this query.
+                statName = preparing->second.first;
+                if (autoBatch_)
+                {
+                    cmd->isChanging_ = preparing->second.second;
+                }
+            }
+            else if (iter == preparedStatementsMap_.end())
             {
                 statName = newStmtName();
                 if (PQsendPrepare(connectionPtr_.get(),
@@ -301,6 +386,7 @@ void PgConnection::sendBatchedSql()
                               << PQerrorMessage(connectionPtr_.get());
 
                     isWorking_ = false;
+                    finishStatement();
                     handleFatalError(true);
                     handleClosed();
                     return;
@@ -308,8 +394,12 @@ void PgConnection::sendBatchedSql()
                 cmd->preparingStatement_ = statName;
                 if (autoBatch_)
                 {
-                    cmd->isChanging_ = checkSql(cmd->sql_);
+                    cmd->isChanging_ =
+                        checkSql(cmd->sql_, batchControl_->maxSqlLength());
                 }
+                preparingStatementsMap_.emplace(
+                    std::string{cmd->sql_.data(), cmd->sql_.length()},
+                    std::make_pair(statName, cmd->isChanging_));
                 if (flush())
                 {
                     return;
@@ -328,20 +418,19 @@ void PgConnection::sendBatchedSql()
         {
             statName = cmd->preparingStatement_;
         }
+        ++batchCount_;
         if (autoBatch_)
         {
-            if (batchSqlCommands_.size() == 1 || cmd->sql_.length() > 1024 ||
-                batchCount_ > maxBatchCount)
+            if (batchSqlCommands_.size() == 1 ||
+                cmd->sql_.length() > batchControl_->maxSqlLength() ||
+                batchCount_ >= batchControl_->maxBatchSize())
             {
                 sendBatchEnd_ = true;
-                batchCount_ = 0;
             }
             else if (cmd->isChanging_)
             {
                 sendBatchEnd_ = true;
-                batchCount_ = 0;
             }
-            ++batchCount_;
         }
         if (PQsendQueryPrepared(connectionPtr_.get(),
                                 statName.c_str(),
@@ -352,6 +441,7 @@ void PgConnection::sendBatchedSql()
                                 0) == 0)
         {
             isWorking_ = false;
+            finishStatement();
             handleFatalError(true);
             handleClosed();
             return;
@@ -407,6 +497,7 @@ void PgConnection::handleRead()
         if (isWorking_)
         {
             isWorking_ = false;
+            finishStatement();
             handleFatalError(true);
         }
         handleClosed();
@@ -467,6 +558,7 @@ void PgConnection::handleRead()
                 batchSqlCommands_.empty())
             {
                 isWorking_ = false;
+                finishStatement();
                 idleCb_();
                 return;
             }
@@ -479,6 +571,7 @@ void PgConnection::handleRead()
             {
                 auto r = preparedStatements_.insert(
                     std::string{cmd->sql_.data(), cmd->sql_.length()});
+                preparingStatementsMap_.erase(*r.first);
                 preparedStatementsMap_[std::string_view{r.first->c_str(),
                                                         r.first->length()}] = {
                     std::move(cmd->preparingStatement_), cmd->isChanging_};
@@ -497,6 +590,7 @@ void PgConnection::handleRead()
         {
             auto r = preparedStatements_.insert(
                 std::string{cmd->sql_.data(), cmd->sql_.length()});
+            preparingStatementsMap_.erase(*r.first);
             preparedStatementsMap_[std::string_view{r.first->c_str(),
                                                     r.first->length()}] = {
                 std::move(cmd->preparingStatement_), cmd->isChanging_};
@@ -530,18 +624,28 @@ void PgConnection::handleFatalError(bool clearAll, bool isAbortPipeline)
         }
         batchCommandsForWaitingResults_.clear();
         batchSqlCommands_.clear();
+        preparingStatementsMap_.clear();
+        batchCount_ = 0;
     }
     else
     {
         if (!batchSqlCommands_.empty() &&
             !batchSqlCommands_.front()->preparingStatement_.empty())
         {
-            batchSqlCommands_.front()->exceptionCallback_(exceptPtr);
+            auto &cmd = batchSqlCommands_.front();
+            preparingStatementsMap_.erase(
+                std::string{cmd->sql_.data(), cmd->sql_.length()});
+            cmd->exceptionCallback_(exceptPtr);
             batchSqlCommands_.pop_front();
         }
         else if (!batchCommandsForWaitingResults_.empty())
         {
             auto &cmd = batchCommandsForWaitingResults_.front();
+            if (!cmd->preparingStatement_.empty())
+            {
+                preparingStatementsMap_.erase(
+                    std::string{cmd->sql_.data(), cmd->sql_.length()});
+            }
             cmd->exceptionCallback_(exceptPtr);
             batchCommandsForWaitingResults_.pop_front();
         }
@@ -557,5 +661,7 @@ void PgConnection::batchSql(std::deque<std::shared_ptr<SqlCmd>> &&sqlCommands)
 {
     loop_->assertInLoopThread();
     batchSqlCommands_ = std::move(sqlCommands);
+    for (size_t i = 0; i < batchSqlCommands_.size(); ++i)
+        startStatement();
     sendBatchedSql();
 }
@@ -58,7 +58,8 @@ int PgConnection::flush()
 
 PgConnection::PgConnection(trantor::EventLoop *loop,
                            const std::string &connInfo,
-                           bool)
+                           bool,
+                           BatchControlPtr)
     : DbConnection(loop),
       connectionPtr_(
           std::shared_ptr<PGconn>(PQconnectStart(connInfo.c_str()),
@@ -150,6 +151,43 @@ void PgConnection::disconnect()
     f.get();
 }
 
+void PgConnection::cancel(uint64_t statementId)
+{
+    auto thisPtr = shared_from_this();
+    loop_->runInLoop([thisPtr, statementId]() {
+        if (thisPtr->isRunning(statementId))
+            thisPtr->sendCancel(statementId);
+    });
+}
+
+void PgConnection::sendCancel(uint64_t statementId)
+{
+    loop_->assertInLoopThread();
+    if (!connectionPtr_)
+        return;
+    auto cancel = PQgetCancel(connectionPtr_.get());
+    if (!cancel)
+        return;
+    // PQcancel() blocks until the server acknowledges the request. The
+    // server cancels whatever the connection is running when the request
+    // arrives, so it is only sent if the statement is still running.
+    std::weak_ptr<PgConnection> weakPtr = shared_from_this();
+    cancelLoop()->queueInLoop([cancel, weakPtr, statementId]() {
+        auto thisPtr = weakPtr.lock();
+        if (!thisPtr || !thisPtr->isRunning(statementId))
+        {
+            PQfreeCancel(cancel);
+            return;
+        }
+        char errbuf[256];
+        if (!PQcancel(cancel, errbuf, sizeof(errbuf)))
+        {
+            LOG_ERROR << "Failed to cancel the statement: " << errbuf;
+        }
+        PQfreeCancel(cancel);
+    });
+}
+
 void PgConnection::pgPoll()
 {
     loop_->assertInLoopThread();
@@ -216,6 +254,7 @@ void PgConnection::execSqlInLoop(
     sql_ = std::move(sql);
     callback_ = std::move(rcb);
     isWorking_ = true;
+    startStatement();
     exceptionCallback_ = std::move(exceptCallback);
     if (paraNum == 0)
     {
@@ -227,6 +266,7 @@ void PgConnection::execSqlInLoop(
             if (isWorking_)
             {
                 isWorking_ = false;
+                finishStatement();
                 isPreparingStatement_ = false;
                 handleFatalError();
                 callback_ = nullptr;
@@ -255,6 +295,7 @@ void PgConnection::execSqlInLoop(
                 if (isWorking_)
                 {
                     isWorking_ = false;
+                    finishStatement();
                     isPreparingStatement_ = false;
                     handleFatalError();
                     callback_ = nullptr;
@@ -278,6 +319,7 @@ void PgConnection::execSqlInLoop(
                 if (isWorking_)
                 {
                     isWorking_ = false;
+                    finishStatement();
                     handleFatalError();
                     callback_ = nullptr;
                     idleCb_();
@@ -305,6 +347,7 @@ void PgConnection::handleRead()
         if (isWorking_)
         {
             isWorking_ = false;
+            finishStatement();
             handleFatalError();
             callback_ = nullptr;
         }
@@ -352,6 +395,7 @@ void PgConnection::handleRead()
         else
         {
             isWorking_ = false;
+            finishStatement();
             isPreparingStatement_ = false;
             idleCb_();
         }
@@ -387,6 +431,7 @@ void PgConnection::doAfterPreparing()
         if (isWorking_)
         {
             isWorking_ = false;
+            finishStatement();
             handleFatalError();
             callback_ = nullptr;
             idleCb_();
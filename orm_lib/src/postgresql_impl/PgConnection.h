@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "../BatchControl.h"
 #include "../DbConnection.h"
 #include <drogon/orm/DbClient.h>
 #include <trantor/net/EventLoop.h>
@@ -43,10 +44,18 @@ class PgConnection : public DbConnection,
         std::function<void(const std::string &, const std::string &)>;
     PgConnection(trantor::EventLoop *loop,
                  const std::string &connInfo,
-                 bool autoBatch);
+                 bool autoBatch,
+                 BatchControlPtr batchControl = nullptr);
 
     void init() override;
 
+#if LIBPQ_SUPPORTS_BATCH_MODE
+    bool supportsPipelining() const override
+    {
+        return true;
+    }
+#endif
+
     void execSql(std::string_view &&sql,
                  size_t paraNum,
                  std::vector<const char *> &&parameters,
@@ -93,6 +102,8 @@ class PgConnection : public DbConnection,
 
     void disconnect() override;
 
+    void cancel(uint64_t statementId) override;
+
     const std::shared_ptr<PGconn> &pgConn() const
     {
         return connectionPtr_;
@@ -118,6 +129,9 @@ class PgConnection : public DbConnection,
     void handleRead();
     void pgPoll();
     void handleClosed();
+    // Send a cancel request for the running statement, must be called in
+    // the loop of the connection.
+    void sendCancel(uint64_t statementId);
 
     void execSqlInLoop(
         std::string_view &&sql,
@@ -145,9 +159,16 @@ class PgConnection : public DbConnection,
     int sendBatchEnd();
     bool sendBatchEnd_{false};
     bool autoBatch_{false};
+    bool sendingScheduled_{false};
     unsigned int batchCount_{0};
+    BatchControlPtr batchControl_;
     std::unordered_map<std::string_view, std::pair<std::string, bool>>
         preparedStatementsMap_;
+    // Statements sent with PQsendPrepare whose results haven't arrived yet,
+    // queries with the same SQL reuse the statement name instead of
+    // preparing it again.
+    std::unordered_map<std::string, std::pair<std::string, bool>>
+        preparingStatementsMap_;
 #else
     std::unordered_map<std::string_view, std::string> preparedStatementsMap_;
 #endif
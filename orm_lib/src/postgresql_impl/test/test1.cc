@@ -15,7 +15,7 @@ int main()
     LOG_DEBUG << "start!";
     std::this_thread::sleep_for(1s);
     *clientPtr << "update group_users set join_date=$1,relationship=$2 where "
-                  "g_uuid=420040 and u_uuid=2"
+                  "g_uuid=420040 and u_uuid=2"_sqlLiteral
                << nullptr << nullptr << Mode::Blocking >>
         [](const Result &r) {
             std::cout << "update " << r.affectedRows() << " lines" << std::endl;
@@ -146,19 +146,21 @@ int main()
             std::cerr << "error:" << e.base().what() << std::endl;
         },
         "default");
-    *clientPtr << "select t2,t9 from ttt where t7=2" >> [](const Result &r) {
-        std::cout << r.size() << " rows selected!" << std::endl;
-        for (auto row : r)
-        {
-            std::cout << row["t9"].as<std::string>() << std::endl;
-            std::cout << row["t2"].as<int>() << std::endl;
-        }
-    } >> [](const DrogonDbException &e) {
-        std::cerr << "error:" << e.base().what() << std::endl;
-    };
+    *clientPtr << "select t2,t9 from ttt where t7=2"_sqlLiteral >>
+        [](const Result &r) {
+            std::cout << r.size() << " rows selected!" << std::endl;
+            for (auto row : r)
+            {
+                std::cout << row["t9"].as<std::string>() << std::endl;
+                std::cout << row["t2"].as<int>() << std::endl;
+            }
+        } >>
+        [](const DrogonDbException &e) {
+            std::cerr << "error:" << e.base().what() << std::endl;
+        };
 
     *clientPtr << "select t1.*, t2.* from users t1 left join groups t2 on "
-                  "t1.talkgroup_uuid=t2.g_uuid" >>
+                  "t1.talkgroup_uuid=t2.g_uuid"_sqlLiteral >>
         [](const Result &r) {
             std::cout << r.size() << " rows selected!" << std::endl;
             if (r.size() == 0)
@@ -53,7 +53,7 @@ int main()
             std::cout << "The transaction submission "
                       << (committed ? "succeeded" : "failed") << std::endl;
         });
-        *trans << "delete from users where user_uuid=201" >>
+        *trans << "delete from users where user_uuid=201"_sqlLiteral >>
             [trans](const Result &r) {
                 std::cout << "delete " << r.affectedRows() << "user!!!!!"
                           << std::endl;
@@ -63,7 +63,7 @@ int main()
                 std::cout << e.base().what() << std::endl;
             };
 
-        *trans << "delete from users where user_uuid=201" >>
+        *trans << "delete from users where user_uuid=201"_sqlLiteral >>
             [](const Result &r) {
                 std::cout << "delete " << r.affectedRows() << "user!!!!!"
                           << std::endl;
@@ -77,7 +77,7 @@ int main()
     auto U = mapper.findByPrimaryKey(2);
     std::cout << "id=" << U.userId_ << std::endl;
     std::cout << "name=" << U.userName_ << std::endl;
-    *client << "select * from array_test" >>
+    *client << "select * from array_test"_sqlLiteral >>
         [](bool isNull,
            const std::vector<std::shared_ptr<int>> &a,
            const std::string &b,
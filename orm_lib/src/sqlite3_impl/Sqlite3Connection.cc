@@ -29,8 +29,27 @@ using namespace drogon::orm;
 
 namespace
 {
+bool isIdentifier(std::string_view name)
+{
+    if (name.empty() ||
+        !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_'))
+        return false;
+    return std::all_of(name.begin() + 1, name.end(), [](unsigned char c) {
+        return std::isalnum(c) || c == '_';
+    });
+}
 
+// A pragma name, optionally qualified by a schema name, e.g.
+// main.journal_mode
+bool isPragmaName(std::string_view name)
+{
+    auto pos = name.find('.');
+    if (pos == std::string_view::npos)
+        return isIdentifier(name);
+    return isIdentifier(name.substr(0, pos)) &&
+           isIdentifier(name.substr(pos + 1));
 }
+}  // namespace
 
 std::once_flag Sqlite3Connection::once_;
 
@@ -100,6 +119,7 @@ void Sqlite3Connection::init()
     // Get the key and value
     auto connParams = parseConnString(connInfo_);
     std::string filename;
+    std::vector<std::pair<std::string, std::string>> pragmas;
     for (auto const &kv : connParams)
     {
         auto key = kv.first;
@@ -112,13 +132,36 @@ void Sqlite3Connection::init()
         {
             filename = value;
         }
+        else if (!isPragmaName(key))
+        {
+            LOG_ERROR << "Invalid sqlite3 option name: " << key
+                      << ", it must be a pragma name";
+        }
+        else if (std::all_of(value.begin(), value.end(), [](unsigned char c) {
+                     return std::isalnum(c) || c == '_' || c == '-' ||
+                            c == '.';
+                 }))
+        {
+            // Other keys are applied as PRAGMAs, e.g. journal_mode=wal
+            pragmas.emplace_back(std::move(key), value);
+        }
+        else
+        {
+            LOG_ERROR << "Invalid sqlite3 option value: " << key << "="
+                      << value;
+        }
     }
-    loop_->runInLoop([this, filename = std::move(filename)]() {
+    loop_->runInLoop([this,
+                      filename = std::move(filename),
+                      pragmas = std::move(pragmas)]() {
         sqlite3 *tmp = nullptr;
         auto ret = sqlite3_open(filename.data(), &tmp);
-        connectionPtr_ = std::shared_ptr<sqlite3>(tmp, [](sqlite3 *ptr) {
-            sqlite3_close(ptr);
-        });
+        {
+            std::lock_guard<std::mutex> lock(connectionMutex_);
+            connectionPtr_ = std::shared_ptr<sqlite3>(tmp, [](sqlite3 *ptr) {
+                sqlite3_close(ptr);
+            });
+        }
         auto thisPtr = shared_from_this();
         if (ret != SQLITE_OK)
         {
@@ -128,6 +171,15 @@ void Sqlite3Connection::init()
         else
         {
             sqlite3_extended_result_codes(tmp, true);
+            for (auto const &[key, value] : pragmas)
+            {
+                auto sql = "PRAGMA " + key + "=" + value;
+                if (sqlite3_exec(tmp, sql.c_str(), nullptr, nullptr, nullptr) !=
+                    SQLITE_OK)
+                {
+                    LOG_ERROR << sql << ": " << sqlite3_errmsg(tmp);
+                }
+            }
             okCallback_(thisPtr);
         }
     });
@@ -167,6 +219,7 @@ void Sqlite3Connection::execSqlInQueue(
     const std::function<void(const std::exception_ptr &)> &exceptCallback)
 {
     LOG_TRACE << "sql:" << sql;
+    startStatement();
     std::shared_ptr<sqlite3_stmt> stmtPtr;
     bool newStmt = false;
     if (paraNum > 0)
@@ -182,8 +235,20 @@ void Sqlite3Connection::execSqlInQueue(
         sqlite3_stmt *stmt = nullptr;
         newStmt = true;
         const char *remaining;
+#if SQLITE_VERSION_NUMBER >= 3020000
+        // Statements with parameters are cached, so tell SQLite they are
+        // long-lived and shouldn't be allocated from the lookaside memory.
+        auto ret = sqlite3_prepare_v3(connectionPtr_.get(),
+                                      sql.data(),
+                                      -1,
+                                      paraNum > 0 ? SQLITE_PREPARE_PERSISTENT
+                                                  : 0,
+                                      &stmt,
+                                      &remaining);
+#else
         auto ret = sqlite3_prepare_v2(
             connectionPtr_.get(), sql.data(), -1, &stmt, &remaining);
+#endif
         stmtPtr = stmt ? std::shared_ptr<sqlite3_stmt>(stmt,
                                                        [](sqlite3_stmt *p) {
                                                            sqlite3_finalize(p);
@@ -277,7 +342,7 @@ void Sqlite3Connection::execSqlInQueue(
     {
         // Readonly, hold read lock;
         std::shared_lock<SharedMutex> lock(*sharedMutexPtr_);
-        r = stmtStep(stmt, resultPtr, columnNum);
+        r = stmtStep(stmt, resultPtr);
         if (r != SQLITE_DONE)
         {
             er = sqlite3_extended_errcode(connectionPtr_.get());
@@ -288,7 +353,7 @@ void Sqlite3Connection::execSqlInQueue(
     {
         // Hold write lock
         std::unique_lock<SharedMutex> lock(*sharedMutexPtr_);
-        r = stmtStep(stmt, resultPtr, columnNum);
+        r = stmtStep(stmt, resultPtr);
         if (r == SQLITE_DONE)
         {
             resultPtr->affectedRows_ = sqlite3_changes(connectionPtr_.get());
@@ -301,6 +366,10 @@ void Sqlite3Connection::execSqlInQueue(
         }
         sqlite3_reset(stmt);
     }
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        finishStatement();
+    }
 
     if (r != SQLITE_DONE)
     {
@@ -321,45 +390,12 @@ void Sqlite3Connection::execSqlInQueue(
 
 int Sqlite3Connection::stmtStep(
     sqlite3_stmt *stmt,
-    const std::shared_ptr<Sqlite3ResultImpl> &resultPtr,
-    int columnNum)
+    const std::shared_ptr<Sqlite3ResultImpl> &resultPtr)
 {
     int r;
     while ((r = sqlite3_step(stmt)) == SQLITE_ROW)
     {
-        std::vector<std::shared_ptr<std::string>> row;
-        for (int i = 0; i < columnNum; ++i)
-        {
-            switch (sqlite3_column_type(stmt, i))
-            {
-                case SQLITE_INTEGER:
-                    row.push_back(std::make_shared<std::string>(
-                        std::to_string(sqlite3_column_int64(stmt, i))));
-                    break;
-                case SQLITE_FLOAT:
-                    row.push_back(std::make_shared<std::string>(
-                        std::to_string(sqlite3_column_double(stmt, i))));
-                    break;
-                case SQLITE_TEXT:
-                    row.push_back(std::make_shared<std::string>(
-                        (const char *)sqlite3_column_text(stmt, i),
-                        (size_t)sqlite3_column_bytes(stmt, i)));
-                    break;
-                case SQLITE_BLOB:
-                {
-                    const char *buf =
-                        (const char *)sqlite3_column_blob(stmt, i);
-                    size_t len = sqlite3_column_bytes(stmt, i);
-                    row.push_back(buf ? std::make_shared<std::string>(buf, len)
-                                      : std::make_shared<std::string>());
-                }
-                break;
-                case SQLITE_NULL:
-                    row.push_back(nullptr);
-                    break;
-            }
-        }
-        resultPtr->result_.push_back(std::move(row));
+        resultPtr->appendRow(stmt);
     }
     return r;
 }
@@ -375,9 +411,20 @@ void Sqlite3Connection::disconnect()
             auto thisPtr = weakPtr.lock();
             if (!thisPtr)
                 return;
+            std::lock_guard<std::mutex> lock(thisPtr->connectionMutex_);
             thisPtr->connectionPtr_.reset();
         }
         pro.set_value(1);
     });
     f.get();
 }
+
+void Sqlite3Connection::cancel(uint64_t statementId)
+{
+    // Statements run in the thread of the connection, interrupt them from
+    // here. The statement is finished under the same lock after it is reset,
+    // and sqlite3_interrupt() does nothing if no statement is running.
+    std::lock_guard<std::mutex> lock(connectionMutex_);
+    if (connectionPtr_ && isRunning(statementId))
+        sqlite3_interrupt(connectionPtr_.get());
+}
@@ -63,6 +63,8 @@ class Sqlite3Connection : public DbConnection,
 
     void disconnect() override;
 
+    void cancel(uint64_t statementId) override;
+
   private:
     static std::once_flag once_;
     void execSqlInQueue(
@@ -78,10 +80,11 @@ class Sqlite3Connection : public DbConnection,
         const std::function<void(const std::exception_ptr &)> &exceptCallback,
         const int &extendedErrcode);
     int stmtStep(sqlite3_stmt *stmt,
-                 const std::shared_ptr<Sqlite3ResultImpl> &resultPtr,
-                 int columnNum);
+                 const std::shared_ptr<Sqlite3ResultImpl> &resultPtr);
     trantor::EventLoopThread loopThread_;
     std::shared_ptr<sqlite3> connectionPtr_;
+    // Guards connectionPtr_ and the running statement against cancel()
+    std::mutex connectionMutex_;
     std::shared_ptr<SharedMutex> sharedMutexPtr_;
     std::unordered_map<std::string_view, std::shared_ptr<sqlite3_stmt>>
         stmtsMap_;
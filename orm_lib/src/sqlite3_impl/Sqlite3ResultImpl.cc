@@ -15,18 +15,20 @@
 #include "Sqlite3ResultImpl.h"
 #include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <cstdio>
 #include <drogon/orm/Exception.h>
 
 using namespace drogon::orm;
 
 Result::SizeType Sqlite3ResultImpl::size() const noexcept
 {
-    return result_.size();
+    return rows_;
 }
 
 Result::RowSizeType Sqlite3ResultImpl::columns() const noexcept
 {
-    return result_.empty() ? 0 : result_[0].size();
+    return rows_ == 0 ? 0 : columnCells_.size();
 }
 
 const char *Sqlite3ResultImpl::columnName(RowSizeType number) const
@@ -56,20 +58,113 @@ Result::RowSizeType Sqlite3ResultImpl::columnNumber(const char colName[]) const
 
 const char *Sqlite3ResultImpl::getValue(SizeType row, RowSizeType column) const
 {
-    auto col = result_[row][column];
-    return col ? col->c_str() : nullptr;
+    const auto &cell = columnCells_[column][row];
+    return cell.type_ == SQLITE_NULL ? nullptr : arena_.data() + cell.offset_;
 }
 
 bool Sqlite3ResultImpl::isNull(SizeType row, RowSizeType column) const
 {
-    return !result_[row][column];
+    return columnCells_[column][row].type_ == SQLITE_NULL;
 }
 
 Result::FieldSizeType Sqlite3ResultImpl::getLength(SizeType row,
                                                    RowSizeType column) const
 {
-    auto col = result_[row][column];
-    return col ? col->length() : 0;
+    return columnCells_[column][row].length_;
+}
+
+bool Sqlite3ResultImpl::getInt64(SizeType row,
+                                 RowSizeType column,
+                                 int64_t &value) const
+{
+    const auto &cell = columnCells_[column][row];
+    if (cell.type_ != SQLITE_INTEGER)
+        return false;
+    value = cell.integer_;
+    return true;
+}
+
+bool Sqlite3ResultImpl::getDouble(SizeType row,
+                                  RowSizeType column,
+                                  double &value) const
+{
+    const auto &cell = columnCells_[column][row];
+    if (cell.type_ == SQLITE_FLOAT)
+    {
+        value = cell.real_;
+        return true;
+    }
+    if (cell.type_ == SQLITE_INTEGER)
+    {
+        value = static_cast<double>(cell.integer_);
+        return true;
+    }
+    return false;
+}
+
+size_t Sqlite3ResultImpl::appendToArena(const char *data, size_t length)
+{
+    auto offset = arena_.size();
+    if (length > 0)
+        arena_.append(data, length);
+    arena_.push_back('\0');
+    return offset;
+}
+
+void Sqlite3ResultImpl::appendRow(sqlite3_stmt *stmt)
+{
+    auto columnNum = columnNames_.size();
+    if (columnCells_.size() != columnNum)
+        columnCells_.resize(columnNum);
+    for (size_t i = 0; i < columnNum; ++i)
+    {
+        Cell cell;
+        cell.integer_ = 0;
+        cell.offset_ = 0;
+        cell.length_ = 0;
+        cell.type_ = sqlite3_column_type(stmt, (int)i);
+        switch (cell.type_)
+        {
+            case SQLITE_INTEGER:
+            {
+                cell.integer_ = sqlite3_column_int64(stmt, (int)i);
+                char buf[32];
+                auto res =
+                    std::to_chars(buf, buf + sizeof(buf), cell.integer_);
+                cell.length_ = static_cast<uint32_t>(res.ptr - buf);
+                cell.offset_ = appendToArena(buf, cell.length_);
+            }
+            break;
+            case SQLITE_FLOAT:
+            {
+                cell.real_ = sqlite3_column_double(stmt, (int)i);
+                // Same representation as std::to_string(double)
+                char buf[512];
+                auto len = snprintf(buf, sizeof(buf), "%f", cell.real_);
+                cell.length_ = static_cast<uint32_t>(
+                    std::min<size_t>(len, sizeof(buf) - 1));
+                cell.offset_ = appendToArena(buf, cell.length_);
+            }
+            break;
+            case SQLITE_TEXT:
+            case SQLITE_BLOB:
+            {
+                const char *data =
+                    cell.type_ == SQLITE_TEXT
+                        ? (const char *)sqlite3_column_text(stmt, (int)i)
+                        : (const char *)sqlite3_column_blob(stmt, (int)i);
+                cell.length_ =
+                    data ? (uint32_t)sqlite3_column_bytes(stmt, (int)i) : 0;
+                cell.offset_ = appendToArena(data, cell.length_);
+            }
+            break;
+            default:
+                cell.type_ = SQLITE_NULL;
+                break;
+        }
+        columnCells_[i].push_back(cell);
+    }
+    ++rows_;
 }
 
 unsigned long long Sqlite3ResultImpl::insertId() const noexcept
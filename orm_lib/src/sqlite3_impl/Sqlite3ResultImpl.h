@@ -38,11 +38,44 @@ class Sqlite3ResultImpl : public ResultImpl
     const char *getValue(SizeType row, RowSizeType column) const override;
     bool isNull(SizeType row, RowSizeType column) const override;
     FieldSizeType getLength(SizeType row, RowSizeType column) const override;
+    bool getInt64(SizeType row,
+                  RowSizeType column,
+                  int64_t &value) const override;
+    bool getDouble(SizeType row,
+                   RowSizeType column,
+                   double &value) const override;
     unsigned long long insertId() const noexcept override;
 
   private:
     friend class Sqlite3Connection;
-    std::vector<std::vector<std::shared_ptr<std::string>>> result_;
+
+    /**
+     * @brief One value of the result set. Integers and floats are kept
+     * unboxed, the text representation of every non-null value lives in the
+     * shared arena as a zero-terminated string starting at offset_.
+     */
+    struct Cell
+    {
+        union
+        {
+            int64_t integer_;
+            double real_;
+        };
+
+        size_t offset_;
+        uint32_t length_;
+        int type_;
+    };
+
+    /**
+     * @brief Append the current row of the statement to the result.
+     */
+    void appendRow(sqlite3_stmt *stmt);
+    size_t appendToArena(const char *data, size_t length);
+
+    std::vector<std::vector<Cell>> columnCells_;
+    std::string arena_;
+    size_t rows_{0};
     std::string query_;
     std::vector<std::string> columnNames_;
     std::unordered_map<std::string, size_t> columnNamesMap_;
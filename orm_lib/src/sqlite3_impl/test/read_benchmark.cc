@@ -0,0 +1,145 @@
+/**
+ *
+ *  read_benchmark.cc
+ *
+ *  Measures SELECT throughput of a Sqlite3 client while another task keeps
+ *  writing to the same database, once with the default rollback journal and
+ *  once in WAL mode (one writer connection plus N read-only connections).
+ *
+ *  Usage: sqlite3_read_benchmark [queries per run]
+ *
+ */
+
+#include <drogon/orm/DbClient.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace drogon::orm;
+
+static const char *dbFile = "read_benchmark.db";
+
+static void prepareDatabase()
+{
+    std::remove(dbFile);
+    std::remove((std::string(dbFile) + "-wal").c_str());
+    std::remove((std::string(dbFile) + "-shm").c_str());
+    auto client =
+        DbClient::newSqlite3Client(std::string("filename=") + dbFile, 1);
+    client->execSqlSync(
+        "CREATE TABLE bench (id INTEGER PRIMARY KEY, v INTEGER, name TEXT)");
+    {
+        auto trans = client->newTransaction();
+        for (int i = 0; i < 20000; ++i)
+        {
+            trans->execSqlSync("insert into bench (v, name) values (?, ?)",
+                               i % 1000,
+                               "name" + std::to_string(i));
+        }
+    }
+    // Runs after the commit on the same connection
+    client->execSqlSync("select count(*) from bench");
+}
+
+// Keep one insert in flight until stop is set
+static void keepWriting(const DbClientPtr &client,
+                        const std::shared_ptr<std::atomic<bool>> &stop,
+                        const std::shared_ptr<std::atomic<size_t>> &writes)
+{
+    if (*stop)
+        return;
+    client->execSqlAsync(
+        "insert into bench (v, name) values (?, ?)",
+        [client, stop, writes](const Result &) {
+            ++*writes;
+            keepWriting(client, stop, writes);
+        },
+        [](const DrogonDbException &e) { LOG_ERROR << e.base().what(); },
+        1,
+        "writer");
+}
+
+static void runQuery(const DbClientPtr &client,
+                     const std::shared_ptr<std::atomic<size_t>> &issued,
+                     const std::shared_ptr<std::atomic<size_t>> &remaining,
+                     const std::shared_ptr<std::promise<void>> &done,
+                     size_t total)
+{
+    auto n = (*issued)++;
+    if (n >= total)
+        return;
+    auto onDone = [=]() {
+        if (--*remaining == 0)
+            done->set_value();
+        else
+            runQuery(client, issued, remaining, done, total);
+    };
+    client->execSqlAsync(
+        "select count(*), sum(v) from bench where id between ? and ?",
+        [onDone](const Result &) { onDone(); },
+        [onDone](const DrogonDbException &e) {
+            LOG_ERROR << e.base().what();
+            onDone();
+        },
+        (int64_t)(n % 19000),
+        (int64_t)(n % 19000 + 1000));
+}
+
+static double measure(const std::string &connInfo,
+                      size_t connNum,
+                      size_t total)
+{
+    auto client = DbClient::newSqlite3Client(connInfo, connNum);
+    std::this_thread::sleep_for(500ms);
+    auto stop = std::make_shared<std::atomic<bool>>(false);
+    auto writes = std::make_shared<std::atomic<size_t>>(0);
+    keepWriting(client, stop, writes);
+
+    auto issued = std::make_shared<std::atomic<size_t>>(0);
+    auto remaining = std::make_shared<std::atomic<size_t>>(total);
+    auto done = std::make_shared<std::promise<void>>();
+    auto start = std::chrono::steady_clock::now();
+    // Keep a few queries per connection in flight
+    for (size_t i = 0; i < connNum * 4; ++i)
+    {
+        runQuery(client, issued, remaining, done, total);
+    }
+    done->get_future().wait();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    *stop = true;
+    std::this_thread::sleep_for(100ms);
+    client->closeAll();
+    return total / elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+    trantor::Logger::setLogLevel(trantor::Logger::kWarn);
+    size_t total = argc > 1 ? std::stoul(argv[1]) : 20000;
+    prepareDatabase();
+    auto cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "readers\trollback journal (qps)\twal (qps)" << std::endl;
+    for (size_t readers = 1; readers <= cores; readers *= 2)
+    {
+        auto base = measure(std::string("filename=") + dbFile +
+                                " journal_mode=delete",
+                            readers + 1,
+                            total);
+        auto wal = measure(std::string("filename=") + dbFile +
+                               " journal_mode=wal",
+                           readers + 1,
+                           total);
+        std::cout << readers << "\t" << (size_t)base << "\t\t\t"
+                  << (size_t)wal << std::endl;
+    }
+    return 0;
+}
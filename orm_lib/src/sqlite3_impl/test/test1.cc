@@ -19,7 +19,7 @@ int main()
     std::this_thread::sleep_for(1s);
 
     LOG_DEBUG << "start!";
-    // *clientPtr << "Drop table groups;" << Mode::Blocking >>
+    // *clientPtr << "Drop table groups;"_sqlLiteral << Mode::Blocking >>
     //     [](const Result &r) {
     //         LOG_DEBUG << "dropped";
     //     } >>
@@ -35,13 +35,13 @@ int main()
                   "INVITING INTEGER,"
                   "INVITING_USER_ID INTEGER,"
                   "AVATAR_ID TEXT, uuu double, text VARCHAR(255),avatar "
-                  "blob,is_default bool)"
+                  "blob,is_default bool)"_sqlLiteral
                << Mode::Blocking >>
         [](const Result &r) { LOG_DEBUG << "created"; } >>
         [](const DrogonDbException &e) {
             std::cout << e.base().what() << std::endl;
         };
-    *clientPtr << "insert into GROUPS (group_name) values(?)"
+    *clientPtr << "insert into GROUPS (group_name) values(?)"_sqlLiteral
                << "test_group" << Mode::Blocking >>
         [](const Result &r) {
             LOG_DEBUG << "inserted:" << r.affectedRows();
@@ -50,7 +50,7 @@ int main()
         [](const DrogonDbException &e) {
             std::cout << e.base().what() << std::endl;
         };
-    *clientPtr << "insert into GROUPS (group_name) values(?)"
+    *clientPtr << "insert into GROUPS (group_name) values(?)"_sqlLiteral
                << "test_group" << Mode::Blocking >>
         [](const Result &r) {
             LOG_DEBUG << "inserted:" << r.affectedRows();
@@ -59,7 +59,7 @@ int main()
         [](const DrogonDbException &e) {
             std::cout << e.base().what() << std::endl;
         };
-    *clientPtr << "select * from GROUPS " >> [](const Result &r) {
+    *clientPtr << "select * from GROUPS "_sqlLiteral >> [](const Result &r) {
         LOG_DEBUG << "affected rows:" << r.affectedRows();
         LOG_DEBUG << "select " << r.size() << " rows";
         LOG_DEBUG << "id:" << r.insertId();
@@ -106,17 +106,20 @@ int main()
         {
             std::cerr << e.base().what() << std::endl;
         }
-        *clientPtr << "select is_default from groups" >> [](const Result &r) {
-            for (auto row : r)
-            {
-                std::cout << "is_default: "
-                          << (row[0].isNull() ? "is null, " : "is not null, ")
-                          << "bool value:" << row[0].as<bool>() << "("
-                          << row[0].as<std::string>() << ")" << std::endl;
-            }
-        } >> [](const DrogonDbException &e) {
-            std::cerr << e.base().what() << std::endl;
-        };
+        *clientPtr << "select is_default from groups"_sqlLiteral >>
+            [](const Result &r) {
+                for (auto row : r)
+                {
+                    std::cout << "is_default: "
+                              << (row[0].isNull() ? "is null, "
+                                                  : "is not null, ")
+                              << "bool value:" << row[0].as<bool>() << "("
+                              << row[0].as<std::string>() << ")" << std::endl;
+                }
+            } >>
+            [](const DrogonDbException &e) {
+                std::cerr << e.base().what() << std::endl;
+            };
     }
     getchar();
 }
@@ -16,6 +16,7 @@
 #include <drogon/HttpAppFramework.h>
 #include <drogon/config.h>
 #include <drogon/drogon_test.h>
+#include <drogon/orm/CachedDbClient.h>
 #include <drogon/orm/CoroMapper.h>
 #include <drogon/orm/DbClient.h>
 #include <drogon/orm/DbTypes.h>
@@ -25,7 +26,9 @@
 
 #include <stdlib.h>
 #include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -2663,6 +2666,38 @@ DROGON_TEST(SQLite3Test)
         FAULT("sqlite3 - Prepare the test environment(0):  what():",
               e.base().what());
     };
+    // Integers and floats are stored unboxed
+    *clientPtr << "select 42 as i, 2.5 as d, 'abc' as s, null as n" >>
+        [TEST_CTX](const Result &r) {
+            MANDATE(r.size() == 1);
+            CHECK(r[0]["i"].as<int64_t>() == 42);
+            CHECK(r[0]["i"].as<std::string>() == "42");
+            CHECK(r[0]["i"].as<double>() == 42.0);
+            CHECK(r[0]["d"].as<double>() == 2.5);
+            CHECK(r[0]["d"].as<int>() == 2);
+            CHECK(r[0]["s"].as<std::string>() == "abc");
+            CHECK(r[0]["n"].isNull());
+            CHECK(r[0]["n"].as<int64_t>() == 0);
+        } >>
+        [TEST_CTX](const DrogonDbException &e) {
+            FAULT("sqlite3 - Unboxed column values what():", e.base().what());
+        };
+    // Values that don't fit the type are not truncated
+    *clientPtr << "select 3000000000 as big, -1 as negative, 1e300 as huge" >>
+        [TEST_CTX](const Result &r) {
+            MANDATE(r.size() == 1);
+            CHECK_THROWS_AS(r[0]["big"].as<int>(), RangeError);
+            CHECK(r[0]["big"].as<unsigned int>() == 3000000000u);
+            CHECK(r[0]["big"].as<int64_t>() == 3000000000);
+            CHECK_THROWS_AS(r[0]["negative"].as<unsigned int>(), RangeError);
+            CHECK_THROWS_AS(r[0]["negative"].as<uint8_t>(), RangeError);
+            CHECK(r[0]["negative"].as<int8_t>() == -1);
+            CHECK_THROWS_AS(r[0]["huge"].as<float>(), RangeError);
+            CHECK(r[0]["huge"].as<double>() == 1e300);
+        } >>
+        [TEST_CTX](const DrogonDbException &e) {
+            FAULT("sqlite3 - Out of range values what():", e.base().what());
+        };
 
     *clientPtr << "CREATE TABLE users "
                   "("
@@ -3918,6 +3953,317 @@ DROGON_TEST(SQLite3Test)
         }
     }
 }
+
+DROGON_TEST(SQLite3WalTest)
+{
+    std::remove("drogon_wal_test.db");
+    auto clientPtr = DbClient::newSqlite3Client(
+        "filename=drogon_wal_test.db journal_mode=wal", 3);
+    REQUIRE(clientPtr != nullptr);
+    try
+    {
+        auto r = clientPtr->execSqlSync("PRAGMA journal_mode");
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<std::string>() == "wal");
+        clientPtr->execSqlSync(
+            "CREATE TABLE wal_test (id INTEGER PRIMARY KEY, name TEXT)");
+        r = clientPtr->execSqlSync("insert into wal_test (name) values (?)",
+                                   "drogon");
+        CHECK(r.affectedRows() == 1);
+        auto id = r.insertId();
+        // Served by one of the read-only connections
+        r = clientPtr->execSqlSync("select name from wal_test where id = ?",
+                                   id);
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<std::string>() == "drogon");
+        // Only the writer knows the rows it inserted
+        r = clientPtr->execSqlSync("select last_insert_rowid(), changes()");
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<uint64_t>() == id);
+        CHECK(r[0][1].as<int>() == 1);
+    }
+    catch (const DrogonDbException &e)
+    {
+        FAULT("sqlite3 - WAL mode what():", e.base().what());
+    }
+    clientPtr->closeAll();
+    std::remove("drogon_wal_test.db");
+    std::remove("drogon_wal_test.db-wal");
+    std::remove("drogon_wal_test.db-shm");
+}
+
+DROGON_TEST(SQLite3CacheTest)
+{
+    QueryCacheOptions options;
+    options.ttl = 60.0;
+    auto clientPtr = CachedDbClient::newCachedClient(
+        DbClient::newSqlite3Client("filename=:memory:", 1), options);
+    REQUIRE(clientPtr != nullptr);
+    try
+    {
+        clientPtr->execSqlSync(
+            "CREATE TABLE cache_test (id INTEGER PRIMARY KEY, name TEXT)");
+        clientPtr->execSqlSync("insert into cache_test (name) values (?)",
+                               "drogon");
+        auto r1 = clientPtr->execSqlSync(
+            "select name from cache_test where id = ?", 1);
+        auto r2 = clientPtr->execSqlSync(
+            "select name from cache_test where id = ?", 1);
+        MANDATE(r2.size() == 1);
+        CHECK(r2[0][0].as<std::string>() == "drogon");
+        CHECK(clientPtr->hits() == 1);
+        CHECK(clientPtr->misses() == 1);
+        // Different parameters are different entries
+        auto r3 = clientPtr->execSqlSync(
+            "select name from cache_test where id = ?", 2);
+        CHECK(r3.size() == 0);
+        CHECK(clientPtr->size() == 2);
+
+        // A write to the table invalidates its results
+        clientPtr->execSqlSync("update cache_test set name = ? where id = ?",
+                               "trantor",
+                               1);
+        CHECK(clientPtr->size() == 0);
+        r1 = clientPtr->execSqlSync(
+            "select name from cache_test where id = ?", 1);
+        MANDATE(r1.size() == 1);
+        CHECK(r1[0][0].as<std::string>() == "trantor");
+
+        // So does a committed transaction
+        {
+            auto trans = clientPtr->newTransaction();
+            trans->execSqlSync("update cache_test set name = ? where id = ?",
+                               "drogon",
+                               1);
+        }
+        std::this_thread::sleep_for(100ms);
+        r1 = clientPtr->execSqlSync(
+            "select name from cache_test where id = ?", 1);
+        MANDATE(r1.size() == 1);
+        CHECK(r1[0][0].as<std::string>() == "drogon");
+
+        clientPtr->invalidate("CACHE_TEST");
+        CHECK(clientPtr->size() == 0);
+    }
+    catch (const DrogonDbException &e)
+    {
+        FAULT("sqlite3 - Query cache what():", e.base().what());
+    }
+}
+
+DROGON_TEST(SQLite3BindingTest)
+{
+    auto clientPtr = DbClient::newSqlite3Client("filename=:memory:", 1);
+    REQUIRE(clientPtr != nullptr);
+    try
+    {
+        // More parameters than the inline slots of a statement
+        std::string name = "a name longer than the small string buffer";
+        auto r = clientPtr->execSqlSync(
+            "select ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?",
+            (int8_t)1,
+            (int16_t)2,
+            3,
+            (int64_t)4,
+            5.5,
+            true,
+            StringRef(name),
+            name,
+            std::string(name),
+            std::string_view(name),
+            nullptr,
+            (int64_t)12);
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<int>() == 1);
+        CHECK(r[0][1].as<int>() == 2);
+        CHECK(r[0][2].as<int>() == 3);
+        CHECK(r[0][3].as<int64_t>() == 4);
+        CHECK(r[0][4].as<double>() == 5.5);
+        CHECK(r[0][5].as<int>() == 1);
+        CHECK(r[0][6].as<std::string>() == name);
+        CHECK(r[0][7].as<std::string>() == name);
+        CHECK(r[0][8].as<std::string>() == name);
+        CHECK(r[0][9].as<std::string>() == name);
+        CHECK(r[0][10].isNull());
+        CHECK(r[0][11].as<int64_t>() == 12);
+    }
+    catch (const DrogonDbException &e)
+    {
+        FAULT("sqlite3 - Binding what():", e.base().what());
+    }
+}
+
+DROGON_TEST(SQLite3SqlStringTest)
+{
+    auto clientPtr = DbClient::newSqlite3Client("filename=:memory:", 1);
+    REQUIRE(clientPtr != nullptr);
+    try
+    {
+        auto r = clientPtr->execSqlSync("select ?"_sqlLiteral, 1);
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<int>() == 1);
+        r = clientPtr->execSqlSync(SqlLiteral("select ? "
+                                              "as value"),
+                                   4);
+        MANDATE(r.size() == 1);
+        CHECK(r[0]["value"].as<int>() == 4);
+        *clientPtr << "select ?, "
+                      "?"_sqlLiteral
+                   << 5 << "five" << Mode::Blocking >>
+            [TEST_CTX](const Result &r) {
+                MANDATE(r.size() == 1);
+                CHECK(r[0][0].as<int>() == 5);
+                CHECK(r[0][1].as<std::string>() == "five");
+            } >>
+            [TEST_CTX](const DrogonDbException &e) {
+                FAULT("sqlite3 - SQL literal what():", e.base().what());
+            };
+
+        // A char array is copied up to its NUL, it may be freed before the
+        // statement completes.
+        auto buffer = std::make_unique<char[]>(64);
+        strcpy(buffer.get(), "select ?");
+        auto f = clientPtr->execSqlAsyncFuture(buffer.get(), 2);
+        char array[64] = "select ? as value";
+        auto rows = clientPtr->query<int>(array, 3);
+        buffer.reset();
+        r = f.get();
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<int>() == 2);
+        MANDATE(rows.size() == 1);
+        CHECK(rows[0] == 3);
+    }
+    catch (const DrogonDbException &e)
+    {
+        FAULT("sqlite3 - SQL string what():", e.base().what());
+    }
+}
+
+struct TypedQueryRow
+{
+    int64_t id;
+    std::string name;
+    std::optional<double> score;
+};
+
+template <>
+struct drogon::orm::RowFields<TypedQueryRow>
+{
+    static constexpr auto value = std::make_tuple(&TypedQueryRow::id,
+                                                  &TypedQueryRow::name,
+                                                  &TypedQueryRow::score);
+};
+
+DROGON_TEST(SQLite3TypedQueryTest)
+{
+    auto clientPtr = DbClient::newSqlite3Client("filename=:memory:", 1);
+    REQUIRE(clientPtr != nullptr);
+    try
+    {
+        clientPtr->execSqlSync(
+            "CREATE TABLE typed_test (id INTEGER PRIMARY KEY, name TEXT, "
+            "score REAL)");
+        clientPtr->execSqlSync(
+            "insert into typed_test (name, score) values (?, ?), (?, ?)",
+            "drogon",
+            1.5,
+            "trantor",
+            nullptr);
+
+        auto tuples = clientPtr->query<int64_t, std::string>(
+            "select id, name from typed_test order by id");
+        MANDATE(tuples.size() == 2);
+        CHECK(std::get<0>(tuples[0]) == 1);
+        CHECK(std::get<1>(tuples[1]) == "trantor");
+
+        auto rows = clientPtr->query<TypedQueryRow>(
+            "select id, name, score from typed_test where id > ? order by id",
+            0);
+        MANDATE(rows.size() == 2);
+        CHECK(rows[0].name == "drogon");
+        MANDATE(rows[0].score.has_value());
+        CHECK(*rows[0].score == 1.5);
+        CHECK(!rows[1].score.has_value());
+
+        auto counts =
+            clientPtr->query<int64_t>("select count(*) from typed_test");
+        MANDATE(counts.size() == 1);
+        CHECK(counts[0] == 2);
+
+        // The column count is checked
+        CHECK_THROWS_AS(clientPtr->query<int64_t>(
+                            "select id, name from typed_test"),
+                        ConversionError);
+    }
+    catch (const DrogonDbException &e)
+    {
+        FAULT("sqlite3 - Typed query what():", e.base().what());
+    }
+
+    clientPtr->queryAsync<int64_t, std::string>(
+        "select id, name from typed_test where id = ?",
+        [TEST_CTX,
+         clientPtr](std::vector<std::tuple<int64_t, std::string>> rows) {
+            MANDATE(rows.size() == 1);
+            CHECK(std::get<1>(rows[0]) == "trantor");
+        },
+        [TEST_CTX](const DrogonDbException &e) {
+            FAULT("sqlite3 - Typed async query what():", e.base().what());
+        },
+        2);
+}
+
+DROGON_TEST(SQLite3CancelTest)
+{
+    // A statement that runs for minutes unless it is interrupted
+    static const std::string slowSql =
+        "with recursive c(x) as (select 1 union all select x + 1 from c "
+        "where x < 1000000000) select count(*) from c";
+    auto start = std::chrono::steady_clock::now();
+
+    auto clientPtr = DbClient::newSqlite3Client("filename=:memory:", 1);
+    REQUIRE(clientPtr != nullptr);
+    auto token = std::make_shared<CancelToken>();
+    *clientPtr << slowSql << token >> [TEST_CTX](const Result &) {
+        FAULT("sqlite3 - The cancelled statement returned a result");
+    } >> [TEST_CTX, clientPtr, start](const DrogonDbException &e) {
+        CHECK(dynamic_cast<const CancelledError *>(&e) != nullptr);
+        // The only connection is free again
+        clientPtr->execSqlAsync(
+            "select 1",
+            [TEST_CTX, start](const Result &r) {
+                CHECK(r.size() == 1);
+                CHECK(std::chrono::steady_clock::now() - start < 10s);
+            },
+            [TEST_CTX](const DrogonDbException &e) {
+                FAULT("sqlite3 - Cancel test what():", e.base().what());
+            });
+    };
+
+    auto timeoutClientPtr = DbClient::newSqlite3Client("filename=:memory:", 1);
+    REQUIRE(timeoutClientPtr != nullptr);
+    timeoutClientPtr->setTimeout(0.1);
+    timeoutClientPtr->execSqlAsync(
+        slowSql,
+        [TEST_CTX](const Result &) {
+            FAULT("sqlite3 - The statement didn't time out");
+        },
+        [TEST_CTX, timeoutClientPtr, start](const DrogonDbException &e) {
+            CHECK(dynamic_cast<const TimeoutError *>(&e) != nullptr);
+            timeoutClientPtr->execSqlAsync(
+                "select 1",
+                [TEST_CTX, start](const Result &r) {
+                    CHECK(r.size() == 1);
+                    CHECK(std::chrono::steady_clock::now() - start < 10s);
+                },
+                [TEST_CTX](const DrogonDbException &e) {
+                    FAULT("sqlite3 - Timeout test what():", e.base().what());
+                });
+        });
+
+    std::this_thread::sleep_for(100ms);
+    token->cancel();
+}
 #endif
 
 using namespace drogon;
@@ -228,6 +228,127 @@ DROGON_TEST(PgPipelineTest)
     runNextStep();
 }
 
+DROGON_TEST(PgBatchWindowTest)
+{
+    auto clientPtr = orm::DbClient::newPgClient(
+        "host=127.0.0.1 port=5432 dbname=postgres user=postgres "
+        "password=12345",
+        1,
+        true);
+    orm::BatchOptions options;
+    options.maxBatchSize = 8;
+    options.batchWindow = 0.005;
+    clientPtr->setBatchOptions(options);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    // Queries issued within the window share synchronization points, but a
+    // batch never exceeds the maximum size.
+    std::vector<std::future<orm::Result>> results;
+    for (int i = 0; i < 32; ++i)
+    {
+        results.push_back(
+            clientPtr->execSqlAsyncFuture("select $1::int as value", i));
+    }
+    for (int i = 0; i < 32; ++i)
+    {
+        try
+        {
+            auto r = results[i].get();
+            MANDATE(r.size() == 1);
+            CHECK(r[0]["value"].as<int>() == i);
+        }
+        catch (const orm::DrogonDbException &e)
+        {
+            FAULT("PgBatchWindowTest what():" + std::string(e.base().what()));
+        }
+    }
+    auto stats = clientPtr->batchStatistics();
+    CHECK(stats.queries == 32);
+    CHECK(stats.maxBatchSize <= 8);
+    CHECK(stats.batches >= 4);
+    CHECK(stats.batches < 32);
+    uint64_t histogramTotal = 0;
+    for (auto n : stats.sizeHistogram)
+        histogramTotal += n;
+    CHECK(histogramTotal == stats.batches);
+}
+
+DROGON_TEST(PgPipelinedTransactionTest)
+{
+    auto clientPtr = orm::DbClient::newPgClient(
+        "host=127.0.0.1 port=5432 dbname=postgres user=postgres "
+        "password=12345",
+        1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    try
+    {
+        clientPtr->execSqlSync(
+            "drop table if exists drogon_test_pipeline_trans");
+        clientPtr->execSqlSync(
+            "create table drogon_test_pipeline_trans (id int primary key)");
+    }
+    catch (const orm::DrogonDbException &e)
+    {
+        FAULT("PgPipelinedTransactionTest(init) what():" +
+              std::string(e.base().what()));
+    }
+
+    // The statements are sent without waiting for each other
+    auto committed = std::make_shared<std::promise<bool>>();
+    {
+        auto trans = clientPtr->newTransaction(
+            [committed](bool ok) { committed->set_value(ok); });
+        std::vector<std::future<orm::Result>> results;
+        for (int i = 1; i <= 3; ++i)
+        {
+            results.push_back(trans->execSqlAsyncFuture(
+                "insert into drogon_test_pipeline_trans values ($1)", i));
+        }
+        for (auto &r : results)
+        {
+            try
+            {
+                CHECK(r.get().affectedRows() == 1);
+            }
+            catch (const orm::DrogonDbException &e)
+            {
+                FAULT("PgPipelinedTransactionTest(insert) what():" +
+                      std::string(e.base().what()));
+            }
+        }
+    }
+    CHECK(committed->get_future().get() == true);
+
+    // The first error rolls back the transaction, the statements after it
+    // are not executed.
+    {
+        auto trans = clientPtr->newTransaction([TEST_CTX](bool) {
+            FAULT("A failed transaction must not be committed");
+        });
+        auto r1 = trans->execSqlAsyncFuture(
+            "insert into drogon_test_pipeline_trans values ($1)", 4);
+        auto r2 = trans->execSqlAsyncFuture(
+            "insert into drogon_test_pipeline_trans values ($1)", 1);
+        auto r3 = trans->execSqlAsyncFuture(
+            "insert into drogon_test_pipeline_trans values ($1)", 5);
+        CHECK_NOTHROW(r1.get());
+        CHECK_THROWS_AS(r2.get(), orm::DrogonDbException);
+        CHECK_THROWS_AS(r3.get(), orm::TransactionRollback);
+    }
+    try
+    {
+        auto r = clientPtr->execSqlSync(
+            "select count(*) from drogon_test_pipeline_trans");
+        CHECK(r[0][0].as<int64_t>() == 3);
+        clientPtr->execSqlSync("drop table drogon_test_pipeline_trans");
+    }
+    catch (const orm::DrogonDbException &e)
+    {
+        FAULT("PgPipelinedTransactionTest(check) what():" +
+              std::string(e.base().what()));
+    }
+}
+
 #endif
 
 int main(int argc, char **argv)
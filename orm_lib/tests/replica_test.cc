@@ -0,0 +1,91 @@
+#define DROGON_TEST_MAIN
+#include <drogon/drogon_test.h>
+#include <drogon/HttpAppFramework.h>
+#include <drogon/config.h>
+
+using namespace drogon;
+using namespace trantor;
+
+#if USE_POSTGRESQL
+DROGON_TEST(ReplicaTest)
+{
+    auto clientPtr = app().getDbClient();
+    REQUIRE(clientPtr != nullptr);
+    try
+    {
+        // Writes and transactions go to the primary server
+        clientPtr->execSqlSync("drop table if exists drogon_test_replica");
+        clientPtr->execSqlSync(
+            "create table drogon_test_replica (id int primary key, name text)");
+        {
+            auto trans = clientPtr->newTransaction();
+            trans->execSqlSync(
+                "insert into drogon_test_replica values ($1, $2)", 1, "drogon");
+            trans->execSqlSync(
+                "insert into drogon_test_replica values ($1, $2)",
+                2,
+                "trantor");
+        }
+        // Reads are spread over the replicas
+        for (int i = 0; i < 20; ++i)
+        {
+            auto r = clientPtr->execSqlSync(
+                "select name from drogon_test_replica where id = $1",
+                i % 2 + 1);
+            MANDATE(r.size() == 1);
+            CHECK(r[0][0].as<std::string>() ==
+                  (i % 2 == 0 ? "drogon" : "trantor"));
+        }
+        auto r = clientPtr->execSqlSync(
+            "/*replica*/ with t as (select count(*) as c from "
+            "drogon_test_replica) select c from t");
+        MANDATE(r.size() == 1);
+        CHECK(r[0][0].as<int64_t>() == 2);
+        // Row locks must be taken on the primary server
+        r = clientPtr->execSqlSync(
+            "select name from drogon_test_replica where id = 1 for update");
+        MANDATE(r.size() == 1);
+        clientPtr->execSqlSync("drop table drogon_test_replica");
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        FAULT("ReplicaTest what():", e.base().what());
+    }
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    std::promise<void> p1;
+    std::future<void> f1 = p1.get_future();
+    app().setThreadNum(1);
+#if USE_POSTGRESQL
+    // The local server plays both roles, it is never behind itself.
+    orm::PostgresConfig config{"127.0.0.1",  // host
+                               5432,         // port
+                               "postgres",   // dbname
+                               "postgres",   // username
+                               "12345",      // password
+                               2,            // connectionNum
+                               "default",    // name
+                               false,        // isFast
+                               "",           // charset
+                               10,           // timeout
+                               false,        // autobatch
+                               {}};          // connectOptions
+    config.replicas = {{"127.0.0.1", 5432}, {"localhost", 5432}};
+    config.replicaCheckInterval = 1.0;
+    config.maxReplicaLag = 10.0;
+    app().addDbClient(config);
+#endif
+    std::thread thr([&]() {
+        app().getLoop()->queueInLoop([&]() { p1.set_value(); });
+        app().run();
+    });
+
+    f1.get();
+    int testStatus = test::run(argc, argv);
+    app().getLoop()->queueInLoop([]() { app().quit(); });
+    thr.join();
+    return testStatus;
+}
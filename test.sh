@@ -236,6 +236,14 @@ function do_db_test()
             exit -1
         fi
     fi
+    if [ -f "./orm_lib/tests/replica_test" ]; then
+        echo "Test read replicas"
+        ./orm_lib/tests/replica_test -s
+        if [ $? -ne 0 ]; then
+            echo "Error in testing"
+            exit -1
+        fi
+    fi
     if [ -f "./nosql_lib/redis/tests/redis_test" ]; then
         echo "Test redis"
         ./nosql_lib/redis/tests/redis_test -s